@@ -0,0 +1,248 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2007-2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2009-2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#if HAVE_SYS_EVENTFD_H
+# include <sys/eventfd.h>
+# include <unistd.h>
+# include <poll.h>
+#endif
+
+#include "xthreads.h"
+#include "types.h"
+#include "bytering.h"
+
+#define CACHE_LINE_SIZE		64
+
+struct _aaxByteRing_s
+{
+   /* the producer and consumer positions are kept on separate cache lines */
+   atomic_size_t head;	/* write position, only changed by the producer */
+   char pad1[CACHE_LINE_SIZE - sizeof(atomic_size_t)];
+   atomic_size_t tail;	/* read position, only changed by the consumer */
+   char pad2[CACHE_LINE_SIZE - sizeof(atomic_size_t)];
+
+   unsigned char *data;
+   size_t mask;
+
+#if HAVE_SYS_EVENTFD_H
+   int event;
+#else
+   mtx_t mutex;
+   cnd_t cond;
+   atomic_bool woken;
+#endif
+};
+
+_aaxByteRing*
+_aaxByteRingCreate(size_t size)
+{
+   _aaxByteRing *rv;
+   size_t s = 1;
+
+   while (s < size) s <<= 1;
+
+   rv = calloc(1, sizeof(_aaxByteRing) + s);
+   if (rv)
+   {
+      rv->data = (unsigned char*)(rv+1);
+      rv->mask = s-1;
+      atomic_init(&rv->head, 0);
+      atomic_init(&rv->tail, 0);
+
+#if HAVE_SYS_EVENTFD_H
+      rv->event = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+      if (rv->event < 0)
+      {
+         free(rv);
+         rv = NULL;
+      }
+#else
+      mtx_init(&rv->mutex, mtx_plain);
+      cnd_init(&rv->cond);
+      atomic_init(&rv->woken, false);
+#endif
+   }
+
+   return rv;
+}
+
+void
+_aaxByteRingDestroy(_aaxByteRing *ring)
+{
+   if (ring)
+   {
+#if HAVE_SYS_EVENTFD_H
+      close(ring->event);
+#else
+      cnd_destroy(&ring->cond);
+      mtx_destroy(&ring->mutex);
+#endif
+      free(ring);
+   }
+}
+
+size_t
+_aaxByteRingWrite(_aaxByteRing *ring, const void *data, size_t size)
+{
+   size_t head, tail, offs, len;
+
+   assert(ring);
+
+   head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+   tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+   size = _MIN(size, ring->mask+1 - (head - tail));
+   offs = head & ring->mask;
+   len = _MIN(size, ring->mask+1 - offs);
+
+   memcpy(ring->data+offs, data, len);
+   memcpy(ring->data, (const unsigned char*)data+len, size-len);
+
+   atomic_store_explicit(&ring->head, head+size, memory_order_release);
+
+   return size;
+}
+
+size_t
+_aaxByteRingGetFreeSpace(_aaxByteRing *ring)
+{
+   size_t head, tail;
+
+   assert(ring);
+
+   head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+   tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+   return ring->mask+1 - (head - tail);
+}
+
+size_t
+_aaxByteRingRead(_aaxByteRing *ring, void *data, size_t size)
+{
+   size_t head, tail, offs, len;
+
+   assert(ring);
+
+   tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+   head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+   size = _MIN(size, head - tail);
+   offs = tail & ring->mask;
+   len = _MIN(size, ring->mask+1 - offs);
+
+   memcpy(data, ring->data+offs, len);
+   memcpy((unsigned char*)data+len, ring->data, size-len);
+
+   atomic_store_explicit(&ring->tail, tail+size, memory_order_release);
+
+   return size;
+}
+
+size_t
+_aaxByteRingGetDataAvail(_aaxByteRing *ring)
+{
+   size_t head, tail;
+
+   assert(ring);
+
+   tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+   head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+   return head - tail;
+}
+
+/* Discard all data which is in the ring right now. */
+void
+_aaxByteRingClear(_aaxByteRing *ring)
+{
+   size_t head;
+
+   assert(ring);
+
+   head = atomic_load_explicit(&ring->head, memory_order_acquire);
+   atomic_store_explicit(&ring->tail, head, memory_order_release);
+}
+
+void
+_aaxByteRingWake(_aaxByteRing *ring)
+{
+#if HAVE_SYS_EVENTFD_H
+   uint64_t one = 1;
+   ssize_t res;
+
+   assert(ring);
+
+   /* the counter can not overflow before the waiter reads it */
+   res = write(ring->event, &one, sizeof(one));
+   (void)res;
+#else
+   assert(ring);
+
+   /*
+    * Never wait for the mutex: if the other thread holds it, it either
+    * sees the flag or it misses the signal and wakes up after its timeout.
+    */
+   atomic_store(&ring->woken, true);
+   if (mtx_trylock(&ring->mutex) == thrd_success)
+   {
+      cnd_signal(&ring->cond);
+      mtx_unlock(&ring->mutex);
+   }
+#endif
+}
+
+/* Returns true if woken up by _aaxByteRingWake, false after dt seconds. */
+bool
+_aaxByteRingWaitTimed(_aaxByteRing *ring, float dt)
+{
+   bool rv = false;
+#if HAVE_SYS_EVENTFD_H
+   struct pollfd pfd;
+   uint64_t count;
+
+   assert(ring);
+
+   pfd.fd = ring->event;
+   pfd.events = POLLIN;
+   pfd.revents = 0;
+   if (poll(&pfd, 1, _MAX((int)(dt*1000.0f), 1)) > 0) {
+      rv = (read(ring->event, &count, sizeof(count)) == sizeof(count));
+   }
+#else
+   assert(ring);
+
+   mtx_lock(&ring->mutex);
+   if (!atomic_load(&ring->woken))
+   {
+      struct timespec to;
+
+      timespec_get(&to, TIME_UTC);
+      to.tv_nsec += dt*1e9f;
+      if (to.tv_nsec >= 1000000000LL)
+      {
+         to.tv_sec += to.tv_nsec/1000000000LL;
+         to.tv_nsec %= 1000000000LL;
+      }
+      cnd_timedwait(&ring->cond, &ring->mutex, &to);
+   }
+   rv = atomic_exchange(&ring->woken, false);
+   mtx_unlock(&ring->mutex);
+#endif
+
+   return rv;
+}
+
@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2007-2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2009-2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#ifndef __AAX_BYTERING_H
+#define __AAX_BYTERING_H 1
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * A wait-free byte ring for one producer thread and one consumer thread.
+ *
+ * _aaxByteRingWrite and _aaxByteRingGetFreeSpace may only be called by the
+ * producer, _aaxByteRingRead, _aaxByteRingGetDataAvail and _aaxByteRingClear
+ * only by the consumer. Neither side ever waits for the other.
+ *
+ * _aaxByteRingWake wakes up a thread which is waiting in
+ * _aaxByteRingWaitTimed, a wakeup which arrives before the other thread
+ * waits is not lost. It uses an eventfd where available and never blocks.
+ * Without an eventfd a wakeup may be delayed until the timeout of the
+ * waiting thread if it arrives just as that thread starts to wait.
+ *
+ * The size will be rounded up to a power of two.
+ */
+typedef struct _aaxByteRing_s _aaxByteRing;
+
+_aaxByteRing *_aaxByteRingCreate(size_t);
+void _aaxByteRingDestroy(_aaxByteRing*);
+
+size_t _aaxByteRingWrite(_aaxByteRing*, const void*, size_t);
+size_t _aaxByteRingGetFreeSpace(_aaxByteRing*);
+
+size_t _aaxByteRingRead(_aaxByteRing*, void*, size_t);
+size_t _aaxByteRingGetDataAvail(_aaxByteRing*);
+void _aaxByteRingClear(_aaxByteRing*);
+
+void _aaxByteRingWake(_aaxByteRing*);
+bool _aaxByteRingWaitTimed(_aaxByteRing*, float);
+
+#if defined(__cplusplus)
+}  /* extern "C" */
+#endif
+
+#endif /* !__AAX_BYTERING_H */
+
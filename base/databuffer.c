@@ -27,6 +27,39 @@
 
 #define DATA_ID	0xDFA82736
 
+static inline unsigned char*
+_aaxDataStart(_data_t *buf, unsigned char buffer_no)
+{
+   unsigned char *rv = buf->data[buffer_no];
+   if (buf->start) rv += buf->start[buffer_no];
+   return rv;
+}
+
+/* remove size bytes from the start of the buffer */
+static void
+_aaxDataConsume(_data_t *buf, unsigned char buffer_no, size_t size)
+{
+   buf->offset[buffer_no] -= size;
+   if (buf->start)
+   {
+      if (buf->offset[buffer_no] > 0)
+      {
+         buf->start[buffer_no] += size;
+         if (buf->start[buffer_no] >= buf->size) {
+            buf->start[buffer_no] -= buf->size;
+         }
+      }
+      else {
+         buf->start[buffer_no] = 0;
+      }
+   }
+   else if (buf->offset[buffer_no] > 0)
+   {
+      memmove(buf->data[buffer_no], buf->data[buffer_no]+size,
+              buf->offset[buffer_no]);
+   }
+}
+
 static unsigned char**
 _aaxDataAlloc(unsigned char no_buffers, size_t buffersize)
 {
@@ -65,6 +98,7 @@ _aaxDataCreate(unsigned char no_buffers, size_t size, unsigned int blocksize)
          if (rv->offset)
          {
             rv->id = DATA_ID;
+            rv->start = NULL;
             rv->size = size;
             rv->no_buffers = no_buffers;
             rv->blocksize = blocksize;
@@ -84,13 +118,67 @@ _aaxDataCreate(unsigned char no_buffers, size_t size, unsigned int blocksize)
    return rv;
 }
 
+_data_t*
+_aaxDataCreateRing(unsigned char no_buffers, size_t size, unsigned int blocksize)
+{
+   _data_t* rv = calloc(1, sizeof(_data_t));
+   if (rv)
+   {
+      if (!blocksize) ++blocksize;
+
+      rv->id = DATA_ID;
+      rv->size = size*blocksize;
+      rv->no_buffers = no_buffers;
+      rv->blocksize = blocksize;
+
+      rv->data = calloc(no_buffers, sizeof(unsigned char*));
+      rv->offset = calloc(no_buffers, sizeof(size_t));
+      rv->start = calloc(no_buffers, sizeof(size_t));
+      if (rv->data && rv->offset && rv->start)
+      {
+         int t;
+         for (t=0; t<no_buffers; ++t)
+         {
+            size_t len = size*blocksize;
+
+            rv->data[t] = _aax_mirror_alloc(&len);
+            if (!rv->data[t]) break;
+
+            rv->size = len;
+         }
+
+         if (t < no_buffers)
+         {
+            _aaxDataDestroy(rv);
+            rv = NULL;
+         }
+      }
+      else
+      {
+         _aaxDataDestroy(rv);
+         rv = NULL;
+      }
+   }
+
+   if (!rv) {
+      rv = _aaxDataCreate(no_buffers, size, blocksize);
+   }
+
+   return rv;
+}
+
 void
 _aaxDataClear(_data_t* buf, unsigned char buffer_no)
 {
-   if (buffer_no < buf->no_buffers) {
+   if (buffer_no < buf->no_buffers)
+   {
       buf->offset[buffer_no] = 0;
-   } else if (buffer_no == (unsigned char)-1) {
+      if (buf->start) buf->start[buffer_no] = 0;
+   }
+   else if (buffer_no == (unsigned char)-1)
+   {
       memset(buf->offset, 0, buf->no_buffers*sizeof(size_t));
+      if (buf->start) memset(buf->start, 0, buf->no_buffers*sizeof(size_t));
    }
 }
 
@@ -103,6 +191,15 @@ _aaxDataDestroy(_data_t* buf)
 
       buf->id = FADEDBAD;
 
+      if (buf->start && buf->data)
+      {
+         int t;
+         for (t=0; t<buf->no_buffers; ++t) {
+            _aax_mirror_free(buf->data[t], buf->size);
+         }
+      }
+
+      free(buf->start);
       free(buf->offset);
       free(buf->data);
       free(buf);
@@ -129,7 +226,7 @@ _aaxDataAdd(_data_t* buf, unsigned char buffer_no, const void* data, size_t size
 
       if (rv)
       {
-         memcpy(buf->data[buffer_no]+buf->offset[buffer_no], data, rv);
+         memcpy(_aaxDataStart(buf, buffer_no)+buf->offset[buffer_no], data, rv);
          buf->offset[buffer_no] += rv;
       }
    }
@@ -154,7 +251,7 @@ _aaxDataCopy(_data_t* buf, unsigned char buffer_no, void* data, size_t offset, s
 
       rv = _MIN((size/buf->blocksize)*buf->blocksize, remain);
       if (rv) {
-         memcpy(data, buf->data[buffer_no]+offset, rv);
+         memcpy(data, _aaxDataStart(buf, buffer_no)+offset, rv);
       }
    }
 
@@ -178,13 +275,9 @@ _aaxDataMove(_data_t* buf, unsigned char buffer_no, void* data, size_t size)
       if (rv)
       {
          if (data) {
-            memcpy(data, buf->data[buffer_no], rv);
-         }
-
-         buf->offset[buffer_no] -= rv;
-         if (buf->offset[buffer_no] > 0) {
-            memmove(buf->data[buffer_no], buf->data[buffer_no]+rv, buf->offset[buffer_no]);
+            memcpy(data, _aaxDataStart(buf, buffer_no), rv);
          }
+         _aaxDataConsume(buf, buffer_no, rv);
       }
    }
 
@@ -208,14 +301,16 @@ _aaxDataMoveOffset(_data_t* buf, unsigned char buffer_no, void* data, size_t off
       rv = _MIN((size/buf->blocksize)*buf->blocksize, remain);
       if (rv)
       {
+         unsigned char *ptr = _aaxDataStart(buf, buffer_no);
+
          if (data) {
-            memcpy(data, buf->data[buffer_no]+offset, rv);
+            memcpy(data, ptr+offset, rv);
          }
 
          remain -= rv;
          buf->offset[buffer_no] -= rv;
          if (buf->offset[buffer_no] > 0 && remain > 0) {
-            memmove(buf->data[buffer_no]+offset, buf->data[buffer_no]+offset+rv, remain);
+            memmove(ptr+offset, ptr+offset+rv, remain);
          }
       }
    }
@@ -244,13 +339,11 @@ _aaxDataMoveData(_data_t* src, unsigned char src_no, _data_t* dst, unsigned char
          rv = dst->size - dst->offset[dst_no];
       }
 
-      memcpy(dst->data[dst_no]+dst->offset[dst_no], src->data[src_no], rv);
+      memcpy(_aaxDataStart(dst, dst_no)+dst->offset[dst_no],
+             _aaxDataStart(src, src_no), rv);
 
-      src->offset[src_no] -= rv;
       dst->offset[dst_no] += rv;
-      if (src->offset[src_no] > 0) {
-         memmove(src->data[src_no], src->data[src_no]+rv, src->offset[src_no]);
-      }
+      _aaxDataConsume(src, src_no, rv);
    }
 
    return rv;
@@ -264,7 +357,7 @@ _aaxDataGetData(_data_t *buf, unsigned char buffer_no)
    assert(buf->no_buffers > buffer_no);
 
    if (buf->no_buffers > buffer_no) {
-      rv = buf->data[buffer_no];
+      rv = _aaxDataStart(buf, buffer_no);
    }
 
    return rv;
@@ -278,7 +371,7 @@ _aaxDataGetPtr(_data_t *buf, unsigned char buffer_no)
    assert(buf->no_buffers > buffer_no);
 
    if (buf->no_buffers > buffer_no) {
-      rv = buf->data[buffer_no] + buf->offset[buffer_no];
+      rv = _aaxDataStart(buf, buffer_no) + buf->offset[buffer_no];
    }
 
    return rv;
@@ -21,6 +21,7 @@ typedef struct _data_st
    unsigned char no_buffers;
    unsigned int blocksize;
    size_t *offset; // or fill-level
+   size_t *start; // read position of a ring buffer, NULL otherwise
    size_t size;   // maximum buffer size
 
 } _data_t;
@@ -40,6 +41,20 @@ typedef struct _data_st
  */
 _data_t* _aaxDataCreate(unsigned char no_buffers, size_t size, unsigned int blocksize);
 
+/**
+ * Create a new data structure where removing data from the start only
+ * advances the read position instead of moving the remaining data.
+ * Every buffer is mapped twice in a row in virtual memory so the data,
+ * and the free space after it, is still contiguous when it wraps around.
+ * Falls back to _aaxDataCreate if mirrored mappings are not supported.
+ *
+ * Note: the pointer returned by _aaxDataGetData is only valid until the
+ * next call which removes data from the buffer.
+ *
+ * The size will be rounded up to a multiple of the page size.
+ */
+_data_t* _aaxDataCreateRing(unsigned char no_buffers, size_t size, unsigned int blocksize);
+
 /**
  * Destroy and clean up a data structure.
  *
@@ -0,0 +1,204 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2005-2023 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2009-2023 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#include "fft.h"
+
+#define FFT_2PI		6.28318530717958647692
+
+/*
+ * A real FFT of size n is calculated as a complex FFT of size n/2 of the
+ * even (real) and odd (imaginary) samples followed by a split pass which
+ * separates the two interleaved spectra again.
+ */
+
+_aax_fft_t *
+_aaxFFTCreate(unsigned int size)
+{
+   _aax_fft_t *rv = NULL;
+
+   if (size >= 4 && (size & (size-1)) == 0)
+   {
+      rv = calloc(1, sizeof(_aax_fft_t));
+      if (rv)
+      {
+         unsigned int i, bits, n = size/2;
+
+         rv->size = size;
+         rv->bitrev = malloc(n*sizeof(unsigned int));
+         rv->twiddle = malloc(2*(n/2)*sizeof(float));
+         rv->split = malloc(2*(n/2+1)*sizeof(float));
+         if (!rv->bitrev || !rv->twiddle || !rv->split)
+         {
+            _aaxFFTDestroy(rv);
+            return NULL;
+         }
+
+         for (bits=0; (1U << bits) < n; ++bits);
+         for (i=0; i<n; ++i)
+         {
+            unsigned int j, r = 0;
+            for (j=0; j<bits; ++j) {
+               if (i & (1U << j)) r |= 1U << (bits-1-j);
+            }
+            rv->bitrev[i] = r;
+         }
+
+         for (i=0; i<n/2; ++i)
+         {
+            double phi = -FFT_2PI*i/n;
+            rv->twiddle[2*i] = (float)cos(phi);
+            rv->twiddle[2*i+1] = (float)sin(phi);
+         }
+
+         for (i=0; i<=n/2; ++i)
+         {
+            double phi = -FFT_2PI*i/size;
+            rv->split[2*i] = (float)cos(phi);
+            rv->split[2*i+1] = (float)sin(phi);
+         }
+      }
+   }
+   return rv;
+}
+
+void
+_aaxFFTDestroy(_aax_fft_t *fft)
+{
+   if (fft)
+   {
+      free(fft->bitrev);
+      free(fft->twiddle);
+      free(fft->split);
+      free(fft);
+   }
+}
+
+/* in-place radix-2 complex FFT of bit-reversed input, sign < 0 is inverse */
+static void
+_fft_complex(float *d, unsigned int n, const float *tw, float sign)
+{
+   unsigned int len;
+
+   for (len=2; len<=n; len <<= 1)
+   {
+      unsigned int k, half = len/2;
+      unsigned int step = n/len;
+
+      for (k=0; k<half; ++k)
+      {
+         float wr = tw[2*k*step];
+         float wi = sign*tw[2*k*step+1];
+         unsigned int i;
+
+         for (i=k; i<n; i += len)
+         {
+            float *a = d + 2*i;
+            float *b = a + 2*half;
+            float tr = wr*b[0] - wi*b[1];
+            float ti = wr*b[1] + wi*b[0];
+
+            b[0] = a[0] - tr;
+            b[1] = a[1] - ti;
+            a[0] += tr;
+            a[1] += ti;
+         }
+      }
+   }
+}
+
+/* dst: size+2 floats (complex), src: size floats (real) */
+void
+_aaxFFTForward(const _aax_fft_t *fft, float *dst, const float *src)
+{
+   unsigned int k, n = fft->size/2;
+   float re, im;
+
+   assert(dst != src);
+
+   for (k=0; k<n; ++k)
+   {
+      unsigned int j = fft->bitrev[k];
+      dst[2*j] = src[2*k];
+      dst[2*j+1] = src[2*k+1];
+   }
+
+   _fft_complex(dst, n, fft->twiddle, 1.0f);
+
+   re = dst[0];
+   im = dst[1];
+   dst[0] = re + im;
+   dst[1] = 0.0f;
+   dst[2*n] = re - im;
+   dst[2*n+1] = 0.0f;
+
+   for (k=1; k<=n/2; ++k)
+   {
+      unsigned int j = n - k;
+      float wr = fft->split[2*k];
+      float wi = fft->split[2*k+1];
+      float er = 0.5f*(dst[2*k] + dst[2*j]);
+      float ei = 0.5f*(dst[2*k+1] - dst[2*j+1]);
+      float or = 0.5f*(dst[2*k+1] + dst[2*j+1]);
+      float oi = -0.5f*(dst[2*k] - dst[2*j]);
+      float tr = wr*or - wi*oi;
+      float ti = wr*oi + wi*or;
+
+      dst[2*k] = er + tr;
+      dst[2*k+1] = ei + ti;
+      dst[2*j] = er - tr;
+      dst[2*j+1] = ti - ei;
+   }
+}
+
+/* dst: size floats (real), src: size+2 floats (complex) */
+void
+_aaxFFTInverse(const _aax_fft_t *fft, float *dst, const float *src)
+{
+   unsigned int k, n = fft->size/2;
+   float scale = 1.0f/fft->size;
+
+   assert(dst != src);
+
+   dst[0] = src[0] + src[2*n];
+   dst[1] = src[0] - src[2*n];
+
+   for (k=1; k<=n/2; ++k)
+   {
+      unsigned int j = n - k;
+      unsigned int bk = fft->bitrev[k];
+      unsigned int bj = fft->bitrev[j];
+      float wr = fft->split[2*k];
+      float wi = fft->split[2*k+1];
+      float er = src[2*k] + src[2*j];
+      float ei = src[2*k+1] - src[2*j+1];
+      float dr = src[2*k] - src[2*j];
+      float di = src[2*k+1] + src[2*j+1];
+      float or = dr*wr + di*wi;
+      float oi = di*wr - dr*wi;
+
+      dst[2*bk] = er - oi;
+      dst[2*bk+1] = ei + or;
+      dst[2*bj] = er + oi;
+      dst[2*bj+1] = or - ei;
+   }
+
+   _fft_complex(dst, n, fft->twiddle, -1.0f);
+
+   for (k=0; k<2*n; ++k) {
+      dst[k] *= scale;
+   }
+}
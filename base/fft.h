@@ -0,0 +1,46 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2005-2023 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2009-2023 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#ifndef __AAX_FFT_H
+#define __AAX_FFT_H 1
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*
+ * Real-valued FFT of a power-of-two size.
+ *
+ * The spectrum is stored as size/2+1 interleaved complex values
+ * (re, im) which requires size+2 floats. The forward transform is not
+ * scaled, the inverse transform is scaled by 1/size so a round trip
+ * returns the original signal.
+ *
+ * A created object is read-only and may be shared by multiple threads.
+ */
+typedef struct _aax_fft_s
+{
+   unsigned int size;
+   unsigned int *bitrev;
+   float *twiddle;	/* size/4 complex values for the size/2 complex FFT */
+   float *split;	/* size/4+1 complex values for the real split pass  */
+} _aax_fft_t;
+
+_aax_fft_t *_aaxFFTCreate(unsigned int);
+void _aaxFFTDestroy(_aax_fft_t*);
+
+void _aaxFFTForward(const _aax_fft_t*, float*, const float*);
+void _aaxFFTInverse(const _aax_fft_t*, float*, const float*);
+
+#if defined(__cplusplus)
+}  /* extern "C" */
+#endif
+
+#endif /* !__AAX_FFT_H */
+
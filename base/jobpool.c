@@ -0,0 +1,299 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2007-2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2009-2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+
+#include "xthreads.h"
+#include "jobpool.h"
+
+typedef struct _aaxJob_s
+{
+   struct _aaxJob_s *next;
+   _aaxJobGroup *group;
+   _aaxJobFn *fn;
+   void *data;
+   unsigned int priority;
+} _aaxJob;
+
+struct _aaxJobPool_s
+{
+   mtx_t mutex;
+   cnd_t cond;		/* signaled on a new job and on job completion */
+
+   _aaxJob *head;
+   _aaxJob *tail;
+   bool quit;
+
+   unsigned int no_workers;
+   _aaxThread *worker[_AAX_MAX_NO_JOB_WORKERS];
+};
+
+static int _aaxJobPoolThread(void*);
+static void _aaxJobPoolRunOne(_aaxJobPool*, _aaxJob*);
+
+_aaxJobPool*
+_aaxJobPoolCreate(unsigned int no_workers, const char *name)
+{
+   _aaxJobPool *rv = NULL;
+
+   if (no_workers > _AAX_MAX_NO_JOB_WORKERS) {
+      no_workers = _AAX_MAX_NO_JOB_WORKERS;
+   }
+
+   if (no_workers) {
+      rv = calloc(1, sizeof(_aaxJobPool));
+   }
+
+   if (rv)
+   {
+      unsigned int i;
+
+      mtx_init(&rv->mutex, mtx_plain);
+      cnd_init(&rv->cond);
+
+      for (i=0; i<no_workers; ++i)
+      {
+         _aaxThread *t = _aaxThreadCreate();
+         if (!t) break;
+
+         if (_aaxThreadStart(t, _aaxJobPoolThread, rv, 0, name) != thrd_success)
+         {
+            _aaxThreadDestroy(t);
+            break;
+         }
+         rv->worker[rv->no_workers++] = t;
+      }
+
+      if (!rv->no_workers)
+      {
+         _aaxJobPoolDestroy(rv);
+         rv = NULL;
+      }
+   }
+
+   return rv;
+}
+
+void
+_aaxJobPoolDestroy(_aaxJobPool *pool)
+{
+   if (pool)
+   {
+      unsigned int i;
+
+      mtx_lock(&pool->mutex);
+      pool->quit = true;
+      cnd_broadcast(&pool->cond);
+      mtx_unlock(&pool->mutex);
+
+      for (i=0; i<pool->no_workers; ++i)
+      {
+         _aaxThreadJoin(pool->worker[i]);
+         _aaxThreadDestroy(pool->worker[i]);
+      }
+
+      /* run what is left so no job group is left waiting */
+      mtx_lock(&pool->mutex);
+      while (pool->head) {
+         _aaxJobPoolRunOne(pool, NULL);
+      }
+      mtx_unlock(&pool->mutex);
+
+      cnd_destroy(&pool->cond);
+      mtx_destroy(&pool->mutex);
+      free(pool);
+   }
+}
+
+void
+_aaxJobGroupInit(_aaxJobGroup *group)
+{
+   assert(group);
+
+   group->pending = 0;
+   group->result = true;
+}
+
+bool
+_aaxJobPoolAdd(_aaxJobPool *pool, _aaxJobGroup *group, _aaxJobFn *fn, void *data)
+{
+   return _aaxJobPoolAddPriority(pool, group, fn, data, UINT_MAX);
+}
+
+/*
+ * Jobs with a lower priority value are executed first, jobs with an equal
+ * priority value are executed in FIFO order.
+ */
+bool
+_aaxJobPoolAddPriority(_aaxJobPool *pool, _aaxJobGroup *group, _aaxJobFn *fn, void *data, unsigned int priority)
+{
+   _aaxJob *job = NULL;
+
+   assert(group);
+   assert(fn);
+
+   if (pool) {
+      job = malloc(sizeof(_aaxJob));
+   }
+
+   if (!job)
+   {
+      bool rv = fn(data) ? true : false;
+      if (pool) mtx_lock(&pool->mutex);
+      group->result &= rv;
+      if (pool) mtx_unlock(&pool->mutex);
+      return rv;
+   }
+
+   job->next = NULL;
+   job->group = group;
+   job->fn = fn;
+   job->data = data;
+   job->priority = priority;
+
+   mtx_lock(&pool->mutex);
+   if (!pool->tail || pool->tail->priority <= priority)
+   {
+      if (pool->tail) pool->tail->next = job;
+      else pool->head = job;
+      pool->tail = job;
+   }
+   else if (pool->head->priority > priority)
+   {
+      job->next = pool->head;
+      pool->head = job;
+   }
+   else
+   {
+      _aaxJob *prev = pool->head;
+      while (prev->next->priority <= priority) {
+         prev = prev->next;
+      }
+      job->next = prev->next;
+      prev->next = job;
+   }
+   group->pending++;
+   cnd_broadcast(&pool->cond);
+   mtx_unlock(&pool->mutex);
+
+   return true;
+}
+
+/*
+ * Run the job after prev, or the first job if prev is NULL.
+ * Must be called with the pool mutex locked, returns with it locked.
+ */
+static void
+_aaxJobPoolRunOne(_aaxJobPool *pool, _aaxJob *prev)
+{
+   _aaxJob *job = prev ? prev->next : pool->head;
+   bool rv;
+
+   if (prev) prev->next = job->next;
+   else pool->head = job->next;
+   if (pool->tail == job) pool->tail = prev;
+   mtx_unlock(&pool->mutex);
+
+   rv = job->fn(job->data) ? true : false;
+
+   mtx_lock(&pool->mutex);
+   job->group->result &= rv;
+   if (--job->group->pending == 0) {
+      cnd_broadcast(&pool->cond);
+   }
+   free(job);
+}
+
+bool
+_aaxJobPoolWait(_aaxJobPool *pool, _aaxJobGroup *group)
+{
+   bool rv;
+
+   assert(group);
+
+   if (!pool) return group->result;
+
+   mtx_lock(&pool->mutex);
+   while (group->pending)
+   {
+      if (pool->head) _aaxJobPoolRunOne(pool, NULL);
+      else cnd_wait(&pool->cond, &pool->mutex);
+   }
+   rv = group->result;
+   mtx_unlock(&pool->mutex);
+
+   return rv;
+}
+
+bool
+_aaxJobPoolWaitOwn(_aaxJobPool *pool, _aaxJobGroup *group)
+{
+   bool rv;
+
+   assert(group);
+
+   if (!pool) return group->result;
+
+   mtx_lock(&pool->mutex);
+   while (group->pending)
+   {
+      _aaxJob *prev = NULL, *job = pool->head;
+
+      while (job && job->group != group)
+      {
+         prev = job;
+         job = job->next;
+      }
+
+      if (job) _aaxJobPoolRunOne(pool, prev);
+      else cnd_wait(&pool->cond, &pool->mutex);
+   }
+   rv = group->result;
+   mtx_unlock(&pool->mutex);
+
+   return rv;
+}
+
+bool
+_aaxJobPoolBusy(_aaxJobPool *pool, _aaxJobGroup *group)
+{
+   bool rv;
+
+   assert(group);
+
+   if (!pool) return false;
+
+   mtx_lock(&pool->mutex);
+   rv = group->pending ? true : false;
+   mtx_unlock(&pool->mutex);
+
+   return rv;
+}
+
+static int
+_aaxJobPoolThread(void *id)
+{
+   _aaxJobPool *pool = id;
+
+   mtx_lock(&pool->mutex);
+   while (!pool->quit)
+   {
+      if (pool->head) _aaxJobPoolRunOne(pool, NULL);
+      else cnd_wait(&pool->cond, &pool->mutex);
+   }
+   mtx_unlock(&pool->mutex);
+
+   return 0;
+}
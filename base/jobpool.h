@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2007-2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2009-2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#ifndef __AAX_JOBPOOL_H
+#define __AAX_JOBPOOL_H 1
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#define _AAX_MAX_NO_JOB_WORKERS		16
+
+/*
+ * A pool of worker threads which execute queued jobs in FIFO order.
+ *
+ * Jobs are added to a job group and _aaxJobPoolWait blocks until all jobs
+ * of a group are finished. The waiting thread executes queued jobs itself
+ * while waiting, so a job may add jobs to the same pool and wait for them
+ * without the risk of a deadlock.
+ *
+ * _aaxJobPoolWaitOwn only executes queued jobs of the group itself and
+ * otherwise sleeps until the workers finished them, so the caller is never
+ * delayed by jobs of other groups.
+ *
+ * If no pool is available (NULL) the jobs are executed immediately.
+ *
+ * _aaxJobPoolAddPriority queues a job ahead of all jobs with a higher
+ * priority value, _aaxJobPoolAdd queues with the lowest priority.
+ */
+typedef int _aaxJobFn(void*);
+typedef struct _aaxJobPool_s _aaxJobPool;
+
+typedef struct
+{
+   int pending;
+   bool result;		/* true if all jobs returned true */
+} _aaxJobGroup;
+
+_aaxJobPool *_aaxJobPoolCreate(unsigned int, const char*);
+void _aaxJobPoolDestroy(_aaxJobPool*);
+
+void _aaxJobGroupInit(_aaxJobGroup*);
+bool _aaxJobPoolAdd(_aaxJobPool*, _aaxJobGroup*, _aaxJobFn*, void*);
+bool _aaxJobPoolAddPriority(_aaxJobPool*, _aaxJobGroup*, _aaxJobFn*, void*, unsigned int);
+bool _aaxJobPoolWait(_aaxJobPool*, _aaxJobGroup*);
+bool _aaxJobPoolWaitOwn(_aaxJobPool*, _aaxJobGroup*);
+bool _aaxJobPoolBusy(_aaxJobPool*, _aaxJobGroup*);
+
+#if defined(__cplusplus)
+}  /* extern "C" */
+#endif
+
+#endif /* !__AAX_JOBPOOL_H */
+
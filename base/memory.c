@@ -20,6 +20,14 @@
 #endif
 #include <ctype.h>	// toupper
 #include <assert.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#elif defined(WIN32)
+# include <windows.h>
+#endif
 
 #include "logging.h"
 #include "types.h"	// _MIN
@@ -646,6 +654,143 @@ strappend(char *dst, const char *src, ssize_t dlen)
    return rv;
 }
 
+/*
+ * Map a file read-only into memory, the size of the file is returned in size.
+ * Systems without memory mapping support get a copy of the file contents.
+ */
+void*
+_aax_mmap_file(const char *fname, size_t *size)
+{
+   void *rv = NULL;
+
+   assert(size);
+
+   *size = 0;
+#ifdef HAVE_SYS_MMAN_H
+   int fd = open(fname, O_RDONLY);
+   if (fd >= 0)
+   {
+      struct stat st;
+      if (!fstat(fd, &st) && st.st_size > 0)
+      {
+         rv = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+         if (rv != MAP_FAILED) *size = st.st_size;
+         else rv = NULL;
+      }
+      close(fd);
+   }
+#elif defined(WIN32)
+   HANDLE hFile = CreateFileA(fname, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+   if (hFile != INVALID_HANDLE_VALUE)
+   {
+      LARGE_INTEGER fsize;
+      if (GetFileSizeEx(hFile, &fsize) && fsize.QuadPart > 0)
+      {
+         HANDLE hMap = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+         if (hMap)
+         {
+            rv = MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+            if (rv) *size = fsize.QuadPart;
+            CloseHandle(hMap);
+         }
+      }
+      CloseHandle(hFile);
+   }
+#else
+   FILE *fp = fopen(fname, "rb");
+   if (fp)
+   {
+      long fsize;
+      if (!fseek(fp, 0, SEEK_END) && (fsize = ftell(fp)) > 0)
+      {
+         rewind(fp);
+         rv = malloc(fsize);
+         if (rv && fread(rv, fsize, 1, fp) == 1) {
+            *size = fsize;
+         } else {
+            free(rv);
+            rv = NULL;
+         }
+      }
+      fclose(fp);
+   }
+#endif
+   return rv;
+}
+
+void
+_aax_munmap_file(void *ptr, size_t size)
+{
+   if (ptr)
+   {
+#ifdef HAVE_SYS_MMAN_H
+      munmap(ptr, size);
+#elif defined(WIN32)
+      UnmapViewOfFile(ptr);
+#else
+      free(ptr);
+#endif
+   }
+}
+
+/*
+ * Allocate a buffer of (at least) size bytes which is mapped twice in a row,
+ * a byte written at ptr[i] can also be read back at ptr[size+i].
+ * size is rounded up to a multiple of the page size.
+ * Returns NULL if the system does not support mirrored mappings.
+ */
+void*
+_aax_mirror_alloc(size_t *size)
+{
+   void *rv = NULL;
+
+   assert(size);
+
+#if defined(HAVE_SYS_MMAN_H) && defined(MFD_CLOEXEC)
+   long page_size = sysconf(_SC_PAGESIZE);
+   if (page_size > 0 && *size)
+   {
+      size_t len = ((*size + page_size-1)/page_size)*page_size;
+      int fd = memfd_create("aax_mirror", MFD_CLOEXEC);
+      if (fd >= 0)
+      {
+         if (!ftruncate(fd, len))
+         {
+            uint8_t *ptr = mmap(NULL, 2*len, PROT_NONE,
+                                MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+            if (ptr != MAP_FAILED)
+            {
+               if (mmap(ptr, len, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_FIXED,
+                        fd, 0) != MAP_FAILED &&
+                   mmap(ptr+len, len, PROT_READ|PROT_WRITE,
+                        MAP_SHARED|MAP_FIXED, fd, 0) != MAP_FAILED)
+               {
+                  *size = len;
+                  rv = ptr;
+               }
+               else {
+                  munmap(ptr, 2*len);
+               }
+            }
+         }
+         close(fd);
+      }
+   }
+#endif
+   return rv;
+}
+
+void
+_aax_mirror_free(void *ptr, size_t size)
+{
+#if defined(HAVE_SYS_MMAN_H) && defined(MFD_CLOEXEC)
+   if (ptr) {
+      munmap(ptr, 2*size);
+   }
+#endif
+}
+
 #ifndef HAVE_STRLCPY
 size_t
 strlcpy(char *dst, const char *src, size_t n)
@@ -27,6 +27,12 @@ char* _aax_calloc_aligned(char**, size_t, size_t, size_t);
 char* _aax_malloc_aligned(char**, size_t, size_t);
 char* _aax_strdup(const_char_ptr);
 
+/* read-only memory mapped files */
+void* _aax_mmap_file(const char*, size_t*);
+void _aax_munmap_file(void*, size_t);
+void* _aax_mirror_alloc(size_t*);
+void _aax_mirror_free(void*, size_t);
+
 /* write */
 void write8(uint8_t**, uint8_t, size_t*);
 void writestr(uint8_t**, const char*, size_t, size_t*);
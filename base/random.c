@@ -120,7 +120,8 @@ _aax_srandom()
 }
 
 
-static uint64_t _aax_seed;
+/* per thread so waveforms can be generated in parallel reproducibly */
+static _Thread_local uint64_t _aax_seed;
 
 // Warning: do not seed with 0
 void
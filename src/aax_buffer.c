@@ -12,6 +12,7 @@
 #endif
 
 #include <stdio.h>	/* for NULL */
+#include <stddef.h>	/* for offsetof */
 #include <math.h>	/* for floorf */
 #include <assert.h>
 #ifdef HAVE_RMALLOC_H
@@ -20,6 +21,9 @@
 # include <string.h>
 # include <strings.h>
 #endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>	/* for unlink */
+#endif
 
 #include <xml.h>
 
@@ -41,18 +45,32 @@
 
 #define MAX_BUFFER_SIZE		(768*1024*1024)
 
+#define CACHE_MAGIC		"AAXC"
+#define CACHE_VERSION		1
+#define CACHE_BYTE_ORDER	0x01020304
+
 static void _bufInitInfo(_buffer_info_t*);
 static _aaxRingBuffer* _bufGetRingBuffer(_buffer_t*, _handle_t*, unsigned char);
 static _aaxRingBuffer* _bufDestroyRingBuffer(_buffer_t*, unsigned char);
-static bool _bufProcessWaveform(aaxBuffer, int, float, float, float, float, float, unsigned char, int, float, enum aaxSourceType, float, enum aaxProcessingType, limitType, float);
+static bool _bufProcessWaveform(_buffer_t*, int, float, float, float, float, float, unsigned char, int, float, enum aaxSourceType, float, enum aaxProcessingType, limitType, float);
+static bool _bufSynthAddWaveform(_aaxSynthVoice*, float, float, float, int, float, enum aaxSourceType, float, enum aaxProcessingType, float);
 static _aaxRingBuffer* _bufSetDataInterleaved(_buffer_t*, _aaxRingBuffer*, const void*, unsigned);
 static _aaxRingBuffer* _bufConvertDataToMixerFormat(_buffer_t*, _aaxRingBuffer*);
 static void** _bufGetDataPitchLevels(_buffer_t*);
 static void _bufGetDataInterleaved(_aaxRingBuffer*, void*, unsigned int, unsigned int, float);
 static void _bufConvertDataToPCM24S(void*, void*, unsigned int, enum aaxFormat);
 static void _bufConvertDataFromPCM24S(void*, void*, unsigned int, unsigned int, enum aaxFormat, unsigned int);
-static int _bufCreateFromAAXS(_buffer_t*, const void*, float);
+static bool _bufSetData(_buffer_t*, const void*);
+static bool _bufCreateFromAAXS(_buffer_t*, const void*, float, bool);
+static bool _bufAAXSWait(_buffer_t*);
+static void _bufLazyDestroy(_buffer_t*);
+static void _bufLazyFinish(_buffer_t*);
 static int _bufSetDataFromAAXS(_buffer_t*, char*, int);
+static void* _bufStreamConnect(const _aaxDriverBackend*, const char*, _buffer_info_t*, const _aaxMixerInfo*, bool);
+static void _bufStreamGetInfo(const _aaxDriverBackend*, void*, _buffer_info_t*);
+static _buffer_t* _bufCreateFromStream(_handle_t*, const char*, float);
+static void _bufSetEnvelopeInfo(_aaxRingBuffer*, const _buffer_info_t*);
+static void* _bufMapWAVFile(const char*, _buffer_info_t*, const void**, size_t*);
 // static char** _bufCreateAAXS(_buffer_t*, void**, unsigned int);
 
 static unsigned char  _aaxFormatsBPS[AAX_FORMAT_MAX];
@@ -111,6 +129,8 @@ aaxBufferCreate(aaxConfig config, unsigned int samples, unsigned tracks,
       buf->midi_mode = AAX_RENDER_NORMAL;
       buf->to_mixer = false;
       buf->mipmap = false;
+      buf->synth = false;
+      buf->compressed = false;
       buf->ref_counter = 1;
       buf->mip_levels = 1;
       buf->gain = 1.0f;
@@ -123,12 +143,23 @@ aaxBufferCreate(aaxConfig config, unsigned int samples, unsigned tracks,
       buf->info.blocksize = blocksize;
       buf->ringbuffer[0] = _bufGetRingBuffer(buf, handle, 0);
 
+      /* keep the sample data compressed, it is decoded while mixing */
+      env = getenv("AAX_USE_COMPRESSED_FMT");
+      if (env && _aax_getbool(env)) {
+         buf->compressed = true;
+      }
+
       /* explicit request not to convert */
       env = getenv("AAX_USE_MIXER_FMT");
       if (env && !_aax_getbool(env)) {
          buf->to_mixer = false;
       }
 
+      /* compressed sample data is converted by the mixer */
+      else if (buf->compressed) {
+         buf->to_mixer = false;
+      }
+
       /* sound is not mono */
       else if (tracks != 1) {
          buf->to_mixer = false;
@@ -544,6 +575,34 @@ AAX_API bool AAX_APIENTRY
 aaxBufferSetData(aaxBuffer buffer, const void* d)
 {
    _buffer_t* handle = get_buffer(buffer, __func__);
+   return _bufSetData(handle, d);
+}
+
+/**
+ * For AAXS buffers the waveform generation is queued on the shared job pool
+ * and this function returns immediately. Every other call which references
+ * the buffer waits for the generation to finish first.
+ */
+AAX_API bool AAX_APIENTRY
+aaxBufferSetDataAsync(aaxBuffer buffer, const void* d)
+{
+   _buffer_t* handle = get_buffer(buffer, __func__);
+   bool rv = false;
+
+   if (handle)
+   {
+      if (d && handle->info.fmt == AAX_AAXS24S) {
+         rv = _bufCreateFromAAXS(handle, d, 0, true);
+      } else {
+         rv = _bufSetData(handle, d);
+      }
+   }
+   return rv;
+}
+
+static bool
+_bufSetData(_buffer_t* handle, const void* d)
+{
    bool rv = __release_mode;
 
    if (!rv && handle)
@@ -573,7 +632,7 @@ aaxBufferSetData(aaxBuffer buffer, const void* d)
          switch(format)
          {
          case AAX_AAXS24S:
-            rv = _bufCreateFromAAXS(handle, d, 0);
+            rv = _bufCreateFromAAXS(handle, d, 0, false);
             break;
          default: /* should never happen */
             break;
@@ -676,6 +735,10 @@ aaxBufferSetData(aaxBuffer buffer, const void* d)
          rb = _bufSetDataInterleaved(handle, rb, data, blocksize);
          handle->ringbuffer[0] = rb;
 
+         if (handle->compressed) {
+            rb->set_parami(rb, RB_COMPRESSED, true);
+         }
+
          rv = true;
          if (ptr) _aax_aligned_free(ptr);
       }
@@ -897,10 +960,29 @@ aaxBufferReadFromStream(aaxConfig config, const char *url)
    if (rv)
    {
       _buffer_info_t info;
-      char **ptr;
+      const void *data = NULL;
+      char **ptr = NULL;
+      void *map = NULL;
+      size_t map_size;
+      char *env;
+
+      /* keep only the start of large files in memory, stream the rest */
+      env = getenv("AAX_STREAM_PRELOAD_MS");
+      if (env && atoi(env) > 0) {
+         buf = _bufCreateFromStream(handle, url, 1e-3f*atoi(env));
+      }
+
+      if (!buf)
+      {
+         map = _bufMapWAVFile(url, &info, &data, &map_size);
+         if (map) {
+            _aax_free_meta(&handle->meta);
+         } else if ((ptr = _bufGetDataFromStream(handle, url, &info, handle->info)) != NULL) {
+            data = ptr[0];
+         }
+      }
 
-      ptr = _bufGetDataFromStream(handle, url, &info, handle->info);
-      if (ptr)
+      if (data)
       {
          buf = aaxBufferCreate(config, info.no_samples, info.no_tracks, info.fmt);
          if (buf)
@@ -946,29 +1028,10 @@ aaxBufferReadFromStream(aaxConfig config, const char *url)
 # endif
 #endif
 
-             if ((aaxBufferSetData(buf, ptr[0])) != false)
+             if ((aaxBufferSetData(buf, data)) != false)
              {
                _aaxRingBuffer* rb = _bufGetRingBuffer(buf, NULL, 0);
-                _buffer_info_t *info = &buf->info;
-                int i;
-
-                for (i=0; i<_MAX_ENVELOPE_STAGES; ++i)
-                {
-                   float level, rate;
-
-                   level = info->envelope.volume[2*i];
-                   rate = info->envelope.volume[2*i+1];
-
-                   rb->set_paramf(rb, RB_ENVELOPE_LEVEL+i, level);
-                   rb->set_paramf(rb, RB_ENVELOPE_RATE+i, rate);
-                }
-
-                rb->set_paramf(rb, RB_TREMOLO_RATE, info->tremolo.rate);
-                rb->set_paramf(rb, RB_TREMOLO_DEPTH, info->tremolo.depth);
-                rb->set_paramf(rb, RB_TREMOLO_SWEEP, info->tremolo.sweep);
-                rb->set_paramf(rb, RB_VIBRATO_RATE, info->vibrato.rate);
-                rb->set_paramf(rb, RB_VIBRATO_DEPTH, info->vibrato.depth);
-                rb->set_paramf(rb, RB_VIBRATO_SWEEP, info->vibrato.sweep);
+                _bufSetEnvelopeInfo(rb, &buf->info);
              }
              else
              {
@@ -979,9 +1042,10 @@ aaxBufferReadFromStream(aaxConfig config, const char *url)
 _aaxFileDriverWrite("/tmp/test.wav", AAX_OVERWRITE, ptr, no_samples, freq, tracks, fmt);
 #endif
          }
+         _aax_munmap_file(map, map_size);
          free(ptr);
       }
-      else {
+      else if (!buf) {
          _aaxErrorSet(AAX_INVALID_REFERENCE);
       }
    }
@@ -1025,11 +1089,11 @@ aaxBufferWriteToFile(aaxBuffer buffer, const char *file, enum aaxProcessingType
 
 /* -------------------------------------------------------------------------- */
 
-static void _bufApplyBitCrusherFilter(_buffer_t*, _filter_t*, int);
-static void _bufApplyFrequencyFilter(_buffer_t*, _filter_t*, int);
-static void _bufApplyDistortionEffect(_buffer_t*, _effect_t*, int);
-static void _bufApplyWaveFoldEffect(_buffer_t*, _effect_t*, int);
-static void _bufApplyEqualizer(_buffer_t*, _filter_t*, int);
+static void _bufApplyBitCrusherFilter(_buffer_t*, _filter_t*, unsigned char, int);
+static void _bufApplyFrequencyFilter(_buffer_t*, _filter_t*, unsigned char, int);
+static void _bufApplyDistortionEffect(_buffer_t*, _effect_t*, unsigned char, int);
+static void _bufApplyWaveFoldEffect(_buffer_t*, _effect_t*, unsigned char, int);
+static void _bufApplyEqualizer(_buffer_t*, _filter_t*, unsigned char, int);
 
 
 static unsigned char  _aaxFormatsBPS[AAX_FORMAT_MAX] =
@@ -1092,7 +1156,11 @@ get_buffer(aaxBuffer buffer, const char *func)
    _buffer_t *handle = (_buffer_t *)buffer;
    _buffer_t* rv  = NULL;
 
-   if (handle && handle->id == BUFFER_ID) {
+   if (handle && handle->id == BUFFER_ID)
+   {
+      if (handle->aaxs_pending) {
+         _bufAAXSWait(handle);
+      }
       rv = handle;
    }
    else if (handle && handle->id == FADEDBAD) {
@@ -1114,6 +1182,8 @@ free_buffer(_buffer_t* handle)
       if (--handle->ref_counter == 0)
       {
          int mip;
+
+         _bufLazyDestroy(handle);
          for (mip=0; mip<handle->mip_levels; ++mip) {
             handle->ringbuffer[mip] = _bufDestroyRingBuffer(handle, mip);
          }
@@ -1213,174 +1283,107 @@ _bufDestroyRingBuffer(_buffer_t* buf, unsigned char pos)
    return rb;
 }
 
-char**
-_bufGetDataFromStream(_handle_t *handle, const char *url, _buffer_info_t *info, _aaxMixerInfo *_info)
+/*
+ * Connect to the stream and set it up for capturing. With copy set the
+ * captured data is returned in the file format, otherwise the captured
+ * data is returned as 24-bit samples, one buffer per track.
+ */
+static void*
+_bufStreamConnect(const _aaxDriverBackend *stream, const char *url, _buffer_info_t *info, const _aaxMixerInfo *_info, bool copy)
 {
-   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
-   char **ptr = NULL;
+   static const char *xcfg = "<?xml?><"COPY_TO_BUFFER">1</"COPY_TO_BUFFER">";
+   void *id = stream->new_handle(AAX_MODE_READ);
+   xmlId *xid = copy ? xmlInitBuffer(xcfg, strlen(xcfg)) : NULL;
 
-   _bufInitInfo(info);
-   if (stream)
+   // xid makes the stream return sound data in file format when capturing
+   // At least the PAT extension supports adding "?level=<n>" to the URL
+   // to define which patch number, of possible many, to process.
+   id = stream->connect(NULL, id, xid, url, AAX_MODE_READ);
+   if (xid) xmlClose(xid);
+
+   if (id)
    {
-      static const char *xcfg = "<?xml?><"COPY_TO_BUFFER">1</"COPY_TO_BUFFER">";
-      void *id = stream->new_handle(AAX_MODE_READ);
-      xmlId *xid = xmlInitBuffer(xcfg, strlen(xcfg));
+      float refrate = _info->refresh_rate;
+      float periodrate = _info->period_rate;
+      int brate = _info->bitrate;
+      int res;
 
-      // xid makes the stream return sound data in file format when capturing
-      // At least the PAT extension supports adding "?level=<n>" to the URL
-      // to define which patch number, of possible many, to process.
-      id = stream->connect(NULL, id, xid, url, AAX_MODE_READ);
-      xmlClose(xid);
+      info->no_tracks = _info->no_tracks;
+      info->rate = _info->frequency;
+      info->fmt = _info->format;
 
-      if (id)
+      res = stream->setup(id, &refrate, &info->fmt, &info->no_tracks,
+                              &info->rate, &brate, false, periodrate);
+      if (TEST_FOR_TRUE(res) &&
+          (info->no_tracks >= 1 && info->no_tracks <= RB_MAX_TRACKS) &&
+          (info->rate >= 4000 && info->rate <= _AAX_MAX_MIXER_FREQUENCY))
       {
-         float refrate = _info->refresh_rate;
-         float periodrate = _info->period_rate;
-         int brate = _info->bitrate;
-         int res;
-
-         info->no_tracks = _info->no_tracks;
-         info->rate = _info->frequency;
-         info->fmt = _info->format;
-
-         res = stream->setup(id, &refrate, &info->fmt, &info->no_tracks,
-                                 &info->rate, &brate, false, periodrate);
-         if (TEST_FOR_TRUE(res) &&
-             (info->no_tracks >= 1 && info->no_tracks <= RB_MAX_TRACKS) &&
-             (info->rate >= 4000 && info->rate <= _AAX_MAX_MIXER_FREQUENCY))
-         {
-            size_t no_bytes, datasize, bits;
-            char *ptr2;
-
-            bits = aaxGetBitsPerSample(info->fmt);
-            info->no_bytes = stream->param(id, DRIVER_NO_BYTES);
-            info->blocksize = stream->param(id, DRIVER_BLOCK_SIZE);
-            info->no_samples = stream->param(id, DRIVER_MAX_SAMPLES);
-            info->rate = stream->param(id, DRIVER_FREQUENCY);
-            no_bytes = (info->no_samples)*bits/8;
-
-            if (info->blocksize) {
-               no_bytes = ((no_bytes/info->blocksize)+1)*info->blocksize;
-            }
-
-            datasize = SIZE_ALIGNED(info->no_tracks*no_bytes);
-            if (datasize < MAX_BUFFER_SIZE)	// sanity check
-            {
-               size_t offs = 2 * sizeof(void*);
-               ptr = (char**)_aax_calloc(&ptr2, offs, 2, datasize);
-            }
-
-            if (ptr)
-            {
-               void **dst = (void **)ptr;
-               ssize_t res; // offset = 0;
-               ssize_t offs_packets = 0;
-//             size_t size;
-               int i;
-
-               dst[0] = ptr2;
-               ptr2 += datasize;
-               dst[1] = ptr2;
-
-               // capture now returns native file format instead of PCM24S
-               // in batched capturing mode
-//             size = 0;
-               do
-               {
-                  ssize_t offs = offs_packets;
-                  size_t packets = info->no_samples;
-
-                  assert(packets <= datasize*8/(info->no_tracks*bits));
-
-                  res = stream->capture(id, dst, &offs, &packets,
-                                            dst[1], datasize, 1.0f, true);
-//                if (res > 0) size += res;
-                  offs_packets += packets;
-//                if (res > 0) {
-//                   offset += res*8/(bits*info->no_tracks);
-//                }
-               }
-               while (res >= 0);
-
-               // read the last information chunks, if any
-               stream->flush(id);
+         info->no_bytes = stream->param(id, DRIVER_NO_BYTES);
+         info->blocksize = stream->param(id, DRIVER_BLOCK_SIZE);
+         info->no_samples = stream->param(id, DRIVER_MAX_SAMPLES);
+         info->rate = stream->param(id, DRIVER_FREQUENCY);
+      }
+      else
+      {
+         stream->disconnect(id);
+         id = NULL;
+      }
+   }
 
-               if (handle)
-               {
-                  _aax_free_meta(&handle->meta);
-                  handle->meta.artist = stream->name(id, AAX_MUSIC_PERFORMER_STRING);
-                  handle->meta.original = stream->name(id, AAX_ORIGINAL_PERFORMER_STRING);
-                  handle->meta.title = stream->name(id, AAX_TRACK_TITLE_STRING);
-                  handle->meta.album = stream->name(id, AAX_ALBUM_NAME_STRING);
-                  handle->meta.trackno = stream->name(id, AAX_TRACK_NUMBER_STRING);
-                  handle->meta.date = stream->name(id, AAX_RELEASE_DATE_STRING);
-                  handle->meta.genre = stream->name(id, AAX_MUSIC_GENRE_STRING);
-                  handle->meta.composer = stream->name(id, AAX_SONG_COMPOSER_STRING);
-                  handle->meta.comments = stream->name(id, AAX_SONG_COMMENT_STRING);
-                  handle->meta.copyright = stream->name(id, AAX_SONG_COPYRIGHT_STRING);
-                  handle->meta.contact = stream->name(id, AAX_CONTACT_STRING);
-                  handle->meta.website = stream->name(id, AAX_WEBSITE_STRING);
-                  handle->meta.image = stream->name(id, AAX_COVER_IMAGE_DATA);
-#if 0
- printf("artist: %s\n", handle->meta.artist);
- printf("title: %s\n", handle->meta.title);
- printf("genre: %s\n", handle->meta.genre);
- printf("track no.: %s\n", handle->meta.trackno);
- printf("album: %s\n", handle->meta.album);
- printf("sate: %s\n", handle->meta.date);
- printf("composer: %s\n", handle->meta.composer);
- printf("copyright: %s\n", handle->meta.copyright);
- printf("comments: %s\n", handle->meta.comments);
- printf("contact: %s\n", handle->meta.contact);
-#endif
-               }
+   return id;
+}
 
-               // get the actual number of samples
-               info->rate = stream->param(id, DRIVER_FREQUENCY);
-               info->no_samples = stream->param(id, DRIVER_MAX_SAMPLES);
-               info->loop.count = stream->param(id, DRIVER_LOOP_COUNT);
-               info->loop.start = stream->param(id, DRIVER_LOOP_START);
-               info->loop.end = stream->param(id, DRIVER_LOOP_END);
-               info->envelope.sampled_release = stream->param(id, DRIVER_SAMPLED_RELEASE);
-               info->tremolo.rate = stream->param(id, DRIVER_TREMOLO_RATE);
-               info->tremolo.depth = stream->param(id, DRIVER_TREMOLO_DEPTH);
-               info->tremolo.sweep = stream->param(id, DRIVER_TREMOLO_SWEEP);
-               info->vibrato.rate = stream->param(id, DRIVER_VIBRATO_RATE);
-               info->vibrato.depth = stream->param(id, DRIVER_VIBRATO_DEPTH);
-               info->vibrato.sweep = stream->param(id, DRIVER_VIBRATO_SWEEP);
-               info->pitch_fraction = stream->param(id, DRIVER_PITCH_FRACTION);
-               if (info->pitch_fraction < FLT_EPSILON) {
-                  info->pitch_fraction = 1.0f;
-               }
-               // These could have been set by an AAXS file
-               if (info->frequency.base < FLT_EPSILON) {
-                  info->frequency.base = stream->param(id, DRIVER_BASE_FREQUENCY);
-               }
-               if (info->frequency.low < FLT_EPSILON) {
-                  info->frequency.low = stream->param(id, DRIVER_LOW_FREQUENCY);
-               }
-               if (info->frequency.high < FLT_EPSILON) {
-                  info->frequency.high = stream->param(id, DRIVER_HIGH_FREQUENCY);
-               }
+static void
+_bufStreamGetInfo(const _aaxDriverBackend *stream, void *id, _buffer_info_t *info)
+{
+   int i;
+
+   // get the actual number of samples
+   info->rate = stream->param(id, DRIVER_FREQUENCY);
+   info->no_samples = stream->param(id, DRIVER_MAX_SAMPLES);
+   info->loop.count = stream->param(id, DRIVER_LOOP_COUNT);
+   info->loop.start = stream->param(id, DRIVER_LOOP_START);
+   info->loop.end = stream->param(id, DRIVER_LOOP_END);
+   info->envelope.sampled_release = stream->param(id, DRIVER_SAMPLED_RELEASE);
+   info->tremolo.rate = stream->param(id, DRIVER_TREMOLO_RATE);
+   info->tremolo.depth = stream->param(id, DRIVER_TREMOLO_DEPTH);
+   info->tremolo.sweep = stream->param(id, DRIVER_TREMOLO_SWEEP);
+   info->vibrato.rate = stream->param(id, DRIVER_VIBRATO_RATE);
+   info->vibrato.depth = stream->param(id, DRIVER_VIBRATO_DEPTH);
+   info->vibrato.sweep = stream->param(id, DRIVER_VIBRATO_SWEEP);
+   info->pitch_fraction = stream->param(id, DRIVER_PITCH_FRACTION);
+   if (info->pitch_fraction < FLT_EPSILON) {
+      info->pitch_fraction = 1.0f;
+   }
+   // These could have been set by an AAXS file
+   if (info->frequency.base < FLT_EPSILON) {
+      info->frequency.base = stream->param(id, DRIVER_BASE_FREQUENCY);
+   }
+   if (info->frequency.low < FLT_EPSILON) {
+      info->frequency.low = stream->param(id, DRIVER_LOW_FREQUENCY);
+   }
+   if (info->frequency.high < FLT_EPSILON) {
+      info->frequency.high = stream->param(id, DRIVER_HIGH_FREQUENCY);
+   }
 
-               for (i=0; i<_MAX_ENVELOPE_STAGES; ++i)
-               {
-                  off_t level, rate;
+   for (i=0; i<_MAX_ENVELOPE_STAGES; ++i)
+   {
+      off_t level, rate;
 
-                  level = stream->param(id, DRIVER_ENVELOPE_LEVEL+i);
-                  rate = stream->param(id, DRIVER_ENVELOPE_RATE+i);
+      level = stream->param(id, DRIVER_ENVELOPE_LEVEL+i);
+      rate = stream->param(id, DRIVER_ENVELOPE_RATE+i);
 
-                  if (rate == OFF_T_MAX) {
-                     info->envelope.volume[2*i+1] = AAX_FPINFINITE;
-                  } else {
-                     info->envelope.volume[2*i+1] = rate;
-                  }
-                  info->envelope.volume[2*i] = level;
-               }
-               info->envelope.sustain = stream->param(id, DRIVER_ENVELOPE_SUSTAIN);
-               info->envelope.sampled_release = stream->param(id, DRIVER_SAMPLED_RELEASE);
-               info->envelope.fast_release = stream->param(id, DRIVER_FAST_RELEASE);
-               info->no_patches = stream->param(id, DRIVER_NO_PATCHES);
+      if (rate == OFF_T_MAX) {
+         info->envelope.volume[2*i+1] = AAX_FPINFINITE;
+      } else {
+         info->envelope.volume[2*i+1] = rate;
+      }
+      info->envelope.volume[2*i] = level;
+   }
+   info->envelope.sustain = stream->param(id, DRIVER_ENVELOPE_SUSTAIN);
+   info->envelope.sampled_release = stream->param(id, DRIVER_SAMPLED_RELEASE);
+   info->envelope.fast_release = stream->param(id, DRIVER_FAST_RELEASE);
+   info->no_patches = stream->param(id, DRIVER_NO_PATCHES);
 
 #if 0
  printf("no. samples:\t\t%lu\n", info->no_samples);
@@ -1413,8 +1416,103 @@ _bufGetDataFromStream(_handle_t *handle, const char *url, _buffer_info_t *info,
  printf("\n");
  printf("Envelope sustain: %s\n", info->envelope.sustain ? "yes" : "no");
  printf("Fast release: %s\n", info->fast_release ? "yes" : "no");
+#endif
+}
+
+char**
+_bufGetDataFromStream(_handle_t *handle, const char *url, _buffer_info_t *info, _aaxMixerInfo *_info)
+{
+   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
+   char **ptr = NULL;
+
+   _bufInitInfo(info);
+   if (stream)
+   {
+      void *id = _bufStreamConnect(stream, url, info, _info, true);
+      if (id)
+      {
+         size_t no_bytes, datasize, bits;
+         char *ptr2;
+
+         bits = aaxGetBitsPerSample(info->fmt);
+         no_bytes = (info->no_samples)*bits/8;
+
+         if (info->blocksize) {
+            no_bytes = ((no_bytes/info->blocksize)+1)*info->blocksize;
+         }
+
+         datasize = SIZE_ALIGNED(info->no_tracks*no_bytes);
+         if (datasize < MAX_BUFFER_SIZE)	// sanity check
+         {
+            size_t offs = 2 * sizeof(void*);
+            ptr = (char**)_aax_calloc(&ptr2, offs, 2, datasize);
+         }
+
+         if (ptr)
+         {
+            void **dst = (void **)ptr;
+            ssize_t res; // offset = 0;
+            ssize_t offs_packets = 0;
+//             size_t size;
+
+            dst[0] = ptr2;
+            ptr2 += datasize;
+            dst[1] = ptr2;
+
+            // capture now returns native file format instead of PCM24S
+            // in batched capturing mode
+//             size = 0;
+            do
+            {
+               ssize_t offs = offs_packets;
+               size_t packets = info->no_samples;
+
+               assert(packets <= datasize*8/(info->no_tracks*bits));
+
+               res = stream->capture(id, dst, &offs, &packets,
+                                         dst[1], datasize, 1.0f, true);
+//                if (res > 0) size += res;
+               offs_packets += packets;
+//                if (res > 0) {
+//                   offset += res*8/(bits*info->no_tracks);
+//                }
+            }
+            while (res >= 0);
+
+            // read the last information chunks, if any
+            stream->flush(id);
+
+            if (handle)
+            {
+               _aax_free_meta(&handle->meta);
+               handle->meta.artist = stream->name(id, AAX_MUSIC_PERFORMER_STRING);
+               handle->meta.original = stream->name(id, AAX_ORIGINAL_PERFORMER_STRING);
+               handle->meta.title = stream->name(id, AAX_TRACK_TITLE_STRING);
+               handle->meta.album = stream->name(id, AAX_ALBUM_NAME_STRING);
+               handle->meta.trackno = stream->name(id, AAX_TRACK_NUMBER_STRING);
+               handle->meta.date = stream->name(id, AAX_RELEASE_DATE_STRING);
+               handle->meta.genre = stream->name(id, AAX_MUSIC_GENRE_STRING);
+               handle->meta.composer = stream->name(id, AAX_SONG_COMPOSER_STRING);
+               handle->meta.comments = stream->name(id, AAX_SONG_COMMENT_STRING);
+               handle->meta.copyright = stream->name(id, AAX_SONG_COPYRIGHT_STRING);
+               handle->meta.contact = stream->name(id, AAX_CONTACT_STRING);
+               handle->meta.website = stream->name(id, AAX_WEBSITE_STRING);
+               handle->meta.image = stream->name(id, AAX_COVER_IMAGE_DATA);
+#if 0
+ printf("artist: %s\n", handle->meta.artist);
+ printf("title: %s\n", handle->meta.title);
+ printf("genre: %s\n", handle->meta.genre);
+ printf("track no.: %s\n", handle->meta.trackno);
+ printf("album: %s\n", handle->meta.album);
+ printf("sate: %s\n", handle->meta.date);
+ printf("composer: %s\n", handle->meta.composer);
+ printf("copyright: %s\n", handle->meta.copyright);
+ printf("comments: %s\n", handle->meta.comments);
+ printf("contact: %s\n", handle->meta.contact);
 #endif
             }
+
+            _bufStreamGetInfo(stream, id, info);
          }
          stream->disconnect(id);
       }
@@ -1423,81 +1521,469 @@ _bufGetDataFromStream(_handle_t *handle, const char *url, _buffer_info_t *info,
    return ptr;
 }
 
-int
-_bufSetDataFromAAXS(_buffer_t *buffer, char *file, int level)
+/*
+ * Local PCM and IEEE float WAVE files are mapped into memory and the data
+ * chunk is passed to aaxBufferSetData as is, which converts and
+ * de-interleaves it in one go. Loop points are taken from a smpl chunk
+ * anywhere in the file, files with other chunks which could hold meta data
+ * are left to the stream driver.
+ *
+ * Returns the mapped file which must be unmapped by the caller.
+ */
+static void*
+_bufMapWAVFile(const char *url, _buffer_info_t *info, const void **data, size_t *size)
 {
-   _buffer_info_t *info = &buffer->info;
-   char *s, *url, **data = NULL;
-   int rv = 0;
+   const char *fname = url;
+   const char *ext;
+   uint8_t *rv = NULL;
 
-   url = _aaxURLConstruct(buffer->url, file);
-   s = strrchr(url, '.');
-   if (!s || strcasecmp(s, ".aaxs"))
-   {
-      data = _bufGetDataFromStream(NULL, url, info, *buffer->mixer_info);
-#if 0
- printf("url: '%s'\n\tfmt: %x, tracks: %i, freq: %4.1f, samples: %li, blocksize: %i\n", url, info->fmt, info->no_tracks, info->rate, info->no_samples, info->blocksize);
-#endif
+   *data = NULL;
+   *size = 0;
+
+   if (!strncasecmp(fname, "file://", strlen("file://"))) {
+      fname += strlen("file://");
+   } else if (strstr(fname, "://")) {
+      return rv;
    }
-   free(url);
 
-   if (data)
+   ext = strrchr(fname, '.');
+   if (!ext || strcasecmp(ext, ".wav") || strchr(fname, '?')) {
+      return rv;
+   }
+
+   rv = _aax_mmap_file(fname, size);
+   if (rv)
    {
-      _aaxRingBuffer* rb = _bufGetRingBuffer(buffer, buffer->root, level);
-      if (rb)
+      enum aaxFormat fmt = AAX_FORMAT_NONE;
+      unsigned int tracks = 0, blocksize = 0, bits = 0;
+      size_t no_bytes = 0, buflen = *size;
+      uint8_t *ptr = rv;
+      float rate = 0.0f;
+
+      if (buflen < 12 || memcmp(ptr, "RIFF", 4) || memcmp(ptr+8, "WAVE", 4)) {
+         buflen = 0;
+      }
+      ptr += 12;
+      buflen -= _MIN(buflen, 12);
+
+      _bufInitInfo(info);
+
+      /* walk all chunks to the end of the file, loop points may follow
+       * the data chunk
+       */
+      while (buflen > 8)
       {
-         /* the internal buffer format for .aaxs files is signed 24-bit */
-         char **ndata;
-         char *ptr;
+         uint8_t *chunk = ptr;
+         size_t len;
 
-         ndata = (char**)_aax_malloc(&ptr, sizeof(void*), info->no_samples*sizeof(int32_t));
-         if (ndata)
+         ptr += 4;
+         buflen -= 4;
+         len = read32le(&ptr, &buflen);
+
+         if (!memcmp(chunk, "data", 4) && !*data)
          {
-            *ndata = (void*)ptr;
-            _bufConvertDataToPCM24S(*ndata, *data, info->no_samples, info->fmt);
-            free(data);
-            data = ndata;
+            *data = ptr;
+            no_bytes = _MIN(len, buflen);
+         }
+         else if (len > buflen) {
+            fmt = AAX_FORMAT_NONE;
+            break;
+         }
+         else if (!memcmp(chunk, "fmt ", 4) && len >= 16)
+         {
+            uint8_t *ch = ptr;
+            size_t chlen = buflen;
+            unsigned int tag;
+
+            tag = read16le(&ch, &chlen);
+            tracks = read16le(&ch, &chlen);
+            rate = read32le(&ch, &chlen);
+            read32le(&ch, &chlen);		// bytes per second
+            blocksize = read16le(&ch, &chlen);
+            bits = read16le(&ch, &chlen);
+
+            if (tag == 0x0001)		// PCM
+            {
+               if (bits == 16) fmt = AAX_PCM16S_LE;
+               else if (bits == 24) fmt = AAX_PCM24S_PACKED_LE;
+               else if (bits == 32) fmt = AAX_PCM32S_LE;
+            }
+            else if (tag == 0x0003 && bits == 32) {	// IEEE float
+               fmt = AAX_FLOAT_LE;
+            }
          }
+         else if (!memcmp(chunk, "smpl", 4) && len >= 60 && bits)
+         {
+            uint8_t *ch = ptr;
+            uint32_t smpl[15];
+            int i;
 
-         info->fmt = AAX_PCM24S;
-//       rb->set_format(rb, fmt, false);
-         rb->set_parami(rb, RB_NO_LAYERS, info->no_tracks);
-         rb->set_parami(rb, RB_NO_TRACKS, info->no_tracks);
-         rb->set_paramf(rb, RB_FREQUENCY, info->rate);
-         rb->set_parami(rb, RB_NO_SAMPLES, info->no_samples);
+            // the chunk may end the file, read32le needs a byte to spare
+            for (i=0; i<15; ++i, ch += 4) {
+               smpl[i] = ch[0] | ch[1] << 8 | ch[2] << 16 | (uint32_t)ch[3] << 24;
+            }
 
-         rv = aaxBufferSetData(buffer, data[0]);
-         free(data);
+            // interpreted the same way as the stream driver does
+            if (smpl[7])		// number of loops
+            {
+               float cents = 100.0f*smpl[4]/(float)0xFFFFFFFF;
 
-         rb->set_paramf(rb, RB_LOOPPOINT_END, info->loop.end/info->rate);
-         rb->set_paramf(rb, RB_LOOPPOINT_START, info->loop.start/info->rate);
-         rb->set_parami(rb, RB_SAMPLED_RELEASE, info->envelope.sampled_release);
-         rb->set_parami(rb, RB_LOOPING, info->loop.count);
+               info->frequency.base = _note2freq((uint8_t)smpl[3]);
+               info->pitch_fraction = _cents2pitch(cents, 1.0f);
+               info->loop.start = 8*smpl[11]/bits;
+               info->loop.end = 8*smpl[12]/bits;
+               info->loop.count = smpl[14];
+            }
+         }
+         else if (memcmp(chunk, "fact", 4) && memcmp(chunk, "PEAK", 4) &&
+                  memcmp(chunk, "JUNK", 4))
+         {
+            fmt = AAX_FORMAT_NONE;
+            break;
+         }
+
+         len = _MIN(len + (len & 1), buflen);
+         ptr += len;
+         buflen -= len;
+      }
+
+      if (*data && fmt != AAX_FORMAT_NONE &&
+          tracks >= 1 && tracks <= RB_MAX_TRACKS &&
+          rate >= 4000 && rate <= _AAX_MAX_MIXER_FREQUENCY &&
+          blocksize == tracks*bits/8 && no_bytes >= blocksize &&
+          no_bytes < MAX_BUFFER_SIZE)
+      {
+         info->fmt = fmt;
+         info->no_tracks = tracks;
+         info->rate = rate;
+         info->blocksize = blocksize;
+         info->no_samples = no_bytes/blocksize;
+         info->no_bytes = info->no_samples*bits/8;
+      }
+      else
+      {
+         _aax_munmap_file(rv, *size);
+         *data = NULL;
+         rv = NULL;
       }
    }
 
    return rv;
 }
 
-static bool
-_bufCreateWaveformFromAAXS(_buffer_t* handle, const xmlId *xwid, int track, float ratio_factor, float pitch_factor, float freq, unsigned int pitch_level, int voices, float spread, limitType limiter, float version)
+/*
+ * Disk streamed buffers: only the first part of the file is kept in memory,
+ * every voice which plays the buffer reads the rest from its own stream.
+ */
+typedef struct
 {
-   enum aaxProcessingType ptype = AAX_OVERWRITE;
-   enum aaxSourceType wtype = (int)AAX_NONE;
-   float staticity = 0.0f;
-   float random = 0.0f;
-   float phase = 0.0f;
-   float pitch = 1.0f;
-   float ratio = 0.0f;
-   int midi_mode, pos;
-   bool rv = true;
+   char *url;
+   _aaxMixerInfo info;
+   unsigned int no_tracks;
+} _buffer_stream_t;
 
-   midi_mode = handle->midi_mode;
-   pos = (midi_mode >> 26) & 0x3;
+typedef struct
+{
+   const _buffer_stream_t *data;
+   void *id;
+   size_t pos;		/* sample position of the stream */
+} _buffer_stream_io_t;
 
-   if (RENDER_NORMAL(midi_mode))
+static size_t
+_bufStreamCapture(const _aaxDriverBackend *stream, void *id, int32_t **tracks, size_t no_samples)
+{
+   size_t rv = 0;
+   ssize_t res;
+
+   do
    {
-      if (xmlAttributeExists(xwid, "voices"))
+      ssize_t offs = rv;
+      size_t frames = no_samples - rv;
+
+      res = stream->capture(id, (void**)tracks, &offs, &frames, NULL, 0,
+                                1.0f, true);
+      rv += frames;
+      if (!frames) break;
+   }
+   while (res >= 0 && rv < no_samples);
+
+   return rv;
+}
+
+static void*
+_bufStreamOpen(void *d)
+{
+   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
+   _buffer_stream_t *data = d;
+   _buffer_stream_io_t *io;
+
+   io = calloc(1, sizeof(_buffer_stream_io_t));
+   if (io)
+   {
+      _buffer_info_t info;
+
+      _bufInitInfo(&info);
+      io->data = data;
+      io->id = _bufStreamConnect(stream, data->url, &info, &data->info, false);
+      if (io->id && info.no_tracks != data->no_tracks)
+      {
+         stream->disconnect(io->id);
+         io->id = NULL;
+      }
+
+      if (!io->id)
+      {
+         free(io);
+         io = NULL;
+      }
+   }
+
+   return io;
+}
+
+static ssize_t
+_bufStreamRead(void *d, int32_t **tracks, size_t pos, size_t no_samples)
+{
+   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
+   _buffer_stream_io_t *io = d;
+   ssize_t rv;
+
+   /* the stream is read sequentially, start over to read backwards */
+   if (io->id && pos < io->pos)
+   {
+      _buffer_info_t info;
+
+      _bufInitInfo(&info);
+      stream->disconnect(io->id);
+      io->id = _bufStreamConnect(stream, io->data->url, &info,
+                                 &io->data->info, false);
+      io->pos = 0;
+   }
+   if (!io->id) return -1;
+
+   while (io->pos < pos)
+   {
+      rv = _bufStreamCapture(stream, io->id, tracks,
+                             _MIN(pos - io->pos, no_samples));
+      if (rv <= 0) return -1;
+      io->pos += rv;
+   }
+
+   rv = _bufStreamCapture(stream, io->id, tracks, no_samples);
+   io->pos += rv;
+
+   return rv;
+}
+
+static void
+_bufStreamClose(void *d)
+{
+   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
+   _buffer_stream_io_t *io = d;
+
+   if (io->id) stream->disconnect(io->id);
+   free(io);
+}
+
+static void
+_bufStreamFree(void *d)
+{
+   _buffer_stream_t *data = d;
+
+   if (data)
+   {
+      free(data->url);
+      free(data);
+   }
+}
+
+static _buffer_t*
+_bufCreateFromStream(_handle_t *handle, const char *url, float preload)
+{
+   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
+   _aaxRingBufferStream *rbs = NULL;
+   _buffer_stream_t *data = NULL;
+   _buffer_t *rv = NULL;
+   _buffer_info_t info;
+   void *id;
+
+   _bufInitInfo(&info);
+   id = _bufStreamConnect(stream, url, &info, handle->info, false);
+   if (id)
+   {
+      size_t no_resident = preload*info.rate;
+
+      /* only stream files which are considerably longer than the preload */
+      if (no_resident && info.no_samples > 2*no_resident) {
+         rbs = _aaxRingBufferStreamCreate(info.no_tracks, no_resident);
+      }
+
+      if (rbs)
+      {
+         data = calloc(1, sizeof(_buffer_stream_t));
+         if (data)
+         {
+            data->url = strdup(url);
+            data->info = *handle->info;
+            data->no_tracks = info.no_tracks;
+         }
+
+         rbs->open = _bufStreamOpen;
+         rbs->read = _bufStreamRead;
+         rbs->close = _bufStreamClose;
+         rbs->free = _bufStreamFree;
+         rbs->data = data;
+
+         if (!data || !data->url ||
+             _bufStreamCapture(stream, id, rbs->head, no_resident) != no_resident)
+         {
+            _aaxRingBufferStreamDestroy(rbs);
+            rbs = NULL;
+         }
+         else {
+            _bufStreamGetInfo(stream, id, &info);
+         }
+      }
+      stream->disconnect(id);
+   }
+
+   if (rbs) {
+      rv = aaxBufferCreate(handle, info.no_samples, info.no_tracks, AAX_PCM24S);
+   }
+
+   if (rv)
+   {
+      _aaxRingBuffer *rb;
+
+      rv->url = strdup(url);
+      rv->info = info;
+      rv->info.fmt = AAX_PCM24S;
+      rv->info.blocksize = 1;
+      rv->to_mixer = false;
+      rv->compressed = false;
+
+      /* the samples are read by the mixer, not by aaxBufferSetData */
+      rv->ringbuffer[0] = _bufDestroyRingBuffer(rv, 0);
+      rb = _bufGetRingBuffer(rv, handle, 0);
+      if (rb)
+      {
+         _aaxRingBufferData *rbi = rb->handle;
+
+         rbi->sample->stream = rbs;
+         _bufSetEnvelopeInfo(rb, &rv->info);
+         rv->ringbuffer[0] = rb;
+         rbs = NULL;
+      }
+      else
+      {
+         aaxBufferDestroy(rv);
+         rv = NULL;
+      }
+   }
+   _aaxRingBufferStreamDestroy(rbs);
+
+   return rv;
+}
+
+static void
+_bufSetEnvelopeInfo(_aaxRingBuffer *rb, const _buffer_info_t *info)
+{
+   int i;
+
+   for (i=0; i<_MAX_ENVELOPE_STAGES; ++i)
+   {
+      float level, rate;
+
+      level = info->envelope.volume[2*i];
+      rate = info->envelope.volume[2*i+1];
+
+      rb->set_paramf(rb, RB_ENVELOPE_LEVEL+i, level);
+      rb->set_paramf(rb, RB_ENVELOPE_RATE+i, rate);
+   }
+
+   rb->set_paramf(rb, RB_TREMOLO_RATE, info->tremolo.rate);
+   rb->set_paramf(rb, RB_TREMOLO_DEPTH, info->tremolo.depth);
+   rb->set_paramf(rb, RB_TREMOLO_SWEEP, info->tremolo.sweep);
+   rb->set_paramf(rb, RB_VIBRATO_RATE, info->vibrato.rate);
+   rb->set_paramf(rb, RB_VIBRATO_DEPTH, info->vibrato.depth);
+   rb->set_paramf(rb, RB_VIBRATO_SWEEP, info->vibrato.sweep);
+}
+
+int
+_bufSetDataFromAAXS(_buffer_t *buffer, char *file, int level)
+{
+   _buffer_info_t *info = &buffer->info;
+   char *s, *url, **data = NULL;
+   int rv = 0;
+
+   url = _aaxURLConstruct(buffer->url, file);
+   s = strrchr(url, '.');
+   if (!s || strcasecmp(s, ".aaxs"))
+   {
+      data = _bufGetDataFromStream(NULL, url, info, *buffer->mixer_info);
+#if 0
+ printf("url: '%s'\n\tfmt: %x, tracks: %i, freq: %4.1f, samples: %li, blocksize: %i\n", url, info->fmt, info->no_tracks, info->rate, info->no_samples, info->blocksize);
+#endif
+   }
+   free(url);
+
+   if (data)
+   {
+      _aaxRingBuffer* rb = _bufGetRingBuffer(buffer, buffer->root, level);
+      if (rb)
+      {
+         /* the internal buffer format for .aaxs files is signed 24-bit */
+         char **ndata;
+         char *ptr;
+
+         ndata = (char**)_aax_malloc(&ptr, sizeof(void*), info->no_samples*sizeof(int32_t));
+         if (ndata)
+         {
+            *ndata = (void*)ptr;
+            _bufConvertDataToPCM24S(*ndata, *data, info->no_samples, info->fmt);
+            free(data);
+            data = ndata;
+         }
+
+         info->fmt = AAX_PCM24S;
+//       rb->set_format(rb, fmt, false);
+         rb->set_parami(rb, RB_NO_LAYERS, info->no_tracks);
+         rb->set_parami(rb, RB_NO_TRACKS, info->no_tracks);
+         rb->set_paramf(rb, RB_FREQUENCY, info->rate);
+         rb->set_parami(rb, RB_NO_SAMPLES, info->no_samples);
+
+         rv = _bufSetData(buffer, data[0]);
+         free(data);
+
+         rb->set_paramf(rb, RB_LOOPPOINT_END, info->loop.end/info->rate);
+         rb->set_paramf(rb, RB_LOOPPOINT_START, info->loop.start/info->rate);
+         rb->set_parami(rb, RB_SAMPLED_RELEASE, info->envelope.sampled_release);
+         rb->set_parami(rb, RB_LOOPING, info->loop.count);
+      }
+   }
+
+   return rv;
+}
+
+static bool
+_bufCreateWaveformFromAAXS(_buffer_t* handle, const xmlId *xwid, int track, float ratio_factor, float pitch_factor, float freq, unsigned int pitch_level, int voices, float spread, limitType limiter, float version, _aaxSynthVoice *synth)
+{
+   enum aaxProcessingType ptype = AAX_OVERWRITE;
+   enum aaxSourceType wtype = (int)AAX_NONE;
+   float staticity = 0.0f;
+   float random = 0.0f;
+   float phase = 0.0f;
+   float pitch = 1.0f;
+   float ratio = 0.0f;
+   int midi_mode, pos;
+   bool rv = true;
+
+   midi_mode = handle->midi_mode;
+   pos = (midi_mode >> 26) & 0x3;
+
+   if (RENDER_NORMAL(midi_mode))
+   {
+      if (xmlAttributeExists(xwid, "voices"))
       {
          voices = _MINMAX(xmlAttributeGetInt(xwid, "voices"), 1, 11);
          if (xmlAttributeExists(xwid, "spread")) {
@@ -1608,15 +2094,20 @@ _bufCreateWaveformFromAAXS(_buffer_t* handle, const xmlId *xwid, int track, floa
 
       spread = spread*_log2lin(_lin2log(freq)/3.3f);
       if (ptype == AAX_RINGMODULATE) voices = 1;
-      rv = _bufProcessWaveform(handle, track, freq, phase, pitch,
-                              staticity, random, pitch_level, voices, spread,
-                              wtype, ratio, ptype, limiter, version);
+      if (synth) {
+         rv = _bufSynthAddWaveform(synth, freq, phase, pitch, voices, spread,
+                                   wtype, ratio, ptype, version);
+      } else {
+         rv = _bufProcessWaveform(handle, track, freq, phase, pitch,
+                                 staticity, random, pitch_level, voices, spread,
+                                 wtype, ratio, ptype, limiter, version);
+      }
    }
    return rv;
 }
 
 static int
-_bufCreateFilterFromAAXS(_buffer_t* handle, const xmlId *xfid, int layer, float frequency)
+_bufCreateFilterFromAAXS(_buffer_t* handle, const xmlId *xfid, unsigned char mip, int layer, float frequency)
 {
    aaxFilter flt;
    _midi_t midi;
@@ -1629,7 +2120,7 @@ _bufCreateFilterFromAAXS(_buffer_t* handle, const xmlId *xfid, int layer, float
       switch (filter->type)
       {
       case AAX_BITCRUSHER_FILTER:
-         _bufApplyBitCrusherFilter(handle, filter, layer);
+         _bufApplyBitCrusherFilter(handle, filter, mip, layer);
          break;
       case AAX_FREQUENCY_FILTER:
       {
@@ -1641,13 +2132,13 @@ _bufCreateFilterFromAAXS(_buffer_t* handle, const xmlId *xfid, int layer, float
              state == AAX_36DB_OCT ||
              state == AAX_48DB_OCT)
          {
-            _bufApplyFrequencyFilter(handle, filter, layer);
+            _bufApplyFrequencyFilter(handle, filter, mip, layer);
          }
          break;
       }
       case AAX_EQUALIZER:
       case AAX_GRAPHIC_EQUALIZER:
-         _bufApplyEqualizer(handle, filter, layer);
+         _bufApplyEqualizer(handle, filter, mip, layer);
          break;
       default:
          break;
@@ -1658,7 +2149,7 @@ _bufCreateFilterFromAAXS(_buffer_t* handle, const xmlId *xfid, int layer, float
 }
 
 static int
-_bufCreateEffectFromAAXS(_buffer_t* handle, const xmlId *xeid, int layer, float frequency)
+_bufCreateEffectFromAAXS(_buffer_t* handle, const xmlId *xeid, unsigned char mip, int layer, float frequency)
 {
    aaxEffect eff;
    _midi_t midi;
@@ -1672,11 +2163,11 @@ _bufCreateEffectFromAAXS(_buffer_t* handle, const xmlId *xeid, int layer, float
       {
       case AAX_DISTORTION_EFFECT:
          if (effect->state == true) {
-            _bufApplyDistortionEffect(handle, effect, layer);
+            _bufApplyDistortionEffect(handle, effect, mip, layer);
          }
          break;
       case AAX_WAVEFOLD_EFFECT:
-         _bufApplyWaveFoldEffect(handle, effect, layer);
+         _bufApplyWaveFoldEffect(handle, effect, mip, layer);
          break;
       default:
          break;
@@ -1729,245 +2220,1061 @@ _bufNormalize(_aaxRingBuffer* rb, float gain)
    double rms_total = 0.0;
    float rv, rms, peak = 0;
 
-   j = no_samples;
-   do
+   j = no_samples;
+   do
+   {
+      float samp = abs(*dptr++);
+      rms_total += (double)samp*samp;
+      if (samp > peak) peak = samp;
+   }
+   while (--j);
+
+   peak /= norm;
+   rms = sqrt(rms_total/no_samples)/norm;
+   rv = gain*_db2lin(-21.0f - _lin2db(rms));
+
+   return rv;
+}
+
+/*
+ * Live voices are only created for a single layer which holds nothing but
+ * periodic waveforms, everything else falls back to offline rendering.
+ * Only a small looping ringbuffer is allocated, the oscillators are
+ * generated by the mixer and sustain until the emitter is stopped.
+ */
+static bool
+_bufCreateLiveVoiceFromAAXS(_buffer_t* handle, xmlId *xsid, xmlId *xlid, float freq, int voices, float spread, float version)
+{
+   _aaxRingBuffer *rb = NULL;
+   _aaxSynthVoice *synth;
+   float pitch = 1.0f;
+   float ratio = 1.0f;
+   bool rv = false;
+   xmlId *xwid;
+   int i, num;
+
+   if (freq < FLT_EPSILON || handle->mip_levels < 1) return rv;
+   if (xlid != xsid && !xmlNodeGetPos(xsid, xlid, "layer", 0)) return rv;
+
+   if (xmlAttributeExists(xlid, "ratio")) {
+      ratio = xmlAttributeGetDouble(xlid, "ratio");
+   }
+   if (xmlAttributeExists(xlid, "pitch")) {
+      pitch = xmlAttributeGetDouble(xlid, "pitch");
+   }
+   if (xmlAttributeExists(xlid, "voices")) {
+      voices = _MINMAX(xmlAttributeGetInt(xlid, "voices"), 1, 11);
+   }
+   if (xmlAttributeExists(xlid, "spread")) {
+      spread = _MAX(xmlAttributeGetDouble(xlid, "spread"), 0.01f);
+      if (xmlAttributeGetBool(xlid, "phasing")) spread = -spread;
+   }
+
+   synth = calloc(1, sizeof(_aaxSynthVoice));
+   if (!synth) return rv;
+
+   synth->frequency = freq;
+   num = xmlNodeGetNum(xlid, "*");
+   xwid = xmlMarkId(xlid);
+   if (num && xwid)
+   {
+      rv = true;
+      for (i=0; rv && i<num; i++)
+      {
+         if (!xmlNodeGetPos(xlid, xwid, "*", i)) continue;
+
+         if (!xmlNodeCompareName(xwid, "waveform")) {
+            rv = _bufCreateWaveformFromAAXS(handle, xwid, 0, ratio, pitch,
+                                            freq, 0, voices, spread,
+                                            WAVEFORM_LIMIT_NORMAL, version,
+                                            synth);
+         } else {
+            rv = false;
+         }
+      }
+   }
+   if (xwid) xmlFree(xwid);
+
+   if (rv && synth->no_oscillators) {
+      rb = _bufGetRingBuffer(handle, handle->root, 0);
+   }
+
+   if (rb && rb->get_state(rb, RB_IS_VALID) == false)
+   {
+      _aaxRingBufferData *rbi = rb->handle;
+      float fs = rb->get_paramf(rb, RB_FREQUENCY);
+      size_t no_samples = SIZE_ALIGNED((size_t)ceilf(fs/freq));
+
+      handle->info.no_tracks = 1;
+      handle->info.no_samples = no_samples;
+      handle->info.loop.start = 0.0f;
+      handle->info.loop.end = no_samples;
+      handle->info.loop.count = INT_MAX;
+
+      rb->set_parami(rb, RB_NO_SAMPLES, no_samples);
+      rb->set_parami(rb, RB_NO_TRACKS, 1);
+      rb->set_parami(rb, RB_NO_LAYERS, 1);
+      rb->init(rb, false);
+      rb->set_parami(rb, RB_LOOPING, handle->info.loop.count);
+
+      rbi->sample->synth = synth;
+      handle->ringbuffer[0] = rb;
+      handle->mip_levels = 1;
+      handle->synth = true;
+   }
+   else
+   {
+      free(synth);
+      rv = false;
+   }
+
+   return rv;
+}
+
+typedef struct
+{
+   _buffer_t *handle;
+   xmlId *xsid;
+   bool layered;
+   int no_layers;
+   unsigned char mip;
+   float freq;
+   int voices;
+   float spread;
+   limitType limiter;
+   float version;
+   double duration;
+} _buffer_mip_t;
+
+static int _bufAAXSThreadCreateMipLevel(void*);
+static bool _bufLazyCreate(_buffer_t*, const _buffer_mip_t*, unsigned int);
+
+#define MIP_LEVELS_MASK(n)	((1u << (n)) - 1)
+
+/* collect the parameters required to render any of the mip levels */
+static void
+_bufGetMipParams(_buffer_t* handle, xmlId *xsid, float version, _buffer_mip_t *data)
+{
+   int midi_mode = handle->midi_mode;
+   char *env;
+
+   memset(data, 0, sizeof(_buffer_mip_t));
+   data->handle = handle;
+   data->xsid = xsid;
+   data->freq = handle->info.frequency.base;
+   data->version = version;
+   data->voices = 1;
+   data->duration = 1.0;
+
+   data->limiter = WAVEFORM_LIMIT_NORMAL;
+   env = getenv("AAX_INSTRUMENT_MODE");
+   if (env) {
+      data->limiter = atoi(env);
+   } else if (RENDER_NORMAL(midi_mode)) {
+      data->limiter = xmlAttributeGetInt(xsid, "mode");
+   }
+
+   if (xmlAttributeExists(xsid, "duration"))
+   {
+      data->duration = xmlAttributeGetDouble(xsid, "duration");
+      if (data->duration < 0.1f) {
+         data->duration = 0.1f;
+      }
+   }
+
+   if (RENDER_NORMAL(midi_mode))
+   {
+      if (xmlAttributeExists(xsid, "voices")) {
+         data->voices = _MINMAX(xmlAttributeGetInt(xsid, "voices"), 1, 11);
+      }
+      if (xmlAttributeExists(xsid, "spread")) {
+         data->spread = _MAX(xmlAttributeGetDouble(xsid, "spread"), 0.01f);
+         if (xmlAttributeGetBool(xsid, "phasing")) data->spread = -data->spread;
+      }
+   }
+
+   // layers, declare one if none are defined
+   data->no_layers = xmlNodeGetNum(xsid, "layer");
+   if (data->no_layers > 0) {
+      data->layered = true;
+   } else {
+      data->no_layers = 1;
+   }
+   if (!RENDER_NORMAL(midi_mode)) {
+      data->no_layers = 1;
+   }
+}
+
+static _aaxRingBuffer*
+_bufPrepareMipLevel(_buffer_t* handle, unsigned char mip, double duration)
+{
+   _aaxRingBuffer *rb = _bufGetRingBuffer(handle, handle->root, mip);
+   if (rb)
+   {
+      float mul = (float)(1 << mip);
+      float pitch_fact = 1.0f/mul;
+
+      if (duration >= 0.099f)
+      {
+         float f = pitch_fact*rb->get_paramf(rb, RB_FREQUENCY);
+         size_t no_samples = SIZE_ALIGNED((size_t)rintf(duration*f));
+
+         rb->set_parami(rb, RB_NO_SAMPLES, no_samples);
+         rb->set_parami(rb, RB_NO_TRACKS, handle->info.no_tracks);
+         rb->set_parami(rb, RB_NO_LAYERS, handle->info.no_tracks);
+         handle->ringbuffer[mip] = rb;
+      }
+      else {
+         rb = NULL;
+      }
+   }
+   return rb;
+}
+
+static bool
+_bufCreateResonatorFromAAXS(_buffer_t* handle, xmlId *xsid, float version, bool lazy)
+{
+   float frequency_high = handle->info.frequency.high;
+   float freq = handle->info.frequency.base;
+   _buffer_mip_t param;
+   int mip, levels;
+   bool rv = false;
+
+   if (xmlAttributeExists(xsid, "gain")) {
+      handle->gain = xmlAttributeGetDouble(xsid, "gain");
+   } else if (xmlAttributeExists(xsid, "fixed-gain")) {
+      handle->gain = xmlAttributeGetDouble(xsid, "fixed-gain");
+   }
+   handle->gain = _ln(handle->gain);
+
+   if (!freq && xmlAttributeExists(xsid, "frequency"))
+   {
+      freq = xmlAttributeGetDouble(xsid, "frequency");
+      handle->info.frequency.base = freq;
+      if (handle->info.pitch_fraction < 1.0f)
+      {
+         handle->info.frequency.low = freq*(1.0f-handle->info.pitch_fraction);
+         handle->info.frequency.high = freq*(1.0f+handle->info.pitch_fraction);
+         frequency_high = handle->info.frequency.high;
+      }
+      if (frequency_high > FLT_EPSILON)
+      {
+         int pitch = ceilf(frequency_high/freq);
+         handle->mip_levels = _getMaxMipLevels(pitch);
+         if (handle->mip_levels > MAX_MIP_LEVELS) {
+            handle->mip_levels = MAX_MIP_LEVELS;
+         }
+      }
+   }
+   if (!handle->info.frequency.base) {
+      handle->info.frequency.base = freq;
+   }
+
+   _bufGetMipParams(handle, xsid, version, &param);
+   handle->info.no_tracks = param.no_layers;
+
+   if (RENDER_NORMAL(handle->midi_mode) && param.no_layers == 1 &&
+       !param.limiter && xmlAttributeGetBool(xsid, "live"))
+   {
+      xmlId *xlid = param.layered ? xmlMarkId(xsid) : xsid;
+
+      rv = _bufCreateLiveVoiceFromAAXS(handle, xsid, xlid, freq, param.voices,
+                                        param.spread, version);
+      if (xlid != xsid) xmlFree(xlid);
+      if (rv) return rv;
+   }
+
+   // mip levels are handled by creating a new ringbuffer for every mip level
+   // and selecting the required ringbuffer later on. When generated lazily
+   // only the base level is rendered now and the other levels on first use.
+   levels = handle->mip_levels;
+   if (lazy && levels > 1 && _bufLazyCreate(handle, &param, 1)) {
+      levels = 1;
+   }
+   for (mip=0; mip<levels; ++mip) {
+      _bufPrepareMipLevel(handle, mip, param.duration);
+   }
+
+   // every mip level renders into its own ringbuffer so they are generated
+   // in parallel on the job pool.
+   if (levels > 0)
+   {
+      _aaxJobPool *pool = handle->root->buffer_pool;
+      _buffer_mip_t data[MAX_MIP_LEVELS];
+      _aaxJobGroup group;
+
+      _aaxJobGroupInit(&group);
+      for (mip=0; mip<levels; ++mip)
+      {
+         data[mip] = param;
+         data[mip].mip = mip;
+         _aaxJobPoolAdd(pool, &group, _bufAAXSThreadCreateMipLevel, &data[mip]);
+      }
+      rv = _aaxJobPoolWait(pool, &group);
+   }
+
+   if (!rv) {
+      _bufLazyDestroy(handle);
+   }
+
+   return rv;
+}
+
+static int
+_bufAAXSThreadCreateMipLevel(void *d)
+{
+   _buffer_mip_t *data = (_buffer_mip_t*)d;
+   _buffer_t* handle = data->handle;
+   unsigned char mip = data->mip;
+   _aaxRingBuffer *rb = handle->ringbuffer[mip];
+   int midi_mode = handle->midi_mode;
+   float spread = data->spread;
+   int voices = data->voices;
+   xmlId *xsid = data->xsid;
+   int layer, no_layers;
+   xmlId *xlid;
+   bool rv = false;
+
+   if (!rb) return rv;
+
+   // every job requires its own node references
+   xlid = data->layered ? xmlMarkId(xsid) : xsid;
+   if (!xlid) return rv;
+
+   // sound layers are handled by creating a new audio track for every layer
+   // and mixing between the tracks later on.
+   no_layers = data->no_layers;
+   for (layer=0; layer<no_layers; ++layer)
+   {
+      float mul = (float)(1 << mip);
+      float frequency = mul*data->freq;
+      float pitch = 1.0f;
+      float ratio = 1.0f;
+      int num, waves;
+      xmlId *xwid;
+
+      if (xlid != xsid) {
+         if (!xmlNodeGetPos(xsid, xlid, "layer", layer)) continue;
+      }
+
+      if (xmlAttributeExists(xlid, "ratio")) {
+         ratio = xmlAttributeGetDouble(xlid, "ratio");
+      }
+      if (xmlAttributeExists(xlid, "pitch")) {
+         pitch = xmlAttributeGetDouble(xlid, "pitch");
+      }
+
+      if (xmlAttributeExists(xlid, "voices")) {
+         voices = _MINMAX(xmlAttributeGetInt(xlid, "voices"), 1, 11);
+      }
+      if (xmlAttributeExists(xlid, "spread")) {
+         spread = _MAX(xmlAttributeGetDouble(xlid, "spread"), 0.01f);
+         if (xmlAttributeGetBool(xlid, "phasing")) spread = -spread;
+      }
+
+      num = xmlNodeGetNum(xlid, "*");
+      if (midi_mode == AAX_RENDER_ARCADE) waves = _MIN(1, num);
+      else if (midi_mode == AAX_RENDER_SYNTHESIZER) waves = _MIN(4, num);
+      else waves = num;
+
+      xwid = xmlMarkId(xlid);
+      if (num && xwid)
+      {
+         int i = _MAX(num-waves-1, 0);
+         for (; i<num; i++)
+         {
+            if (!xmlNodeGetPos(xlid, xwid, "*", i)) continue;
+
+            if (!xmlNodeCompareName(xwid, "waveform"))
+            {
+               if (waves)
+               {
+                  // mode:
+                  // 0: do limiting in _bufferMixWaveform for every sample
+                  // 1: do limiting here for all waveforms at once
+                  // 2: do both
+                  int mode = data->limiter & 1; // mode 0 or 1 only
+                  rv = _bufCreateWaveformFromAAXS(handle, xwid, layer,
+                                                  ratio, pitch, frequency,
+                                                  mip, voices, spread, mode,
+                                                  data->version, NULL);
+                  waves--;
+               }
+            }
+            else
+            {
+               if (!xmlNodeCompareName(xwid, "filter")) {
+                  rv = _bufCreateFilterFromAAXS(handle, xwid, mip, layer,
+                                                frequency);
+               } else if (!xmlNodeCompareName(xwid, "effect")) {
+                  rv = _bufCreateEffectFromAAXS(handle, xwid, mip, layer,
+                                                frequency);
+               }
+            }
+
+            if (rv == false) break;
+         }
+      }
+      if (xwid) xmlFree(xwid);
+   } // layer
+
+   if (rv)
+   {
+      if (midi_mode)
+      {
+         if (mip == 0 && rb->get_state(rb, RB_IS_VALID))
+         {
+            float gain = _exp(handle->gain);
+            switch (handle->midi_mode)
+            {
+            case AAX_RENDER_ARCADE:
+            case AAX_RENDER_SYNTHESIZER:
+               handle->gain = _ln(0.7f*gain);
+               break;
+            case AAX_RENDER_NORMAL:
+            case AAX_RENDER_DEFAULT:
+            default:
+               break;
+            }
+            handle->gain = _ln(handle->gain);
+         }
+      }
+      else if (data->limiter) {
+         _bufLimit(rb);
+      }
+   }
+
+   if (xlid != xsid) {
+      xmlFree(xlid);
+   }
+
+   return rv;
+}
+
+/*
+ * Rendered AAXS buffers are cached on disk. The file name is a hash of the
+ * <sound> section and everything else which determines the rendered result.
+ * The header is followed by the tracks of every mip level, each aligned to
+ * the memory alignment. Mip levels which were not rendered have no samples.
+ * The checksum covers everything following it.
+ */
+typedef struct
+{
+   uint32_t sound[4];
+   int32_t aax_version;
+   int32_t midi_mode;
+   int32_t limiter;
+   int32_t mip_levels;
+   float version;
+   float gain;
+   float rate;
+   float mixer_rate;
+   float frequency[4];		/* base, low, high, requested */
+   float pitch_fraction;
+} _buffer_cache_key_t;
+
+typedef struct
+{
+   char magic[4];
+   uint32_t version;
+   uint32_t byte_order;
+   uint32_t header_size;
+   uint64_t checksum[2];
+   uint64_t file_size;
+
+   _buffer_cache_key_t key;
+
+   float gain;
+   float frequency[3];		/* base, low, high */
+   int32_t mip_levels;
+   int32_t no_tracks;
+   int32_t bytes_sample;
+   uint32_t no_samples[MAX_MIP_LEVELS];
+   uint64_t offset[MAX_MIP_LEVELS];
+} _buffer_cache_t;
+
+#define CACHE_CHECKSUM_OFFSET	offsetof(_buffer_cache_t, file_size)
+
+static void
+_bufCacheChecksum(const char *data, size_t size, uint64_t checksum[2])
+{
+   MurmurHash3_x64_128(data + CACHE_CHECKSUM_OFFSET,
+                       size - CACHE_CHECKSUM_OFFSET, CACHE_VERSION, checksum);
+}
+
+static char*
+_bufCacheFile(_buffer_aax_t *aax_buf, _buffer_cache_key_t *key, float version)
+{
+   _buffer_t* handle = aax_buf->parent;
+   char *env = getenv("AAX_INSTRUMENT_MODE");
+   uint32_t hash[4];
+   char hstr[64];
+
+   memset(key, 0, sizeof(_buffer_cache_key_t));
+   memcpy(key->sound, aax_buf->hash, sizeof(key->sound));
+   key->aax_version = (AAX_MAJOR_VERSION << 16) | (AAX_MINOR_VERSION << 8) |
+                       AAX_MICRO_VERSION;
+   key->midi_mode = handle->midi_mode;
+   key->limiter = env ? atoi(env) : -1;
+   key->mip_levels = handle->mip_levels;
+   key->version = version;
+   key->gain = handle->gain;
+   key->rate = handle->info.rate;
+   key->mixer_rate = _info->frequency;
+   if (handle->mixer_info && *handle->mixer_info) {
+      key->mixer_rate = (*handle->mixer_info)->frequency;
+   }
+   key->frequency[0] = handle->info.frequency.base;
+   key->frequency[1] = handle->info.frequency.low;
+   key->frequency[2] = handle->info.frequency.high;
+   key->frequency[3] = aax_buf->frequency;
+   key->pitch_fraction = handle->info.pitch_fraction;
+
+   MurmurHash3_x64_128(key, sizeof(_buffer_cache_key_t), 0x27918072, hash);
+   snprintf(hstr, 64, "%08x%08x%08x%08x", hash[0], hash[1], hash[2], hash[3]);
+
+   return userCacheFile(hstr);
+}
+
+/* test the header and the checksum of a mapped cache file */
+static bool
+_bufCacheValid(const char *data, size_t size, const _buffer_cache_key_t *key)
+{
+   const _buffer_cache_t *hdr = (const _buffer_cache_t*)data;
+   bool rv = false;
+   int mip;
+
+   if (size >= sizeof(_buffer_cache_t) &&
+       !memcmp(hdr->magic, CACHE_MAGIC, 4) &&
+       hdr->version == CACHE_VERSION &&
+       hdr->byte_order == CACHE_BYTE_ORDER &&
+       hdr->header_size == sizeof(_buffer_cache_t) &&
+       hdr->file_size == size &&
+       !memcmp(&hdr->key, key, sizeof(_buffer_cache_key_t)) &&
+       hdr->mip_levels > 0 && hdr->mip_levels <= MAX_MIP_LEVELS &&
+       hdr->no_tracks > 0 && hdr->no_tracks <= RB_MAX_TRACKS &&
+       hdr->bytes_sample == sizeof(int32_t))
+   {
+      uint64_t checksum[2];
+
+      rv = true;
+      for (mip=0; mip<hdr->mip_levels; ++mip)
+      {
+         size_t len = hdr->no_samples[mip]*hdr->bytes_sample;
+         size_t step = SIZE_ALIGNED(len);
+         uint64_t total = (uint64_t)hdr->no_tracks*step;
+
+         // mip levels which were never used are not stored
+         if (mip > 0 && !hdr->no_samples[mip]) continue;
+
+         if (!hdr->no_samples[mip] || hdr->offset[mip] < sizeof(_buffer_cache_t)
+             || hdr->offset[mip] + total > size)
+         {
+            rv = false;
+            break;
+         }
+      }
+
+      if (rv)
+      {
+         _bufCacheChecksum(data, size, checksum);
+         if (memcmp(checksum, hdr->checksum, sizeof(checksum))) rv = false;
+      }
+   }
+
+   return rv;
+}
+
+static bool
+_bufAAXSThreadReadFromCache(_buffer_t *handle, const char *fname, const _buffer_cache_key_t *key, unsigned int *levels)
+{
+   const _buffer_cache_t *hdr;
+   bool rv = false;
+   size_t size;
+   char *data;
+   int mip;
+
+   data = _aax_mmap_file(fname, &size);
+   if (!data) return rv;
+
+   hdr = (const _buffer_cache_t*)data;
+   rv = _bufCacheValid(data, size, key);
+   if (rv)
+   {
+      *levels = 0;
+      for (mip=0; rv && mip<hdr->mip_levels; ++mip)
+      {
+         size_t len = hdr->no_samples[mip]*hdr->bytes_sample;
+         size_t step = SIZE_ALIGNED(len);
+         const char *ptr = data + hdr->offset[mip];
+         _aaxRingBuffer *rb;
+
+         if (!hdr->no_samples[mip]) continue;
+
+         rb = _bufGetRingBuffer(handle, handle->root, mip);
+         rv = false;
+         if (rb)
+         {
+            rb->set_parami(rb, RB_NO_SAMPLES, hdr->no_samples[mip]);
+            rb->set_parami(rb, RB_NO_TRACKS, hdr->no_tracks);
+            rb->set_parami(rb, RB_NO_LAYERS, hdr->no_tracks);
+            rb->init(rb, false);
+            handle->ringbuffer[mip] = rb;
+
+            if (rb->get_parami(rb, RB_BYTES_SAMPLE) == hdr->bytes_sample)
+            {
+               void **tracks = (void**)rb->get_tracks_ptr(rb, RB_WRITE);
+               int t;
+
+               for (t=0; t<hdr->no_tracks; ++t)
+               {
+                  memcpy(tracks[t], ptr, len);
+                  ptr += step;
+               }
+               rb->release_tracks_ptr(rb);
+               *levels |= (1 << mip);
+               rv = true;
+            }
+         }
+      }
+
+      if (rv)
+      {
+         handle->gain = hdr->gain;
+         handle->info.frequency.base = hdr->frequency[0];
+         handle->info.frequency.low = hdr->frequency[1];
+         handle->info.frequency.high = hdr->frequency[2];
+         handle->info.no_tracks = hdr->no_tracks;
+         handle->mip_levels = hdr->mip_levels;
+      }
+   }
+   _aax_munmap_file(data, size);
+
+   return rv;
+}
+
+static once_flag _cache_once = ONCE_FLAG_INIT;
+static mtx_t _cache_mutex;
+
+static void
+_bufCacheInit(void) {
+   mtx_init(&_cache_mutex, mtx_plain);
+}
+
+/*
+ * Write the rendered mip levels to the cache file. Writes are serialized
+ * and the mip levels which are already stored in the cache file, but which
+ * are not rendered by this buffer, are kept.
+ */
+static void
+_bufAAXSThreadWriteToCache(_buffer_t *handle, const char *fname, const _buffer_cache_key_t *key, unsigned int levels)
+{
+   const _buffer_cache_t *old = NULL;
+   _buffer_cache_t *hdr;
+   int mip, no_tracks, bps;
+   size_t size, old_size = 0;
+   char *data, *old_data;
+
+   if (handle->synth || handle->mip_levels < 1 || !(levels & 1)) return;
+
+   call_once(&_cache_once, _bufCacheInit);
+   mtx_lock(&_cache_mutex);
+
+   no_tracks = handle->info.no_tracks;
+   bps = sizeof(int32_t);
+
+   old_data = _aax_mmap_file(fname, &old_size);
+   if (old_data)
+   {
+      old = (const _buffer_cache_t*)old_data;
+      if (!_bufCacheValid(old_data, old_size, key) ||
+          old->mip_levels != handle->mip_levels || old->no_tracks != no_tracks)
+      {
+         old = NULL;
+      }
+   }
+
+   size = SIZE_ALIGNED(sizeof(_buffer_cache_t));
+   for (mip=0; mip<handle->mip_levels; ++mip)
+   {
+      _aaxRingBuffer *rb = handle->ringbuffer[mip];
+      size_t len, step;
+
+      if (!(levels & (1 << mip)))
+      {
+         if (old && old->no_samples[mip])
+         {
+            len = old->no_samples[mip]*bps;
+            step = SIZE_ALIGNED(len);
+            size += no_tracks*step;
+         }
+         continue;
+      }
+      if (!rb || !rb->get_state(rb, RB_IS_VALID) ||
+          rb->get_parami(rb, RB_NO_TRACKS) != no_tracks ||
+          rb->get_parami(rb, RB_BYTES_SAMPLE) != bps)
+      {
+         size = 0;
+         break;
+      }
+
+      len = rb->get_parami(rb, RB_NO_SAMPLES)*bps;
+      step = SIZE_ALIGNED(len);
+      size += no_tracks*step;
+   }
+
+   data = size ? calloc(1, size) : NULL;
+   if (!data)
+   {
+      if (old_data) _aax_munmap_file(old_data, old_size);
+      mtx_unlock(&_cache_mutex);
+      return;
+   }
+
+   hdr = (_buffer_cache_t*)data;
+   memcpy(hdr->magic, CACHE_MAGIC, 4);
+   hdr->version = CACHE_VERSION;
+   hdr->byte_order = CACHE_BYTE_ORDER;
+   hdr->header_size = sizeof(_buffer_cache_t);
+   hdr->file_size = size;
+   hdr->key = *key;
+   hdr->gain = handle->gain;
+   hdr->frequency[0] = handle->info.frequency.base;
+   hdr->frequency[1] = handle->info.frequency.low;
+   hdr->frequency[2] = handle->info.frequency.high;
+   hdr->mip_levels = handle->mip_levels;
+   hdr->no_tracks = no_tracks;
+   hdr->bytes_sample = bps;
+
+   size = SIZE_ALIGNED(sizeof(_buffer_cache_t));
+   for (mip=0; mip<handle->mip_levels; ++mip)
+   {
+      _aaxRingBuffer *rb = handle->ringbuffer[mip];
+      size_t no_samples, len, step;
+      void **tracks;
+      int t;
+
+      if (!(levels & (1 << mip)))
+      {
+         if (old && old->no_samples[mip])
+         {
+            no_samples = old->no_samples[mip];
+            len = no_samples*bps;
+            step = SIZE_ALIGNED(len);
+            hdr->no_samples[mip] = no_samples;
+            hdr->offset[mip] = size;
+
+            memcpy(data+size, old_data+old->offset[mip], no_tracks*step);
+            size += no_tracks*step;
+         }
+         continue;
+      }
+
+      no_samples = rb->get_parami(rb, RB_NO_SAMPLES);
+      len = no_samples*bps;
+      step = SIZE_ALIGNED(len);
+      hdr->no_samples[mip] = no_samples;
+      hdr->offset[mip] = size;
+
+      tracks = (void**)rb->get_tracks_ptr(rb, RB_READ);
+      for (t=0; t<no_tracks; ++t)
+      {
+         memcpy(data+size, tracks[t], len);
+         size += step;
+      }
+      rb->release_tracks_ptr(rb);
+   }
+   _bufCacheChecksum(data, size, hdr->checksum);
+   if (old_data) _aax_munmap_file(old_data, old_size);
+
+   // write to a temporary file first and rename it when complete so
+   // other threads or processes never see a partially written file.
+   do
+   {
+      size_t len = strlen(fname) + 16;
+      char *tmp = malloc(len);
+      FILE *output = NULL;
+#ifndef WIN32
+      int fd;
+#endif
+
+      if (!tmp) break;
+#ifndef WIN32
+      snprintf(tmp, len, "%s.XXXXXX", fname);
+      fd = mkstemp(tmp);
+      if (fd >= 0) output = fdopen(fd, "wb");
+#else
+      snprintf(tmp, len, "%s.%lu", fname, GetCurrentThreadId());
+      output = fopen(tmp, "wb");
+#endif
+      if (output)
+      {
+         bool ok = (fwrite(data, size, 1, output) == 1);
+         if (fclose(output) != 0) ok = false;
+#ifndef WIN32
+         if (ok) ok = (rename(tmp, fname) == 0);
+#else
+         if (ok) ok = MoveFileExA(tmp, fname, MOVEFILE_REPLACE_EXISTING);
+#endif
+         if (!ok) unlink(tmp);
+      }
+      free(tmp);
+   }
+   while(0);
+   mtx_unlock(&_cache_mutex);
+
+   free(data);
+}
+
+/*
+ * Mip levels of an AAXS buffer other than the base level are rendered on
+ * first use by an emitter. Until the background job has finished the
+ * emitter falls back to the nearest lower level which is available.
+ */
+typedef struct _buffer_lazy_s
+{
+   mtx_t mutex;
+   _aaxJobGroup group;
+   unsigned int ready;		/* bitmask of the rendered mip levels */
+   unsigned int queued;		/* bitmask of the requested mip levels */
+
+   char *cache_file;
+   _buffer_cache_key_t key;
+
+   _buffer_mip_t data[MAX_MIP_LEVELS];
+} _buffer_lazy_t;
+
+static xmlId*
+_bufAAXSGetSoundNode(_buffer_t* handle, xmlId *xaid)
+{
+   xmlId *xsid = NULL;
+
+   if (!RENDER_NORMAL(handle->midi_mode)) {
+      xsid = xmlNodeGet(xaid, "fm");
+   }
+   if (!xsid)
+   {
+      xsid = xmlNodeGet(xaid, "resonator");
+      if (!xsid) {
+         xsid = xmlNodeGet(xaid, "sound");
+      }
+   }
+   return xsid;
+}
+
+static bool
+_bufLazyCreate(_buffer_t* handle, const _buffer_mip_t *param, unsigned int ready)
+{
+   _buffer_lazy_t *lazy;
+   int mip;
+
+   assert(!handle->lazy);
+
+   lazy = calloc(1, sizeof(_buffer_lazy_t));
+   if (!lazy) return false;
+
+   mtx_init(&lazy->mutex, mtx_plain);
+   _aaxJobGroupInit(&lazy->group);
+   lazy->ready = lazy->queued = ready;
+
+   for (mip=0; mip<MAX_MIP_LEVELS; ++mip)
    {
-      float samp = abs(*dptr++);
-      rms_total += (double)samp*samp;
-      if (samp > peak) peak = samp;
+      lazy->data[mip] = *param;
+      lazy->data[mip].xsid = NULL;
+      lazy->data[mip].mip = mip;
    }
-   while (--j);
-
-   peak /= norm;
-   rms = sqrt(rms_total/no_samples)/norm;
-   rv = gain*_db2lin(-21.0f - _lin2db(rms));
+   handle->lazy = lazy;
 
-   return rv;
+   return true;
 }
 
-static bool
-_bufCreateResonatorFromAAXS(_buffer_t* handle, xmlId *xsid, float version)
+static void
+_bufLazyDestroy(_buffer_t* handle)
 {
-   float frequency_high = handle->info.frequency.high;
-   float freq = handle->info.frequency.base;
-   int mip, layer, no_layers;
-   double duration = 1.0f;
-   limitType limiter;
-   float spread = 0;
-   int voices = 1;
-   int bits = 24;
-   int midi_mode;
-   xmlId *xlid;
-   char *env;
-   bool rv = false;
+   _buffer_lazy_t *lazy = handle->lazy;
+   if (lazy)
+   {
+      _aaxJobPool *pool = handle->root ? handle->root->buffer_pool : NULL;
 
-   limiter = WAVEFORM_LIMIT_NORMAL;
-   env = getenv("AAX_INSTRUMENT_MODE");
-   if (env) {
-      limiter = atoi(env);
-   }
+      _aaxJobPoolWait(pool, &lazy->group);
+      handle->lazy = NULL;
 
-   if (xmlAttributeExists(xsid, "gain")) {
-      handle->gain = xmlAttributeGetDouble(xsid, "gain");
-   } else if (xmlAttributeExists(xsid, "fixed-gain")) {
-      handle->gain = xmlAttributeGetDouble(xsid, "fixed-gain");
+      mtx_destroy(&lazy->mutex);
+      free(lazy->cache_file);
+      free(lazy);
    }
-   handle->gain = _ln(handle->gain);
+}
 
-   if (!freq && xmlAttributeExists(xsid, "frequency"))
+/* render all mip levels which are not yet available */
+static void
+_bufLazyFinish(_buffer_t* handle)
+{
+   _buffer_lazy_t *lazy = handle->lazy;
+   if (lazy)
    {
-      freq = xmlAttributeGetDouble(xsid, "frequency");
-      handle->info.frequency.base = freq;
-      if (handle->info.pitch_fraction < 1.0f)
-      {
-         handle->info.frequency.low = freq*(1.0f-handle->info.pitch_fraction);
-         handle->info.frequency.high = freq*(1.0f+handle->info.pitch_fraction);
-         frequency_high = handle->info.frequency.high;
-      }
-      if (frequency_high > FLT_EPSILON)
+      _aaxJobPool *pool = handle->root ? handle->root->buffer_pool : NULL;
+      int mip;
+
+      for (mip=1; mip<handle->mip_levels; ++mip)
       {
-         int pitch = ceilf(frequency_high/freq);
-         handle->mip_levels = _getMaxMipLevels(pitch);
-         if (handle->mip_levels > MAX_MIP_LEVELS) {
-            handle->mip_levels = MAX_MIP_LEVELS;
-         }
+         int level = mip;
+         _bufGetMipLevel(handle, &level);
       }
+      _aaxJobPoolWait(pool, &lazy->group);
    }
-   if (!handle->info.frequency.base) {
-      handle->info.frequency.base = freq;
-   }
+}
 
-   if (xmlAttributeExists(xsid, "duration"))
+static int
+_bufAAXSThreadLazyMipLevel(void *d)
+{
+   _buffer_mip_t *data = (_buffer_mip_t*)d;
+   _buffer_t* handle = data->handle;
+   _buffer_lazy_t *lazy = handle->lazy;
+   const char *aaxs = handle->aaxs;
+   unsigned char mip = data->mip;
+   bool rv = false;
+   xmlId *xid;
+
+   xid = xmlInitBuffer(aaxs, strlen(aaxs));
+   if (xid)
    {
-      duration = xmlAttributeGetDouble(xsid, "duration");
-      if (duration < 0.1f) {
-         duration = 0.1f;
+      xmlId *xaid = xmlNodeGet(xid, "aeonwave");
+      if (xaid)
+      {
+         xmlId *xsid = _bufAAXSGetSoundNode(handle, xaid);
+         if (xsid)
+         {
+            if (_bufPrepareMipLevel(handle, mip, data->duration))
+            {
+               data->xsid = xsid;
+               rv = _bufAAXSThreadCreateMipLevel(data);
+               data->xsid = NULL;
+            }
+            xmlFree(xsid);
+         }
+         xmlFree(xaid);
       }
+      xmlClose(xid);
    }
 
-   if (xmlAttributeExists(xsid, "bits"))
+   if (rv)
    {
-      bits = xmlAttributeGetInt(xsid, "bits");
-      if (bits != 16) bits = 24;
-   }
+      unsigned int ready;
 
-   midi_mode = handle->midi_mode;
-   if (!env && RENDER_NORMAL(handle->midi_mode)) {
-      limiter = xmlAttributeGetInt(xsid, "mode");
-   }
+      mtx_lock(&lazy->mutex);
+      lazy->ready |= (1 << mip);
+      ready = lazy->ready;
+      mtx_unlock(&lazy->mutex);
 
-   if (RENDER_NORMAL(midi_mode))
-   {
-      if (xmlAttributeExists(xsid, "voices")) {
-         voices = _MINMAX(xmlAttributeGetInt(xsid, "voices"), 1, 11);
-      }
-      if (xmlAttributeExists(xsid, "spread")) {
-         spread = _MAX(xmlAttributeGetDouble(xsid, "spread"), 0.01f);
-         if (xmlAttributeGetBool(xsid, "phasing")) spread = -spread;
+      if (lazy->cache_file) {
+         _bufAAXSThreadWriteToCache(handle, lazy->cache_file, &lazy->key, ready);
       }
    }
-
-   // layers, declare one if none are defined
-   no_layers = xmlNodeGetNum(xsid, "layer");
-   if (no_layers > 0) {
-      xlid = xmlMarkId(xsid);
-   }
    else
    {
-      no_layers = 1;
-      xlid = xsid;
-   }
-   if (!RENDER_NORMAL(midi_mode)) {
-      no_layers = 1;
+      // the level may be requested again, e.g. after memory was freed
+      mtx_lock(&lazy->mutex);
+      lazy->queued &= ~(1 << mip);
+      mtx_unlock(&lazy->mutex);
    }
-   handle->info.no_tracks = no_layers;
 
-   // mip levels are handled by creating a new ringbuffer for every mip level
-   // and selecting the required ringbuffer later on.
-   for (mip=0; mip<handle->mip_levels; ++mip)
-   {
-      _aaxRingBuffer *rb = _bufGetRingBuffer(handle, handle->root, mip);
-      if (rb)
-      {
-         float mul = (float)(1 << mip);
-         float pitch_fact = 1.0f/mul;
+   return rv;
+}
 
-         if (duration >= 0.099f)
-         {
-            float f = pitch_fact*rb->get_paramf(rb, RB_FREQUENCY);
-            size_t no_samples = SIZE_ALIGNED((size_t)rintf(duration*f));
+/*
+ * Get the ringbuffer of the requested mip level. If the level is not
+ * rendered yet a job is queued to do so and the nearest lower level
+ * which is available is returned instead. level is updated accordingly.
+ */
+_aaxRingBuffer*
+_bufGetMipLevel(_buffer_t* handle, int *level)
+{
+   _buffer_lazy_t *lazy = handle->lazy;
+   int mip = *level;
 
-            rb->set_parami(rb, RB_NO_SAMPLES, no_samples);
-            rb->set_parami(rb, RB_NO_TRACKS, handle->info.no_tracks);
-            rb->set_parami(rb, RB_NO_LAYERS, handle->info.no_tracks);
-            handle->ringbuffer[mip] = rb;
-         }
-      }
+   assert(mip >= 0 && mip < MAX_MIP_LEVELS);
 
-      // sound layers are handled by creating a new audio track for every layer
-      // and mixing between the tracks later on.
-      for (layer=0; layer<no_layers; ++layer)
-      {
-         float mul = (float)(1 << mip);
-         float frequency = mul*freq;
-         float pitch = 1.0f;
-         float ratio = 1.0f;
-         int num, waves;
-         xmlId *xwid;
+   if (lazy)
+   {
+      bool queue = false;
 
-         if (xlid != xsid) {
-            if (!xmlNodeGetPos(xsid, xlid, "layer", layer)) continue;
-         }
+      mtx_lock(&lazy->mutex);
+      if (!(lazy->queued & (1 << mip)))
+      {
+         lazy->queued |= (1 << mip);
+         queue = true;
+      }
+      while (mip > 0 && !(lazy->ready & (1 << mip))) {
+         --mip;
+      }
+      mtx_unlock(&lazy->mutex);
 
-         if (xmlAttributeExists(xlid, "ratio")) {
-            ratio = xmlAttributeGetDouble(xlid, "ratio");
-         }
-         if (xmlAttributeExists(xlid, "pitch")) {
-            pitch = xmlAttributeGetDouble(xlid, "pitch");
-         }
+      // a job without a pool runs immediately and locks the mutex itself
+      if (queue)
+      {
+         _aaxJobPool *pool = handle->root ? handle->root->buffer_pool : NULL;
+         _aaxJobPoolAdd(pool, &lazy->group, _bufAAXSThreadLazyMipLevel,
+                        &lazy->data[*level]);
+      }
+   }
+   else
+   {
+      while (mip > 0 && !handle->ringbuffer[mip]) {
+         --mip;
+      }
+   }
 
-         if (xmlAttributeExists(xlid, "voices")) {
-            voices = _MINMAX(xmlAttributeGetInt(xlid, "voices"), 1, 11);
-         }
-         if (xmlAttributeExists(xlid, "spread")) {
-            spread = _MAX(xmlAttributeGetDouble(xlid, "spread"), 0.01f);
-            if (xmlAttributeGetBool(xlid, "phasing")) spread = -spread;
-         }
+   *level = mip;
+   return handle->ringbuffer[mip];
+}
 
-         num = xmlNodeGetNum(xlid, "*");
-         if (midi_mode == AAX_RENDER_ARCADE) waves = _MIN(1, num);
-         else if (midi_mode == AAX_RENDER_SYNTHESIZER) waves = _MIN(4, num);
-         else waves = num;
+static bool
+_bufCreateResonatorFromCache(_buffer_aax_t *aax_buf, xmlId *xsid, float version)
+{
+   _buffer_t* handle = aax_buf->parent;
+   unsigned int levels = 0;
+   _buffer_cache_key_t key;
+   char *fname = NULL;
+   bool rv = false;
 
-         xwid = xmlMarkId(xlid);
-         if (num && xwid)
-         {
-            int i = _MAX(num-waves-1, 0);
-            for (; i<num; i++)
-            {
-               if (!xmlNodeGetPos(xlid, xwid, "*", i)) continue;
+   if (aax_buf->hash[0] || aax_buf->hash[1]) {
+      fname = _bufCacheFile(aax_buf, &key, version);
+   }
 
-               if (!xmlNodeCompareName(xwid, "waveform"))
-               {
-                  if (waves)
-                  {
-                     // mode:
-                     // 0: do limiting in _bufferMixWaveform for every sample
-                     // 1: do limiting here for all waveforms at once
-                     // 2: do both
-                     int mode = limiter & 1; // mode 0 or 1 only
-                     rv = _bufCreateWaveformFromAAXS(handle, xwid, layer,
-                                                     ratio, pitch, frequency,
-                                                     mip, voices, spread, mode,
-                                                     version);
-                     waves--;
-                  }
-               }
-               else
-               {
-                  if (!xmlNodeCompareName(xwid, "filter")) {
-                     rv = _bufCreateFilterFromAAXS(handle, xwid, layer, frequency);
-                  } else if (!xmlNodeCompareName(xwid, "effect")) {
-                     rv = _bufCreateEffectFromAAXS(handle, xwid, layer, frequency);
-                  }
-               }
+   if (fname) {
+      rv = _bufAAXSThreadReadFromCache(handle, fname, &key, &levels);
+   }
 
-               if (rv == false) break;
-            }
-         }
-         if (xwid) xmlFree(xwid);
-      } // layer
+   if (rv)
+   {
+      // levels which were not in the cache are rendered on first use
+      if (levels != MIP_LEVELS_MASK(handle->mip_levels))
+      {
+         _buffer_mip_t param;
 
-      if (rv)
+         _bufGetMipParams(handle, xsid, version, &param);
+         _bufLazyCreate(handle, &param, levels);
+      }
+   }
+   else
+   {
+      rv = _bufCreateResonatorFromAAXS(handle, xsid, version, true);
+      if (rv && fname)
       {
-         if (midi_mode)
-         {
-            if (mip == 0 && rb->get_state(rb, RB_IS_VALID))
-            {
-               float gain = _exp(handle->gain);
-               switch (handle->midi_mode)
-               {
-               case AAX_RENDER_ARCADE:
-               case AAX_RENDER_SYNTHESIZER:
-                  handle->gain = _ln(0.7f*gain);
-                  break;
-               case AAX_RENDER_NORMAL:
-               case AAX_RENDER_DEFAULT:
-               default:
-                  break;
-               }
-               handle->gain = _ln(handle->gain);
-            }
-         }
-         else if (limiter) {
-            _bufLimit(rb);
-         }
-      } // mip-level
+         levels = MIP_LEVELS_MASK(handle->mip_levels);
+         if (handle->lazy) levels = handle->lazy->ready;
+         _bufAAXSThreadWriteToCache(handle, fname, &key, levels);
+      }
    }
 
-   if (xlid != xsid) {
-      xmlFree(xlid);
+   // rendered levels are added to the cache when they become available
+   if (rv && handle->lazy && fname)
+   {
+      handle->lazy->cache_file = fname;
+      handle->lazy->key = key;
+      fname = NULL;
    }
+   free(fname);
 
    return rv;
 }
@@ -1992,17 +3299,7 @@ _bufAAXSThreadCreateWaveform(_buffer_aax_t *aax_buf, xmlId *xid)
       midi_mode = handle->midi_mode = (*handle->mixer_info)->midi_mode;
    }
 
-   xsid = NULL;
-   if (!RENDER_NORMAL(midi_mode) && xmlNodeGet(xaid, "fm")) {
-      xsid = xmlNodeGet(xaid, "fm");
-   }
-   if (!xsid)
-   {
-      xsid = xmlNodeGet(xaid, "resonator");
-      if (!xsid) {
-         xsid = xmlNodeGet(xaid, "sound");
-      }
-   }
+   xsid = _bufAAXSGetSoundNode(handle, xaid);
    if (!xsid)
    {
       xmlFree(xaid);
@@ -2144,7 +3441,7 @@ _bufAAXSThreadCreateWaveform(_buffer_aax_t *aax_buf, xmlId *xid)
                }
                if (xasid)
                {
-                  rv =_bufCreateResonatorFromAAXS(handle, xasid, sound_version);
+                  rv =_bufCreateResonatorFromAAXS(handle, xasid, sound_version, false);
                   xmlFree(xasid);
                }
                xmlClose(xid);
@@ -2189,10 +3486,10 @@ _bufAAXSThreadCreateWaveform(_buffer_aax_t *aax_buf, xmlId *xid)
       }
 
       handle->mip_levels = 0;
-      rv = _bufCreateResonatorFromAAXS(handle, xsid, sound_version);
+      rv = _bufCreateResonatorFromAAXS(handle, xsid, sound_version, false);
    }
    else {
-      rv = _bufCreateResonatorFromAAXS(handle, xsid, sound_version);
+      rv = _bufCreateResonatorFromCache(aax_buf, xsid, sound_version);
    }
 
    xmlFree(xsid);
@@ -2206,28 +3503,18 @@ _bufAAXSThread(void *d)
 {
    _buffer_aax_t *aax_buf = (_buffer_aax_t*)d;
    _buffer_t* handle = aax_buf->parent;
-   const void *aaxs =  aax_buf->aaxs;
+   const char *aaxs =  aax_buf->aaxs;
    bool rv = false;
    xmlId *xid, *xiid;
 
    assert(handle);
    assert(aaxs);
 
-   if (handle->aaxs) free(handle->aaxs);
-   handle->aaxs = strdup(aaxs);
-   if (!handle->aaxs)
-   {
-      aax_buf->error = AAX_INSUFFICIENT_RESOURCES;
-      return false;
-   }
-
-   xid = xmlInitBuffer(handle->aaxs, strlen(handle->aaxs));
+   xid = xmlInitBuffer(aaxs, strlen(aaxs));
    if (xid)
    {
       char *a = xmlNodeGetString(xid, "aeonwave");
-      uint32_t hash[4] = {0, 0, 0, 0};
       char have_hash = 0;
-      char hstr[64];
 
       if (a)
       {
@@ -2238,9 +3525,7 @@ _bufAAXSThread(void *d)
               if (e)
               {
                   e += strlen("</sound>");
-                  MurmurHash3_x64_128(s, e-s, 0x27918072, &hash);
-                  snprintf(hstr, 64, "%08x%08x%08x%08x", hash[0], hash[1],
-                                                         hash[2], hash[3]);
+                  MurmurHash3_x64_128(s, e-s, 0x27918072, aax_buf->hash);
                   have_hash = 1;
               }
           }
@@ -2307,53 +3592,8 @@ _bufAAXSThread(void *d)
          }
       }
 
-      if (have_hash)
-      {
-         char *fname;
-
-         fname = userCacheFile(hstr);
-         if (fname)
-         {
-#if 0
-            size_t fsize = getFileSize(fname);
-            if (fsize) {
-               rv = _bufAAXSThreadReadFromCache(aax_buf, fname, fsize);
-            }
-#endif
-            if (!rv)
-            {
-               rv = _bufAAXSThreadCreateWaveform(aax_buf, xid);
-#if 0
-               if (rv)
-               {
-                  // create the cache file
-                  void **data = _bufGetDataPitchLevels(handle);
-                  if (data)
-                  {
-                     FILE *output = fopen(fname, "w");
-                     if (output)
-                     {
-                        size_t *d = (size_t*)data;
-                        char *s = (char*)data;
-                        size_t datasize;
-
-                        while (*d)
-                        {
-                           char *c = (char*)*d;
-                           *d++ = (size_t)(c - s); // make offsets relative
-                        }
-                        datasize = *(d+1);
-
-                        fwrite(data, datasize, 1, output);
-                        fclose(output);
-                     }
-                     free(data);
-                  }
-               }
-#endif
-            }
-            free(fname);
-         }
+      if (have_hash) {
+         rv = _bufAAXSThreadCreateWaveform(aax_buf, xid);
       }
       else
       {
@@ -2372,50 +3612,85 @@ _bufAAXSThread(void *d)
    return rv;
 }
 
-static int
-_bufCreateFromAAXS(_buffer_t* buffer, const void *aaxs, float freq)
+static bool
+_bufCreateFromAAXS(_buffer_t* buffer, const void *aaxs, float freq, bool async)
 {
    _handle_t *handle = buffer->root;
-   _buffer_aax_t data;
+   _buffer_aax_t *data;
    bool rv = false;
 
-   memset(&data, 0, sizeof(_buffer_aax_t));
-
-   data.parent = buffer;
-   data.aaxs = aaxs;
-   data.frequency = freq;
-   data.error = AAX_ERROR_NONE;
+   if (buffer->aaxs_pending) {
+      _bufAAXSWait(buffer);
+   }
+   _bufLazyDestroy(buffer);
 
-   // Using a thread here might spawn wavweform generation on another CPU
-   // core freeing the current (possibly busy) CPU core from doing the work.
-   if (!handle->buffer_thread.ptr) {
-      handle->buffer_thread.ptr = _aaxThreadCreate();
+   data = calloc(1, sizeof(_buffer_aax_t));
+   if (!data)
+   {
+      _aaxErrorSet(AAX_INSUFFICIENT_RESOURCES);
+      return rv;
    }
 
-   if (handle->buffer_thread.ptr)
+   // keep a copy, the caller may release aaxs before the job gets started
+   if (buffer->aaxs) free(buffer->aaxs);
+   buffer->aaxs = strdup(aaxs);
+   if (!buffer->aaxs)
    {
-      int r = _aaxThreadStart(handle->buffer_thread.ptr, _bufAAXSThread, &data,
-                              0, "aaxBufferAAXS");
-      if (r == thrd_success)
-      {
-         r = _aaxThreadJoin(handle->buffer_thread.ptr);
-         if (r == thrd_success) rv = true;
-      }
-      else {
-         _bufAAXSThread(&data);
-      }
+      _aaxErrorSet(AAX_INSUFFICIENT_RESOURCES);
+      free(data);
+      return rv;
    }
-   else {
-      _bufAAXSThread(&data);
+
+   data->parent = buffer;
+   data->aaxs = buffer->aaxs;
+   data->frequency = freq;
+   data->error = AAX_ERROR_NONE;
+   _aaxJobGroupInit(&buffer->aaxs_group);
+
+   // Using the job pool spawns waveform generation on other CPU cores
+   // freeing the current (possibly busy) CPU core from doing the work.
+   if (!handle->buffer_pool) {
+      handle->buffer_pool = _aaxJobPoolCreate(_aaxGetNoCores(),"aaxBufferAAXS");
    }
 
-   _aax_free_meta(&handle->meta);
-   handle->meta = data.meta;
+   // only publish the job after it was added to the job group, so other
+   // threads never wait for a job group which has no pending job yet
+   _aaxJobPoolAdd(handle->buffer_pool, &buffer->aaxs_group, _bufAAXSThread,
+                  data);
+   _aaxAtomicPointerSwap((void**)&buffer->aaxs_pending, (void**)&data);
+
+   if (async) rv = true;
+   else rv = _bufAAXSWait(buffer);
 
-   if (data.error)
+   return rv;
+}
+
+/*
+ * Wait for the AAXS generation of this buffer and collect the results.
+ * Every caller waits for the job group of the buffer, only the caller which
+ * claims the pending job collects the results and releases it.
+ */
+static bool
+_bufAAXSWait(_buffer_t* buffer)
+{
+   _handle_t *handle = buffer->root;
+   _buffer_aax_t *data = NULL;
+   bool rv;
+
+   rv = _aaxJobPoolWait(handle->buffer_pool, &buffer->aaxs_group);
+
+   _aaxAtomicPointerSwap((void**)&buffer->aaxs_pending, (void**)&data);
+   if (data)
    {
-      _aaxErrorSet(data.error);
-      rv = false;
+      _aax_free_meta(&handle->meta);
+      handle->meta = data->meta;
+
+      if (data->error)
+      {
+         _aaxErrorSet(data->error);
+         rv = false;
+      }
+      free(data);
    }
 
    return rv;
@@ -2441,10 +3716,9 @@ _bufCreateAAXS(_buffer_t *handle, void **data, unsigned int samples)
 #endif
 
 static bool
-_bufProcessWaveform(aaxBuffer buffer, int track, float freq, float phase, float pitch, float staticity, float random, unsigned char pitch_level, int voices, float spread, enum aaxSourceType wtype, float ratio, enum aaxProcessingType ptype, limitType limiter, float version)
+_bufProcessWaveform(_buffer_t* handle, int track, float freq, float phase, float pitch, float staticity, float random, unsigned char pitch_level, int voices, float spread, enum aaxSourceType wtype, float ratio, enum aaxProcessingType ptype, limitType limiter, float version)
 {
    enum aaxSourceType wave = wtype & (AAX_ALL_SOURCE_MASK & ~AAX_PURE_WAVEFORM);
-   _buffer_t* handle = get_buffer(buffer, __func__);
    bool rv = __release_mode;
 
    if (!rv)
@@ -2474,6 +3748,9 @@ _bufProcessWaveform(aaxBuffer buffer, int track, float freq, float phase, float
       bool modulate;
       bool phasing;
 
+      // waveforms are mixed into uncompressed sample data
+      rb->set_parami(rb, RB_COMPRESSED, false);
+
       fs = rb->get_paramf(rb, RB_FREQUENCY);
       fs_mixer = _info->frequency;
       if (handle->mixer_info && *handle->mixer_info) {
@@ -2570,6 +3847,70 @@ _bufProcessWaveform(aaxBuffer buffer, int track, float freq, float phase, float
    return rv;
 }
 
+/*
+ * The live voice equivalent of _bufProcessWaveform: add one oscillator for
+ * every voice instead of mixing the waveform into the ringbuffer.
+ */
+static bool
+_bufSynthAddWaveform(_aaxSynthVoice *synth, float freq, float phase, float pitch, int voices, float spread, enum aaxSourceType wtype, float ratio, enum aaxProcessingType ptype, float version)
+{
+   enum aaxSourceType wave = wtype & (AAX_ALL_SOURCE_MASK & ~AAX_PURE_WAVEFORM);
+   float fw, pre_gain = 1.0f;
+   bool modulate = false;
+   bool phasing;
+   int q, hvoices;
+
+   if (wave < AAX_1ST_WAVE || wave > AAX_LAST_WAVE) return false;
+   if ((ptype == AAX_MIX) && (ratio > 1.0f || ratio < -1.0f)) return false;
+
+   hvoices = voices >> 1;
+   voices |= 0x1;
+   if (synth->no_oscillators + voices > MAX_SYNTH_OSCILLATORS) return false;
+
+   fw = FNMINMAX(freq * pitch, 1.0f, 22050.0f);
+   phase *= GMATH_PI;
+
+   switch (ptype)
+   {
+   case AAX_OVERWRITE:
+      pre_gain = 0.0f;
+      break;
+   case AAX_MIX:
+      pre_gain = FNMINMAX(1.0f-ratio, 0.0f, 1.0f);
+      ratio = (1.0f - pre_gain);
+      break;
+   case AAX_RINGMODULATE:
+      modulate = true;
+      break;
+   case AAX_ADD:
+   default:
+      break;
+   }
+
+   phasing = (spread < 0.0f) ? true : false;
+   spread = fabsf(spread);
+   for (q=0; q<voices; ++q)
+   {
+      _aaxSynthOscillator *osc = &synth->osc[synth->no_oscillators++];
+      float nfw, nphase;
+
+      nfw = (fw - hvoices*spread);
+      if (phasing) nfw += (float)q*spread;
+      nphase = fmodf(phase + q*GMATH_2PI/voices, GMATH_2PI);
+      if (nphase < 0.0f) nphase += GMATH_2PI;
+
+      osc->wtype = wtype;
+      osc->freq_fact = nfw/synth->frequency;
+      osc->phase = nphase;
+      osc->gain = (q == hvoices) ? 0.8f*ratio : 0.6f*ratio;
+      osc->pre_gain = (q == 0) ? pre_gain : 1.0f;
+      osc->modulate = modulate;
+      osc->v0 = (version <= 1.0f) ? true : false;
+   }
+
+   return true;
+}
+
 /*
  * Convert the buffer to 24-bit
  */
@@ -3103,6 +4444,8 @@ _bufGetDataPitchLevels(_buffer_t *handle)
    if (handle->mip_levels <= 1) return data;
    if (format != AAX_PCM24S && format != AAX_FLOAT) return data;
    if (rb->get_parami(rb, RB_FORMAT) != AAX_PCM24S) return data;
+
+   _bufLazyFinish(handle);
    /**
     * format:
     * 1. an array of offsets to the nth buffer followd by a value of zero.
@@ -3252,9 +4595,9 @@ _bufGetDataInterleaved(_aaxRingBuffer *rb, void* data, unsigned int samples, uns
 }
 
 static void
-_bufApplyBitCrusherFilter(_buffer_t* handle, _filter_t *filter, int layer)
+_bufApplyBitCrusherFilter(_buffer_t* handle, _filter_t *filter, unsigned char mip, int layer)
 {
-   _aaxRingBuffer* rb = _bufGetRingBuffer(handle, NULL, 0);
+   _aaxRingBuffer* rb = _bufGetRingBuffer(handle, NULL, mip);
    int32_t **sbuf = (int32_t**)rb->get_tracks_ptr(rb, RB_RW);
    _aaxFilterInfo* slot = filter->slot[0];
    float ratio = slot->param[AAX_NOISE_LEVEL];
@@ -3289,9 +4632,9 @@ _bufApplyBitCrusherFilter(_buffer_t* handle, _filter_t *filter, int layer)
 
 
 static void
-_bufApplyFrequencyFilter(_buffer_t* handle, _filter_t *filter, int layer)
+_bufApplyFrequencyFilter(_buffer_t* handle, _filter_t *filter, unsigned char mip, int layer)
 {
-   _aaxRingBuffer* rb = _bufGetRingBuffer(handle, NULL, 0);
+   _aaxRingBuffer* rb = _bufGetRingBuffer(handle, NULL, mip);
    _aaxRingBufferData *rbi = rb->handle;
    _aaxRingBufferSample *rbd = rbi->sample;
    unsigned int bps, no_samples;
@@ -3332,9 +4675,9 @@ _bufApplyFrequencyFilter(_buffer_t* handle, _filter_t *filter, int layer)
 }
 
 static void
-_bufApplyEqualizer(_buffer_t* handle, _filter_t *filter, int layer)
+_bufApplyEqualizer(_buffer_t* handle, _filter_t *filter, unsigned char mip, int layer)
 {
-   _aaxRingBuffer* rb = _bufGetRingBuffer(handle, NULL, 0);
+   _aaxRingBuffer* rb = _bufGetRingBuffer(handle, NULL, mip);
    _aaxRingBufferData *rbi = rb->handle;
    _aaxRingBufferSample *rbd = rbi->sample;
    unsigned int bps, no_samples;
@@ -3372,9 +4715,9 @@ _bufApplyEqualizer(_buffer_t* handle, _filter_t *filter, int layer)
 }
 
 static void
-_bufApplyDistortionEffect(_buffer_t* handle, _effect_t *effect, int layer)
+_bufApplyDistortionEffect(_buffer_t* handle, _effect_t *effect, unsigned char mip, int layer)
 {
-   _aaxRingBuffer* rb = _bufGetRingBuffer(handle, NULL, 0);
+   _aaxRingBuffer* rb = _bufGetRingBuffer(handle, NULL, mip);
    int32_t **sbuf = (int32_t**)rb->get_tracks_ptr(rb, RB_RW);
    _aaxRingBufferData *rbi = rb->handle;
    _aaxRingBufferSample *rbd = rbi->sample;
@@ -3420,10 +4763,10 @@ _bufApplyDistortionEffect(_buffer_t* handle, _effect_t *effect, int layer)
 }
 
 static void
-_bufApplyWaveFoldEffect(_buffer_t* handle, _effect_t *effect, int layer)
+_bufApplyWaveFoldEffect(_buffer_t* handle, _effect_t *effect, unsigned char mip, int layer)
 {
    _aaxRingBufferWaveFoldData *wavefold = effect->slot[0]->data;
-   _aaxRingBuffer* rb = _bufGetRingBuffer(handle, NULL, 0);
+   _aaxRingBuffer* rb = _bufGetRingBuffer(handle, NULL, mip);
    _aaxRingBufferData *rbi = rb->handle;
    _aaxRingBufferSample *rbd = rbi->sample;
    MIX_T *dptr = rbd->track[layer];
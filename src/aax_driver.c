@@ -41,7 +41,7 @@
 static _intBuffers* get_backends();
 static _handle_t* _open_handle(aaxConfig);
 static _aaxConfig* _aaxReadConfig(_handle_t*, const char*, int, char);
-static void _aaxSetupHRTFfromXML(xmlId*, unsigned int);
+static void* _aaxSetupHRTFfromXML(xmlId*, unsigned int);
 static void _aaxSetupSpeakersFromXML(char **, unsigned char *router, unsigned int);
 static void _aaxFreeSensor(void *);
 
@@ -551,8 +551,10 @@ aaxDriverDestroy(aaxConfig config)
 
       _intBufErase(&handle->sensors, _AAX_SENSOR, _aaxFreeSensor);
 
-      if (handle->buffer_thread.ptr) {
-         _aaxThreadDestroy(handle->buffer_thread.ptr);
+      if (handle->buffer_pool)
+      {
+         _aaxJobPoolDestroy(handle->buffer_pool);
+         handle->buffer_pool = NULL;
       }
 
       if (handle->buffer) {
@@ -578,6 +580,9 @@ aaxDriverDestroy(aaxConfig config)
       if (handle->ringbuffer) {
          _aaxRingBufferFree(handle->ringbuffer);
       }
+      if (handle->hrir) {
+         _aaxRingBufferHRIRUnload(handle->hrir);
+      }
 
       free(handle->data_dir);
 
@@ -1072,6 +1077,7 @@ _open_handle(aaxConfig config)
                _aaxAudioFrame* smixer;
 
                sensor->mutex = _aaxMutexCreate(NULL);
+               atomic_init(&sensor->metering, 0);
                _aaxSetEqualizer(sensor->filter, handle->info->frequency);
 
                size = sizeof(_sensor_t);
@@ -1355,8 +1361,13 @@ _aaxReadConfig(_handle_t *handle, const char *devname, int mode, char setup)
                _sensor_t* sensor = _intBufGetDataPtr(dptr);
                _aaxMixerInfo* info = sensor->mixer->info;
                unsigned int size;
+               void *hrir;
+
+               // only drop a previously loaded HRIR set after the new load
+               hrir = _aaxSetupHRTFfromXML(config->node[0].hrtf, 0);
+               if (handle->hrir) _aaxRingBufferHRIRUnload(handle->hrir);
+               handle->hrir = hrir;
 
-               _aaxSetupHRTFfromXML(config->node[0].hrtf, 0);
                vec4fFill(info->hrtf[0].v4, _aaxDefaultHead[0]);
                vec4fFill(info->hrtf[1].v4, _aaxDefaultHead[1]);
 
@@ -1446,11 +1457,14 @@ _aaxReadConfig(_handle_t *handle, const char *devname, int mode, char setup)
    return config;
 }
 
-static void
+static void*
 _aaxSetupHRTFfromXML(xmlId *xid, UNUSED(unsigned int n))
 {
+   void *rv = NULL;
+
    if (xid)
    {
+      xmlId *xhid;
       float f = (float)xmlNodeGetDouble(xid, "gain");
       _aaxDefaultHead[HRTF_FACTOR][GAIN] = f;
 
@@ -1471,7 +1485,22 @@ _aaxSetupHRTFfromXML(xmlId *xid, UNUSED(unsigned int n))
 
       f = (float)xmlNodeGetDouble(xid, "forward-offset-sec");
       _aaxDefaultHead[HRTF_OFFSET][DIR_BACK] = f;
+
+      /* measured HRIR set, converted from SOFA */
+      xhid = xmlNodeGet(xid, "hrir");
+      if (xhid)
+      {
+         char *file = xmlGetString(xhid);
+         bool bilinear;
+
+         bilinear = !xmlAttributeCompareString(xhid, "interpolation",
+                                                     "bilinear");
+         rv = _aaxRingBufferHRIRLoad(file, bilinear);
+         xmlFree(file);
+         xmlFree(xhid);
+      }
    }
+   return rv;
 }
 
 static void
@@ -28,6 +28,8 @@
 #include <dsp/filters.h>
 #include <dsp/effects.h>
 #include <dsp/lfo.h>
+#include <dsp/automation.h>
+#include <dsp/common.h>
 
 #include "api.h"
 #include "arch.h"
@@ -37,6 +39,8 @@ static void _aaxFreeEmitterBuffer(void *);
 static bool _emitterSetFilter(_emitter_t*, _filter_t*);
 static bool _emitterSetEffect(_emitter_t*, _effect_t*);
 static void _emitterSetPitch(const _aaxEmitter*, _aax2dProps *);
+static bool _emitterSetParamAt(_emitter_t*, int, float, int64_t, bool);
+static bool _emitterSetState(_emitter_t*, enum aaxState, int64_t);
 static bool _emitterCreateEFFromAAXS(struct aax_emitter_t*, struct aax_embuffer_t*);
 
 struct _arg_t {
@@ -64,6 +68,8 @@ aaxEmitterCreate()
       src = (_aaxEmitter*)((char*)ptr1 + sizeof(_emitter_t));
       handle->source = src;
       src->buffer_pos = UINT_MAX;
+      src->start_sample = -1;
+      src->stop_sample = -1;
 
       assert(((long int)ptr2 & MEMMASK) == 0);
       src->props2d = (_aax2dProps*)ptr2;
@@ -132,6 +138,7 @@ aaxEmitterDestroy(aaxEmitter emitter)
          for (i=0; i<MAX_STEREO_EFFECT; ++i) {
             _EFFECT_FREE2D_DATA(src, i);
          }
+         _automation_destroy(src->props2d->automation);
 
          _intBufErase(&src->p3dq, _AAX_DELAYED3D, _aax_aligned_free);
          _aax3dPropsDestory(src->props3d);
@@ -219,17 +226,22 @@ aaxEmitterAddBuffer(aaxEmitter emitter, aaxBuffer buf)
          if (mip_level >= ep2d->mip_levels) {
             mip_level = ep2d->mip_levels-1;
          }
-         ep2d->mip_pitch_factor = 1.0f/(float)(1 << (mip_level));
       }
 
-      rb = buffer->ringbuffer[mip_level];
+      // a level which is not generated yet falls back to a lower level
+      rb = _bufGetMipLevel(buffer, &mip_level);
+      if (ep2d->mip_levels > 1) {
+         ep2d->mip_pitch_factor = 1.0f/(float)(1 << (mip_level));
+      }
       if (rb)
       {
          const _aaxEmitter *src = handle->source;
          _embuffer_t* embuf;
 
+         // live voices are band-limited at any pitch
+         mip_level = buffer->synth ? MAX_MIP_LEVELS : buffer->mip_levels;
          _EFFECT_SET(ep2d, PITCH_EFFECT, AAX_MAX_PITCH,
-                           _MAX(4.0f, (float)(1 << buffer->mip_levels)));
+                           _MAX(4.0f, (float)(1 << mip_level)));
          if (handle->looping >= 0) {
             rb->set_parami(rb, RB_LOOPING, handle->looping);
          }
@@ -376,6 +388,29 @@ AAX_API bool AAX_APIENTRY
 aaxEmitterSetState(aaxEmitter emitter, enum aaxState state)
 {
    _emitter_t* handle = get_emitter(emitter, _LOCK, __func__);
+   bool rv = _emitterSetState(handle, state, -1);
+   put_emitter(handle);
+   return rv;
+}
+
+AAX_API bool AAX_APIENTRY
+aaxEmitterSetStateAt(aaxEmitter emitter, enum aaxState state, int64_t sample_time)
+{
+   _emitter_t* handle = get_emitter(emitter, _LOCK, __func__);
+   bool rv = false;
+   if (state == AAX_PLAYING || state == AAX_STOPPED) {
+      rv = _emitterSetState(handle, state, _MAX(sample_time, 0));
+   } else {
+      _aaxErrorSet(AAX_INVALID_ENUM);
+   }
+   put_emitter(handle);
+   return rv;
+}
+
+/* sample_time < 0 changes the state now and cancels scheduled changes */
+static bool
+_emitterSetState(_emitter_t *handle, enum aaxState state, int64_t sample_time)
+{
    bool rv = false;
    if (handle)
    {
@@ -390,12 +425,14 @@ aaxEmitterSetState(aaxEmitter emitter, enum aaxState state)
             if (num)
             {
                src->buffer_pos = 0;
+               src->start_sample = sample_time;
                _SET_PLAYING(src->props3d);
             }
          }
          else if (_IS_PAUSED(src->props3d)) {
             _TAS_PAUSED(src->props3d, false);
          }
+         if (sample_time < 0) src->start_sample = -1;
          // intentional fallthrough
       case AAX_UPDATE:				/* update distance delay */
          if (handle->mixer_pos != UINT_MAX)	/* emitter is registered */
@@ -423,6 +460,14 @@ aaxEmitterSetState(aaxEmitter emitter, enum aaxState state)
          rv = true;
          break;
       case AAX_STOPPED:
+         if (sample_time >= 0)
+         {
+            src->stop_sample = sample_time;
+            rv = true;
+            break;
+         }
+         src->start_sample = -1;
+         src->stop_sample = -1;
          if (_IS_PLAYING(src->props3d))
          {
             if (!handle->sampled_release &&
@@ -451,6 +496,8 @@ aaxEmitterSetState(aaxEmitter emitter, enum aaxState state)
          rv = true;
          break;
       case AAX_PROCESSED:
+         src->start_sample = -1;
+         src->stop_sample = -1;
          if (!_IS_PROCESSED(src->props3d))
          {
             _SET_PLAYING(src->props3d); // In case rthe caller never did that
@@ -465,6 +512,8 @@ aaxEmitterSetState(aaxEmitter emitter, enum aaxState state)
 
          src->buffer_pos = 0;
          src->curr_pos_sec = 0.0f;
+         src->start_sample = -1;
+         src->stop_sample = -1;
 
          handle->mtx_set = false;
          dptr = _intBufGet(src->buffers, _AAX_EMITTER_BUFFER, 0);
@@ -497,7 +546,6 @@ aaxEmitterSetState(aaxEmitter emitter, enum aaxState state)
          _aaxErrorSet(AAX_INVALID_PARAMETER);
       }
    }
-   put_emitter(handle);
    return rv;
 }
 
@@ -611,6 +659,71 @@ aaxEmitterGetEffect(const aaxEmitter emitter, enum aaxEffectType type)
    return rv;
 }
 
+AAX_API bool AAX_APIENTRY
+aaxEmitterSetFilterParamAt(aaxEmitter emitter, enum aaxFilterType type, int param, int ptype, float value, int64_t sample_time, bool ramp)
+{
+   _emitter_t* handle = get_emitter(emitter, _LOCK, __func__);
+   bool rv = false;
+   if (handle)
+   {
+      _aax2dProps *p2d = handle->source->props2d;
+      int pos = -1;
+
+      if (type == AAX_VOLUME_FILTER && param == AAX_GAIN) {
+         pos = AUTOMATION_GAIN;
+      }
+      else if (type == AAX_FREQUENCY_FILTER && param == AAX_CUTOFF_FREQUENCY)
+      {
+         if (_FILTER_GET_DATA(p2d, FREQUENCY_FILTER)) {
+            pos = AUTOMATION_CUTOFF_FREQUENCY;
+         } else {
+            _aaxErrorSet(AAX_INVALID_STATE);
+         }
+      }
+      else {
+         _aaxErrorSet(AAX_INVALID_ENUM);
+      }
+
+      if (pos >= 0)
+      {
+         if (ptype == AAX_DECIBEL) value = _db2lin(value);
+         else if (ptype != AAX_LINEAR) pos = -1;
+
+         if (pos >= 0) {
+            rv = _emitterSetParamAt(handle, pos, value, sample_time, ramp);
+         } else {
+            _aaxErrorSet(AAX_INVALID_PARAMETER);
+         }
+      }
+   }
+   put_emitter(handle);
+   return rv;
+}
+
+AAX_API bool AAX_APIENTRY
+aaxEmitterSetEffectParamAt(aaxEmitter emitter, enum aaxEffectType type, int param, int ptype, float value, int64_t sample_time, bool ramp)
+{
+   _emitter_t* handle = get_emitter(emitter, _LOCK, __func__);
+   bool rv = false;
+   if (handle)
+   {
+      if (type == AAX_PITCH_EFFECT && param == AAX_PITCH)
+      {
+         if (ptype == AAX_LINEAR) {
+            rv = _emitterSetParamAt(handle, AUTOMATION_PITCH, value,
+                                    sample_time, ramp);
+         } else {
+            _aaxErrorSet(AAX_INVALID_PARAMETER);
+         }
+      }
+      else {
+         _aaxErrorSet(AAX_INVALID_ENUM);
+      }
+   }
+   put_emitter(handle);
+   return rv;
+}
+
 AAX_API bool AAX_APIENTRY
 aaxEmitterSetMode(aaxEmitter emitter, enum aaxModeType type, int mode)
 {
@@ -1552,6 +1665,56 @@ _emitterSetPitch(const _aaxEmitter *src, _aax2dProps *p2d)
    _EFFECT_SET(p2d, PITCH_EFFECT, AAX_PITCH_START, pitch);
 }
 
+/*
+ * Schedule a parameter change at a mixer sample time, see dsp/automation.h
+ * While gain automation is active the emitter gain is applied per sample
+ * to the source data instead of to the channel gain ramp.
+ */
+static bool
+_emitterSetParamAt(_emitter_t *handle, int pos, float value, int64_t time,
+                   bool ramp)
+{
+   _aax2dProps *p2d = handle->source->props2d;
+   _aaxAutomationData *automation = p2d->automation;
+   bool rv = false;
+
+   if (!automation) {
+      automation = p2d->automation = _automation_create();
+   }
+
+   if (automation)
+   {
+      _aaxAutomationQueue *q = &automation->param[pos];
+      float curr;
+
+      switch (pos)
+      {
+      case AUTOMATION_GAIN:
+         curr = _FILTER_GET(p2d, VOLUME_FILTER, AAX_GAIN);
+         break;
+      case AUTOMATION_PITCH:
+         curr = _EFFECT_GET(p2d, PITCH_EFFECT, AAX_PITCH);
+         break;
+      case AUTOMATION_CUTOFF_FREQUENCY:
+         curr = _FILTER_GET(p2d, FREQUENCY_FILTER, AAX_CUTOFF_FREQUENCY);
+         break;
+      default:
+         curr = value;
+         break;
+      }
+
+      rv = _automation_add(q, time, value, ramp, curr);
+      if (!rv) {
+         _aaxErrorSet(AAX_INSUFFICIENT_RESOURCES);
+      }
+   }
+   else {
+      _aaxErrorSet(AAX_INSUFFICIENT_RESOURCES);
+   }
+
+   return rv;
+}
+
 /*
  * Create filters and effects from audio file provided data like
  * envelope (timed-gain filter), tremolo and vibrato.
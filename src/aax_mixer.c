@@ -200,6 +200,27 @@ aaxMixerSetSetup(aaxConfig config, enum aaxSetupType type, int64_t setup)
                break;
             }
             break;
+         case AAX_LIMITER_LOOKAHEAD:
+            if (setup == 0)
+            {
+               info->lookahead = 0.0f;
+               rv = true;
+            }
+            else if (setup >= 1000 && setup <= 5000)
+            {
+               info->lookahead = setup*1e-6f;
+               rv = true;
+            }
+            else _aaxErrorSet(AAX_INVALID_PARAMETER);
+            break;
+         case AAX_AMBISONICS_ORDER:
+            if (setup >= 0 && setup <= _AAX_MAX_AMBISONICS_ORDER)
+            {
+               info->ambisonics_order = setup;
+               rv = true;
+            }
+            else _aaxErrorSet(AAX_INVALID_PARAMETER);
+            break;
          default:
             _aaxErrorSet(AAX_INVALID_ENUM);
             break;
@@ -357,6 +378,15 @@ aaxMixerGetSetup(const aaxConfig config, enum aaxSetupType type)
                break;
             }
          }
+         else if (type == AAX_LIMITER_LOOKAHEAD) {
+            rv = (int64_t)rintf(handle->info->lookahead*1e6f);
+         }
+         else if (type == AAX_AMBISONICS_ORDER) {
+            rv = handle->info->ambisonics_order;
+         }
+         else if (type == AAX_SAMPLE_CLOCK) {
+            rv = atomic_load(&handle->info->curr_sample);
+         }
          else if (type & AAX_SHARED_MODE)
          {
             if (handle->backend.driver)
@@ -455,6 +485,7 @@ aaxMixerGetSetup(const aaxConfig config, enum aaxSetupType type)
                   if (dptr)
                   {
                      _sensor_t* sensor = _intBufGetDataPtr(dptr);
+                     atomic_store(&sensor->metering, METER_HOLD_PERIODS);
                      if (type & AAX_PEAK_VALUE) {
                         rv = sensor->peak[track][band];
                      } else if (type & AAX_AVERAGE_VALUE) {
@@ -545,6 +545,7 @@ aaxSensorGetSetup(aaxConfig config, enum aaxSetupType type)
          default:
             if (track < AAX_TRACK_MAX && band < AAX_MAX_BANDS)
             {
+               atomic_store(&sensor->metering, METER_HOLD_PERIODS);
                if (type & AAX_PEAK_VALUE) {
                   rv = sensor->peak[track][band];
                } else if (type & AAX_AVERAGE_VALUE) {
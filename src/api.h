@@ -21,6 +21,7 @@ extern "C" {
 #include <aax/aax.h>
 
 #include <base/xthreads.h>
+#include <base/jobpool.h>
 #include <base/gmath.h>
 
 #include "ringbuffer.h"
@@ -61,6 +62,9 @@ unsigned long long _aax_get_free_memory(void);
 /* --- Sensor --- */
 #define CAPTURE_ID	0x8FB82DEF
 
+/* keep metering the bands this many periods after the last request */
+#define METER_HOLD_PERIODS	64
+
 typedef struct
 {
    _aaxAudioFrame *mixer;
@@ -69,6 +73,7 @@ typedef struct
    _aaxRingBufferFreqFilterData *filter[2];
    float rms[RB_MAX_TRACKS][_AAX_MAX_EQBANDS];
    float peak[RB_MAX_TRACKS][_AAX_MAX_EQBANDS];
+   atomic_int metering;	/* periods left to meter the bands */
    void *mutex;
 
 } _sensor_t;
@@ -158,6 +163,7 @@ typedef struct aax_handle_t
    /* destination ringbuffer */
    _aaxRingBuffer *ringbuffer;
    float dt_ms;
+   void *hrir;			/* the measured HRIR set loaded by this handle */
 
    /* timing */
    _aaxTimer *timer;
@@ -166,8 +172,8 @@ typedef struct aax_handle_t
    /* buffer for AAXS defined filters and effects */
    aaxBuffer buffer;
 
-   /* emitter thread for AAXS defined waveform generation */
-   struct threat_t buffer_thread;
+   /* job pool for AAXS defined waveform generation */
+   _aaxJobPool *buffer_pool;
 
 } _handle_t;
 
@@ -301,6 +307,8 @@ typedef struct aax_buffer_t
    enum aaxCapabilities midi_mode;
    bool to_mixer;
    bool mipmap;
+   bool synth;		/* live voice: generated by the mixer */
+   bool compressed;	/* sample data is decoded by the mixer */
 
    char mip_levels;
    _aaxRingBuffer *ringbuffer[MAX_MIP_LEVELS];
@@ -310,9 +318,16 @@ typedef struct aax_buffer_t
    void *aaxs;
    void *url;
 
+   /* pending asynchronous AAXS waveform generation */
+   struct _buffer_aax_s *aaxs_pending;
+   _aaxJobGroup aaxs_group;
+
+   /* AAXS mip levels which are generated on first use */
+   struct _buffer_lazy_s *lazy;
+
 } _buffer_t;
 
-typedef struct
+typedef struct _buffer_aax_s
 {
    _buffer_t* parent;
    const void *aaxs;
@@ -320,6 +335,7 @@ typedef struct
    enum aaxErrorType error;
 
    struct _meta_t meta;
+   uint32_t hash[4];		/* of the <sound> section, for caching */
 
 } _buffer_aax_t;
 
@@ -328,6 +344,7 @@ _buffer_t* get_buffer(aaxBuffer, const char*);
 int free_buffer(_buffer_t*);
 
 int _getMaxMipLevels(int);
+_aaxRingBuffer* _bufGetMipLevel(_buffer_t*, int*);
 char** _bufGetDataFromStream(_handle_t*, const char*, _buffer_info_t*, _aaxMixerInfo*);
 void _aaxFileDriverWrite(const char*, enum aaxProcessingType, void*, size_t, size_t, char, enum aaxFormat);
 
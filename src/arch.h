@@ -53,9 +53,11 @@ typedef void (*_batch_dsp_1param_proc)(float32_ptr, const_float32_ptr, size_t, f
 typedef void (*_batch_ema_proc)(int32_ptr, const_int32_ptr, size_t, float*, float);
 typedef void (*_batch_ema_float_proc)(float32_ptr, const_float32_ptr, size_t, float*, float);
 typedef void (*_batch_freqfilter_float_proc)(float32_ptr, const_float32_ptr, int, size_t, void*);
+typedef void (*_batch_freqfilter_bank_proc)(float32_ptr, const_float32_ptr, int, size_t, void*, bool);
 typedef void (*_batch_convolution_proc)(float32_ptr, const_float32_ptr, const_float32_ptr, unsigned int, unsigned int, int, float, float);
 
 typedef void (*_batch_resample_float_proc)(float32_ptr, const_float32_ptr, size_t, size_t, float, float);
+typedef void (*_batch_resample_ramp_float_proc)(float32_ptr, const_float32_ptr, size_t, size_t, float, float, float);
 typedef void (*_batch_resample_proc)(int32_ptr, const_int32_ptr, size_t, size_t, float, float);
 
 typedef void (*_batch_get_average_rms_proc)(const_float32_ptr, size_t, float32_ptr, float32_ptr);
@@ -79,8 +81,10 @@ extern _batch_dsp_1param_proc _batch_dc_shift;
 extern _batch_dsp_1param_proc _batch_wavefold;
 extern _batch_ema_float_proc _batch_movingaverage_float;
 extern _batch_freqfilter_float_proc _batch_freqfilter_float;
+extern _batch_freqfilter_bank_proc _batch_freqfilter_bank;
 extern _batch_resample_proc _batch_resample;
 extern _batch_resample_float_proc _batch_resample_float;
+extern _batch_resample_ramp_float_proc _batch_resample_ramp_float;
 extern _batch_convolution_proc _batch_convolution;
 
 extern _batch_get_average_rms_proc _batch_get_average_rms;
@@ -130,6 +134,7 @@ extern _batch_cvt_to_proc _batch_cvt24_24;
 extern _batch_cvt_to_proc _batch_roundps;
 extern _batch_cvt_to_proc _batch_atanps;
 extern _batch_cvt_to_proc _batch_limit;
+extern _batch_cvt_to_proc _batch_get_truepeak;
 extern _batch_cvt_to_intl_proc _batch_cvt8_intl_24;
 extern _batch_cvt_to_intl_proc _batch_cvt16_intl_24;
 extern _batch_cvt_to_intl_proc _batch_cvt24_3intl_24;
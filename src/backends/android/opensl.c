@@ -100,7 +100,8 @@ const _aaxDriverBackend _aaxSLESDriverBackend =
 
    (_aaxDriverState *)&_aaxSLESDriverState,
    (_aaxDriverParam *)&_aaxSLESDriverParam,
-   (_aaxDriverLog *)&_aaxSLESDriverLog
+   (_aaxDriverLog *)&_aaxSLESDriverLog,
+   NULL
 };
 
 typedef struct
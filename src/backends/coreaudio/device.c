@@ -98,7 +98,8 @@ const _aaxDriverBackend _aaxCoreAudioDriverBackend =
 
    (_aaxDriverState *)&_aaxCoreAudioDriverState,
    (_aaxDriverParam *)&_aaxCoreAudioDriverParam,
-   (_aaxDriverLog *)&_aaxCoreAudioDriverLog
+   (_aaxDriverLog *)&_aaxCoreAudioDriverLog,
+   NULL
 };
 
 
@@ -38,6 +38,8 @@ extern "C" {
 #define _AAX_MIN_MIXER_REFRESH_RATE	1.0f
 #define _AAX_MAX_BACKENDS		7
 #define _AAX_MAX_SPEAKERS		8
+#define _AAX_MAX_AMBISONICS_ORDER	3
+#define _AAX_MAX_AMBISONICS_CHANNELS	16	/* (order+1)^2 */
 
 
 #include <xml.h>
@@ -100,6 +102,7 @@ enum _aaxDriverParam {
    DRIVER_SAMPLED_RELEASE,
    DRIVER_FAST_RELEASE,
    DRIVER_ENVELOPE_SUSTAIN,
+   DRIVER_MIXER_FORMAT,	/* capture returns MIX_T data instead of int32_t */
 
    /* envelopes */
    DRIVER_ENVELOPE_LEVEL     = 0x2000,
@@ -134,6 +137,7 @@ typedef char *_aaxDriverGetName(const void*, int);
 typedef int _aaxDriverSetName(const void*, int, const char*);
 typedef int _aaxDriverState(const void*, enum _aaxDriverState);
 typedef float _aaxDriverParam(const void*, enum _aaxDriverParam);
+typedef int _aaxDriverSetParam(const void*, enum _aaxDriverParam, float);
 typedef int _aaxDriverSetPosition(const void*, off_t);
 
 typedef char *_aaxDriverGetDevices(const void*, int mode);
@@ -195,6 +199,8 @@ typedef struct
     _aaxDriverParam *param;
     _aaxDriverLog *log;
 
+    _aaxDriverSetParam *set_param;	/* optional */
+
 } _aaxDriverBackend;
 
 
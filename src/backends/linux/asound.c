@@ -115,7 +115,8 @@ const _aaxDriverBackend _aaxALSADriverBackend =
 
    (_aaxDriverState *)&_aaxALSADriverState,
    (_aaxDriverParam *)&_aaxALSADriverParam,
-   (_aaxDriverLog *)&_aaxALSADriverLog
+   (_aaxDriverLog *)&_aaxALSADriverLog,
+   NULL
 };
 
 typedef struct
@@ -135,7 +135,8 @@ const _aaxDriverBackend _aaxLinuxDriverBackend =
 
    (_aaxDriverState *)&_aaxLinuxDriverState,
    (_aaxDriverParam *)&_aaxLinuxDriverParam,
-   (_aaxDriverLog *)&_aaxLinuxDriverLog
+   (_aaxDriverLog *)&_aaxLinuxDriverLog,
+   NULL
 };
 
 typedef struct
@@ -127,7 +127,8 @@ const _aaxDriverBackend _aaxPipeWireDriverBackend =
 
    (_aaxDriverState *)&_aaxPipeWireDriverState,
    (_aaxDriverParam *)&_aaxPipeWireDriverParam,
-   (_aaxDriverLog *)&_aaxPipeWireDriverLog
+   (_aaxDriverLog *)&_aaxPipeWireDriverLog,
+   NULL
 };
 
 typedef struct
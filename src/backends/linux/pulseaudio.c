@@ -126,7 +126,8 @@ const _aaxDriverBackend _aaxPulseAudioDriverBackend =
 
    (_aaxDriverState *)&_aaxPulseAudioDriverState,
    (_aaxDriverParam *)&_aaxPulseAudioDriverParam,
-   (_aaxDriverLog *)&_aaxPulseAudioDriverLog
+   (_aaxDriverLog *)&_aaxPulseAudioDriverLog,
+   NULL
 };
 
 typedef struct
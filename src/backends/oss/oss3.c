@@ -127,7 +127,8 @@ const _aaxDriverBackend _aaxOSS3DriverBackend =
 
    (_aaxDriverState *)&_aaxOSS3DriverState,
    (_aaxDriverParam *)&_aaxOSS3DriverParam,
-   (_aaxDriverLog *)&_aaxOSS3DriverLog
+   (_aaxDriverLog *)&_aaxOSS3DriverLog,
+   NULL
 };
 
 typedef struct
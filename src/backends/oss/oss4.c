@@ -131,7 +131,8 @@ const _aaxDriverBackend _aaxOSS4DriverBackend =
 
    (_aaxDriverState *)&_aaxOSS4DriverState,
    (_aaxDriverParam *)&_aaxOSS4DriverParam,
-   (_aaxDriverLog *)&_aaxOSS4DriverLog
+   (_aaxDriverLog *)&_aaxOSS4DriverLog,
+   NULL
 };
 
 typedef struct
@@ -121,7 +121,8 @@ const _aaxDriverBackend _aaxSDLDriverBackend =
 
    (_aaxDriverState *)&_aaxSDLDriverState,
    (_aaxDriverParam *)&_aaxSDLDriverParam,
-   (_aaxDriverLog *)&_aaxSDLDriverLog
+   (_aaxDriverLog *)&_aaxSDLDriverLog,
+   NULL
 };
 
 typedef struct
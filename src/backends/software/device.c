@@ -91,7 +91,8 @@ const _aaxDriverBackend _aaxNoneDriverBackend =
 
    (_aaxDriverState *)_aaxNoneDriverState,
    (_aaxDriverParam *)&_aaxNoneDriverParam,
-   (_aaxDriverLog *)&_aaxNoneDriverLog
+   (_aaxDriverLog *)&_aaxNoneDriverLog,
+   NULL
 };
 
 
@@ -159,7 +160,8 @@ const _aaxDriverBackend _aaxLoopbackDriverBackend =
 
    (_aaxDriverState *)_aaxNoneDriverState,
    (_aaxDriverParam *)&_aaxLoopbackDriverParam,
-   (_aaxDriverLog *)&_aaxLoopbackDriverLog
+   (_aaxDriverLog *)&_aaxLoopbackDriverLog,
+   NULL
 };
 
 static int
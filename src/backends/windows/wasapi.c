@@ -121,7 +121,8 @@ const _aaxDriverBackend _aaxWASAPIDriverBackend =
 
    (_aaxDriverState *)&_aaxWASAPIDriverState,
    (_aaxDriverParam *)&_aaxWASAPIDriverParam,
-   (_aaxDriverLog *)&_aaxWASAPIDriverLog
+   (_aaxDriverLog *)&_aaxWASAPIDriverLog,
+   NULL
 };
 
 typedef struct
@@ -0,0 +1,290 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2005-2023 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2009-2023 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_RMALLOC_H
+# include <rmalloc.h>
+#else
+# include <stdlib.h>
+# include <string.h>
+#endif
+#include <assert.h>
+#include <math.h>
+
+#include <base/types.h>
+#include <arch.h>
+
+#include "filters.h"
+#include "effects.h"
+#include "api.h"
+#include "automation.h"
+
+_aaxAutomationData*
+_automation_create()
+{
+   return calloc(1, sizeof(_aaxAutomationData));
+}
+
+void
+_automation_destroy(void *data)
+{
+   free(data);
+}
+
+/*
+ * Insert an event in time order. Events with the same sample time are
+ * processed in the order they were added.
+ * value is the current parameter value which is used as the start value
+ * of a queue which isn't active yet.
+ */
+bool
+_automation_add(_aaxAutomationQueue *q, int64_t time, float value, bool ramp,
+                float curr)
+{
+   bool rv = false;
+
+   assert(q);
+
+   if (q->no_events < _AAX_MAX_AUTOMATION_EVENTS)
+   {
+      unsigned int i = q->no_events;
+
+      if (!q->active)
+      {
+         q->time = -1;
+         q->value = curr;
+         q->next = curr;
+         q->active = true;
+      }
+
+      while (i && q->event[i-1].time > time)
+      {
+         q->event[i] = q->event[i-1];
+         --i;
+      }
+      q->event[i].time = time;
+      q->event[i].value = value;
+      q->event[i].ramp = ramp;
+      q->no_events++;
+      rv = true;
+   }
+
+   return rv;
+}
+
+/* value at sample time t, without consuming any events */
+float
+_automation_get(const _aaxAutomationQueue *q, int64_t t)
+{
+   int64_t time = (q->time < 0) ? t : q->time;
+   float rv = q->value;
+   unsigned int i;
+
+   for (i=0; i<q->no_events; ++i)
+   {
+      const _aaxAutomationEvent *ev = &q->event[i];
+      if (ev->time > t)
+      {
+         if (ev->ramp && ev->time > time) {
+            rv += (ev->value - rv)*(float)(t - time)/(float)(ev->time - time);
+         }
+         break;
+      }
+      rv = ev->value;
+      time = ev->time;
+   }
+
+   return rv;
+}
+
+/* _batch_fmul_value leaves the data untouched for very small factors */
+static inline void
+_automation_fmul(float *d, size_t num, float f)
+{
+   if (fabsf(f) >= LEVEL_90DB) {
+      _batch_fmul_value(d, d, num, f, 1.0f);
+   } else {
+      memset(d, 0, num*sizeof(float));
+   }
+}
+
+/*
+ * Multiply num samples starting at sample time t0 by the scheduled values,
+ * without consuming any events.
+ */
+void
+_automation_multiply(const _aaxAutomationQueue *q, float *d, int64_t t0,
+                     size_t num)
+{
+   int64_t time = (q->time < 0) ? t0 : q->time;
+   float value = q->value;
+   unsigned int e = 0;
+   size_t i = 0;
+
+   while (i < num)
+   {
+      const _aaxAutomationEvent *ev;
+      int64_t t = t0 + i;
+      size_t end;
+
+      while (e < q->no_events && q->event[e].time <= t)
+      {
+         value = q->event[e].value;
+         time = q->event[e].time;
+         e++;
+      }
+
+      if (e == q->no_events)
+      {
+         _automation_fmul(d+i, num-i, value);
+         break;
+      }
+
+      ev = &q->event[e];
+      end = (size_t)_MIN(ev->time - t0, (int64_t)num);
+      if (ev->ramp)
+      {
+         float step = (ev->value - value)/(float)(ev->time - time);
+         for (; i<end; ++i) {
+            d[i] *= value + step*(float)(t0 + i - time);
+         }
+      }
+      else
+      {
+         _automation_fmul(d+i, end-i, value);
+         i = end;
+      }
+   }
+}
+
+/*
+ * Consume all events up to and including sample time t.
+ * Returns false if there are no events left.
+ */
+bool
+_automation_advance(_aaxAutomationQueue *q, int64_t t)
+{
+   unsigned int i, n = 0;
+
+   if (q->time < 0) q->time = t;
+   while (n < q->no_events && q->event[n].time <= t)
+   {
+      q->value = q->event[n].value;
+      q->time = q->event[n].time;
+      n++;
+   }
+
+   if (n)
+   {
+      q->no_events -= n;
+      for (i=0; i<q->no_events; ++i) {
+         q->event[i] = q->event[i+n];
+      }
+   }
+
+   return q->no_events ? true : false;
+}
+
+/*
+ * Called by the renderer before the emitter is mixed for the period which
+ * starts at sample time t0 and lasts num samples.
+ * Pitch is resolved at period level where the resampler ramps the change,
+ * the cutoff frequency is swept towards next by the frequency filter.
+ */
+void
+_automation_prepare(struct _aax2dProps_s *p2d, int64_t t0, size_t num)
+{
+   _aaxAutomationData *automation = p2d->automation;
+   _aaxAutomationQueue *q;
+   int i;
+
+   if (!automation) return;
+
+   /*
+    * From now on the emitter gain is applied to the source data instead of
+    * to the channel gains, remove it from the previous channel gains.
+    */
+   q = &automation->param[AUTOMATION_GAIN];
+   if (q->active && q->time < 0)
+   {
+      float gain = _FILTER_GET(p2d, VOLUME_FILTER, AAX_GAIN);
+      float fact = (gain > LEVEL_128DB) ? 1.0f/gain : 0.0f;
+
+      for (i=0; i<_AAX_MAX_SPEAKERS; ++i) {
+         p2d->prev_gain[i] *= fact;
+      }
+   }
+
+   for (i=0; i<AUTOMATION_MAX; ++i)
+   {
+      q = &automation->param[i];
+      if (q->active)
+      {
+         if (q->time < 0) q->time = t0;
+         q->next = _automation_get(q, t0 + num);
+      }
+   }
+
+   if (automation->param[AUTOMATION_PITCH].active) {
+      _EFFECT_SET(p2d, PITCH_EFFECT, AAX_PITCH,
+                  automation->param[AUTOMATION_PITCH].next);
+   }
+}
+
+/* sample accurate emitter gain, replaces the volume filter gain */
+void
+_automation_apply_gain(const struct _aax2dProps_s *p2d, float *d, int64_t t0,
+                       size_t num)
+{
+   _aaxAutomationData *automation = p2d->automation;
+   if (automation && automation->param[AUTOMATION_GAIN].active) {
+      _automation_multiply(&automation->param[AUTOMATION_GAIN], d, t0, num);
+   }
+}
+
+/*
+ * Consume the events of the rendered period. When a queue runs empty the
+ * final value is stored as the regular parameter value again.
+ */
+void
+_automation_finish(struct _aax2dProps_s *p2d, int64_t t_end)
+{
+   _aaxAutomationData *automation = p2d->automation;
+   _aaxAutomationQueue *q;
+   int i;
+
+   if (!automation) return;
+
+   q = &automation->param[AUTOMATION_GAIN];
+   if (q->active && !_automation_advance(q, t_end))
+   {
+      q->active = false;
+      _FILTER_SET(p2d, VOLUME_FILTER, AAX_GAIN, q->value);
+      for (i=0; i<_AAX_MAX_SPEAKERS; ++i) {
+         p2d->prev_gain[i] *= q->value;
+      }
+   }
+
+   q = &automation->param[AUTOMATION_PITCH];
+   if (q->active && !_automation_advance(q, t_end))
+   {
+      q->active = false;
+      _EFFECT_SET(p2d, PITCH_EFFECT, AAX_PITCH, q->value);
+   }
+
+   q = &automation->param[AUTOMATION_CUTOFF_FREQUENCY];
+   if (q->active && !_automation_advance(q, t_end))
+   {
+      q->active = false;
+      _FILTER_SET(p2d, FREQUENCY_FILTER, AAX_CUTOFF_FREQUENCY, q->value);
+   }
+}
@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2005-2023 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2009-2023 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#ifndef _AAX_FE_AUTOMATION_H
+#define _AAX_FE_AUTOMATION_H 1
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define _AAX_MAX_AUTOMATION_EVENTS	32
+
+enum
+{
+   AUTOMATION_GAIN = 0,
+   AUTOMATION_PITCH,
+   AUTOMATION_CUTOFF_FREQUENCY,
+
+   AUTOMATION_MAX
+};
+
+/*
+ * Scheduled parameter changes against the mixer sample clock.
+ *
+ * A step changes the value at the sample time of the event. A ramp changes
+ * the value linearly, starting at the previous event (or when the queue was
+ * started), and reaches the value of the event at its sample time.
+ */
+typedef struct
+{
+   int64_t time;
+   float value;
+   bool ramp;
+} _aaxAutomationEvent;
+
+typedef struct
+{
+   _aaxAutomationEvent event[_AAX_MAX_AUTOMATION_EVENTS];
+   unsigned int no_events;
+
+   int64_t time;	/* sample time of value, < 0 when not yet started */
+   float value;		/* value of the last processed event */
+   float next;		/* value at the end of the current period */
+   bool active;
+} _aaxAutomationQueue;
+
+typedef struct
+{
+   _aaxAutomationQueue param[AUTOMATION_MAX];
+} _aaxAutomationData;
+
+#define _AUTOMATION_ACTIVE(a, p) \
+   ((a) && ((_aaxAutomationData*)(a))->param[p].active)
+
+struct _aax2dProps_s;
+
+_aaxAutomationData* _automation_create(void);
+void _automation_destroy(void*);
+
+bool _automation_add(_aaxAutomationQueue*, int64_t, float, bool, float);
+float _automation_get(const _aaxAutomationQueue*, int64_t);
+void _automation_multiply(const _aaxAutomationQueue*, float*, int64_t, size_t);
+bool _automation_advance(_aaxAutomationQueue*, int64_t);
+
+void _automation_prepare(struct _aax2dProps_s*, int64_t, size_t);
+void _automation_apply_gain(const struct _aax2dProps_s*, float*, int64_t, size_t);
+void _automation_finish(struct _aax2dProps_s*, int64_t);
+
+#if defined(__cplusplus)
+}  /* extern "C" */
+#endif
+
+#endif /* _AAX_FE_AUTOMATION_H */
+
@@ -126,6 +126,7 @@ enum _aaxLimiterType
     RB_LIMITER_DIGITAL,
     RB_LIMITER_VALVE,
     RB_COMPRESS,
+    RB_LIMITER_TRUEPEAK,	/* lookahead true-peak limiter */
 
     RB_LIMITER_MAX
 };
@@ -33,6 +33,7 @@ void _aax_bessel_compute(float, void*);
 void _aax_butterworth_compute(float, void*);
 
 int _freqfilter_run(void*, MIX_PTR_T, CONST_MIX_PTR_T, size_t, size_t, size_t, unsigned int, void*, void*, float);
+int _freqfilter_sweep_run(void*, MIX_PTR_T, CONST_MIX_PTR_T, size_t, size_t, unsigned int, _aaxRingBufferFreqFilterData*, float);
 void _freqfilter_reset(void*);
 void _freqfilter_data_swap( _aaxRingBufferFreqFilterData*, _aaxRingBufferFreqFilterData*);
 void _freqfilter_destroy(void*);
@@ -41,7 +42,7 @@ void _freqfilter_normalize_gains(_aaxRingBufferFreqFilterData*);
 // equalizers
 void _equalizer_swap(void*, void*);
 int _equalizer_run(void*, MIX_PTR_T, MIX_PTR_T, size_t, size_t, unsigned int, _aaxRingBufferFreqFilterData*[_MAX_PARAM_EQ]);
-int _grapheq_run(void*, MIX_PTR_T, MIX_PTR_T, MIX_PTR_T, size_t, size_t, unsigned int, _aaxRingBufferEqualizerData*);
+int _grapheq_run(void*, MIX_PTR_T, CONST_MIX_PTR_T, size_t, size_t, unsigned int, _aaxRingBufferEqualizerData*, bool);
 
 // bitcrusher
 int _bitcrusher_run(MIX_PTR_T, size_t, size_t, void*, void*, unsigned int);
@@ -1055,22 +1055,12 @@ _delay_run(void *rb, MIX_PTR_T d, MIX_PTR_T s, MIX_PTR_T scratch,
          {
             float fact = lfo_fact/effect->lfo.max;
             float fc = flt->fc_low + fact*(flt->fc_high-flt->fc_low);
-            fc = CLIP_FREQUENCY(fc, flt->fs);
 
-            if (flt->resonance > 0.0f) {
-               if (flt->type > BANDPASS) { // HIGHPASS
-                  flt->Q = _MAX(flt->resonance*(flt->fc_high - fc), 1.0f);
-               } else {
-                  flt->Q = flt->resonance*fc;
-               }
-            }
-
-            if (flt->state == AAX_BESSEL) {
-               _aax_bessel_compute(fc, flt);
+            if (flt->lfo) {
+               flt->run(rbd, dptr, dptr, 0, no_samples, 0, track, flt, env, 1.0f);
             } else {
-               _aax_butterworth_compute(fc, flt);
+               _freqfilter_sweep_run(rbd, dptr, dptr, no_samples, 0, track, flt, fc);
             }
-            flt->run(rbd, dptr, dptr, 0, no_samples, 0, track, flt, env, 1.0f);
          }
       }
 
@@ -28,6 +28,8 @@
 #define DSIZE	sizeof(_aaxRingBufferDistoritonData)
 
 static int _distortion_run(void*, MIX_PTR_T, CONST_MIX_PTR_T, size_t, size_t, size_t, unsigned int, void*, void*);
+static void _distortion_destroy(void*);
+static void _distortion_swap(void*, void*);
 
 static aaxEffect
 _aaxDistortionEffectCreate(_aaxMixerInfo *info, enum aaxEffectType type)
@@ -38,6 +40,8 @@ _aaxDistortionEffectCreate(_aaxMixerInfo *info, enum aaxEffectType type)
    if (eff)
    {
       _aaxSetDefaultEffect2d(eff->slot[0], eff->pos, 0);
+      eff->slot[0]->destroy = _distortion_destroy;
+      eff->slot[0]->swap = _distortion_swap;
       rv = (aaxEffect)eff;
    }
    return rv;
@@ -123,13 +127,13 @@ _aaxDistortionEffectSetState(_effect_t* effect, int state)
             }
             else
             {
-               _aax_aligned_free(flt);
+               _freqfilter_destroy(flt);
                flt = NULL;
             }
          }
          else if (flt)
          {
-            _aax_aligned_free(flt);
+            _freqfilter_destroy(flt);
             flt = NULL;
          }
          data->freq_filter = flt;
@@ -235,6 +239,9 @@ _aaxNewDistortionEffectHandle(const aaxConfig config, enum aaxEffectType type, _
    if (rv)
    {
       _aax_dsp_copy(rv->slot[0], &p2d->effect[rv->pos]);
+      rv->slot[0]->destroy = _distortion_destroy;
+      rv->slot[0]->swap = _distortion_swap;
+
       rv->state = p2d->effect[rv->pos].state;
    }
    return rv;
@@ -306,6 +313,7 @@ _distortion_run(void *rb, MIX_PTR_T d, CONST_MIX_PTR_T s,
    int rv = false;
    size_t no_samples;
    float lfo_fact = 1.0;
+   float fc = 0.0f;
    CONST_MIX_PTR_T sptr;
    MIX_T *dptr;
 
@@ -329,24 +337,8 @@ _distortion_run(void *rb, MIX_PTR_T d, CONST_MIX_PTR_T s,
    if (lfo->state != AAX_CONSTANT)
    {
       lfo_fact = lfo->get(lfo, env, sptr, track, no_samples);
-      if (flt) // && !ctr
-      {
-         float fc = flt->fc_low + lfo_fact*(flt->fc_high-flt->fc_low);
-         fc = CLIP_FREQUENCY(fc, flt->fs);
-
-         if (flt->resonance > 0.0f) {
-            if (flt->type > BANDPASS) { // HIGHPASS
-                flt->Q = _MAX(flt->resonance*(flt->fc_high - fc), 1.0f);
-            } else {
-               flt->Q = flt->resonance*fc;
-            }
-         }
-
-         if (flt->state == AAX_BESSEL) {
-            _aax_bessel_compute(fc, flt);
-         } else {
-            _aax_butterworth_compute(fc, flt);
-         }
+      if (flt) { // && !ctr
+         fc = flt->fc_low + lfo_fact*(flt->fc_high-flt->fc_low);
       }
    }
    fact = params[AAX_DISTORTION_FACTOR]*lfo_fact;
@@ -360,7 +352,9 @@ _distortion_run(void *rb, MIX_PTR_T d, CONST_MIX_PTR_T s,
       _aax_memcpy(dptr, sptr, no_samples*bps);
 
       /* frequency filter first, if defined */
-      if (flt) {
+      if (flt && fc > 0.0f) {
+         _freqfilter_sweep_run(rbd, dptr, dptr, no_samples, 0, track, flt, fc);
+      } else if (flt) {
          flt->run(rbd, dptr, dptr, 0, no_samples, 0, track, flt, env, 1.0f);
       }
 
@@ -383,3 +377,44 @@ _distortion_run(void *rb, MIX_PTR_T d, CONST_MIX_PTR_T s,
    return rv;
 }
 
+static void
+_distortion_destroy(void *ptr)
+{
+   _aaxRingBufferDistoritonData *data = ptr;
+   if (data)
+   {
+      _freqfilter_destroy(data->freq_filter);
+      _aax_aligned_free(data);
+   }
+}
+
+static void
+_distortion_swap(void *d, void *s)
+{
+   _aaxEffectInfo *dst = d, *src = s;
+
+   if (src->data && src->data_size)
+   {
+      if (!dst->data)
+      {
+          _aaxAtomicPointerSwap(&src->data, &dst->data);
+          dst->data_size = src->data_size;
+      }
+      else
+      {
+         _aaxRingBufferDistoritonData *ddef = dst->data;
+         _aaxRingBufferDistoritonData *sdef = src->data;
+
+         assert(dst->data_size == src->data_size);
+
+         ddef->lfo = sdef->lfo;
+         ddef->run = sdef->run;
+
+         /* the old filter, and its sweep table, go with the source */
+         _aaxAtomicPointerSwap((void**)&sdef->freq_filter,
+                               (void**)&ddef->freq_filter);
+      }
+   }
+   dst->destroy = src->destroy;
+   dst->swap = src->swap;
+}
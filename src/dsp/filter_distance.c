@@ -440,6 +440,10 @@ _aaxSetupSpeakersFromDistanceVector(vec3f_ptr rpos, float dist_fact,
    float dp, offs, fact, gain;
    int i, t;
 
+   /* used by the Ambisonics encoder */
+   vec3fCopy(&ep2d->direction.v3, rpos);
+   ep2d->direction.v4[3] = dist_fact;
+
    switch (info->mode)
    {
    case AAX_MODE_WRITE_SPATIAL:
@@ -498,6 +502,13 @@ _aaxSetupSpeakersFromDistanceVector(vec3f_ptr rpos, float dist_fact,
             ep2d->hrtf[t].v4[i] = _MAX(offs + dp*fact, 0.0f);
          }
       }
+
+      /*
+       * Direction for the measured HRIR set, azimuth counter-clockwise
+       * from the front (left is positive) and elevation upwards.
+       */
+      ep2d->hrir_dir[0] = atan2f(-rpos->v3[0], rpos->v3[2]);
+      ep2d->hrir_dir[1] = asinf(_MINMAX(rpos->v3[1], -1.0f, 1.0f));
       break;
    case AAX_MODE_WRITE_SURROUND:
    case AAX_MODE_WRITE_STEREO:
@@ -534,6 +545,12 @@ _distance_prepare(_aax2dProps *ep2d, _aax3dProps *ep3d, _aaxDelayed3dProps *fdp3
       float dfact = _MIN(dist_ef/refdist, 1.0f);
       _aaxSetupSpeakersFromDistanceVector(epos, dfact, speaker, ep2d, info);
    }
+   else
+   {
+      /* keep the Ambisonics encoder direction up to date */
+      vec3fCopy(&ep2d->direction.v3, epos);
+      ep2d->direction.v4[3] = _MIN(dist_ef/refdist, 1.0f);
+   }
 
    data->dist = dist_ef;
    data->ref_dist = refdist;
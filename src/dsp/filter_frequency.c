@@ -362,6 +362,9 @@ _freqfilter_reset(void *data)
    if (flt->lfo) {
       _lfo_reset(flt->lfo);
    }
+   if (flt->freqfilter) {
+      memset(flt->freqfilter->sweep_fc, 0, sizeof(float[RB_MAX_TRACKS]));
+   }
 }
 
 void
@@ -415,6 +418,7 @@ _freqfilter_destroy(void *ptr)
    {
       _lfo_destroy(data->lfo);
       _aax_aligned_free(data->freqfilter);
+      free(data->table);
       _aax_aligned_free(data);
    }
 }
@@ -862,6 +866,244 @@ _aax_bessel_compute(float fc, float fs, float *coef, float *gain, float Q, int s
 }
 #endif
 
+/*
+ * Swept filters look up their coefficients in a table over the logarithmic
+ * cutoff frequency range instead of recomputing the cascade every period.
+ * Q is either constant or follows the cutoff frequency (resonance) so a
+ * single dimension suffices. The table is (re)built when the filter
+ * parameters differ from the ones it was built for.
+ */
+#define FILTER_TABLE_STEPS	24	/* entries per octave */
+#define FILTER_TABLE_COEFFS	(4*_AAX_MAX_STAGES+1)
+#define FILTER_SUBBLOCK		32	/* samples per coefficient update */
+
+typedef struct
+{
+   float fs, Q, resonance, fc_high;
+   float high_gain, low_gain;
+   unsigned int state;
+   unsigned char no_stages;
+   signed char type;
+
+   float lfc_min, lfc_fact;
+   unsigned int no_entries;
+   float entry[][FILTER_TABLE_COEFFS];
+} _freqfilter_table_t;
+
+static inline void
+_freqfilter_resonance(_aaxRingBufferFreqFilterData *filter, float fc)
+{
+   // if filter->resonance != 0.0f then the filter Q factor responds to
+   // the LFO and the cutoff frequency remains the same
+   if (filter->resonance > 0.0f) {
+      if (filter->type > BANDPASS) { // HIGHPASS
+          filter->Q = _MAX(filter->resonance*(filter->fc_high - fc), 1.0f);
+      } else {
+         filter->Q = filter->resonance*fc;
+      }
+   }
+}
+
+static bool
+_freqfilter_table_valid(const _freqfilter_table_t *tbl,
+                        const _aaxRingBufferFreqFilterData *filter)
+{
+   if (tbl->fs != filter->fs || tbl->state != filter->state ||
+       tbl->no_stages != filter->no_stages || tbl->type != filter->type ||
+       tbl->high_gain != filter->high_gain ||
+       tbl->low_gain != filter->low_gain ||
+       tbl->resonance != filter->resonance) {
+      return false;
+   }
+   if (filter->resonance > 0.0f) {
+      return (tbl->fc_high == filter->fc_high);
+   }
+   return (filter->state == AAX_BESSEL || tbl->Q == filter->Q);
+}
+
+static _freqfilter_table_t*
+_freqfilter_table_get(_aaxRingBufferFreqFilterData *filter)
+{
+   _freqfilter_table_t *tbl = filter->table;
+
+   if (!tbl || !_freqfilter_table_valid(tbl, filter))
+   {
+      float lfc_min = log2f(MINIMUM_CUTOFF);
+      float lfc_max = log2f(HIGHEST_CUTOFF(filter->fs));
+      unsigned int no_entries;
+
+      no_entries = 2 + (unsigned int)((lfc_max - lfc_min)*FILTER_TABLE_STEPS);
+      if (tbl && tbl->no_entries != no_entries)
+      {
+         free(tbl);
+         tbl = NULL;
+      }
+      if (!tbl)
+      {
+         size_t size = sizeof(_freqfilter_table_t);
+         size += no_entries*sizeof(float[FILTER_TABLE_COEFFS]);
+         tbl = malloc(size);
+      }
+
+      if (tbl)
+      {
+         _aaxRingBufferFreqFilterData flt = *filter;
+         unsigned int i;
+
+         tbl->fs = filter->fs;
+         tbl->Q = filter->Q;
+         tbl->resonance = filter->resonance;
+         tbl->fc_high = filter->fc_high;
+         tbl->high_gain = filter->high_gain;
+         tbl->low_gain = filter->low_gain;
+         tbl->state = filter->state;
+         tbl->no_stages = filter->no_stages;
+         tbl->type = filter->type;
+
+         tbl->no_entries = no_entries;
+         tbl->lfc_min = lfc_min;
+         tbl->lfc_fact = (float)(no_entries-1)/(lfc_max - lfc_min);
+
+         for (i=0; i<no_entries; ++i)
+         {
+            float fc = exp2f(lfc_min + (float)i/tbl->lfc_fact);
+
+            fc = CLIP_FREQUENCY(fc, flt.fs);
+            _freqfilter_resonance(&flt, fc);
+            if (flt.state == AAX_BESSEL) {
+               _aax_bessel_compute(fc, &flt);
+            } else {
+               _aax_butterworth_compute(fc, &flt);
+            }
+            memcpy(tbl->entry[i], flt.coeff, sizeof(float[4*_AAX_MAX_STAGES]));
+            tbl->entry[i][FILTER_TABLE_COEFFS-1] = flt.k;
+         }
+      }
+      filter->table = tbl;
+   }
+   return tbl;
+}
+
+static inline float
+_freqfilter_table_pos(const _freqfilter_table_t *tbl, float fc) {
+   return (log2f(fc) - tbl->lfc_min)*tbl->lfc_fact;
+}
+
+/* Catmull-Rom interpolation between the table entries */
+static void
+_freqfilter_table_compute(const _freqfilter_table_t *tbl, float pos,
+                          _aaxRingBufferFreqFilterData *filter)
+{
+   const float *e0, *e1, *e2, *e3;
+   unsigned int i, n, last;
+   float f, c0, c1, c2, c3;
+
+   last = tbl->no_entries-1;
+   pos = _MINMAX(pos, 0.0f, (float)last);
+   i = _MIN((unsigned int)pos, last-1);
+   f = pos - (float)i;
+
+   e0 = tbl->entry[i ? i-1 : 0];
+   e1 = tbl->entry[i];
+   e2 = tbl->entry[i+1];
+   e3 = tbl->entry[_MIN(i+2, last)];
+
+   c0 = f*(-0.5f + f*(1.0f - 0.5f*f));
+   c1 = 1.0f + f*f*(-2.5f + 1.5f*f);
+   c2 = f*(0.5f + f*(2.0f - 1.5f*f));
+   c3 = f*f*(-0.5f + 0.5f*f);
+
+   n = 4*_MAX(filter->no_stages, 1);
+   for (i=0; i<n; ++i) {
+      filter->coeff[i] = c0*e0[i] + c1*e1[i] + c2*e2[i] + c3*e3[i];
+   }
+   n = FILTER_TABLE_COEFFS-1;
+   filter->k = c0*e0[n] + c1*e1[n] + c2*e2[n] + c3*e3[n];
+}
+
+/*
+ * Filter dmax+ds samples while sweeping the cutoff frequency from the value
+ * of the previous period to fc. The coefficients are updated every
+ * FILTER_SUBBLOCK samples, the last sub-block takes the remaining samples.
+ */
+int
+_freqfilter_sweep_run(void *rb, MIX_PTR_T d, CONST_MIX_PTR_T s,
+                      size_t dmax, size_t ds, unsigned int track,
+                      _aaxRingBufferFreqFilterData *filter, float fc)
+{
+   _aaxRingBufferSample *rbd = (_aaxRingBufferSample*)rb;
+   size_t no_samples = dmax + ds;
+   _freqfilter_table_t *tbl;
+   CONST_MIX_PTR_T sptr;
+   MIX_T *dptr;
+   float fc_prev;
+
+   assert(track < RB_MAX_TRACKS);
+
+   fc = CLIP_FREQUENCY(fc, filter->fs);
+   fc_prev = filter->freqfilter->sweep_fc[track];
+   filter->freqfilter->sweep_fc[track] = fc;
+
+   sptr = s - ds;
+   dptr = d - ds;
+
+   tbl = _freqfilter_table_get(filter);
+   if (tbl)
+   {
+      float pos = _freqfilter_table_pos(tbl, fc);
+      size_t no_blocks = dmax/FILTER_SUBBLOCK;
+      float step = 0.0f;
+
+      if (fc_prev > 0.0f && no_blocks > 1) {
+         step = (pos - _freqfilter_table_pos(tbl, fc_prev))/no_blocks;
+      }
+
+      if (fabsf(step) > 1e-4f)
+      {
+         size_t num = ds + FILTER_SUBBLOCK;
+
+         pos -= no_blocks*step;
+         do
+         {
+            if (no_blocks == 1) num = dmax + ds;
+
+            pos += step;
+            _freqfilter_table_compute(tbl, pos, filter);
+            rbd->freqfilter(dptr, sptr, track, num, filter);
+
+            dptr += num;
+            sptr += num;
+            dmax -= num - ds;
+            num = FILTER_SUBBLOCK;
+            ds = 0;
+         }
+         while (--no_blocks);
+      }
+      else
+      {
+         _freqfilter_table_compute(tbl, pos, filter);
+         rbd->freqfilter(dptr, sptr, track, no_samples, filter);
+      }
+      filter->fc = fc;
+   }
+   else
+   {
+      _freqfilter_resonance(filter, fc);
+      if (filter->state == AAX_BESSEL) {
+         _aax_bessel_compute(fc, filter);
+      } else {
+         _aax_butterworth_compute(fc, filter);
+      }
+      rbd->freqfilter(dptr, sptr, track, no_samples, filter);
+   }
+
+   if (filter->state == AAX_BESSEL && filter->low_gain > LEVEL_128DB) {
+      rbd->add(d - ds, s - ds, no_samples, filter->low_gain, 0.0f);
+   }
+
+   return true;
+}
+
 int
 _freqfilter_run(void *rb, MIX_PTR_T d, CONST_MIX_PTR_T s,
                 size_t dmin, size_t dmax, size_t ds, unsigned int track,
@@ -887,23 +1129,7 @@ _freqfilter_run(void *rb, MIX_PTR_T d, CONST_MIX_PTR_T s,
    if (filter->lfo)
    {
       float fc = filter->lfo->get(filter->lfo, env, s, track, dmax);
-      fc = CLIP_FREQUENCY(fc, filter->fs);
-
-      // if filter->resonance != 0.0f then the filter Q factor responds to
-      // the LFO and the cutoff frequency remains the same
-      if (filter->resonance > 0.0f) {
-         if (filter->type > BANDPASS) { // HIGHPASS
-             filter->Q = _MAX(filter->resonance*(filter->fc_high - fc), 1.0f);
-         } else {
-            filter->Q = filter->resonance*fc;
-         }
-      }
-
-      if (filter->state == AAX_BESSEL) {
-         _aax_bessel_compute(fc, filter);
-      } else {
-         _aax_butterworth_compute(fc, filter);
-      }
+      return _freqfilter_sweep_run(rb, d, s, dmax, ds, track, filter, fc);
    }
 
    dmax += ds;
@@ -343,41 +343,22 @@ _grapheq_destroy(void *ptr)
    }
 }
 
+/*
+ * All bands are calculated from the same input by one filter-bank call which
+ * processes multiple bands at once in SIMD lanes. The per band rms and peak
+ * values are only calculated when meter is set.
+ */
 int
-_grapheq_run(void *rb, MIX_PTR_T dptr, MIX_PTR_T sptr, MIX_PTR_T tmp,
+_grapheq_run(UNUSED(void *rb), MIX_PTR_T dptr, CONST_MIX_PTR_T sptr,
              size_t dmin, size_t dmax, unsigned int track,
-             _aaxRingBufferEqualizerData *eq)
+             _aaxRingBufferEqualizerData *eq, bool meter)
 {
-   _aaxRingBufferSample *rbd = (_aaxRingBufferSample*)rb;
-   _aaxRingBufferFreqFilterData* filter;
-   int rv = false;
    size_t no_samples;
-   int band;
 
    sptr += dmin;
    no_samples = dmax - dmin;
 
-   // TODO: Make sure we actually need to filter something, otherwise return
-   //       false, although the impact is rather low being mixer-only.
-   rv = true;
-
-   // first band, straight into dptr to save a bzero() and rbd->add()
-   band = eq->no_bands;
-   filter = &eq->band[--band];
-   rbd->freqfilter(dptr, sptr, track, no_samples, filter);
-
-   _batch_get_average_rms(tmp, no_samples, &eq->rms[band], &eq->peak[band]);
-
-   // next 7 bands
-   do
-   {
-      filter = &eq->band[--band];
-      rbd->freqfilter(tmp, sptr, track, no_samples, filter);
-      rbd->add(dptr, tmp, no_samples, 1.0f, 0.0f);
-
-      _batch_get_average_rms(tmp, no_samples, &eq->rms[band], &eq->peak[band]);
-   }
-   while(band);
+   _batch_freqfilter_bank(dptr, sptr, track, no_samples, eq, meter);
 
-   return rv;
+   return true;
 }
@@ -90,6 +90,9 @@ _aaxSetDefaultInfo(_aaxMixerInfo **inf, void *handle)
 
    info->capabilities = _aaxGetCapabilities(NULL);
    info->batched_mode = false;
+   info->lookahead = 0.0f;
+   info->ambisonics_order = 0;
+   atomic_init(&info->curr_sample, 0);
 
    info->id = INFO_ID;
    info->backend = handle;
@@ -156,6 +159,14 @@ _aaxSetDefault2dProps(_aax2dProps *p2d)
    memset(p2d->hrtf, 0, size);
    memset(p2d->hrtf_prev, 0, size);
 
+   /* measured HRIR direction */
+   p2d->hrir_dir[0] = p2d->hrir_dir[1] = 0.0f;
+   p2d->hrir_dir_set = false;
+
+   /* direction and spherical harmonic gains for the Ambisonics bus */
+   memset(&p2d->direction, 0, sizeof(vec4f_t));
+   memset(p2d->prev_sh_gain, 0, sizeof(p2d->prev_sh_gain));
+
    /* HRTF head shadow */
    size = _AAX_MAX_SPEAKERS*sizeof(float);
    memset(p2d->freqfilter_history, 0, size);
@@ -165,6 +176,9 @@ _aaxSetDefault2dProps(_aax2dProps *p2d)
    size = _AAX_MAX_SPEAKERS*sizeof(float);
    memset(&p2d->prev_gain, 0, size);
    p2d->prev_freq_fact = 0.0f;
+   p2d->automation = NULL;
+   p2d->start_offs = 0;
+   p2d->stop_offs = -1;
    p2d->dist_delay_sec = 0.0f;
    p2d->bufpos3dq = 0.0f;
 
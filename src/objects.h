@@ -21,6 +21,7 @@ extern "C" {
 #if HAVE_LOCALE_H
 # include <locale.h>
 #endif
+#include <stdatomic.h>
 
 #include <xml.h>
 
@@ -299,6 +300,9 @@ typedef ALIGN16 struct
 
    int capabilities;			/* CPU capabilities */
    bool batched_mode;
+   float lookahead;			/* true-peak limiter lookahead time */
+   unsigned int ambisonics_order;	/* 0 = speaker panning */
+   atomic_int_least64_t curr_sample;	/* mixer clock at the period start */
 
    unsigned int id;
    void *backend;
@@ -355,6 +359,15 @@ typedef ALIGN16 struct _aax2dProps_s
    vec4f_t hrtf[2];
    vec4f_t hrtf_prev[2];
 
+   /* measured HRIR direction: azimuth and elevation in radians */
+   float hrir_dir[2];
+   float hrir_dir_prev[2];
+   bool hrir_dir_set;
+
+   /* normalized direction and the distance factor (w) for Ambisonics */
+   vec4f_t direction;
+   float prev_sh_gain[_AAX_MAX_AMBISONICS_CHANNELS];
+
    /* HRTF head shadow */
    float freqfilter_history[_AAX_MAX_SPEAKERS];
    float k;
@@ -369,6 +382,13 @@ typedef ALIGN16 struct _aax2dProps_s
    float prev_gain[_AAX_MAX_SPEAKERS];
    float prev_freq_fact;
 
+   /* scheduled parameter changes, emitters only (dsp/automation.h) */
+   void *automation;
+
+   /* scheduled start and stop offsets within the current period */
+   size_t start_offs;
+   ssize_t stop_offs;		/* < 0 if not set */
+
    float dist_delay_sec;        /* time to keep playing after a stop request */
    float bufpos3dq;             /* distance delay queue buffer position      */
 
@@ -440,6 +460,8 @@ typedef struct
    unsigned int buffer_pos;		/* audio buffer queue pos        */
 
    float curr_pos_sec;
+   int64_t start_sample;		/* scheduled start, < 0 if not set */
+   int64_t stop_sample;			/* scheduled stop, < 0 if not set  */
 
    _history_t history;
 
@@ -63,6 +63,9 @@ enum _aaxRingBufferParam
    RB_DDE_SAMPLES,
    RB_IS_PLAYING,
    RB_IS_MIXER_BUFFER,
+   RB_LIMITER_LOOKAHEAD,
+   RB_AMBISONICS_ORDER,
+   RB_COMPRESSED,	/* sample data is stored in compressed blocks */
 
    RB_PEAK_VALUE = 0x1000,
    RB_PEAK_VALUE_MAX = RB_PEAK_VALUE+RB_MAX_TRACKS,
@@ -147,6 +150,7 @@ typedef struct
 
 typedef ALIGN16 struct {
    float history[RB_MAX_TRACKS][2*_AAX_MAX_STAGES];
+   float sweep_fc[RB_MAX_TRACKS]; // cutoff frequency of the previous period
 } _aaxRingBufferFreqFilterHistoryData ALIGN16C;
 
 typedef struct
@@ -167,6 +171,7 @@ typedef struct
               unsigned int, void*, void*, float);
 
    _aaxRingBufferFreqFilterHistoryData *freqfilter;
+   void *table; // coefficient table for swept filters
 
 } _aaxRingBufferFreqFilterData;
 
@@ -761,6 +766,34 @@ _aaxRingBufferDataDitherFn(struct _aaxRingBuffer_t*, unsigned int bits);
  */
 size_t _aaxRingBufferCreateHistoryBuffer(_aaxRingBufferHistoryData**, size_t, int);
 
+/**
+ * Measured HRIR binaural rendering
+ *
+ * Load loads the HRIR set used by all HRTF mode ringbuffers and Unload
+ * drops it again, the set stays loaded until every successful Load is
+ * matched by an Unload. Flush renders the emitters which were mixed since the
+ * last flush, Merge adds the pending emitters of a worker thread ringbuffer
+ * to the destination ringbuffer and Swap hands the convolution state over
+ * to another ringbuffer.
+ */
+void* _aaxRingBufferHRIRLoad(const char*, bool);
+void _aaxRingBufferHRIRUnload(void*);
+void _aaxRingBufferHRIRFlush(struct _aaxRingBuffer_t*);
+void _aaxRingBufferHRIRMerge(struct _aaxRingBuffer_t*, struct _aaxRingBuffer_t*);
+void _aaxRingBufferHRIRSwap(struct _aaxRingBuffer_t*, struct _aaxRingBuffer_t*);
+
+/**
+ * Higher-order Ambisonics bus
+ *
+ * If RB_AMBISONICS_ORDER is set 3d emitters are encoded into the spherical
+ * harmonic channels of the bus instead of being panned to every speaker.
+ * Flush decodes the bus to the speakers of the mixer (or to virtual
+ * speakers for the measured HRIR set in HRTF mode) and Merge adds the bus
+ * of a worker thread ringbuffer to that of the destination ringbuffer.
+ */
+void _aaxRingBufferAmbisonicsFlush(struct _aaxRingBuffer_t*, const _aaxMixerInfo*);
+void _aaxRingBufferAmbisonicsMerge(struct _aaxRingBuffer_t*, struct _aaxRingBuffer_t*);
+
 
 typedef struct _aaxRingBuffer_t
 {
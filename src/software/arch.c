@@ -76,6 +76,7 @@ _batch_cvt_to_proc _batch_cvtps_24 = _batch_cvtps_24_cpu;
 _batch_cvt_to_proc _batch_cvtpd_24 = _batch_cvtpd_24_cpu;
 _batch_cvt_to_proc _batch_cvt24_24 = _batch_cvt24_24_cpu;
 _batch_cvt_to_proc _batch_limit = _batch_limit_cpu;
+_batch_cvt_to_proc _batch_get_truepeak = _batch_get_truepeak_cpu;
 _batch_cvt_to_proc _batch_atanps = _batch_atanps_cpu;
 _batch_cvt_to_proc _batch_roundps = _batch_roundps_cpu;
 _batch_cvt_to_intl_proc _batch_cvt8_intl_24 = _batch_cvt8_intl_24_cpu;
@@ -97,11 +98,13 @@ _batch_fmadd_proc _batch_fmul_value = _batch_fmul_value_cpu;
 _batch_ema_float_proc _batch_allpass_float = _batch_iir_allpass_float_cpu;
 _batch_ema_float_proc _batch_movingaverage_float = _batch_ema_iir_float_cpu;
 _batch_freqfilter_float_proc _batch_freqfilter_float = _batch_freqfilter_float_cpu;
+_batch_freqfilter_bank_proc _batch_freqfilter_bank = _batch_freqfilter_bank_cpu;
 
 
 _batch_cvt_from_proc _batch_cvt24_ps24 = _batch_cvt24_ps24_cpu;
 _batch_cvt_to_proc _batch_cvtps24_24 = _batch_cvtps24_24_cpu;
 _batch_resample_float_proc _batch_resample_float = _batch_resample_float_cpu;
+_batch_resample_ramp_float_proc _batch_resample_ramp_float = _batch_resample_ramp_float_cpu;
 _batch_convolution_proc _batch_convolution = _batch_convolution_cpu;
 
 
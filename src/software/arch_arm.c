@@ -189,6 +189,7 @@ _aaxGetSIMDSupportLevel()
          _batch_dc_shift = _batch_dc_shift_vfpv4;
          _batch_wavefold = _batch_wavefold_vfpv4;
 	 _aax_generate_waveform_float = _aax_generate_waveform_vfpv4;
+	 _aax_generate_additive_float = _aax_generate_additive_vfpv4;
          _aax_generate_noise_float = _aax_generate_noise_vfpv4;
 
 //       _batch_cvt24_24 = _batch_cvt24_24_vfpv4;
@@ -197,6 +198,7 @@ _aaxGetSIMDSupportLevel()
          _batch_cvt24_ps24 = _batch_cvt24_ps24_vfpv4;
          _batch_cvtps24_24 = _batch_cvtps24_24_vfpv4;
          _batch_limit = _batch_limit_vfpv4;
+         _batch_get_truepeak = _batch_get_truepeak_vfpv4;
          _batch_atanps = _batch_atanps_vfpv4;
          _batch_cvt24_ps = _batch_cvt24_ps_vfpv4;
          _batch_cvtps_24 = _batch_cvtps_24_vfpv4;
@@ -239,7 +241,9 @@ _aaxGetSIMDSupportLevel()
 //       _batch_endianswap64 = _batch_endianswap64_vfpv4;
          _batch_movingaverage_float = _batch_ema_iir_float_vfpv4;
          _batch_freqfilter_float = _batch_freqfilter_float_vfpv4;
+         _batch_freqfilter_bank = _batch_freqfilter_bank_vfpv4;
          _batch_resample_float = _batch_resample_float_vfpv4;
+         _batch_resample_ramp_float = _batch_resample_ramp_float_vfpv4;
 
 //       vec3fAdd = _vec3fAdd_vfpv4;
 //       vec3fDevide = _vec3fDevide_vfpv4;
@@ -351,12 +351,14 @@ _aaxGetSIMDSupportLevel()
             vec3dAltitudeVector = _vec3dAltitudeVector_sse2;
 
             _aax_generate_waveform_float = _aax_generate_waveform_sse2;
+            _aax_generate_additive_float = _aax_generate_additive_sse2;
 //          _aax_generate_noise_float = _aax_generate_noise_sse2;
 
             _batch_get_average_rms = _batch_get_average_rms_sse2;
             _batch_saturate24 = _batch_saturate24_sse2;
 
 //          _batch_limit = _batch_limit_sse2;
+            _batch_get_truepeak = _batch_get_truepeak_sse2;
             _batch_atanps = _batch_atanps_sse2;
             _batch_cvtps_24 = _batch_cvtps_24_sse2;
             _batch_cvt24_ps = _batch_cvt24_ps_sse2;
@@ -373,7 +375,9 @@ _aaxGetSIMDSupportLevel()
             _batch_cvt24_ps24 = _batch_cvt24_ps24_sse2;
             _batch_movingaverage_float = _batch_ema_iir_float_sse2;
             _batch_freqfilter_float = _batch_freqfilter_float_sse2;
+            _batch_freqfilter_bank = _batch_freqfilter_bank_sse2;
             _batch_resample_float = _batch_resample_float_sse2;
+            _batch_resample_ramp_float = _batch_resample_ramp_float_sse2;
          }
          if (_aax_arch_capabilities & AAX_ARCH_SSE3)
          {
@@ -405,12 +409,14 @@ _aaxGetSIMDSupportLevel()
                vec3fAltitudeVector = _vec3fAltitudeVector_sse_vex;
 
                _aax_generate_waveform_float = _aax_generate_waveform_sse_vex;
+               _aax_generate_additive_float = _aax_generate_additive_sse_vex;
                _aax_generate_noise_float = _aax_generate_noise_sse_vex;
 
                _batch_get_average_rms = _batch_get_average_rms_sse_vex;
                _batch_saturate24 = _batch_saturate24_sse_vex;
 
                _batch_limit = _batch_limit_sse_vex;
+               _batch_get_truepeak = _batch_get_truepeak_sse_vex;
                _batch_atanps = _batch_atanps_sse_vex;
                _batch_cvtps_24 = _batch_cvtps_24_sse_vex;
                _batch_cvt24_ps = _batch_cvt24_ps_sse_vex;
@@ -427,7 +433,9 @@ _aaxGetSIMDSupportLevel()
                _batch_cvt24_ps24 = _batch_cvt24_ps24_sse_vex;
                _batch_movingaverage_float = _batch_ema_iir_float_sse_vex;
                _batch_freqfilter_float = _batch_freqfilter_float_sse_vex;
+               _batch_freqfilter_bank = _batch_freqfilter_bank_sse_vex;
                _batch_resample_float = _batch_resample_float_sse_vex;
+               _batch_resample_ramp_float = _batch_resample_ramp_float_sse_vex;
 
                /* AVX */
                mtx4dMul = _mtx4dMul_avx;
@@ -435,6 +443,7 @@ _aaxGetSIMDSupportLevel()
                vec3dAltitudeVector = _vec3dAltitudeVector_avx;
 
                _aax_generate_waveform_float = _aax_generate_waveform_avx;
+               _aax_generate_additive_float = _aax_generate_additive_avx;
                _aax_generate_noise_float = _aax_generate_noise_avx;
                _batch_get_average_rms = _batch_get_average_rms_avx;
 
@@ -449,7 +458,9 @@ _aaxGetSIMDSupportLevel()
                _batch_atanps = _batch_atanps_avx;
                _batch_movingaverage_float = _batch_ema_iir_float_sse_vex;
                _batch_freqfilter_float = _batch_freqfilter_float_sse_vex;
+               _batch_freqfilter_bank = _batch_freqfilter_bank_sse_vex;
                _batch_resample_float = _batch_resample_float_sse_vex;
+               _batch_resample_ramp_float = _batch_resample_ramp_float_sse_vex;
 
 //             _aax_memcpy = _aax_memcpy_avx;
                _batch_cvtps_24 = _batch_cvtps_24_avx;
@@ -1213,6 +1213,84 @@ _batch_fmadd_avx(float32_ptr dst, const_float32_ptr src, size_t num, float v, fl
    }
 }
 
+/*
+ * The phasor of every harmonic is rotated for eight consecutive samples at
+ * once, the remaining samples continue from the first lane.
+ */
+float *
+_aax_generate_additive_avx(float32_ptr rv, size_t no_samples, float freq, float phase, enum aaxSourceType wtype)
+{
+   const_float32_ptr phases = _harmonic_phases[wtype-AAX_1ST_WAVE];
+   const_float32_ptr harmonics = _harmonics[wtype-AAX_1ST_WAVE];
+   size_t step = no_samples/8;
+   int h;
+
+   memset(rv, 0, no_samples*sizeof(float));
+   for (h=0; h<MAX_HARMONICS; ++h)
+   {
+      float n = (float)(h+1);
+      float ngain = harmonics[h];
+
+      if (freq/n < 2.0f) break;    // higher than the nyquist-frequency
+      if (ngain)
+      {
+         float a = n*phase - GMATH_PI + GMATH_PI*phases[h];
+         float d = n*GMATH_2PI/freq;
+         float dc, ds, c, s;
+         float *ptr = rv;
+         size_t i;
+
+         if (step)
+         {
+            float c8[8], s8[8];
+            __m256 dc8, ds8, vc, vs;
+
+            for (i=0; i<8; ++i)
+            {
+               c8[i] = ngain*cosf(a + i*d);
+               s8[i] = ngain*sinf(a + i*d);
+            }
+            vc = _mm256_loadu_ps(c8);
+            vs = _mm256_loadu_ps(s8);
+            dc8 = _mm256_set1_ps(cosf(8.0f*d));
+            ds8 = _mm256_set1_ps(sinf(8.0f*d));
+
+            i = step;
+            do
+            {
+               __m256 ns = _mm256_add_ps(_mm256_mul_ps(vs, dc8),
+                                         _mm256_mul_ps(vc, ds8));
+               _mm256_storeu_ps(ptr, _mm256_add_ps(_mm256_loadu_ps(ptr), vs));
+               vc = _mm256_sub_ps(_mm256_mul_ps(vc, dc8),
+                                  _mm256_mul_ps(vs, ds8));
+               vs = ns;
+               ptr += 8;
+            }
+            while (--i);
+
+            c = _mm256_cvtss_f32(vc);
+            s = _mm256_cvtss_f32(vs);
+         }
+         else
+         {
+            c = ngain*cosf(a);
+            s = ngain*sinf(a);
+         }
+
+         dc = cosf(d);
+         ds = sinf(d);
+         for (i=8*step; i<no_samples; ++i)
+         {
+            float ns = s*dc + c*ds;
+            *ptr++ += s;
+            c = c*dc - s*ds;
+            s = ns;
+         }
+      }
+   }
+   return rv;
+}
+
 float *
 _aax_generate_waveform_avx(float32_ptr rv, size_t no_samples, float freq, float phase, enum aaxSourceType wtype)
 {
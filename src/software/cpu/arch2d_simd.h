@@ -59,16 +59,19 @@ typedef float*(*_aax_generate_noise_proc)(float32_ptr, size_t, uint64_t, unsigne
 
 
 extern _aax_generate_waveform_proc _aax_generate_waveform_float;
+extern _aax_generate_waveform_proc _aax_generate_additive_float;
 extern _aax_generate_noise_proc _aax_generate_noise_float;
 
 /* CPU*/
 void _batch_cvt24_24_cpu(void_ptr, const void*, size_t);
 void _batch_roundps_cpu(void_ptr, const_void_ptr, size_t);
 void _batch_limit_cpu(void_ptr, const_void_ptr, size_t);
+void _batch_get_truepeak_cpu(void_ptr, const_void_ptr, size_t);
 void _batch_atanps_cpu(void_ptr, const_void_ptr, size_t);
 void _batch_atan_cpu(void_ptr, const_void_ptr, size_t);
 
 float* _aax_generate_waveform_cpu(float32_ptr, size_t, float, float, enum aaxSourceType);
+float* _aax_generate_additive_cpu(float32_ptr, size_t, float, float, enum aaxSourceType);
 float* _aax_generate_noise_cpu(float32_ptr, size_t, uint64_t, unsigned char, float);
 
 void _batch_fmul_cpu(void_ptr, const_void_ptr, size_t);
@@ -81,9 +84,11 @@ void _batch_wavefold_cpu(float32_ptr, const_float32_ptr, size_t, float);
 void _batch_iir_allpass_float_cpu(float32_ptr, const_float32_ptr, size_t, float*, float);
 void _batch_ema_iir_float_cpu(float32_ptr, const_float32_ptr, size_t, float*, float);
 void _batch_freqfilter_float_cpu(float32_ptr, const_float32_ptr, int, size_t, void*);
+void _batch_freqfilter_bank_cpu(float32_ptr, const_float32_ptr, int, size_t, void*, bool);
 void _batch_cvt24_ps24_cpu(void_ptr, const_void_ptr, size_t);
 void _batch_cvtps24_24_cpu(void_ptr, const_void_ptr, size_t);
 void _batch_resample_float_cpu(float32_ptr, const_float32_ptr, size_t, size_t, float, float);
+void _batch_resample_ramp_float_cpu(float32_ptr, const_float32_ptr, size_t, size_t, float, float, float);
 void _batch_convolution_cpu(float32_ptr, const_float32_ptr, const_float32_ptr, unsigned int, unsigned int, int, float, float);
 
 void _batch_get_average_rms_cpu(const_float32_ptr, size_t, float*, float*);
@@ -142,6 +147,7 @@ float fast_sin_sse2(float);
 void _batch_dc_shift_sse2(float32_ptr, const_float32_ptr, size_t, float);
 void _batch_wavefold_sse2(float32_ptr, const_float32_ptr, size_t, float);
 float* _aax_generate_waveform_sse2(float32_ptr, size_t, float, float, enum aaxSourceType);
+float* _aax_generate_additive_sse2(float32_ptr, size_t, float, float, enum aaxSourceType);
 float* _aax_generate_noise_sse2(float32_ptr, size_t, uint64_t, unsigned char, float);
 
 void _batch_get_average_rms_sse2(const_float32_ptr, size_t, float*, float*);
@@ -153,11 +159,14 @@ void _batch_imadd_sse2(int32_ptr, const_int32_ptr, size_t, float, float);
 void _batch_fmadd_sse2(float32_ptr, const_float32_ptr, size_t, float, float);
 void _batch_ema_iir_float_sse2(float32_ptr d, const_float32_ptr sptr, size_t num, float *hist, float a1);
 void _batch_freqfilter_float_sse2(float32_ptr, const_float32_ptr, int, size_t, void*);
+void _batch_freqfilter_bank_sse2(float32_ptr, const_float32_ptr, int, size_t, void*, bool);
 void _batch_limit_sse2(void_ptr, const_void_ptr, size_t);
+void _batch_get_truepeak_sse2(void_ptr, const_void_ptr, size_t);
 void _batch_atanps_sse2(void_ptr, const_void_ptr, size_t);
 void _batch_cvtps24_24_sse2(void_ptr, const_void_ptr, size_t);
 void _batch_cvt24_ps24_sse2(void_ptr, const_void_ptr, size_t);
 void _batch_resample_float_sse2(float32_ptr, const_float32_ptr, size_t, size_t, float, float);
+void _batch_resample_ramp_float_sse2(float32_ptr, const_float32_ptr, size_t, size_t, float, float, float);
 
 void _batch_cvtps_24_sse2(void_ptr, const_void_ptr, size_t);
 void _batch_cvt24_ps_sse2(void_ptr, const_void_ptr, size_t);
@@ -176,6 +185,7 @@ float fast_sin_sse_vex(float);
 void _batch_dc_shift_sse_vex(float32_ptr, const_float32_ptr, size_t, float);
 void _batch_wavefold_sse_vex(float32_ptr, const_float32_ptr, size_t, float);
 float* _aax_generate_waveform_sse_vex(float32_ptr, size_t, float, float, enum aaxSourceType);
+float* _aax_generate_additive_sse_vex(float32_ptr, size_t, float, float, enum aaxSourceType);
 float* _aax_generate_noise_sse_vex(float32_ptr, size_t, uint64_t, unsigned char, float);
 
 void _batch_get_average_rms_sse_vex(const_float32_ptr, size_t, float*, float*);
@@ -186,11 +196,14 @@ void _batch_fmul_value_sse_vex(float32_ptr, const_float32_ptr, size_t, float, fl
 void _batch_imadd_sse_vex(int32_ptr, const_int32_ptr, size_t, float, float);
 void _batch_fmadd_sse_vex(float32_ptr, const_float32_ptr, size_t, float, float);void _batch_ema_iir_float_sse_vex(float32_ptr d, const_float32_ptr sptr, size_t num, float *hist, float a1);
 void _batch_freqfilter_float_sse_vex(float32_ptr, const_float32_ptr, int, size_t, void*);
+void _batch_freqfilter_bank_sse_vex(float32_ptr, const_float32_ptr, int, size_t, void*, bool);
 void _batch_limit_sse_vex(void_ptr, const_void_ptr, size_t);
+void _batch_get_truepeak_sse_vex(void_ptr, const_void_ptr, size_t);
 void _batch_atanps_sse_vex(void_ptr, const_void_ptr, size_t);
 void _batch_cvtps24_24_sse_vex(void_ptr, const_void_ptr, size_t);
 void _batch_cvt24_ps24_sse_vex(void_ptr, const_void_ptr, size_t);
 void _batch_resample_float_sse_vex(float32_ptr, const_float32_ptr, size_t, size_t, float, float);
+void _batch_resample_ramp_float_sse_vex(float32_ptr, const_float32_ptr, size_t, size_t, float, float, float);
 
 void _batch_cvtps_24_sse_vex(void_ptr, const_void_ptr, size_t);
 void _batch_cvt24_ps_sse_vex(void_ptr, const_void_ptr, size_t);
@@ -214,6 +227,7 @@ void _batch_cvtps_24_avx(void_ptr, const_void_ptr, size_t);
 void _batch_cvt24_ps_avx(void_ptr, const_void_ptr, size_t);
 
 float* _aax_generate_waveform_avx(float32_ptr, size_t, float, float, enum aaxSourceType);
+float* _aax_generate_additive_avx(float32_ptr, size_t, float, float, enum aaxSourceType);
 float* _aax_generate_noise_avx(float32_ptr, size_t, uint64_t, unsigned char, float);
 void _batch_get_average_rms_avx(const_float32_ptr, size_t, float*, float*);
 
@@ -299,9 +313,11 @@ void _batch_cvtpd_intl_24_vfpv2(void_ptr, const_int32_ptrptr, size_t, unsigned i
 /* VFPv4 */
 void _batch_cvt24_24_vfpv4(void_ptr, const void*, size_t);
 void _batch_limit_vfpv4(void_ptr, const_void_ptr, size_t);
+void _batch_get_truepeak_vfpv4(void_ptr, const_void_ptr, size_t);
 void _batch_atanps_vfpv4(void_ptr, const_void_ptr, size_t);
 
 float* _aax_generate_waveform_vfpv4(float32_ptr, size_t, float, float, enum aaxSourceType);
+float* _aax_generate_additive_vfpv4(float32_ptr, size_t, float, float, enum aaxSourceType);
 float* _aax_generate_noise_vfpv4(float32_ptr, size_t, uint64_t, unsigned char, float);
 
 void _batch_fmul_vfpv4(void_ptr, const_void_ptr, size_t);
@@ -313,9 +329,11 @@ void _batch_dc_shift_vfpv4(float32_ptr, const_float32_ptr, size_t, float);
 void _batch_wavefold_vfpv4(float32_ptr, const_float32_ptr, size_t, float);
 void _batch_ema_iir_float_vfpv4(float32_ptr, const_float32_ptr, size_t, float*, float);
 void _batch_freqfilter_float_vfpv4(float32_ptr, const_float32_ptr, int, size_t, void*);
+void _batch_freqfilter_bank_vfpv4(float32_ptr, const_float32_ptr, int, size_t, void*, bool);
 void _batch_cvt24_ps24_vfpv4(void_ptr, const_void_ptr, size_t);
 void _batch_cvtps24_24_vfpv4(void_ptr, const_void_ptr, size_t);
 void _batch_resample_float_vfpv4(float32_ptr, const_float32_ptr, size_t, size_t, float, float);
+void _batch_resample_ramp_float_vfpv4(float32_ptr, const_float32_ptr, size_t, size_t, float, float, float);
 
 void _batch_get_average_rms_vfpv4(const_float32_ptr, size_t, float*, float*);
 void _batch_dither_vfpv4(int32_t*, unsigned, size_t);
@@ -358,6 +358,82 @@ FN(aax_generate_waveform,A)(float32_ptr rv, size_t no_samples, float freq, float
    return rv;
 }
 
+/*
+ * The phasor of every harmonic is rotated for four consecutive samples at
+ * once, the remaining samples continue from the first lane.
+ */
+float *
+FN(aax_generate_additive,A)(float32_ptr rv, size_t no_samples, float freq, float phase, enum aaxSourceType wtype)
+{
+   const_float32_ptr phases = _harmonic_phases[wtype-AAX_1ST_WAVE];
+   const_float32_ptr harmonics = _harmonics[wtype-AAX_1ST_WAVE];
+   size_t step = no_samples/4;
+   int h;
+
+   memset(rv, 0, no_samples*sizeof(float));
+   for (h=0; h<MAX_HARMONICS; ++h)
+   {
+      float n = (float)(h+1);
+      float ngain = harmonics[h];
+
+      if (freq/n < 2.0f) break;    // higher than the nyquist-frequency
+      if (ngain)
+      {
+         float a = n*phase - GMATH_PI + GMATH_PI*phases[h];
+         float d = n*GMATH_2PI/freq;
+         float dc, ds, c, s;
+         float *ptr = rv;
+         size_t i;
+
+         if (step)
+         {
+            float c4[4], s4[4];
+            __m128 dc4, ds4, vc, vs;
+
+            for (i=0; i<4; ++i)
+            {
+               c4[i] = ngain*cosf(a + i*d);
+               s4[i] = ngain*sinf(a + i*d);
+            }
+            vc = _mm_loadu_ps(c4);
+            vs = _mm_loadu_ps(s4);
+            dc4 = _mm_set1_ps(cosf(4.0f*d));
+            ds4 = _mm_set1_ps(sinf(4.0f*d));
+
+            i = step;
+            do
+            {
+               __m128 ns = _mm_add_ps(_mm_mul_ps(vs, dc4), _mm_mul_ps(vc, ds4));
+               _mm_storeu_ps(ptr, _mm_add_ps(_mm_loadu_ps(ptr), vs));
+               vc = _mm_sub_ps(_mm_mul_ps(vc, dc4), _mm_mul_ps(vs, ds4));
+               vs = ns;
+               ptr += 4;
+            }
+            while (--i);
+
+            c = _mm_cvtss_f32(vc);
+            s = _mm_cvtss_f32(vs);
+         }
+         else
+         {
+            c = ngain*cosf(a);
+            s = ngain*sinf(a);
+         }
+
+         dc = cosf(d);
+         ds = sinf(d);
+         for (i=4*step; i<no_samples; ++i)
+         {
+            float ns = s*dc + c*ds;
+            *ptr++ += s;
+            c = c*dc - s*ds;
+            s = ns;
+         }
+      }
+   }
+   return rv;
+}
+
 #define FC      50.0f // 50Hz high-pass EMA filter cutoff frequency
 float *
 FN(aax_generate_noise,A)(float32_ptr rv, size_t no_samples, uint64_t seed, unsigned char skip, float fs)
@@ -633,6 +709,61 @@ FN(batch_limit,A)(void_ptr dptr, const_void_ptr sptr, size_t num)
    }
 }
 
+/*
+ * 4x oversampled true-peak detection, four consecutive samples at a time.
+ * sptr must hold TRUEPEAK_TAPS-1 samples of history before the first sample.
+ */
+void
+FN(batch_get_truepeak,A)(void_ptr dptr, const_void_ptr sptr, size_t num)
+{
+   float *d = (float*)dptr;
+   const float *s = (const float*)sptr;
+   size_t i, step;
+
+   if (!num) return;
+
+   step = sizeof(__m128)/sizeof(float);
+
+   i = num/step;
+   if (i)
+   {
+      num -= i*step;
+      do
+      {
+         __m128 acc0 = _mm_setzero_ps();
+         __m128 acc1 = _mm_setzero_ps();
+         __m128 acc2 = _mm_setzero_ps();
+         __m128 acc3 = _mm_setzero_ps();
+         __m128 peak;
+         int j;
+
+         for (j=0; j<TRUEPEAK_TAPS; ++j)
+         {
+            const float *fir = _truepeak_fir[j];
+            __m128 xmm = _mm_loadu_ps(s-j);
+
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(xmm, _mm_set1_ps(fir[0])));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(xmm, _mm_set1_ps(fir[1])));
+            acc2 = _mm_add_ps(acc2, _mm_mul_ps(xmm, _mm_set1_ps(fir[2])));
+            acc3 = _mm_add_ps(acc3, _mm_mul_ps(xmm, _mm_set1_ps(fir[3])));
+         }
+
+         acc0 = _mm_max_ps(FN(mm_abs_ps,A)(acc0), FN(mm_abs_ps,A)(acc1));
+         acc2 = _mm_max_ps(FN(mm_abs_ps,A)(acc2), FN(mm_abs_ps,A)(acc3));
+         peak = _mm_max_ps(_mm_loadu_ps(d), _mm_max_ps(acc0, acc2));
+         _mm_storeu_ps(d, peak);
+
+         s += step;
+         d += step;
+      }
+      while(--i);
+   }
+
+   if (num) {
+      _batch_get_truepeak_cpu(d, s, num);
+   }
+}
+
 void
 FN(batch_atanps,A)(void_ptr dptr, const_void_ptr sptr, size_t num)
 {
@@ -1428,6 +1559,180 @@ FN(batch_freqfilter_float,A)(float32_ptr dptr, const_float32_ptr sptr, int t, si
    }
 }
 
+/*
+ * Filter-bank version of batch_freqfilter_float which processes four
+ * equalizer bands in parallel, one band per SIMD lane, from the same input.
+ * All bands are required to have the same number of stages.
+ */
+#define FILTER_BANK_CHUNK	64
+#define FILTER_BANK_GROUPS	(_AAX_MAX_EQBANDS/4)
+void
+FN(batch_freqfilter_bank,A)(float32_ptr dptr, const_float32_ptr sptr, int t, size_t num, void *data, bool meter)
+{
+   _aaxRingBufferEqualizerData *eq = (_aaxRingBufferEqualizerData*)data;
+   int no_bands = eq->no_bands;
+   int stages = eq->band[0].no_stages;
+
+   if (!stages) stages++;
+   if (num && no_bands)
+   {
+      __m128 coeff[FILTER_BANK_GROUPS][_AAX_MAX_STAGES][4];
+      __m128 hist[FILTER_BANK_GROUPS][_AAX_MAX_STAGES][2];
+      __m128 k[FILTER_BANK_GROUPS], gain[FILTER_BANK_GROUPS];
+      __m128 peak[FILTER_BANK_GROUPS];
+      __m128 acc[FILTER_BANK_CHUNK];
+      __m128 tmp[FILTER_BANK_CHUNK];
+      double rms[_AAX_MAX_EQBANDS];
+      int b, g, j, st, no_groups;
+      float v[4][4];
+      size_t pos = 0;
+
+      // transpose the band data into groups of four SIMD lanes
+      no_groups = (no_bands+3)/4;
+      for (g=0; g<no_groups; ++g)
+      {
+         for (st=0; st<stages; ++st)
+         {
+            memset(v, 0, sizeof(v));
+            for (b=0; b<4 && 4*g+b < no_bands; ++b)
+            {
+               _aaxRingBufferFreqFilterData *filter = &eq->band[4*g+b];
+
+               assert(filter->no_stages == eq->band[0].no_stages);
+               for (j=0; j<4; ++j) {
+                  v[j][b] = filter->coeff[4*st+j];
+               }
+            }
+            for (j=0; j<4; ++j) {
+               coeff[g][st][j] = _mm_loadu_ps(v[j]);
+            }
+
+            memset(v, 0, sizeof(v));
+            for (b=0; b<4 && 4*g+b < no_bands; ++b)
+            {
+               _aaxRingBufferFreqFilterData *filter = &eq->band[4*g+b];
+
+               v[0][b] = filter->freqfilter->history[t][2*st+0];
+               v[1][b] = filter->freqfilter->history[t][2*st+1];
+            }
+            hist[g][st][0] = _mm_loadu_ps(v[0]);
+            hist[g][st][1] = _mm_loadu_ps(v[1]);
+         }
+
+         memset(v, 0, sizeof(v));
+         for (b=0; b<4 && 4*g+b < no_bands; ++b)
+         {
+            v[0][b] = eq->band[4*g+b].k;
+            v[1][b] = eq->band[4*g+b].gain;
+         }
+         k[g] = _mm_loadu_ps(v[0]);
+         gain[g] = _mm_loadu_ps(v[1]);
+         peak[g] = _mm_setzero_ps();
+      }
+      memset(rms, 0, sizeof(rms));
+
+      do
+      {
+         size_t i, n = _MIN(num-pos, FILTER_BANK_CHUNK);
+
+         for (i=0; i<n; ++i) {
+            acc[i] = _mm_setzero_ps();
+         }
+
+         for (g=0; g<no_groups; ++g)
+         {
+            __m128 sum = _mm_setzero_ps();
+            __m128 max = peak[g];
+
+            for (st=0; st<stages; ++st)
+            {
+               __m128 c0 = coeff[g][st][0];
+               __m128 c1 = coeff[g][st][1];
+               __m128 c2 = coeff[g][st][2];
+               __m128 c3 = coeff[g][st][3];
+               __m128 h0 = hist[g][st][0];
+               __m128 h1 = hist[g][st][1];
+
+               for (i=0; i<n; ++i)
+               {
+                  __m128 smp, nsmp;
+
+                  if (st) smp = tmp[i];
+                  else smp = _mm_mul_ps(_mm_set1_ps(sptr[pos+i]), k[g]);
+
+                  nsmp = _mm_add_ps(smp, _mm_add_ps(_mm_mul_ps(h0, c0),
+                                                    _mm_mul_ps(h1, c1)));
+                  tmp[i] = _mm_add_ps(nsmp, _mm_add_ps(_mm_mul_ps(h0, c2),
+                                                       _mm_mul_ps(h1, c3)));
+                  h1 = h0;
+                  h0 = nsmp;
+               }
+               hist[g][st][0] = h0;
+               hist[g][st][1] = h1;
+            }
+
+            for (i=0; i<n; ++i)
+            {
+               __m128 smp = _mm_mul_ps(tmp[i], gain[g]);
+
+               acc[i] = _mm_add_ps(acc[i], smp);
+               if (meter)
+               {
+                  smp = _mm_mul_ps(smp, smp);
+                  sum = _mm_add_ps(sum, smp);
+                  max = _mm_max_ps(max, smp);
+               }
+            }
+
+            if (meter)
+            {
+               _mm_storeu_ps(v[0], sum);
+               for (b=0; b<4 && 4*g+b < no_bands; ++b) {
+                  rms[4*g+b] += v[0][b];
+               }
+               peak[g] = max;
+            }
+         }
+
+         // horizontal sum of the bands
+         for (i=0; i<n; ++i)
+         {
+            __m128 x = _mm_add_ps(acc[i], _mm_movehl_ps(acc[i], acc[i]));
+            x = _mm_add_ss(x, _mm_shuffle_ps(x, x, _MM_SHUFFLE(1,1,1,1)));
+            dptr[pos+i] = _mm_cvtss_f32(x);
+         }
+         pos += n;
+      }
+      while (pos < num);
+
+      for (g=0; g<no_groups; ++g)
+      {
+         for (st=0; st<stages; ++st)
+         {
+            _mm_storeu_ps(v[0], hist[g][st][0]);
+            _mm_storeu_ps(v[1], hist[g][st][1]);
+            for (b=0; b<4 && 4*g+b < no_bands; ++b)
+            {
+               _aaxRingBufferFreqFilterData *filter = &eq->band[4*g+b];
+
+               filter->freqfilter->history[t][2*st+0] = v[0][b];
+               filter->freqfilter->history[t][2*st+1] = v[1][b];
+            }
+         }
+
+         if (meter)
+         {
+            _mm_storeu_ps(v[0], peak[g]);
+            for (b=0; b<4 && 4*g+b < no_bands; ++b)
+            {
+               eq->rms[4*g+b] = sqrt(rms[4*g+b]/num);
+               eq->peak[4*g+b] = sqrtf(v[0][b]);
+            }
+         }
+      }
+   }
+}
+
 
 static inline void
 FN(aaxBufResampleDecimate_float,A)(float32_ptr dptr, const_float32_ptr sptr, size_t dmin, size_t dmax, float smu, float freq_factor)
@@ -1660,3 +1965,114 @@ FN(batch_resample_float,A)(float32_ptr d, const_float32_ptr s, size_t dmin, size
       memcpy(d+dmin, s, (dmax-dmin)*sizeof(MIX_T));
    }
 }
+
+/*
+ * Resample with a step size which changes linearly from fact (at dmin) to
+ * fact_end (at dmax). Four linear interpolated output samples are
+ * calculated at a time, only the source samples are loaded one by one.
+ * Cubic interpolation moves at most one source sample per output sample
+ * which the serial code handles best.
+ */
+void
+FN(batch_resample_ramp_float,A)(float32_ptr d, const_float32_ptr s, size_t dmin, size_t dmax, float smu, float fact, float fact_end)
+{
+   const __m128 k = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+   const __m128 kk = _mm_set_ps(3.0f, 1.0f, 0.0f, 0.0f);	// k*(k-1)/2
+   float32_ptr sptr = (float32_ptr)s;
+   float32_ptr dptr = d;
+   float step, dstep;
+   size_t i, j, n, b;
+
+   assert(fact > 0.0f && fact_end > 0.0f);
+   assert(d != s);
+   assert(dmin < dmax);
+   assert(0.0f <= smu && smu < 1.0f);
+
+   if (fact == fact_end)
+   {
+      FN(batch_resample_float,A)(d, s, dmin, dmax, smu, fact);
+      return;
+   }
+
+   dptr += dmin;
+   i = dmax-dmin;
+
+   /* step(j) = fact + (j+0.5)*dstep, not accumulated to prevent drift */
+   dstep = (fact_end - fact)/i;
+   step = fact + 0.5f*dstep;
+
+   if (fact < CUBIC_TRESHOLD && fact_end < CUBIC_TRESHOLD)
+   {
+      float y0, y1, y2, y3, a0, a1, a2;
+
+      y0 = *sptr++;
+      y1 = *sptr++;
+      y2 = *sptr++;
+      y3 = *sptr++;
+
+      a0 = y3 - y2 - y0 + y1;
+      a1 = y0 - y1 - a0;
+      a2 = y2 - y0;
+
+      j = 0;
+      do
+      {
+         float smu2 = smu*smu;
+
+         *dptr++ = (a0*smu*smu2 + a1*smu2 + a2*smu + y1);
+
+         smu += step + (j++)*dstep;
+         if (smu >= 1.0f)
+         {
+            smu--;
+            y0 = y1;
+            y1 = y2;
+            y2 = y3;
+            y3 = *sptr++;
+            a0 = y3 - y2 - y0 + y1;
+            a1 = y0 - y1 - a0;
+            a2 = y2 - y0;
+         }
+      }
+      while (--i);
+      return;
+   }
+
+   n = i/4;
+   i -= 4*n;
+   for (b=0; b<n; ++b)
+   {
+      float bstep = step + 4*b*dstep;
+      __m128 pos, mu, y0, y1;
+      __m128i ipos;
+      int idx[4];
+
+      pos = _mm_add_ps(_mm_set1_ps(smu),
+                       _mm_add_ps(_mm_mul_ps(k, _mm_set1_ps(bstep)),
+                                  _mm_mul_ps(kk, _mm_set1_ps(dstep))));
+      ipos = _mm_cvttps_epi32(pos);
+      mu = _mm_sub_ps(pos, _mm_cvtepi32_ps(ipos));
+      _mm_storeu_si128((__m128i*)idx, ipos);
+
+      y0 = _mm_set_ps(sptr[idx[3]], sptr[idx[2]], sptr[idx[1]], sptr[idx[0]]);
+      y1 = _mm_set_ps(sptr[idx[3]+1], sptr[idx[2]+1],
+                      sptr[idx[1]+1], sptr[idx[0]+1]);
+      _mm_storeu_ps(dptr, _mm_add_ps(y0, _mm_mul_ps(_mm_sub_ps(y1, y0), mu)));
+      dptr += 4;
+
+      smu += 4.0f*bstep + 6.0f*dstep;
+      j = (size_t)smu;
+      sptr += j;
+      smu -= j;
+   }
+
+   for (b=4*n; i--; ++b)
+   {
+      *dptr++ = sptr[0] + (sptr[1] - sptr[0])*smu;
+
+      smu += step + b*dstep;
+      j = (size_t)smu;
+      sptr += j;
+      smu -= j;
+   }
+}
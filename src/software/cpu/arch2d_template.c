@@ -84,6 +84,47 @@ FN(aax_generate_waveform,A)(float32_ptr rv, size_t no_samples, float freq, float
    return rv;
 }
 
+/*
+ * Additive synthesis of the harmonics below the Nyquist frequency.
+ * Unlike aax_generate_waveform every harmonic starts at a multiple of the
+ * fundamental phase so rendering can resume at any phase. Every harmonic
+ * is a rotating phasor which only requires four multiplications per sample.
+ */
+float *
+FN(aax_generate_additive,A)(float32_ptr rv, size_t no_samples, float freq, float phase, enum aaxSourceType wtype)
+{
+   const_float32_ptr phases = _harmonic_phases[wtype-AAX_1ST_WAVE];
+   const_float32_ptr harmonics = _harmonics[wtype-AAX_1ST_WAVE];
+   int h;
+
+   memset(rv, 0, no_samples*sizeof(float));
+   for (h=0; h<MAX_HARMONICS; ++h)
+   {
+      float n = (float)(h+1);
+      float ngain = harmonics[h];
+
+      if (freq/n < 2.0f) break;    // higher than the nyquist-frequency
+      if (ngain)
+      {
+         float a = n*phase - GMATH_PI + GMATH_PI*phases[h];
+         float d = n*GMATH_2PI/freq;
+         float c = ngain*cosf(a), s = ngain*sinf(a);
+         float dc = cosf(d), ds = sinf(d);
+         float *ptr = rv;
+         size_t i;
+
+         for (i=0; i<no_samples; ++i)
+         {
+            float ns = s*dc + c*ds;
+            *ptr++ += s;
+            c = c*dc - s*ds;
+            s = ns;
+         }
+      }
+   }
+   return rv;
+}
+
 #define FC	50.0f // 50Hz high-pass EMA filter cutoff frequency
 float *
 FN(aax_generate_noise,A)(float32_ptr rv, size_t no_samples, uint64_t seed, unsigned char skip, float fs)
@@ -443,6 +484,41 @@ FN(batch_limit,A)(void_ptr dptr, const_void_ptr sptr, size_t num)
    }
 }
 
+/*
+ * 4x oversampled true-peak detection.
+ * sptr must hold TRUEPEAK_TAPS-1 samples of history before the first sample.
+ * dptr[i] = max(dptr[i], |interpolated samples around sptr[i]|)
+ */
+void
+FN(batch_get_truepeak,A)(void_ptr dptr, const_void_ptr sptr, size_t num)
+{
+   if (num)
+   {
+      float* d = (float*)dptr;
+      const float* s = (const float*)sptr;
+      size_t i = num;
+
+      do
+      {
+         float peak = *d;
+         int j, k;
+
+         for (k=0; k<TRUEPEAK_PHASES; ++k)
+         {
+            float samp = 0.0f;
+            for (j=0; j<TRUEPEAK_TAPS; ++j) {
+               samp += _truepeak_fir[j][k]*s[-j];
+            }
+            samp = fabsf(samp);
+            if (samp > peak) peak = samp;
+         }
+         *d++ = peak;
+         s++;
+      }
+      while (--i);
+   }
+}
+
 void
 FN(batch_atanps,A)(void_ptr dptr, const_void_ptr sptr, size_t num)
 {
@@ -1544,6 +1620,95 @@ FN(batch_freqfilter_float,A)(float32_ptr dptr, const_float32_ptr sptr, int t, si
    }
 }
 
+/*
+ * Filter all bands of an equalizer filter-bank from the same input and sum
+ * the results into dptr. dptr and sptr may point to the same buffer.
+ * Per band metering (rms and peak) is only calculated when meter is set.
+ */
+#define FILTER_BANK_CHUNK	64
+void
+FN(batch_freqfilter_bank,A)(float32_ptr dptr, const_float32_ptr sptr, int t, size_t num, void *data, bool meter)
+{
+   _aaxRingBufferEqualizerData *eq = (_aaxRingBufferEqualizerData*)data;
+   int b, no_bands = eq->no_bands;
+
+   if (num && no_bands)
+   {
+      double rms[_AAX_MAX_EQBANDS];
+      float peak[_AAX_MAX_EQBANDS];
+      float acc[FILTER_BANK_CHUNK];
+      float tmp[FILTER_BANK_CHUNK];
+      size_t pos = 0;
+
+      memset(rms, 0, sizeof(rms));
+      memset(peak, 0, sizeof(peak));
+      do
+      {
+         size_t i, n = _MIN(num-pos, FILTER_BANK_CHUNK);
+
+         memset(acc, 0, n*sizeof(float));
+         for (b=0; b<no_bands; ++b)
+         {
+            _aaxRingBufferFreqFilterData *filter = &eq->band[b];
+            float *hist = filter->freqfilter->history[t];
+            const_float32_ptr s = sptr+pos;
+            float *cptr = filter->coeff;
+            int stage = filter->no_stages;
+            float k = filter->k;
+
+            if (!stage) stage++;
+            while (stage--)
+            {
+               float h0 = hist[0];
+               float h1 = hist[1];
+
+               for (i=0; i<n; ++i)
+               {
+                  float smp = (s[i] * k) + h0 * cptr[0] + h1 * cptr[1];
+                  tmp[i] = smp           + h0 * cptr[2] + h1 * cptr[3];
+
+                  h1 = h0;
+                  h0 = smp;
+               }
+
+               *hist++ = h0;
+               *hist++ = h1;
+
+               s = tmp;
+               cptr += 4;
+               k = 1.0f;
+            }
+
+            k = filter->gain;
+            for (i=0; i<n; ++i)
+            {
+               float smp = tmp[i] * k;
+
+               acc[i] += smp;
+               if (meter)
+               {
+                  float val = smp*smp;
+                  rms[b] += val;
+                  if (val > peak[b]) peak[b] = val;
+               }
+            }
+         }
+         memcpy(dptr+pos, acc, n*sizeof(float));
+         pos += n;
+      }
+      while (pos < num);
+
+      if (meter)
+      {
+         for (b=0; b<no_bands; ++b)
+         {
+            eq->rms[b] = sqrt(rms[b]/num);
+            eq->peak[b] = sqrtf(peak[b]);
+         }
+      }
+   }
+}
+
 void
 FN(batch_convolution,A)(float32_ptr hcptr, const_float32_ptr cptr, const_float32_ptr sptr, unsigned int cnum, unsigned int dnum, int step, float v, float threshold)
 {
@@ -1782,3 +1947,96 @@ FN(batch_resample_float,A)(float32_ptr d, const_float32_ptr s, size_t dmin, size
       memcpy(d+dmin, s, (dmax-dmin)*sizeof(float));
    }
 }
+
+/*
+ * Resample with a step size which changes linearly from fact (at dmin) to
+ * fact_end (at dmax) to prevent stepped pitch changes at period boundaries.
+ * The number of source samples used is (dmax-dmin)*(fact+fact_end)/2.
+ */
+void
+FN(batch_resample_ramp_float,A)(float32_ptr dptr, const_float32_ptr sptr, size_t dmin, size_t dmax, float smu, float fact, float fact_end)
+{
+   float32_ptr s = (float32_ptr)sptr;
+   float32_ptr d = dptr;
+   float step, dstep;
+   size_t i, j;
+
+   assert(fact > 0.0f && fact_end > 0.0f);
+   assert(dptr != sptr);
+   assert(dmin < dmax);
+   assert(0.0f <= smu && smu < 1.0f);
+
+   if (fact == fact_end)
+   {
+      FN(batch_resample_float,A)(dptr, sptr, dmin, dmax, smu, fact);
+      return;
+   }
+
+   d += dmin;
+   i = dmax-dmin;
+
+   /* step(j) = fact + (j+0.5)*dstep, not accumulated to prevent drift */
+   dstep = (fact_end - fact)/i;
+   step = fact + 0.5f*dstep;
+   j = 0;
+
+   if (fact < CUBIC_TRESHOLD && fact_end < CUBIC_TRESHOLD)
+   {
+      float y0, y1, y2, y3, a0, a1, a2;
+
+      y0 = *s++;
+      y1 = *s++;
+      y2 = *s++;
+      y3 = *s++;
+
+      a0 = y3 - y2 - y0 + y1;
+      a1 = y0 - y1 - a0;
+      a2 = y2 - y0;
+
+      do
+      {
+         float smu2 = smu*smu;
+
+         *d++ = (a0*smu*smu2 + a1*smu2 + a2*smu + y1);
+
+         smu += step + (j++)*dstep;
+         if (smu >= 1.0f)
+         {
+            smu--;
+            y0 = y1;
+            y1 = y2;
+            y2 = y3;
+            y3 = *s++;
+            a0 = y3 - y2 - y0 + y1;
+            a1 = y0 - y1 - a0;
+            a2 = y2 - y0;
+         }
+      }
+      while (--i);
+   }
+   else
+   {
+      float samp, dsamp;
+
+      samp = *s++;		// n
+      dsamp = *s - samp;	// (n+1) - n
+
+      do
+      {
+         size_t n;
+
+         *d++ = samp + (dsamp * smu);
+
+         smu += step + (j++)*dstep;
+         n = (size_t)smu;
+         if (n)
+         {
+            smu -= n;
+            s += n-1;
+            samp = *s++;
+            dsamp = *s - samp;
+         }
+      }
+      while (--i);
+   }
+}
@@ -0,0 +1,407 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2005-2023 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2009-2023 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>	/* calloc, free */
+#include <string.h>	/* memset */
+#include <math.h>	/* cosf, sqrtf, atan2f, asinf */
+#include <assert.h>
+
+#include <api.h>
+#include <base/types.h>
+#include <base/memory.h>
+#include <base/geometry.h>
+
+#include "software/rbuf_int.h"
+
+/*
+ * Higher-order Ambisonics bus
+ *
+ * Every 3d emitter is encoded once into (order+1)^2 spherical harmonic
+ * channels (ACN channel order, SN3D normalization) which only takes one
+ * gain per channel, no matter how many speakers there are. Once per period
+ * the bus is decoded to the speaker layout of the mixer using a max-rE
+ * weighted sampling decoder which is normalized to unity energy.
+ *
+ * In HRTF mode the bus is decoded to the vertices of an icosahedron which
+ * are rendered as virtual speakers by the measured HRIR set, or to the
+ * two ears if no HRIR set is loaded.
+ *
+ * The Ambisonics axes are X front, Y left and Z up while the listener
+ * frame of the emitter directions is x right, y up and z front.
+ */
+#define AMBISONICS_NO_VIRTUAL	12
+
+typedef struct
+{
+   unsigned int order;
+   unsigned int no_channels;
+   size_t no_samples;
+   bool used;
+
+   float *channel[_AAX_MAX_AMBISONICS_CHANNELS];
+   float *scratch;
+
+   _aax2dProps *virt;		/* virtual speakers for the HRIR set */
+
+} _aaxAmbisonicsBus;
+
+/* the unit vector (X, Y, Z) of the icosahedron vertices */
+#define A	0.525731112f
+#define B	0.850650808f
+static const float _ambisonics_icosahedron[AMBISONICS_NO_VIRTUAL][3] = {
+   {  A,  B, 0.0f }, {  A, -B, 0.0f }, { -A,  B, 0.0f }, { -A, -B, 0.0f },
+   { 0.0f,  A,  B }, { 0.0f,  A, -B }, { 0.0f, -A,  B }, { 0.0f, -A, -B },
+   {  B, 0.0f,  A }, { -B, 0.0f,  A }, {  B, 0.0f, -A }, { -B, 0.0f, -A }
+};
+#undef A
+#undef B
+
+/* real SN3D spherical harmonics in ACN order for the unit vector X, Y, Z */
+static void
+_ambisonics_encode(float *sh, float X, float Y, float Z, unsigned int order)
+{
+   sh[0] = 1.0f;
+   if (order >= 1)
+   {
+      sh[1] = Y;
+      sh[2] = Z;
+      sh[3] = X;
+   }
+   if (order >= 2)
+   {
+      const float s3 = 1.732050808f;
+
+      sh[4] = s3*X*Y;
+      sh[5] = s3*Y*Z;
+      sh[6] = 0.5f*(3.0f*Z*Z - 1.0f);
+      sh[7] = s3*X*Z;
+      sh[8] = 0.5f*s3*(X*X - Y*Y);
+   }
+   if (order >= 3)
+   {
+      const float s58 = 0.790569415f;	/* sqrt(5/8)  */
+      const float s38 = 0.612372436f;	/* sqrt(3/8)  */
+      const float s15 = 3.872983346f;	/* sqrt(15)   */
+
+      sh[9]  = s58*Y*(3.0f*X*X - Y*Y);
+      sh[10] = s15*X*Y*Z;
+      sh[11] = s38*Y*(5.0f*Z*Z - 1.0f);
+      sh[12] = 0.5f*Z*(5.0f*Z*Z - 3.0f);
+      sh[13] = s38*X*(5.0f*Z*Z - 1.0f);
+      sh[14] = 0.5f*s15*Z*(X*X - Y*Y);
+      sh[15] = s58*X*(X*X - 3.0f*Y*Y);
+   }
+}
+
+/*
+ * Decoder matrix for no_speakers directions (X, Y, Z):
+ * D[t][c] = (2l+1) g(l) Y(c, t), normalized to unity energy where g(l) are
+ * the max-rE weights.
+ */
+static void
+_ambisonics_decoder(float *dec, const float (*spk)[3], unsigned int no_speakers, unsigned int order)
+{
+   unsigned int no_channels = (order+1)*(order+1);
+   float x, g[_AAX_MAX_AMBISONICS_ORDER+1];
+   float energy = 0.0f;
+   unsigned int t, c, l;
+
+   x = cosf(137.9f*GMATH_DEG_TO_RAD/(order+1.51f));
+   g[0] = 1.0f;
+   g[1] = x;
+   g[2] = 0.5f*(3.0f*x*x - 1.0f);
+   g[3] = 0.5f*(5.0f*x*x*x - 3.0f*x);
+
+   for (t=0; t<no_speakers; ++t)
+   {
+      float *d = dec + t*no_channels;
+
+      _ambisonics_encode(d, spk[t][0], spk[t][1], spk[t][2], order);
+      for (l=0; l<=order; ++l)
+      {
+         for (c=l*l; c<(l+1)*(l+1); ++c)
+         {
+            d[c] *= (2*l+1)*g[l];
+            energy += d[c]*d[c]/(2*l+1);
+         }
+      }
+   }
+
+   if (energy > 0.0f)
+   {
+      float norm = 1.0f/sqrtf(energy);
+      for (c=0; c<no_speakers*no_channels; ++c) {
+         dec[c] *= norm;
+      }
+   }
+}
+
+void
+_aaxRingBufferAmbisonicsDestroy(void *ptr)
+{
+   _aaxAmbisonicsBus *bus = ptr;
+   if (bus)
+   {
+      _aax_aligned_free(bus->channel[0]);
+      _aax_aligned_free(bus->virt);
+      free(bus);
+   }
+}
+
+static _aaxAmbisonicsBus*
+_ambisonics_create(unsigned int order, size_t no_samples)
+{
+   _aaxAmbisonicsBus *bus = calloc(1, sizeof(_aaxAmbisonicsBus));
+   if (bus)
+   {
+      unsigned int c, no_channels = (order+1)*(order+1);
+      size_t size = (no_channels+1)*no_samples*sizeof(float);
+      float *ptr;
+
+      bus->order = order;
+      bus->no_channels = no_channels;
+      bus->no_samples = no_samples;
+
+      ptr = _aax_aligned_alloc(size);
+      if (!ptr)
+      {
+         free(bus);
+         return NULL;
+      }
+      memset(ptr, 0, size);
+
+      for (c=0; c<no_channels; ++c)
+      {
+         bus->channel[c] = ptr;
+         ptr += no_samples;
+      }
+      bus->scratch = ptr;
+   }
+   return bus;
+}
+
+/* (re)create the bus of the ringbuffer when required */
+static _aaxAmbisonicsBus*
+_ambisonics_get(_aaxRingBufferSample *rbd)
+{
+   _aaxAmbisonicsBus *bus = rbd->ambisonics;
+
+   if (bus && (bus->order != rbd->ambisonics_order ||
+               bus->no_samples != rbd->no_samples))
+   {
+      _aaxRingBufferAmbisonicsDestroy(bus);
+      rbd->ambisonics = bus = NULL;
+   }
+
+   if (!bus && rbd->ambisonics_order && rbd->no_samples)
+   {
+      bus = _ambisonics_create(rbd->ambisonics_order, rbd->no_samples);
+      rbd->ambisonics = bus;
+   }
+
+   return bus;
+}
+
+void
+_aaxRingBufferMixMono16Ambisonics(_aaxRingBufferSample *drbd, CONST_MIX_PTRPTR_T sptr, UNUSED(const unsigned char *router), _aax2dProps *ep2d, unsigned char ch, size_t offs, size_t dno_samples, UNUSED(float fs), float gain, float svol, float evol)
+{
+   _aaxAmbisonicsBus *bus = _ambisonics_get(drbd);
+   float sh[_AAX_MAX_AMBISONICS_CHANNELS];
+   const float *dir = ep2d->direction.v4;
+   unsigned int c, l;
+
+   _AAX_LOG(LOG_DEBUG, __func__);
+
+   if (!bus) return;
+
+   assert(offs+dno_samples <= bus->no_samples);
+
+   /* listener frame to Ambisonics axes */
+   _ambisonics_encode(sh, dir[2], -dir[0], dir[1], bus->order);
+
+   /* nearby emitters are less directional */
+   for (l=1; l<=bus->order; ++l) {
+      for (c=l*l; c<(l+1)*(l+1); ++c) {
+         sh[c] *= dir[3];
+      }
+   }
+
+   /** Mix */
+   for (c=0; c<bus->no_channels; ++c)
+   {
+      MIX_T *dptr = bus->channel[c] + offs;
+      float vstart, vend, vstep;
+
+      vstart = ep2d->prev_sh_gain[c] * svol;
+      vend   = gain * sh[c] * evol;
+      vstep  = (vend - vstart) / dno_samples;
+
+      if (vstart != 0.0f || vend != 0.0f) {
+         drbd->add(dptr, sptr[ch]+offs, dno_samples, vstart, vstep);
+      }
+
+      ep2d->prev_sh_gain[c] = vend;
+   }
+   bus->used = true;
+}
+
+/* decode to the virtual speakers of the HRIR set */
+static bool
+_ambisonics_decode_hrir(_aaxRingBufferSample *rbd, _aaxAmbisonicsBus *bus,
+                        const unsigned char *router)
+{
+   float dec[AMBISONICS_NO_VIRTUAL*_AAX_MAX_AMBISONICS_CHANNELS];
+   size_t no_samples = bus->no_samples;
+   const MIX_T *sptr = bus->scratch;
+   unsigned int t, c;
+
+   if (!bus->virt)
+   {
+      size_t size = AMBISONICS_NO_VIRTUAL*sizeof(_aax2dProps);
+
+      bus->virt = _aax_aligned_alloc(size);
+      if (!bus->virt) return false;
+
+      memset(bus->virt, 0, size);
+      for (t=0; t<AMBISONICS_NO_VIRTUAL; ++t)
+      {
+         const float *v = _ambisonics_icosahedron[t];
+         _aax2dProps *vp2d = &bus->virt[t];
+
+         vp2d->prev_gain[0] = 1.0f;
+         vp2d->hrir_dir[0] = vp2d->hrir_dir_prev[0] = atan2f(v[1], v[0]);
+         vp2d->hrir_dir[1] = vp2d->hrir_dir_prev[1] = asinf(v[2]);
+         vp2d->hrir_dir_set = true;
+      }
+   }
+
+   _ambisonics_decoder(dec, _ambisonics_icosahedron, AMBISONICS_NO_VIRTUAL,
+                       bus->order);
+   for (t=0; t<AMBISONICS_NO_VIRTUAL; ++t)
+   {
+      const float *d = dec + t*bus->no_channels;
+
+      memset(bus->scratch, 0, no_samples*sizeof(float));
+      for (c=0; c<bus->no_channels; ++c) {
+         rbd->add(bus->scratch, bus->channel[c], no_samples, d[c], 0.0f);
+      }
+
+      if (!_aaxRingBufferHRIRMix(rbd, &sptr, router, &bus->virt[t], 0, 0,
+                                 no_samples, 1.0f, 1.0f, 1.0f))
+      {
+         return false;
+      }
+   }
+   return true;
+}
+
+/* decode the bus once per period, before the HRIR set is flushed */
+void
+_aaxRingBufferAmbisonicsFlush(_aaxRingBuffer *rb, const _aaxMixerInfo *info)
+{
+   _aaxRingBufferData *rbi = rb->handle;
+   _aaxRingBufferSample *rbd = rbi->sample;
+   _aaxAmbisonicsBus *bus = rbd->ambisonics;
+
+   if (bus && bus->used)
+   {
+      float dec[_AAX_MAX_SPEAKERS*_AAX_MAX_AMBISONICS_CHANNELS];
+      float spk[_AAX_MAX_SPEAKERS][3];
+      size_t no_samples = bus->no_samples;
+      unsigned int t, c, no_speakers = 0;
+      bool decoded = false;
+
+      if (info->mode == AAX_MODE_WRITE_HRTF)
+      {
+         decoded = _ambisonics_decode_hrir(rbd, bus, info->router);
+         if (!decoded)
+         {
+            no_speakers = 2;
+            spk[0][0] = 0.0f; spk[0][1] =  1.0f; spk[0][2] = 0.0f;
+            spk[1][0] = 0.0f; spk[1][1] = -1.0f; spk[1][2] = 0.0f;
+         }
+      }
+      else
+      {
+         no_speakers = _MIN(rbd->no_tracks, info->no_tracks);
+         no_speakers = _MIN(no_speakers, _AAX_MAX_SPEAKERS);
+         for (t=0; t<no_speakers; ++t)
+         {
+            const float *v = info->speaker[t].v4;
+            float len = sqrtf(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+            if (len > 0.0f) len = 1.0f/len;
+
+            spk[t][0] = v[2]*len;
+            spk[t][1] = -v[0]*len;
+            spk[t][2] = v[1]*len;
+         }
+      }
+
+      if (!decoded)
+      {
+         _ambisonics_decoder(dec, (const float (*)[3])spk, no_speakers,
+                             bus->order);
+         for (t=0; t<no_speakers; ++t)
+         {
+            MIX_T *dptr = rbd->track[info->router[t]];
+            const float *d = dec + t*bus->no_channels;
+
+            for (c=0; c<bus->no_channels; ++c)
+            {
+               if (d[c] != 0.0f) {
+                  rbd->add(dptr, bus->channel[c], no_samples, d[c], 0.0f);
+               }
+            }
+         }
+      }
+
+      for (c=0; c<bus->no_channels; ++c) {
+         memset(bus->channel[c], 0, no_samples*sizeof(float));
+      }
+      bus->used = false;
+   }
+}
+
+/* add the bus of a worker thread to that of the destination */
+void
+_aaxRingBufferAmbisonicsMerge(_aaxRingBuffer *drb, _aaxRingBuffer *srb)
+{
+   _aaxRingBufferData *drbi = drb->handle;
+   _aaxRingBufferData *srbi = srb->handle;
+   _aaxAmbisonicsBus *sbus = srbi->sample->ambisonics;
+
+   if (sbus && sbus->used)
+   {
+      _aaxRingBufferSample *drbd = drbi->sample;
+      _aaxAmbisonicsBus *dbus = _ambisonics_get(drbd);
+      size_t no_samples = sbus->no_samples;
+      unsigned int c;
+
+      if (dbus && (dbus->order != sbus->order ||
+                   dbus->no_samples != no_samples))
+      {
+         dbus = NULL;
+      }
+
+      for (c=0; c<sbus->no_channels; ++c)
+      {
+         if (dbus) {
+            drbd->add(dbus->channel[c], sbus->channel[c], no_samples,
+                      1.0f, 0.0f);
+         }
+         memset(sbus->channel[c], 0, no_samples*sizeof(float));
+      }
+      sbus->used = false;
+      if (dbus) dbus->used = true;
+   }
+}
@@ -18,6 +18,8 @@
 
 #include <dsp/filters.h>
 #include <dsp/effects.h>
+#include <dsp/automation.h>
+#include <dsp/dsp.h>
 
 #include <api.h>
 #include <arch.h>
@@ -150,8 +152,17 @@ _aaxRingBufferEffectsApply(_aaxRingBufferSample *rbd,
       freq =_FILTER_GET_DATA(p2d, FREQUENCY_FILTER);
       if (freq)
       {
+         _aaxAutomationData *automation = p2d->automation;
          float v = p2d->note.velocity;
-         r = freq->run(rbd, pdst, psrc, 0, end, ds, track, freq, env, v);
+
+         if (automation && automation->param[AUTOMATION_CUTOFF_FREQUENCY].active)
+         {
+            float fc = automation->param[AUTOMATION_CUTOFF_FREQUENCY].next;
+            r = _freqfilter_sweep_run(rbd, pdst, psrc, end, ds, track, freq, fc);
+         }
+         else {
+            r = freq->run(rbd, pdst, psrc, 0, end, ds, track, freq, env, v);
+         }
          if (r) BUFSWAP(pdst, psrc);
       }
    }
@@ -0,0 +1,871 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2005-2023 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2009-2023 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>	/* fopen, fread */
+#include <stdlib.h>	/* calloc, free */
+#include <string.h>	/* memcpy, memset */
+#include <math.h>	/* atan2f, asinf */
+#include <assert.h>
+
+#include <api.h>
+#include <base/fft.h>
+#include <base/types.h>
+#include <base/memory.h>
+#include <base/geometry.h>
+#include <base/xthreads.h>
+
+#include "software/rbuf_int.h"
+
+/*
+ * Measured HRIR binaural rendering
+ *
+ * The HRIR set is converted offline (e.g. from SOFA) to the following
+ * little-endian binary format:
+ *
+ *   char[4]  "AAXH"
+ *   uint32   version (1)
+ *   uint32   sample frequency in Hz
+ *   uint32   impulse response length in samples
+ *   uint32   number of elevation rings
+ *   per ring, in ascending order of elevation:
+ *     float32  elevation in degrees (-90 .. 90)
+ *     uint32   number of azimuths, equally spaced starting at 0 degrees
+ *              counter-clockwise (90 degrees is left) like SOFA
+ *     float32  impulse responses: [no_azimuths][left, right][length]
+ *
+ * Emitters are convolved in the frequency domain. Every emitter takes one
+ * forward FFT and a complex multiply-accumulate per ear into accumulators
+ * which are shared by all emitters of the destination ringbuffer. The
+ * HRIR spectra are calculated once per set and the inverse FFTs once per
+ * accumulator and period, no matter how many emitters are rendered.
+ *
+ * Emitters which changed direction are crossfaded at the input: the part
+ * which fades out is convolved with the previous direction and the part
+ * which fades in with the next direction. Both end up in the same
+ * accumulator, which keeps the convolution tails of both directions. The
+ * tail is added to the tracks after the ringbuffer is cleared for the next
+ * period.
+ */
+#define HRIR_MAGIC		"AAXH"
+#define HRIR_VERSION		1
+#define HRIR_MAX_LENGTH		4096
+#define HRIR_STATIC_RAD		0.0175f		// one degree
+
+typedef struct
+{
+   float elevation;		/* in radians */
+   unsigned int no_azimuths;
+   unsigned int offset;		/* index of the first direction */
+} _hrir_ring_t;
+
+typedef struct _hrir_spectra_s
+{
+   struct _hrir_spectra_s *next;
+   _aax_fft_t *fft;
+   float frequency;
+   unsigned int ir_len;		/* resampled impulse response length */
+   float *data;			/* [no_directions][2][fft_size+2] */
+} _hrir_spectra_t;
+
+typedef struct
+{
+   char *file;
+   bool bilinear;
+   atomic_int ref_counter;
+   unsigned int users;		/* loads of this set, under _hrir_mutex */
+
+   float frequency;
+   unsigned int ir_len;
+   unsigned int no_rings;
+   unsigned int no_directions;
+   _hrir_ring_t *ring;
+   float *ir;			/* [no_directions][2][ir_len] */
+
+   _aaxMutex *mutex;
+   _hrir_spectra_t *spectra;
+
+} _aaxHRIRSet;
+
+typedef struct
+{
+   _aaxHRIRSet *set;
+   _hrir_spectra_t *spectra;
+   int generation;		/* of the shared set when created */
+   unsigned int fft_size;
+   size_t no_samples;
+   size_t tail_len;
+   unsigned char router[2];
+   bool used;
+   bool tail_set;
+
+   float *input;		/* fft_size */
+   float *output;		/* fft_size */
+   float *spectrum;		/* fft_size+2 */
+   float *hrtf[2];		/* fft_size+2, bilinear interpolation */
+   float *acc[2];		/* fft_size+2 */
+   float *tail[2];		/* tail_len */
+
+} _aaxHRIRData;
+
+/*
+ * The loaded HRIR set is shared by all mixers. Every successful load
+ * returns a reference to its set which is handed back to unload, a set is
+ * only dropped when the last load of that set is gone.
+ *
+ * _hrir_generation changes whenever the shared set changes and is zero if
+ * no set is loaded. The convolution state of a ringbuffer keeps the set it
+ * was created with, so mixer threads only take _hrir_mutex when the
+ * generation changed.
+ */
+static _aaxHRIRSet *_hrir_set = NULL;
+static int _hrir_counter = 0;
+static atomic_int _hrir_generation = 0;
+static once_flag _hrir_once = ONCE_FLAG_INIT;
+static mtx_t _hrir_mutex;
+
+static void
+_hrir_init(void)
+{
+   mtx_init(&_hrir_mutex, mtx_plain);
+}
+
+/* a set without references is being destroyed and can not be used */
+static _aaxHRIRSet*
+_hrir_set_ref(_aaxHRIRSet *set)
+{
+   if (set && _aaxAtomicIntIncrement(&set->ref_counter) <= 1) {
+      set = NULL;
+   }
+   return set;
+}
+
+/* take a reference to the loaded HRIR set, if any, and its generation */
+static _aaxHRIRSet*
+_hrir_set_get(int *generation)
+{
+   _aaxHRIRSet *set;
+
+   call_once(&_hrir_once, _hrir_init);
+   mtx_lock(&_hrir_mutex);
+   set = _hrir_set_ref(_hrir_set);
+   *generation = atomic_load(&_hrir_generation);
+   mtx_unlock(&_hrir_mutex);
+
+   return set;
+}
+
+/* must be called with _hrir_mutex locked */
+static void
+_hrir_set_shared(_aaxHRIRSet *set)
+{
+   _hrir_set = set;
+   if (set)
+   {
+      if (++_hrir_counter <= 0) _hrir_counter = 1;
+      atomic_store(&_hrir_generation, _hrir_counter);
+   }
+   else {
+      atomic_store(&_hrir_generation, 0);
+   }
+}
+
+static void
+_hrir_set_release(_aaxHRIRSet *set)
+{
+   if (set && _aaxAtomicIntDecrement(&set->ref_counter) == 0)
+   {
+      _hrir_spectra_t *spectra = set->spectra;
+      while (spectra)
+      {
+         _hrir_spectra_t *next = spectra->next;
+         _aaxFFTDestroy(spectra->fft);
+         _aax_aligned_free(spectra->data);
+         free(spectra);
+         spectra = next;
+      }
+      if (set->mutex) _aaxMutexDestroy(set->mutex);
+      free(set->ring);
+      free(set->ir);
+      free(set->file);
+      free(set);
+   }
+}
+
+static bool
+_hrir_read32(uint8_t **ptr, size_t *len, uint32_t *u32)
+{
+   bool rv = false;
+   if (*len >= 4)
+   {
+      uint8_t *ch = *ptr;
+      *u32 = (uint32_t)ch[0] | (uint32_t)ch[1] << 8 |
+             (uint32_t)ch[2] << 16 | (uint32_t)ch[3] << 24;
+      *ptr += 4;
+      *len -= 4;
+      rv = true;
+   }
+   return rv;
+}
+
+static bool
+_hrir_readf(uint8_t **ptr, size_t *len, float *f)
+{
+   union { uint32_t u; float f; } v;
+   bool rv = _hrir_read32(ptr, len, &v.u);
+   if (rv) *f = v.f;
+   return rv;
+}
+
+static _aaxHRIRSet*
+_hrir_set_create(const char *file, uint8_t *buf, size_t len)
+{
+   _aaxHRIRSet *set = NULL;
+   uint32_t version, fs, ir_len, no_rings;
+   uint8_t *ptr = buf;
+
+   if (len < 20 || memcmp(ptr, HRIR_MAGIC, 4)) return NULL;
+   ptr += 4;
+   len -= 4;
+
+   if (!_hrir_read32(&ptr, &len, &version) ||
+       !_hrir_read32(&ptr, &len, &fs) ||
+       !_hrir_read32(&ptr, &len, &ir_len) ||
+       !_hrir_read32(&ptr, &len, &no_rings) ||
+       version != HRIR_VERSION || !fs || !ir_len || ir_len > HRIR_MAX_LENGTH ||
+       !no_rings || no_rings > 181)
+   {
+      return NULL;
+   }
+
+   set = calloc(1, sizeof(_aaxHRIRSet));
+   if (set)
+   {
+      size_t no_samples = 0;
+      unsigned int r;
+      bool ok = true;
+
+      set->ref_counter = 1;
+      set->frequency = (float)fs;
+      set->ir_len = ir_len;
+      set->no_rings = no_rings;
+      set->ring = calloc(no_rings, sizeof(_hrir_ring_t));
+      set->file = _aax_strdup(file);
+      set->mutex = _aaxMutexCreate(NULL);
+      if (!set->ring || !set->file || !set->mutex) ok = false;
+
+      for (r=0; ok && r<no_rings; ++r)
+      {
+         _hrir_ring_t *ring = &set->ring[r];
+         size_t size, i;
+         uint32_t no_az;
+         float *ir, el;
+
+         ok = _hrir_readf(&ptr, &len, &el);
+         ok &= _hrir_read32(&ptr, &len, &no_az);
+         if (!ok || !no_az || no_az > 3600 || el < -90.0f || el > 90.0f ||
+             (r && el*GMATH_DEG_TO_RAD <= set->ring[r-1].elevation))
+         {
+            ok = false;
+            break;
+         }
+
+         size = (size_t)no_az*2*ir_len;
+         if (len < size*sizeof(float))
+         {
+            ok = false;
+            break;
+         }
+
+         ir = realloc(set->ir, (no_samples+size)*sizeof(float));
+         if (!ir)
+         {
+            ok = false;
+            break;
+         }
+         set->ir = ir;
+
+         ring->elevation = el*GMATH_DEG_TO_RAD;
+         ring->no_azimuths = no_az;
+         ring->offset = set->no_directions;
+         set->no_directions += no_az;
+
+         ir += no_samples;
+         for (i=0; ok && i<size; ++i) {
+            ok = _hrir_readf(&ptr, &len, ir+i);
+         }
+         no_samples += size;
+      }
+
+      if (!ok)
+      {
+         _hrir_set_release(set);
+         set = NULL;
+      }
+   }
+
+   return set;
+}
+
+void*
+_aaxRingBufferHRIRLoad(const char *file, bool bilinear)
+{
+   _aaxHRIRSet *set = NULL;
+
+   if (!file || !*file) {
+      return set;
+   }
+
+   call_once(&_hrir_once, _hrir_init);
+   mtx_lock(&_hrir_mutex);
+   if (_hrir_set && !strcmp(_hrir_set->file, file))
+   {
+      set = _hrir_set_ref(_hrir_set);
+      if (set)
+      {
+         set->bilinear = bilinear;
+         set->users++;
+      }
+   }
+   mtx_unlock(&_hrir_mutex);
+   if (set) return set;
+
+   do
+   {
+      FILE *fp = fopen(file, "rb");
+      if (fp)
+      {
+         uint8_t *buf;
+         long len;
+
+         fseek(fp, 0, SEEK_END);
+         len = ftell(fp);
+         fseek(fp, 0, SEEK_SET);
+
+         buf = (len > 0) ? malloc(len) : NULL;
+         if (buf && fread(buf, 1, len, fp) == (size_t)len) {
+            set = _hrir_set_create(file, buf, len);
+         }
+         free(buf);
+         fclose(fp);
+      }
+   }
+   while (0);
+
+   if (set)
+   {
+      _aaxHRIRSet *prev;
+
+      // one reference for the shared set and one for this load
+      set = _hrir_set_ref(set);
+      set->bilinear = bilinear;
+      set->users = 1;
+
+      mtx_lock(&_hrir_mutex);
+      prev = _hrir_set;
+      _hrir_set_shared(set);
+      mtx_unlock(&_hrir_mutex);
+
+      _hrir_set_release(prev);
+   }
+   else {
+      _AAX_SYSLOG("hrir: unable to load the HRIR set");
+   }
+
+   return set;
+}
+
+void
+_aaxRingBufferHRIRUnload(void *ptr)
+{
+   _aaxHRIRSet *set = ptr;
+   _aaxHRIRSet *shared = NULL;
+
+   if (!set) return;
+
+   call_once(&_hrir_once, _hrir_init);
+   mtx_lock(&_hrir_mutex);
+   if (--set->users == 0 && _hrir_set == set)
+   {
+      shared = _hrir_set;
+      _hrir_set_shared(NULL);
+   }
+   mtx_unlock(&_hrir_mutex);
+
+   _hrir_set_release(shared);
+   _hrir_set_release(set);
+}
+
+/* HRIR spectra for one FFT size and mixer frequency */
+static _hrir_spectra_t*
+_hrir_get_spectra(_aaxHRIRSet *set, unsigned int fft_size, float fs)
+{
+   _hrir_spectra_t *spectra;
+
+   _aaxMutexLock(set->mutex);
+   spectra = set->spectra;
+   while (spectra && (spectra->fft->size != fft_size ||
+                      spectra->frequency != fs))
+   {
+      spectra = spectra->next;
+   }
+
+   if (!spectra && (spectra = calloc(1, sizeof(_hrir_spectra_t))) != NULL)
+   {
+      size_t stride = fft_size+2;
+      float *ir = malloc(fft_size*sizeof(float));
+
+      spectra->frequency = fs;
+      spectra->ir_len = ceilf(set->ir_len*fs/set->frequency);
+      spectra->fft = _aaxFFTCreate(fft_size);
+      spectra->data = _aax_aligned_alloc(set->no_directions*2*stride*sizeof(float));
+      if (ir && spectra->fft && spectra->data)
+      {
+         float fact = set->frequency/fs;
+         float gain = _MIN(1.0f/fact, 1.0f);
+         unsigned int d, i;
+
+         for (d=0; d<2*set->no_directions; ++d)
+         {
+            const float *sptr = set->ir + d*set->ir_len;
+
+            // linear interpolation to the mixer frequency
+            memset(ir, 0, fft_size*sizeof(float));
+            for (i=0; i<spectra->ir_len; ++i)
+            {
+               float pos = i*fact;
+               unsigned int p = (unsigned int)pos;
+               float mu = pos - p;
+
+               if (p+1 < set->ir_len) {
+                  ir[i] = gain*((1.0f-mu)*sptr[p] + mu*sptr[p+1]);
+               } else if (p < set->ir_len) {
+                  ir[i] = gain*(1.0f-mu)*sptr[p];
+               }
+            }
+            _aaxFFTForward(spectra->fft, spectra->data + d*stride, ir);
+         }
+
+         spectra->next = set->spectra;
+         set->spectra = spectra;
+      }
+      else
+      {
+         _aaxFFTDestroy(spectra->fft);
+         _aax_aligned_free(spectra->data);
+         free(spectra);
+         spectra = NULL;
+      }
+      free(ir);
+   }
+   _aaxMutexUnLock(set->mutex);
+
+   return spectra;
+}
+
+void
+_aaxRingBufferHRIRDestroy(void *ptr)
+{
+   _aaxHRIRData *hrir = ptr;
+   if (hrir)
+   {
+      _hrir_set_release(hrir->set);
+      _aax_aligned_free(hrir->input);
+      free(hrir);
+   }
+}
+
+static _aaxHRIRData*
+_hrir_create(_aaxHRIRSet *set, size_t no_samples, float fs)
+{
+   _aaxHRIRData *hrir = NULL;
+   unsigned int ir_len, fft_size;
+
+   ir_len = ceilf(set->ir_len*fs/set->frequency);
+   fft_size = get_pow2(no_samples + ir_len - 1);
+   if (fft_size < 4) fft_size = 4;
+
+   set = _hrir_set_ref(set);
+   hrir = set ? calloc(1, sizeof(_aaxHRIRData)) : NULL;
+   if (!hrir) {
+      _hrir_set_release(set);
+   }
+   else
+   {
+      size_t stride = fft_size+2;
+      size_t tail_len = fft_size - no_samples;
+      size_t size;
+      float *ptr;
+      int t;
+
+      hrir->set = set;
+      hrir->fft_size = fft_size;
+      hrir->no_samples = no_samples;
+      hrir->tail_len = tail_len;
+      hrir->router[0] = 0;
+      hrir->router[1] = 1;
+
+      hrir->spectra = _hrir_get_spectra(set, fft_size, fs);
+
+      size = 2*fft_size + 5*stride + 2*tail_len;
+      hrir->input = _aax_aligned_alloc(size*sizeof(float));
+      if (!hrir->spectra || !hrir->input)
+      {
+         _aaxRingBufferHRIRDestroy(hrir);
+         return NULL;
+      }
+      memset(hrir->input, 0, size*sizeof(float));
+
+      ptr = hrir->input + fft_size;
+      hrir->output = ptr;
+      ptr += fft_size;
+      hrir->spectrum = ptr;
+      ptr += stride;
+      for (t=0; t<2; ++t)
+      {
+         hrir->hrtf[t] = ptr;
+         ptr += stride;
+      }
+      for (t=0; t<2; ++t)
+      {
+         hrir->acc[t] = ptr;
+         ptr += stride;
+      }
+      for (t=0; t<2; ++t)
+      {
+         hrir->tail[t] = ptr;
+         ptr += tail_len;
+      }
+   }
+
+   return hrir;
+}
+
+/*
+ * (Re)create the convolution state of the ringbuffer when required.
+ * The state is reused without locking for as long as the shared set stays
+ * the same, which is the case for every emitter of the period.
+ */
+static _aaxHRIRData*
+_hrir_get(_aaxRingBufferSample *rbd)
+{
+   _aaxHRIRData *hrir = rbd->hrir;
+   int generation = atomic_load(&_hrir_generation);
+
+   if (hrir && hrir->generation == generation &&
+       hrir->no_samples == rbd->no_samples)
+   {
+      return hrir;
+   }
+
+   if (hrir)
+   {
+      _aaxRingBufferHRIRDestroy(hrir);
+      rbd->hrir = hrir = NULL;
+   }
+
+   if (generation && rbd->no_samples && rbd->no_tracks >= 2)
+   {
+      _aaxHRIRSet *set = _hrir_set_get(&generation);
+      if (set)
+      {
+         hrir = _hrir_create(set, rbd->no_samples, rbd->frequency_hz);
+         if (hrir) hrir->generation = generation;
+         rbd->hrir = hrir;
+      }
+      _hrir_set_release(set);
+   }
+
+   return hrir;
+}
+
+/* acc += x*h for n complex values */
+static void
+_hrir_cmadd(float *acc, const float *x, const float *h, size_t n)
+{
+   size_t i;
+   for (i=0; i<2*n; i += 2)
+   {
+      float xr = x[i], xi = x[i+1];
+      float hr = h[i], hi = h[i+1];
+
+      acc[i] += xr*hr - xi*hi;
+      acc[i+1] += xr*hi + xi*hr;
+   }
+}
+
+static void
+_hrir_convolve(_aaxHRIRData *hrir, const float dir[2])
+{
+   const _aaxHRIRSet *set = hrir->set;
+   const _hrir_ring_t *ring = set->ring;
+   size_t n = hrir->fft_size/2+1;
+   size_t stride = hrir->fft_size+2;
+   const float *data = hrir->spectra->data;
+   float az, el, pos, mu;
+   unsigned int r;
+   int t;
+
+   az = dir[0];
+   if (az < 0.0f) az += GMATH_2PI;
+   el = dir[1];
+
+   r = 0;
+   while (r+1 < set->no_rings && ring[r+1].elevation <= el) ++r;
+
+   mu = 0.0f;
+   if (r+1 < set->no_rings && el > ring[r].elevation) {
+      mu = (el - ring[r].elevation)/(ring[r+1].elevation - ring[r].elevation);
+   }
+
+   if (!set->bilinear)
+   {
+      unsigned int d;
+
+      if (mu > 0.5f) r++;
+      pos = rintf(az*ring[r].no_azimuths/GMATH_2PI);
+      d = ring[r].offset + ((unsigned int)pos % ring[r].no_azimuths);
+      for (t=0; t<2; ++t) {
+         _hrir_cmadd(hrir->acc[t], hrir->spectrum,
+                     data + (2*d+t)*stride, n);
+      }
+   }
+   else
+   {
+      unsigned int i, d[4];
+      float w[4];
+
+      for (i=0; i<2; ++i)
+      {
+         unsigned int rn = _MIN(r+i, set->no_rings-1);
+         unsigned int no_az = ring[rn].no_azimuths;
+         unsigned int p;
+         float f, wr;
+
+         pos = az*no_az/GMATH_2PI;
+         p = (unsigned int)pos;
+         f = pos - p;
+
+         wr = i ? mu : 1.0f-mu;
+         d[2*i] = ring[rn].offset + (p % no_az);
+         d[2*i+1] = ring[rn].offset + ((p+1) % no_az);
+         w[2*i] = wr*(1.0f-f);
+         w[2*i+1] = wr*f;
+      }
+
+      for (t=0; t<2; ++t)
+      {
+         float *h = hrir->hrtf[t];
+         size_t j;
+
+         for (j=0; j<2*n; ++j) {
+            h[j] = w[0]*data[(2*d[0]+t)*stride + j];
+         }
+         for (i=1; i<4; ++i)
+         {
+            const float *s = data + (2*d[i]+t)*stride;
+            if (w[i] == 0.0f) continue;
+            for (j=0; j<2*n; ++j) {
+               h[j] += w[i]*s[j];
+            }
+         }
+         _hrir_cmadd(hrir->acc[t], hrir->spectrum, h, n);
+      }
+   }
+   hrir->used = true;
+}
+
+static float
+_hrir_angle(float a, float b)
+{
+   float d = fabsf(a - b);
+   return (d > GMATH_PI) ? GMATH_2PI - d : d;
+}
+
+/*
+ * Returns false if no HRIR set is loaded and the caller should fall back
+ * to the HRTF approximation.
+ */
+bool
+_aaxRingBufferHRIRMix(_aaxRingBufferSample *drbd, CONST_MIX_PTRPTR_T sptr, const unsigned char *router, _aax2dProps *ep2d, unsigned char ch, size_t offs, size_t dno_samples, float gain, float svol, float evol)
+{
+   _aaxHRIRData *hrir = _hrir_get(drbd);
+   float vstart, vend, vstep;
+
+   if (!hrir) return false;
+
+   assert(offs+dno_samples <= hrir->no_samples);
+
+   vstart = ep2d->prev_gain[0] * svol;
+   vend   = gain * evol;
+   vstep  = (vend - vstart) / dno_samples;
+
+   memset(hrir->input, 0, hrir->fft_size*sizeof(float));
+   drbd->add(hrir->input+offs, sptr[ch]+offs, dno_samples, vstart, vstep);
+   ep2d->prev_gain[0] = vend;
+
+   if (!ep2d->hrir_dir_set)
+   {
+      ep2d->hrir_dir_prev[0] = ep2d->hrir_dir[0];
+      ep2d->hrir_dir_prev[1] = ep2d->hrir_dir[1];
+      ep2d->hrir_dir_set = true;
+   }
+
+   if (_hrir_angle(ep2d->hrir_dir[0], ep2d->hrir_dir_prev[0]) < HRIR_STATIC_RAD &&
+       fabsf(ep2d->hrir_dir[1] - ep2d->hrir_dir_prev[1]) < HRIR_STATIC_RAD)
+   {
+      _aaxFFTForward(hrir->spectra->fft, hrir->spectrum, hrir->input);
+      _hrir_convolve(hrir, ep2d->hrir_dir_prev);
+   }
+   else
+   {
+      float *fade_in = hrir->output;
+      float w, dw = 1.0f/hrir->no_samples;
+      size_t j;
+
+      // crossfade over the period, output is only used by the flush
+      memset(fade_in, 0, hrir->fft_size*sizeof(float));
+      w = offs*dw;
+      for (j=offs; j<offs+dno_samples; ++j)
+      {
+         fade_in[j] = w*hrir->input[j];
+         hrir->input[j] -= fade_in[j];
+         w += dw;
+      }
+
+      _aaxFFTForward(hrir->spectra->fft, hrir->spectrum, hrir->input);
+      _hrir_convolve(hrir, ep2d->hrir_dir_prev);
+
+      _aaxFFTForward(hrir->spectra->fft, hrir->spectrum, fade_in);
+      _hrir_convolve(hrir, ep2d->hrir_dir);
+
+      ep2d->hrir_dir_prev[0] = ep2d->hrir_dir[0];
+      ep2d->hrir_dir_prev[1] = ep2d->hrir_dir[1];
+   }
+
+   hrir->router[0] = router[0];
+   hrir->router[1] = router[1];
+
+   return true;
+}
+
+/* add the convolution tail of the previous period to the cleared tracks */
+void
+_aaxRingBufferHRIRClear(_aaxRingBufferSample *rbd)
+{
+   _aaxHRIRData *hrir = rbd->hrir;
+   if (hrir && hrir->tail_set)
+   {
+      size_t no_samples = _MIN(hrir->tail_len, hrir->no_samples);
+      size_t remain = hrir->tail_len - no_samples;
+      int t;
+
+      for (t=0; t<2; ++t)
+      {
+         MIX_T *dptr = rbd->track[hrir->router[t]];
+         float *tail = hrir->tail[t];
+
+         rbd->add(dptr, tail, no_samples, 1.0f, 0.0f);
+         if (remain) memmove(tail, tail+no_samples, remain*sizeof(float));
+         memset(tail+remain, 0, no_samples*sizeof(float));
+      }
+      hrir->tail_set = (remain > 0);
+   }
+}
+
+/* one inverse FFT per ear for all emitters of this period */
+void
+_aaxRingBufferHRIRFlush(_aaxRingBuffer *rb)
+{
+   _aaxRingBufferData *rbi = rb->handle;
+   _aaxRingBufferSample *rbd = rbi->sample;
+   _aaxHRIRData *hrir = rbd->hrir;
+
+   if (hrir && hrir->used)
+   {
+      size_t no_samples = hrir->no_samples;
+      size_t tail_len = hrir->tail_len;
+      size_t stride = hrir->fft_size+2;
+      float *out = hrir->output;
+      int t;
+
+      for (t=0; t<2; ++t)
+      {
+         MIX_T *dptr = rbd->track[hrir->router[t]];
+         float *tail = hrir->tail[t];
+         size_t j;
+
+         _aaxFFTInverse(hrir->spectra->fft, out, hrir->acc[t]);
+         memset(hrir->acc[t], 0, stride*sizeof(float));
+
+         rbd->add(dptr, out, no_samples, 1.0f, 0.0f);
+         for (j=0; j<tail_len; ++j) {
+            tail[j] += out[no_samples+j];
+         }
+      }
+
+      hrir->used = false;
+      hrir->tail_set = true;
+   }
+}
+
+/* add the accumulators of a worker thread to those of the destination */
+void
+_aaxRingBufferHRIRMerge(_aaxRingBuffer *drb, _aaxRingBuffer *srb)
+{
+   _aaxRingBufferData *drbi = drb->handle;
+   _aaxRingBufferData *srbi = srb->handle;
+   _aaxHRIRData *shrir = srbi->sample->hrir;
+
+   if (shrir && shrir->used)
+   {
+      _aaxHRIRData *dhrir = _hrir_get(drbi->sample);
+      size_t stride = shrir->fft_size+2;
+      int t;
+
+      if (dhrir && dhrir->fft_size != shrir->fft_size) dhrir = NULL;
+      for (t=0; t<2; ++t)
+      {
+         float *sacc = shrir->acc[t];
+         if (dhrir)
+         {
+            float *dacc = dhrir->acc[t];
+            size_t j;
+
+            for (j=0; j<stride; ++j) {
+               dacc[j] += sacc[j];
+            }
+         }
+         memset(sacc, 0, stride*sizeof(float));
+      }
+      shrir->used = false;
+
+      if (dhrir)
+      {
+         dhrir->used = true;
+         dhrir->router[0] = shrir->router[0];
+         dhrir->router[1] = shrir->router[1];
+      }
+   }
+}
+
+/* hand the convolution state (and tail) over to the next ringbuffer */
+void
+_aaxRingBufferHRIRSwap(_aaxRingBuffer *rb1, _aaxRingBuffer *rb2)
+{
+   _aaxRingBufferData *rbi1 = rb1->handle;
+   _aaxRingBufferData *rbi2 = rb2->handle;
+   void *hrir = rbi1->sample->hrir;
+
+   rbi1->sample->hrir = rbi2->sample->hrir;
+   rbi2->sample->hrir = hrir;
+}
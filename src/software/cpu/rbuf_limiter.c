@@ -31,6 +31,10 @@
 #include "cpu/arch2d_simd.h"
 #endif
 
+#include <stdlib.h>	/* calloc, free */
+#include <string.h>	/* memcpy, memset */
+#include <math.h>	/* rintf, expf */
+
 #include <base/types.h>
 
 #include "software/rbuf_int.h"
@@ -89,3 +93,297 @@ _aaxRingBufferCompress(MIX_PTR_T d, size_t dmax, UNUSED(float clip), UNUSED(floa
 {
    _batch_limit(d, d, dmax);
 }
+
+/*
+ * Lookahead true-peak limiter
+ *
+ * The true-peak of every track is detected with a 4x oversampling
+ * interpolator and the maximum of all tracks is used to calculate one
+ * gain for all tracks so the stereo image stays intact.
+ *
+ * The gain reduction is calculated from the sliding window maximum of the
+ * detected peaks (a monotonic queue, O(1) per sample) followed by an
+ * instant-attack, exponential release filter and a moving average of the
+ * same window length. The moving average guarantees the gain has reached
+ * its target when the peak leaves the lookahead delay-line.
+ */
+#define LIMITER_CEILING		(0.891251f*AAX_PEAK_MAX)	// -1 dBTP
+#define LIMITER_RELEASE		0.060f
+#define TRUEPEAK_HISTORY	(TRUEPEAK_TAPS-1)
+#define TRUEPEAK_DELAY		6	// interpolator group delay in samples
+
+typedef struct
+{
+   float lookahead_sec;
+   float frequency_hz;
+   unsigned int no_tracks;
+   size_t max_samples;
+
+   size_t delay;		// lookahead delay-line length in samples
+   size_t window;		// sliding maximum and moving average length
+   size_t delay_pos;
+
+   MIX_T *delay_line[RB_MAX_TRACKS];
+   MIX_T *history[RB_MAX_TRACKS];
+   MIX_T *input;		// TRUEPEAK_HISTORY+max_samples
+   MIX_T *peak;			// detected peaks, and later the gain
+
+   // sliding window maximum
+   float *queue_value;
+   size_t *queue_idx;
+   size_t queue_head, queue_len;
+   size_t sample_no;
+
+   // gain smoothing
+   float *average;
+   size_t average_pos;
+   double average_sum;
+   float release_gain;
+   float release;
+
+} _aaxLimiterData;
+
+void
+_aaxRingBufferTruePeakLimiterDestroy(void *ptr)
+{
+   _aaxLimiterData *limiter = ptr;
+   if (limiter)
+   {
+      unsigned int t;
+
+      for (t=0; t<limiter->no_tracks; ++t)
+      {
+         _aax_aligned_free(limiter->delay_line[t]);
+         _aax_aligned_free(limiter->history[t]);
+      }
+      _aax_aligned_free(limiter->input);
+      _aax_aligned_free(limiter->peak);
+      free(limiter->queue_value);
+      free(limiter->queue_idx);
+      free(limiter->average);
+      free(limiter);
+   }
+}
+
+static _aaxLimiterData*
+_aaxRingBufferTruePeakLimiterCreate(float lookahead, float fs, unsigned int tracks, size_t no_samples)
+{
+   _aaxLimiterData *limiter;
+
+   limiter = calloc(1, sizeof(_aaxLimiterData));
+   if (limiter)
+   {
+      size_t t, delay, window;
+      bool ok = true;
+
+      delay = (size_t)rintf(lookahead*fs);
+      if (delay <= TRUEPEAK_DELAY) delay = TRUEPEAK_DELAY+1;
+      window = delay - TRUEPEAK_DELAY + 1;
+
+      limiter->lookahead_sec = lookahead;
+      limiter->frequency_hz = fs;
+      limiter->no_tracks = tracks;
+      limiter->max_samples = no_samples;
+      limiter->delay = delay;
+      limiter->window = window;
+      limiter->release_gain = 1.0f;
+      limiter->release = 1.0f - expf(-1.0f/(LIMITER_RELEASE*fs));
+
+      for (t=0; t<tracks; ++t)
+      {
+         limiter->delay_line[t] = _aax_aligned_alloc(delay*sizeof(MIX_T));
+         limiter->history[t] = _aax_aligned_alloc(TRUEPEAK_HISTORY*sizeof(MIX_T));
+         if (!limiter->delay_line[t] || !limiter->history[t])
+         {
+            ok = false;
+            break;
+         }
+         memset(limiter->delay_line[t], 0, delay*sizeof(MIX_T));
+         memset(limiter->history[t], 0, TRUEPEAK_HISTORY*sizeof(MIX_T));
+      }
+
+      limiter->input = _aax_aligned_alloc((TRUEPEAK_HISTORY+no_samples)*sizeof(MIX_T));
+      limiter->peak = _aax_aligned_alloc(no_samples*sizeof(MIX_T));
+      limiter->queue_value = malloc(window*sizeof(float));
+      limiter->queue_idx = malloc(window*sizeof(size_t));
+      limiter->average = malloc(window*sizeof(float));
+      if (!limiter->input || !limiter->peak || !limiter->queue_value ||
+          !limiter->queue_idx || !limiter->average)
+      {
+         ok = false;
+      }
+
+      if (ok)
+      {
+         for (t=0; t<window; ++t) {
+            limiter->average[t] = 1.0f;
+         }
+         limiter->average_sum = (double)window;
+      }
+      else
+      {
+         _aaxRingBufferTruePeakLimiterDestroy(limiter);
+         limiter = NULL;
+      }
+   }
+   return limiter;
+}
+
+/* convert the linked peak values to the gain for every sample */
+static void
+_aaxLimiterGetGain(_aaxLimiterData *limiter, size_t no_samples)
+{
+   float *queue_value = limiter->queue_value;
+   size_t *queue_idx = limiter->queue_idx;
+   size_t queue_head = limiter->queue_head;
+   size_t queue_len = limiter->queue_len;
+   size_t sample_no = limiter->sample_no;
+   float *average = limiter->average;
+   size_t average_pos = limiter->average_pos;
+   double average_sum = limiter->average_sum;
+   float release_gain = limiter->release_gain;
+   float release = limiter->release;
+   size_t window = limiter->window;
+   float iwindow = 1.0f/window;
+   MIX_T *ptr = limiter->peak;
+   size_t i, tail;
+
+   for (i=0; i<no_samples; ++i)
+   {
+      float peak = ptr[i];
+      float gain;
+
+      // remove the maximum if it left the window
+      if (queue_len && queue_idx[queue_head] + window <= sample_no)
+      {
+         if (++queue_head == window) queue_head = 0;
+         queue_len--;
+      }
+
+      // remove the samples from the back which can never become the maximum
+      while (queue_len)
+      {
+         tail = queue_head + queue_len - 1;
+         if (tail >= window) tail -= window;
+         if (queue_value[tail] > peak) break;
+         queue_len--;
+      }
+
+      tail = queue_head + queue_len;
+      if (tail >= window) tail -= window;
+      queue_value[tail] = peak;
+      queue_idx[tail] = sample_no;
+      queue_len++;
+      sample_no++;
+
+      peak = queue_value[queue_head];
+      gain = (peak > LIMITER_CEILING) ? LIMITER_CEILING/peak : 1.0f;
+
+      // instant attack, exponential release
+      if (gain < release_gain) release_gain = gain;
+      else release_gain += (gain - release_gain)*release;
+
+      // moving average
+      average_sum += release_gain - average[average_pos];
+      average[average_pos] = release_gain;
+      if (++average_pos == window)
+      {
+         size_t j;
+
+         // prevent accumulating rounding errors
+         average_sum = 0.0;
+         for (j=0; j<window; ++j) {
+            average_sum += average[j];
+         }
+         average_pos = 0;
+      }
+
+      ptr[i] = (MIX_T)average_sum*iwindow;
+   }
+
+   limiter->queue_head = queue_head;
+   limiter->queue_len = queue_len;
+   limiter->sample_no = sample_no;
+   limiter->average_pos = average_pos;
+   limiter->average_sum = average_sum;
+   limiter->release_gain = release_gain;
+}
+
+/* delay the signal by the lookahead time and apply the gain */
+static void
+_aaxLimiterApply(MIX_PTR_T d, MIX_PTR_T delay_line, CONST_MIX_PTR_T gain, size_t num)
+{
+   size_t i;
+   for (i=0; i<num; ++i)
+   {
+      MIX_T samp = delay_line[i];
+      delay_line[i] = d[i];
+      d[i] = samp*gain[i];
+   }
+}
+
+void
+_aaxRingBufferTruePeakLimiter(_aaxRingBufferSample *rbd, MIX_T **tracks, unsigned int no_tracks, size_t no_samples)
+{
+   _aaxLimiterData *limiter = rbd->limiter;
+   size_t pos = 0;
+   unsigned int t;
+
+   if (!no_samples || !no_tracks) return;
+
+   if (!limiter || limiter->lookahead_sec != rbd->lookahead_sec ||
+       limiter->frequency_hz != rbd->frequency_hz ||
+       limiter->no_tracks != no_tracks || limiter->max_samples < no_samples)
+   {
+      _aaxRingBufferTruePeakLimiterDestroy(limiter);
+      limiter = _aaxRingBufferTruePeakLimiterCreate(rbd->lookahead_sec,
+                                   rbd->frequency_hz, no_tracks, no_samples);
+      rbd->limiter = limiter;
+      if (!limiter)
+      {
+         for (t=0; t<no_tracks; ++t) {
+            _aaxRingBufferCompress(tracks[t], no_samples, 0.0f, 0.0f);
+         }
+         return;
+      }
+   }
+
+   // detect the linked true-peak of all tracks
+   memset(limiter->peak, 0, no_samples*sizeof(MIX_T));
+   for (t=0; t<no_tracks; ++t)
+   {
+      MIX_T *input = limiter->input + TRUEPEAK_HISTORY;
+      MIX_T *history = limiter->history[t];
+
+      memcpy(input-TRUEPEAK_HISTORY, history, TRUEPEAK_HISTORY*sizeof(MIX_T));
+      memcpy(input, tracks[t], no_samples*sizeof(MIX_T));
+      _batch_get_truepeak(limiter->peak, input, no_samples);
+      memcpy(history, input+no_samples-TRUEPEAK_HISTORY,
+                      TRUEPEAK_HISTORY*sizeof(MIX_T));
+   }
+
+   _aaxLimiterGetGain(limiter, no_samples);
+
+   for (t=0; t<no_tracks; ++t)
+   {
+      MIX_T *delay_line = limiter->delay_line[t];
+      MIX_T *dptr = tracks[t];
+      MIX_T *gain = limiter->peak;
+      size_t i = no_samples;
+
+      pos = limiter->delay_pos;
+      do
+      {
+         size_t num = _MIN(i, limiter->delay - pos);
+
+         _aaxLimiterApply(dptr, delay_line+pos, gain, num);
+         dptr += num;
+         gain += num;
+         pos += num;
+         if (pos == limiter->delay) pos = 0;
+         i -= num;
+      }
+      while (i);
+   }
+   limiter->delay_pos = pos;
+}
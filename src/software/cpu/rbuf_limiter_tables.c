@@ -702,3 +702,24 @@ const float _limiter_tbl[2][2048] = {
  }
 };
 
+
+/*
+ * 48-tap, 4x oversampling interpolation filter for true-peak detection,
+ * Kaiser windowed sinc (beta = 6), split into four polyphase components.
+ * Every row holds one tap for all four phases, every phase has unity gain.
+ * The group delay is 5.875 samples.
+ */
+const float _truepeak_fir[12][4] = {
+ { -0.00030842f, -0.00147944f, -0.00252347f, -0.00163527f },
+ {  0.00241573f,  0.00826450f,  0.01134447f,  0.00628911f },
+ { -0.00824538f, -0.02565848f, -0.03261491f, -0.01697787f },
+ {  0.02114383f,  0.06314362f,  0.07777947f,  0.03962823f },
+ { -0.04883820f, -0.14624827f, -0.18376748f, -0.09786733f },
+ {  0.13098881f,  0.45618121f,  0.77557877f,  0.97340677f },
+ {  0.97340677f,  0.77557877f,  0.45618121f,  0.13098881f },
+ { -0.09786733f, -0.18376748f, -0.14624827f, -0.04883820f },
+ {  0.03962823f,  0.07777947f,  0.06314362f,  0.02114383f },
+ { -0.01697787f, -0.03261491f, -0.02565848f, -0.00824538f },
+ {  0.00628911f,  0.01134447f,  0.00826450f,  0.00241573f },
+ { -0.00163527f, -0.00252347f, -0.00147944f, -0.00030842f }
+};
@@ -228,6 +228,13 @@ _aaxRingBufferMixMono16HRTF(_aaxRingBufferSample *drbd, CONST_MIX_PTRPTR_T sptr,
 
    _AAX_LOG(LOG_DEBUG, __func__);
 
+   /* measured HRIR set */
+   if (_aaxRingBufferHRIRMix(drbd, sptr, router, ep2d, ch, offs, dno_samples,
+                             gain, svol, evol))
+   {
+      return;
+   }
+
    // compensate for a combined gain of 1.45 below
 // gain *= 0.69f;
 
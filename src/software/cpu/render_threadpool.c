@@ -401,8 +401,12 @@ _aaxWorkerThread(void *id)
          {
             int max = _aaxAtomicIntSub(&handle->max_emitters,
                                        _AAX_MIN_EMITTERS_PER_WORKER);
+            int order = data->drb->get_parami(data->drb, RB_AMBISONICS_ORDER);
             int r = false;
 
+            /* our ringbuffer was duplicated from the first destination */
+            drb->set_parami(drb, RB_AMBISONICS_ORDER, order);
+
              /*
              * It might be possible that other threads aleady processed
              * all emitters which causes max to turn negative here.
@@ -436,6 +440,8 @@ _aaxWorkerThread(void *id)
 
                /* mix our own ringbuffer with that of the mixer */
                _aaxMutexLock(handle->mutex);
+               _aaxRingBufferAmbisonicsMerge(data->drb, drb);
+               _aaxRingBufferHRIRMerge(data->drb, drb);
                data->drb->data_mix(data->drb, drb, NULL, AAX_TRACK_ALL);
                _aaxMutexUnLock(handle->mutex);
 
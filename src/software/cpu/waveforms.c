@@ -19,6 +19,7 @@
 #  include <unistd.h>
 # endif
 #endif
+#include <string.h>	/* for memset() */
 #include <math.h>	/* for floorf() */
 #include <time.h>	/* for time() */
 #include <assert.h>
@@ -45,8 +46,10 @@ static void _aax_noise_filter(float32_ptr, const_float32_ptr, size_t, float, flo
 static void _aax_pinknoise_filter(float32_ptr, size_t, float);
 static void _aax_add_data(int32_t*, const_float32_ptr, unsigned int, float, limitType);
 static void _aax_mul_data(int32_t*, const_float32_ptr, unsigned int, float, limitType);
+static void _bufferGenerateBandLimited(float32_ptr, size_t, float, float, enum aaxSourceType);
 
 _aax_generate_waveform_proc _aax_generate_waveform_float = _aax_generate_waveform_cpu;
+_aax_generate_waveform_proc _aax_generate_additive_float = _aax_generate_additive_cpu;
 _aax_generate_noise_proc _aax_generate_noise_float = _aax_generate_noise_cpu;
 
 
@@ -164,6 +167,78 @@ _bufferMixWaveform(int32_t* data, _data_t *scratch, enum aaxSourceType wtype, fl
    }
 }
 
+/*
+ * Render the oscillators of a live voice at the mixer frequency.
+ * The voice is mixed the same way _bufferMixWaveform mixes the layers of
+ * an offline rendered AAXS sound (tanh limited) but in the float domain.
+ *
+ * The first ddesamps samples are generated by rewinding the phase so the
+ * delay effects section is continuous, the stored phase only advances by
+ * no_samples.
+ *
+ * The oscillators and the gains use the SIMD functions. tanhf stays scalar,
+ * it takes about two thirds of the render time of a voice.
+ */
+void
+_bufferRenderSynthVoice(MIX_PTR_T dst, MIX_PTR_T scratch, const _aaxSynthVoice *voice, float *phases, size_t ddesamps, size_t no_samples, float fs, float pitch)
+{
+   size_t j, samples = ddesamps + no_samples;
+   unsigned int i;
+
+   memset(dst, 0, samples*sizeof(MIX_T));
+   for (i=0; i<voice->no_oscillators; ++i)
+   {
+      const _aaxSynthOscillator *osc = &voice->osc[i];
+      int wave = osc->wtype & ~AAX_PURE_WAVEFORM;
+      bool type = osc->wtype & AAX_PURE_WAVEFORM;
+      float freq = voice->frequency*osc->freq_fact*pitch;
+      float phase, samps_period, gain;
+
+      if (osc->pre_gain == 0.0f) {
+         memset(dst, 0, samples*sizeof(MIX_T));
+      } else if (osc->pre_gain != 1.0f) {
+         _batch_fmul_value(dst, dst, samples, osc->pre_gain, 1.0f);
+      }
+
+      if (freq <= 0.0f) continue;
+
+      samps_period = fs/freq;
+      phase = phases[i] - GMATH_2PI*ddesamps/samps_period;
+      phase = fmodf(phase, GMATH_2PI);
+      if (phase < 0.0f) phase += GMATH_2PI;
+
+      phases[i] = fmodf(phases[i] + GMATH_2PI*no_samples/samps_period,
+                        GMATH_2PI);
+
+      gain = osc->gain;
+      gain *= osc->v0 ? _gains_v0[wave-AAX_1ST_WAVE][type]
+                      : _gains[wave-AAX_1ST_WAVE][type];
+
+      // everything above the Nyquist frequency would only add aliasing
+      if (gain == 0.0f || 2.0f*freq >= fs) continue;
+
+      _bufferGenerateBandLimited(scratch, samples, samps_period, phase,
+                                 osc->wtype);
+      if (osc->modulate)
+      {
+         gain = fabsf(gain);
+         for (j=0; j<samples; ++j) {
+            scratch[j] = tanhf(scratch[j]*gain);
+         }
+         _batch_fmul(dst, scratch, samples);
+      }
+      else
+      {
+         _batch_fmadd(dst, scratch, samples, gain, 0.0f);
+         for (j=0; j<samples; ++j) {
+            dst[j] = tanhf(dst[j])*GMATH_1_PI_2;
+         }
+      }
+   }
+
+   _batch_fmul_value(dst, dst, samples, AAX_PEAK_MAX, 1.0f);
+}
+
 void
 _bufferMixWhiteNoise(int32_t* data, _data_t *scratch, size_t no_samples, float rate, float gain, float fs, uint64_t seed, unsigned char skip, bool modulate, limitType limiter)
 {
@@ -251,6 +326,97 @@ _bufferMixBrownianNoise(int32_t* data, _data_t *scratch, size_t no_samples, floa
    }
 }
 
+/*
+ * Polynomial band-limited step: the residual of a unit step (from -1 to 1)
+ * smoothed over one sample at either side of the discontinuity.
+ * t is the normalized phase relative to the step, dt the phase increment.
+ */
+static inline float
+_aax_polyblep(float t, float dt)
+{
+   float rv = 0.0f;
+   if (t < dt)
+   {
+      t /= dt;
+      rv = t + t - t*t - 1.0f;
+   }
+   else if (t > 1.0f - dt)
+   {
+      t = (t - 1.0f)/dt;
+      rv = t*t + t + t + 1.0f;
+   }
+   return rv;
+}
+
+/*
+ * Pure waveforms with a discontinuity (sawtooth, square, pulse and impulse)
+ * are generated using PolyBLEP, the other waveforms are generated by the
+ * additive generator or don't need band-limiting at all.
+ */
+static void
+_bufferGenerateBandLimited(float32_ptr rv, size_t no_samples, float freq, float phase, enum aaxSourceType wtype)
+{
+   int wave = wtype & ~AAX_PURE_WAVEFORM;
+   float ngain, edge, dt, t;
+   float *ptr = rv;
+   size_t i;
+
+   if (!(wtype & AAX_PURE_WAVEFORM))
+   {
+      _aax_generate_additive_float(rv, no_samples, freq, phase, wtype);
+      return;
+   }
+   else if (wave == AAX_SINE || wave == AAX_CYCLOID)
+   {
+      _bufferGenerateWaveform(rv, no_samples, freq, phase, wtype);
+      return;
+   }
+
+   ngain = _harmonics[wave-AAX_1ST_WAVE][0];
+   t = phase/GMATH_2PI;
+   dt = 1.0f/freq;
+
+   switch(wave)
+   {
+   case AAX_SAWTOOTH:
+      for (i=0; i<no_samples; ++i)
+      {
+         *ptr++ = ngain*(2.0f*t - 1.0f - _aax_polyblep(t, dt));
+         if ((t += dt) >= 1.0f) t -= 1.0f;
+      }
+      break;
+   case AAX_TRIANGLE:
+      for (i=0; i<no_samples; ++i)
+      {
+         *ptr++ = ngain*((t < 0.5f) ? 4.0f*t - 1.0f : 3.0f - 4.0f*t);
+         if ((t += dt) >= 1.0f) t -= 1.0f;
+      }
+      break;
+   case AAX_SQUARE:
+   case AAX_PULSE:
+   case AAX_IMPULSE:
+      if (wave == AAX_SQUARE) edge = 0.5f;
+      else if (wave == AAX_PULSE) edge = 0.75f;
+      else edge = 0.975f;
+
+      // a rising edge at t == edge and a falling edge at t == 0
+      for (i=0; i<no_samples; ++i)
+      {
+         float u = t - edge;
+         float v = (t >= edge) ? 1.0f : -1.0f;
+
+         if (u < 0.0f) u += 1.0f;
+         v += _aax_polyblep(u, dt) - _aax_polyblep(t, dt);
+         *ptr++ = ngain*v;
+         if ((t += dt) >= 1.0f) t -= 1.0f;
+      }
+      break;
+   default:
+      memset(rv, 0, no_samples*sizeof(float));
+      break;
+   }
+}
+
 /* -------------------------------------------------------------------------- */
 // Gains for AAXS info block version 0.0
 static float _gains_v0[AAX_MAX_WAVE][2] = {
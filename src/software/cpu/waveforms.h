@@ -18,4 +18,29 @@
 extern float ALIGN _harmonic_phases[AAX_MAX_WAVE][2*MAX_HARMONICS];
 extern float ALIGN _harmonics[AAX_MAX_WAVE][2*MAX_HARMONICS];
 
+/*
+ * Live synthesized AAXS voice: the waveform layer is generated by the mixer
+ * at render time using band-limited oscillators instead of being rendered
+ * to a ringbuffer up front.
+ */
+#define MAX_SYNTH_OSCILLATORS	16
+
+typedef struct
+{
+   enum aaxSourceType wtype;
+   float freq_fact;		/* relative to the base frequency */
+   float gain;
+   float phase;			/* initial phase in radians */
+   float pre_gain;		/* applied to the mix before this oscillator */
+   bool modulate;
+   bool v0;
+} _aaxSynthOscillator;
+
+typedef struct
+{
+   float frequency;		/* base frequency in Hz */
+   unsigned int no_oscillators;
+   _aaxSynthOscillator osc[MAX_SYNTH_OSCILLATORS];
+} _aaxSynthVoice;
+
 #endif /* WAVEFORMS_H */
@@ -49,6 +49,7 @@ _aaxEmittersProcess(_aaxRingBuffer *drb, const _aaxMixerInfo *info,
 {
    _aaxRenderer *render = be->render(be_handle);
    _aaxRendererData data;
+   bool rv;
 
    data.mode = THREAD_PROCESS_EMITTER;
 
@@ -67,7 +68,50 @@ _aaxEmittersProcess(_aaxRingBuffer *drb, const _aaxMixerInfo *info,
 
    data.callback = _aaxProcessEmitter;
 
-   return render->process(render, &data);
+   rv = render->process(render, &data);
+   _aaxRingBufferAmbisonicsFlush(drb, info);
+   _aaxRingBufferHRIRFlush(drb);
+
+   return rv;
+}
+
+/*
+ * Convert the scheduled start and stop sample times of the emitter to
+ * offsets within the period which is about to be rendered.
+ * Returns false if the emitter should not be rendered yet.
+ */
+static bool
+_aaxEmitterSchedule(_emitter_t *emitter, _aaxRingBuffer *drb,
+                    const _aaxRendererData *data)
+{
+   _aaxEmitter *src = emitter->source;
+   _aax2dProps *ep2d = src->props2d;
+   int64_t t0 = data->info->curr_sample;
+   int64_t t_end = t0 + drb->get_parami(drb, RB_NO_SAMPLES);
+
+   if (src->start_sample >= 0)
+   {
+      if (src->start_sample >= t_end) return false;
+
+      if (src->start_sample > t0) {
+         ep2d->start_offs = src->start_sample - t0;
+      }
+      src->start_sample = -1;
+   }
+
+   if (src->stop_sample >= 0 && src->stop_sample < t_end)
+   {
+      /* a release phase starts at the period which holds the stop time */
+      if (!emitter->sampled_release &&
+          !_PROP_TIMED_GAIN_IS_DEFINED(src->props3d))
+      {
+         ep2d->stop_offs = _MAX(src->stop_sample - t0, 0);
+      }
+      src->stop_sample = -1;
+      _SET_STOPPED(src->props3d);
+   }
+
+   return true;
 }
 
 int
@@ -81,7 +125,12 @@ _aaxProcessEmitter(_aaxRingBuffer *drb, _aaxRendererData *data, _intBufferData *
 
    emitter = _intBufGetDataPtr(dptr_src);
    src = emitter->source;
-   if (_IS_PLAYING(src->props3d))
+   if (_IS_PLAYING(src->props3d) && !_aaxEmitterSchedule(emitter, drb, data))
+   {
+      /* the scheduled start is not within this period */
+      rv = true;
+   }
+   else if (_IS_PLAYING(src->props3d))
    {
       _intBufferData *dptr_sbuf;
       unsigned int nbuf;
@@ -185,6 +234,8 @@ _aaxProcessEmitter(_aaxRingBuffer *drb, _aaxRendererData *data, _intBufferData *
             }
          }
          while (res);
+         src->props2d->start_offs = 0;
+         src->props2d->stop_offs = -1;
          src->curr_pos_sec += data->dt;
          _intBufReleaseData(dptr_sbuf, _AAX_EMITTER_BUFFER);
       }
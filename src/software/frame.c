@@ -332,6 +332,8 @@ _aaxAudioFrameMix3D(_aaxRingBuffer *dest_rb, _intBuffers *ringbuffers,
       }
       drbd->mix1n(drbd, sptr, info->router, fp2d, 0, 0, no_samples,
                   info->frequency, 1.0f, 1.0f, 1.0f);
+      _aaxRingBufferAmbisonicsFlush(dest_rb, info);
+      _aaxRingBufferHRIRFlush(dest_rb);
       /*
        * push the ringbuffer to the back of the stack so it can
        * be used without the need to delete this one now and 
@@ -496,12 +498,14 @@ _aaxAudioFrameSwapBuffers(void *rbuf, _intBuffers *ringbuffers, bool dde)
 //       most often less data, but it would get rid of this function.
          nrb->copy_effectsdata(nrb, rb);
       }
+      _aaxRingBufferHRIRSwap(nrb, rb);
 
       _intBufPushNormal(ringbuffers, _AAX_RINGBUFFER, buf, true);
    }
    else
    {
       nrb = rb->duplicate(rb, true, true);
+      _aaxRingBufferHRIRSwap(nrb, rb);
       _intBufAddDataNormal(ringbuffers, _AAX_RINGBUFFER, rb, true);
    }
 
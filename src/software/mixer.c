@@ -167,22 +167,26 @@ _aaxFrameProcessEqualizer(_aaxRingBuffer *rb, _sensor_t *sensor, _aaxAudioFrame
       else
       {
          _aaxRingBufferEqualizerData *eq;
-         size_t track_len_bytes;
+         bool meter;
+
+         // only meter the bands while they are requested by the sensor
+         meter = (sensor && atomic_load(&sensor->metering) > 0);
 
          eq = _FILTER_GET_DATA(mixer, EQUALIZER_HF);
-         track_len_bytes = rb->get_parami(rb, RB_TRACKSIZE);
          for (t=0; t<no_tracks; t++)
          {
-            _aax_memcpy(scratch[SCRATCH_BUFFER0], tracks[t], track_len_bytes);
-            _grapheq_run(rbi->sample, tracks[t], scratch[SCRATCH_BUFFER0],
-                         scratch[SCRATCH_BUFFER1], 0, no_samples, t, eq);
+            _grapheq_run(rbi->sample, tracks[t], tracks[t],
+                         0, no_samples, t, eq, meter);
 
-            if (sensor)
+            if (meter)
             {
                memcpy(sensor->rms[t], eq->rms, sizeof(float[_AAX_MAX_EQBANDS]));
                memcpy(sensor->peak[t],eq->peak,sizeof(float[_AAX_MAX_EQBANDS]));
             }
          }
+
+         // metering stops when the band values are no longer requested
+         if (meter) atomic_fetch_sub(&sensor->metering, 1);
       }
    }
 }
@@ -339,7 +343,14 @@ _aaxSensorPostProcess(const _aaxRendererData *data)
       }
    }
 
-   rb->limit(rb, RB_COMPRESS);
+   if (info->lookahead > 0.0f)
+   {
+      rb->set_paramf(rb, RB_LIMITER_LOOKAHEAD, info->lookahead);
+      rb->limit(rb, RB_LIMITER_TRUEPEAK);
+   }
+   else {
+      rb->limit(rb, RB_COMPRESS);
+   }
 }
 
 // Send the rendered audio to the backend driver.
@@ -496,6 +507,9 @@ _aaxSoftwareMixerThreadUpdate(void *config, void *drb)
   PRINT_MATRICES(sdp3d_m->velocity, sdp3d.velocity);
  }
 #endif
+               rb->set_parami(rb, RB_AMBISONICS_ORDER,
+                              handle->info->ambisonics_order);
+
                /* clear the buffer for use by the subframe */
                rb->set_state(rb, RB_CLEARED);
                rb->set_state(rb, RB_STARTED);
@@ -543,6 +557,10 @@ _aaxSoftwareMixerThreadUpdate(void *config, void *drb)
                }
             }
          }
+
+         /* the sample clock used for scheduled parameter changes */
+         atomic_fetch_add(&handle->info->curr_sample,
+                          rb->get_parami(rb, RB_NO_SAMPLES));
       }
       else /* if (_IS_STANDBY(handle) */
       {
@@ -32,6 +32,7 @@
 #include <dsp/filters.h>
 #include <dsp/effects.h>
 #include <dsp/lfo.h>
+#include <dsp/automation.h>
 
 #include <api.h>
 
@@ -95,6 +96,9 @@ _aaxRingBufferMixMono16(_aaxRingBuffer *drb, _aaxRingBuffer *srb, _aax2dProps *e
    // TODO: Why won't data->scratch work
    scratch = (MIX_T**)drbd->scratch;
 
+   /** Scheduled parameter changes */
+   _automation_prepare(ep2d, info->curr_sample, drbd->no_samples);
+
    /** Pitch */
    pitch = ep2d->final.pitch; /* Doppler effect */
    pitch *= _EFFECT_GET(ep2d, PITCH_EFFECT, AAX_PITCH);
@@ -213,7 +217,9 @@ _aaxRingBufferMixMono16(_aaxRingBuffer *drb, _aaxRingBuffer *srb, _aax2dProps *e
    volume = (fp2d) ? _FILTER_GET(fp2d, VOLUME_FILTER, AAX_GAIN) : 1.0f;
 
    /* Final emitter volume */
-   volume *= _FILTER_GET(ep2d, VOLUME_FILTER, AAX_GAIN);
+   if (!_AUTOMATION_ACTIVE(ep2d->automation, AUTOMATION_GAIN)) {
+      volume *= _FILTER_GET(ep2d, VOLUME_FILTER, AAX_GAIN);
+   }
    if (volume > 1.0f) volume = 1.0f;
    if (genv) genv->value_total = gain*volume;
 
@@ -281,6 +287,12 @@ _aaxRingBufferMixMono16(_aaxRingBuffer *drb, _aaxRingBuffer *srb, _aax2dProps *e
          _batch_movingaverage_float(s, s, dno_samples, hist+1, ep2d->final.k);
       }
 
+      if (_AUTOMATION_ACTIVE(ep2d->automation, AUTOMATION_GAIN))
+      {
+         MIX_PTR_T s = (MIX_PTR_T)sptr[track] + offs;
+         _automation_apply_gain(ep2d, s, info->curr_sample+offs, dno_samples);
+      }
+
       gain = _MINMAX(gain*gnvel, ep2d->final.gain_min, ep2d->final.gain_max);
       if (_PROP3D_MONO_IS_DEFINED(fdp3d_m))
       {
@@ -294,6 +306,8 @@ _aaxRingBufferMixMono16(_aaxRingBuffer *drb, _aaxRingBuffer *srb, _aax2dProps *e
       }
    }
 
+   _automation_finish(ep2d, info->curr_sample + drbd->no_samples);
+
    if (ret >= -1 && !drbi->playing && drbi->stopped) {
       ret = 0;
    }
@@ -0,0 +1,366 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2005-2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2009-2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <assert.h>
+#include <string.h>
+#ifdef HAVE_RMALLOC_H
+# include <rmalloc.h>
+#else
+# include <stdlib.h>
+#endif
+
+#include <base/types.h>
+
+#include <ringbuffer.h>
+#include <arch.h>
+
+#include "rbuf_int.h"
+#include "audio.h"
+
+/*
+ * Every track is stored as a sequence of RB_BLOCK_SAMPLES sample blocks.
+ * A block starts with a four byte header: the predictor (little endian)
+ * and the step index, followed by the nibbles, low nibble first.
+ *
+ * Blocks can be decoded independently so the mixer only decodes the blocks
+ * about to be played. Every emitter holds its own reference ringbuffer
+ * which keeps the last decoded block of every track, a block which spans
+ * two mixer periods is decoded only once.
+ */
+typedef struct
+{
+   unsigned int no_tracks;
+   size_t block[RB_MAX_TRACKS];	/* decoded block no. plus one, 0 if none */
+   int32_t data[][RB_BLOCK_SAMPLES];
+} _aaxRingBufferBlockCache;
+
+extern const int16_t _ima4_step_table[89];
+
+static inline uint8_t
+_aaxRingBufferEncodeNibble(int32_t sample, int16_t *predictor, uint8_t *index)
+{
+   int32_t diff = sample - *predictor;
+   int32_t step = _ima4_step_table[*index];
+   uint8_t nibble = 0;
+
+   if (diff < 0)
+   {
+      nibble = 8;
+      diff = -diff;
+   }
+   if (diff >= step)
+   {
+      nibble |= 4;
+      diff -= step;
+   }
+   step >>= 1;
+   if (diff >= step)
+   {
+      nibble |= 2;
+      diff -= step;
+   }
+   step >>= 1;
+   if (diff >= step) {
+      nibble |= 1;
+   }
+
+   /* keep the encoder state identical to the decoder state */
+   _adpcm2linear(nibble, predictor, index);
+
+   return nibble;
+}
+
+static void
+_aaxRingBufferEncodeTrack(uint8_t *d, const void *src, size_t no_samples, unsigned char bits)
+{
+   const int32_t *s32 = (const int32_t*)src;
+   const int16_t *s16 = (const int16_t*)src;
+   uint8_t index = 0;
+   size_t i;
+
+   /* start with a step size which matches the signal */
+   if (no_samples > 1)
+   {
+      int32_t diff = (bits == 16) ? s16[1] - s16[0] : (s32[1]-s32[0]) >> 8;
+      diff = abs(diff);
+      while (index < 88 && _ima4_step_table[index] < diff) {
+         index++;
+      }
+   }
+
+   for (i=0; i<no_samples; i += RB_BLOCK_SAMPLES)
+   {
+      int16_t predictor;
+      int32_t sample = 0;
+      int j;
+
+      predictor = (bits == 16) ? s16[i] : (s32[i] >> 8);
+      *d++ = predictor & 0xFF;
+      *d++ = (predictor >> 8) & 0xFF;
+      *d++ = index;
+      *d++ = 0;
+
+      for (j=0; j<RB_BLOCK_SAMPLES; ++j)
+      {
+         uint8_t nibble;
+
+         /* repeat the last sample to fill the last block */
+         if (i+j < no_samples) {
+            sample = (bits == 16) ? s16[i+j] : (s32[i+j] >> 8);
+         }
+
+         nibble = _aaxRingBufferEncodeNibble(sample, &predictor, &index);
+         if (j & 1) *d++ |= nibble << 4;
+         else *d = nibble;
+      }
+   }
+}
+
+static void
+_aaxRingBufferDecodeBlock(int32_t *d, const uint8_t *s)
+{
+   int16_t predictor;
+   uint8_t index;
+   int i;
+
+   predictor = *s++;
+   predictor |= *s++ << 8;
+   index = *s++;
+   s++;
+
+   i = RB_BLOCK_SAMPLES/2;
+   do
+   {
+      uint8_t nibble = *s++;
+      *d++ = _adpcm2linear(nibble & 0xF, &predictor, &index) << 8;
+      *d++ = _adpcm2linear(nibble >> 4, &predictor, &index) << 8;
+   }
+   while (--i);
+}
+
+/*
+ * Decode no_samples samples of a track starting at sample position pos
+ * into 24-bit samples. Samples beyond the end of the track are silent.
+ */
+static void
+_aaxRingBufferDecodeSamples(int32_t *dst, _aaxRingBufferData *rbi, int track, size_t pos, size_t no_samples)
+{
+   _aaxRingBufferBlockCache *cache = rbi->block_cache;
+   _aaxRingBufferBlocks *blocks = rbi->sample->blocks;
+   size_t end = rbi->sample->no_samples;
+   const uint8_t *src = blocks->track[track];
+   int32_t tmp[RB_BLOCK_SAMPLES];
+
+   if (cache && track >= cache->no_tracks) {
+      cache = NULL;
+   }
+
+   // streaming voices request HISTORY_SAMPS beyond the end of the buffer
+   if (pos + no_samples > end)
+   {
+      size_t len = (pos < end) ? end - pos : 0;
+      memset(dst+len, 0, (no_samples - len)*sizeof(int32_t));
+      no_samples = len;
+   }
+
+   while (no_samples)
+   {
+      size_t block = pos/RB_BLOCK_SAMPLES;
+      size_t offs = pos - block*RB_BLOCK_SAMPLES;
+      size_t len = _MIN(no_samples, RB_BLOCK_SAMPLES - offs);
+
+      assert(block < blocks->no_blocks);
+
+      if (len == RB_BLOCK_SAMPLES) {
+         _aaxRingBufferDecodeBlock(dst, src + block*RB_IMA4_BLOCK_SIZE);
+      }
+      else if (cache)
+      {
+         if (cache->block[track] != block+1)
+         {
+            _aaxRingBufferDecodeBlock(cache->data[track],
+                                      src + block*RB_IMA4_BLOCK_SIZE);
+            cache->block[track] = block+1;
+         }
+         memcpy(dst, cache->data[track]+offs, len*sizeof(int32_t));
+      }
+      else
+      {
+         _aaxRingBufferDecodeBlock(tmp, src + block*RB_IMA4_BLOCK_SIZE);
+         memcpy(dst, tmp+offs, len*sizeof(int32_t));
+      }
+
+      dst += len;
+      pos += len;
+      no_samples -= len;
+   }
+}
+
+/*
+ * The compressed counterpart of _aaxRingBufferProcessCodec:
+ * it decodes the samples of one track which are about to be played,
+ * taking care of looping of the source buffer.
+ *
+ * @dst destination buffer for the 24-bit samples.
+ * @rbi the source ringbuffer.
+ * @track the track to decode.
+ * @src_pos starting sample position within the source track.
+ * @loop_start sample position to start from when looping.
+ * @sno_samples total length (in samples) of the source buffer.
+ * @dno_samples total length (in samples) of the destination buffer.
+ * @src_loops boolean, 0 = no srource looping, otherwise the source loops.
+ */
+void
+_aaxRingBufferProcessBlocks(int32_t *dst, _aaxRingBufferData *rbi, int track,
+                 size_t src_pos, size_t loop_start, size_t sno_samples,
+                 size_t dno_samples, char src_loops)
+{
+   const size_t sbuflen = sno_samples - loop_start;
+   size_t new_len, dbuflen = dno_samples;
+   int32_t *dptr = dst;
+
+   assert(rbi->sample->blocks);
+   assert(src_pos <= sno_samples);
+
+   if (dbuflen >= (sno_samples-src_pos)) {
+      new_len = sno_samples - src_pos;
+   } else {
+      new_len = dbuflen;
+   }
+
+   _aaxRingBufferDecodeSamples(dptr, rbi, track, src_pos, new_len);
+   dbuflen -= new_len;
+
+   if (dbuflen && src_loops && sbuflen)
+   {
+      int32_t *start_dptr;
+
+      dptr += new_len;
+      start_dptr = dptr;
+
+      new_len = (dbuflen > sbuflen) ? sbuflen : dbuflen;
+      _aaxRingBufferDecodeSamples(dptr, rbi, track, loop_start, new_len);
+      dbuflen -= new_len;
+      dptr += new_len;
+
+      /* repeat the already decoded loop if required */
+      while (dbuflen)
+      {
+         new_len = (dbuflen > sbuflen) ? sbuflen : dbuflen;
+         _aax_memcpy(dptr, start_dptr, new_len*sizeof(int32_t));
+         dbuflen -= new_len;
+         dptr += new_len;
+      }
+   }
+}
+
+/*
+ * Replace the audio tracks of the sample by compressed blocks.
+ * Only 16-bit and 24-bit samples are supported.
+ */
+bool
+_aaxRingBufferBlocksEncode(_aaxRingBufferSample *rbd)
+{
+   size_t no_samples = rbd->no_samples;
+   int no_tracks = rbd->no_tracks;
+   _aaxRingBufferBlocks *blocks;
+   size_t no_blocks, size;
+   uint8_t *ptr;
+   int t;
+
+   if (!rbd->track || !no_samples || no_tracks > RB_MAX_TRACKS) {
+      return false;
+   }
+   if (rbd->bits_sample != 16 &&
+       (rbd->bits_sample != 32 || rbd->format != AAX_PCM24S)) {
+      return false;
+   }
+
+   no_blocks = (no_samples + RB_BLOCK_SAMPLES-1)/RB_BLOCK_SAMPLES;
+   size = no_blocks*RB_IMA4_BLOCK_SIZE;
+   blocks = malloc(sizeof(_aaxRingBufferBlocks) + no_tracks*size);
+   if (!blocks) return false;
+
+   blocks->no_blocks = no_blocks;
+   ptr = (uint8_t*)(blocks+1);
+   for (t=0; t<no_tracks; ++t)
+   {
+      blocks->track[t] = ptr;
+      _aaxRingBufferEncodeTrack(ptr, rbd->track[t], no_samples,
+                                rbd->bits_sample);
+      ptr += size;
+   }
+
+   free(rbd->blocks);
+   rbd->blocks = blocks;
+
+   _aax_free(rbd->track);
+   rbd->track = NULL;
+
+   return true;
+}
+
+/* Decode all compressed blocks into tracks in the sample format. */
+void
+_aaxRingBufferBlocksDecode(const _aaxRingBufferSample *rbd, void **tracks)
+{
+   const _aaxRingBufferBlocks *blocks = rbd->blocks;
+   size_t no_samples = rbd->no_samples;
+   int t;
+
+   assert(blocks);
+
+   for (t=0; t<rbd->no_tracks; ++t)
+   {
+      const uint8_t *src = blocks->track[t];
+      int32_t tmp[RB_BLOCK_SAMPLES];
+      size_t i;
+
+      for (i=0; i<no_samples; i += RB_BLOCK_SAMPLES)
+      {
+         size_t len = _MIN(no_samples - i, RB_BLOCK_SAMPLES);
+
+         _aaxRingBufferDecodeBlock(tmp, src);
+         src += RB_IMA4_BLOCK_SIZE;
+
+         if (rbd->bits_sample == 16)
+         {
+            int16_t *d = (int16_t*)tracks[t] + i;
+            size_t j;
+            for (j=0; j<len; ++j) {
+               d[j] = tmp[j] >> 8;
+            }
+         }
+         else {
+            memcpy((int32_t*)tracks[t] + i, tmp, len*sizeof(int32_t));
+         }
+      }
+   }
+}
+
+void*
+_aaxRingBufferBlockCacheCreate(const _aaxRingBufferSample *rbd)
+{
+   _aaxRingBufferBlockCache *cache;
+   size_t size;
+
+   size = sizeof(_aaxRingBufferBlockCache);
+   size += rbd->no_tracks*RB_BLOCK_SAMPLES*sizeof(int32_t);
+
+   cache = calloc(1, size);
+   if (cache) {
+      cache->no_tracks = rbd->no_tracks;
+   }
+
+   return cache;
+}
@@ -81,10 +81,42 @@ enum
     MAX_SCRATCH_BUFFERS
 };
 
+/*
+ * Compressed sample storage: every track is stored as a sequence of
+ * independent IMA4-ADPCM blocks which the mixer decodes when played.
+ */
+#define RB_BLOCK_SAMPLES	64
+#define RB_IMA4_BLOCK_SIZE	IMA4_SMP_TO_BLOCKSIZE(RB_BLOCK_SAMPLES)
+
+typedef struct
+{
+    size_t no_blocks;
+    uint8_t *track[RB_MAX_TRACKS];
+} _aaxRingBufferBlocks;
+
+/*
+ * Disk streamed sample storage: only the first no_resident samples are
+ * kept in memory, the rest is read from disk for every playing voice.
+ * read() returns the number of 24-bit samples read at sample position pos.
+ */
+typedef struct
+{
+    void* (*open)(void*);
+    ssize_t (*read)(void*, int32_t**, size_t, size_t);
+    void (*close)(void*);
+    void (*free)(void*);
+    void *data;
+
+    size_t no_resident;
+    int32_t *head[RB_MAX_TRACKS];
+} _aaxRingBufferStream;
+
 typedef struct _aaxRingBufferSample_t  /* static information about the sample */
 {
     void** scratch;		/* resident scratch buffer */
     void** track;		/* audio tracks data */
+    _aaxRingBufferBlocks *blocks; /* compressed audio tracks data */
+    _aaxRingBufferStream *stream; /* disk streamed audio tracks data */
     size_t tracksize;		/* size of the allocated audio tracks data */
 
     size_t no_blocks;
@@ -110,6 +142,13 @@ typedef struct _aaxRingBufferSample_t  /* static information about the sample */
     float freqfilter_history_x[RB_MAX_TRACKS];
     float freqfilter_history_y[RB_MAX_TRACKS];
 
+    float lookahead_sec;	/* true-peak limiter lookahead time */
+    void *limiter;		/* true-peak limiter state */
+    void *hrir;			/* measured HRIR convolution state */
+    void *ambisonics;		/* spherical harmonics bus */
+    unsigned char ambisonics_order;
+    _aaxSynthVoice *synth;	/* live oscillators, no sample data */
+
     float volume_envelope[2*_MAX_ENVELOPE_STAGES];
     bool envelope_sustain;
     bool sampled_release;
@@ -128,6 +167,7 @@ typedef struct _aaxRingBufferSample_t  /* static information about the sample */
     _batch_fmadd_proc add;
     _batch_fmadd_proc multiply;
     _batch_resample_float_proc resample;
+    _batch_resample_ramp_float_proc resample_ramp;
     _batch_freqfilter_float_proc freqfilter;
 
    /* called by the mix function above */
@@ -154,6 +194,8 @@ typedef struct _aaxRingBufferData_t
     FLOAT curr_pos_sec;
     size_t curr_sample;
 
+    float synth_phase[MAX_SYNTH_OSCILLATORS];
+
     unsigned int loop_max;
     unsigned int loop_no;
     int loop_mode;
@@ -171,6 +213,9 @@ typedef struct _aaxRingBufferData_t
    enum aaxRenderMode mode;
    enum _aaxRingBufferMode access;
 
+   void *block_cache;		/* last decoded block of every track */
+   void *stream_voice;		/* read-ahead of disk streamed data */
+
    _aaxProcessCodecFn *codec;
    _aaxEffectsApplyFn *effects;
    _aaxProcessMixerFn *mix;
@@ -191,6 +236,19 @@ typedef struct {
 extern _batch_codec_proc _aaxRingBufferCodecs[];
 
 void _aaxRingBufferProcessCodec(int32_t*, void*, _batch_codec_proc, size_t, size_t, size_t, size_t, size_t, unsigned char, char);
+void _aaxRingBufferProcessBlocks(int32_t*, _aaxRingBufferData*, int, size_t, size_t, size_t, size_t, char);
+
+bool _aaxRingBufferBlocksEncode(_aaxRingBufferSample*);
+void _aaxRingBufferBlocksDecode(const _aaxRingBufferSample*, void**);
+void *_aaxRingBufferBlockCacheCreate(const _aaxRingBufferSample*);
+
+void _aaxRingBufferProcessStream(int32_t*, _aaxRingBufferData*, int, size_t, size_t, size_t, size_t, char);
+
+_aaxRingBufferStream *_aaxRingBufferStreamCreate(unsigned int, size_t);
+void _aaxRingBufferStreamDestroy(_aaxRingBufferStream*);
+bool _aaxRingBufferStreamRead(const _aaxRingBufferSample*, void**);
+void *_aaxRingBufferStreamVoiceCreate(const _aaxRingBufferSample*);
+void _aaxRingBufferStreamVoiceDestroy(void*);
 void _aaxRingBufferEffectsApply(_aaxRingBufferSample*, MIX_PTR_T, MIX_PTR_T, MIX_PTR_T, size_t, size_t, size_t, size_t, unsigned int, _aax2dProps*, unsigned char);
 
 
@@ -205,13 +263,27 @@ _aaxRingBufferMix1NFn _aaxRingBufferMixMono16Spatial;
 _aaxRingBufferMix1NFn _aaxRingBufferMixMono16Surround;
 _aaxRingBufferMix1NFn _aaxRingBufferMixMono16SpatialSurround;
 _aaxRingBufferMix1NFn _aaxRingBufferMixMono16HRTF;
+_aaxRingBufferMix1NFn _aaxRingBufferMixMono16Ambisonics;
 
 void _aaxRingBufferLimiter(MIX_PTR_T, size_t, float, float);
 void _aaxRingBufferCompress(MIX_PTR_T, size_t, float, float);
+void _aaxRingBufferTruePeakLimiter(_aaxRingBufferSample*, MIX_T**, unsigned int, size_t);
+void _aaxRingBufferTruePeakLimiterDestroy(void*);
+
+bool _aaxRingBufferHRIRMix(_aaxRingBufferSample*, CONST_MIX_PTRPTR_T, const unsigned char*, _aax2dProps*, unsigned char, size_t, size_t, float, float, float);
+void _aaxRingBufferHRIRClear(_aaxRingBufferSample*);
+void _aaxRingBufferHRIRDestroy(void*);
+
+void _aaxRingBufferAmbisonicsDestroy(void*);
+
+#define TRUEPEAK_PHASES		4
+#define TRUEPEAK_TAPS		12
+extern const float _truepeak_fir[TRUEPEAK_TAPS][TRUEPEAK_PHASES];
 
 
 /** BUFFER */
 void _bufferMixWaveform(int32_t*, _data_t*, enum aaxSourceType, float, size_t, float, float, bool, bool, limitType);
+void _bufferRenderSynthVoice(MIX_PTR_T, MIX_PTR_T, const _aaxSynthVoice*, float*, size_t, size_t, float, float);
 
 void _bufferMixWhiteNoise(int32_t*, _data_t*, size_t, float, float, float, uint64_t, unsigned char, bool, limitType);
 void _bufferMixPinkNoise(int32_t*, _data_t*, size_t, float, float, float, uint64_t, unsigned char, bool, limitType);
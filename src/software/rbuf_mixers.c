@@ -48,8 +48,10 @@ _aaxRingBufferProcessMixer(MIX_T **track_ptr, _aaxRingBuffer *drb, _aaxRingBuffe
    _aaxRingBufferSample *srbd, *drbd;
    float dfreq, dduration, drb_pos_sec, fact, dremain;
    float sfreq, sduration, srb_pos_sec, new_srb_pos_sec, pitch;
+   float fact_start, fact_end;
    size_t ddesamps = *start;
    FLOAT dadvance;
+   bool delayed_start;
    char src_loops;
 
    _AAX_LOG(LOG_DEBUG, __func__);
@@ -71,9 +73,24 @@ _aaxRingBufferProcessMixer(MIX_T **track_ptr, _aaxRingBuffer *drb, _aaxRingBuffe
    assert(drbd->no_tracks >= 1);
 
    /* destination position and duration */
+   dfreq = drb->get_paramf(drb, RB_FREQUENCY);
    drb_pos_sec = drb->get_paramf(drb, RB_OFFSET_SEC);
-   dduration = drb->get_paramf(drb, RB_DURATION_SEC) - drb_pos_sec;
-   if (dduration == 0)
+   dduration = drb->get_paramf(drb, RB_DURATION_SEC);
+
+   /* a scheduled start or stop within this period */
+   delayed_start = false;
+   if (p2d->start_offs)
+   {
+      drb_pos_sec += p2d->start_offs/dfreq;
+      p2d->start_offs = 0;
+      delayed_start = true;
+   }
+   if (p2d->stop_offs >= 0) {
+      dduration = _MIN(dduration, p2d->stop_offs/dfreq);
+   }
+
+   dduration -= drb_pos_sec;
+   if (dduration <= 0)
    {
       _AAX_SYSLOG("remaining duration of the destination buffer = 0.0.");
       return NULL;
@@ -86,12 +103,29 @@ _aaxRingBufferProcessMixer(MIX_T **track_ptr, _aaxRingBuffer *drb, _aaxRingBuffe
 
    /* source fast forward */
    pitch_norm *= srbi->pitch_norm;
+   sfreq = srb->get_paramf(srb, RB_FREQUENCY);
+
+   /*
+    * Ramp the pitch from the previous period to this one to prevent
+    * stepped pitch changes (e.g. Doppler). The source then advances by
+    * the average pitch of the period.
+    */
+   pitch = pitch_norm;
+   fact_end = _MAX((sfreq * pitch)/dfreq, 0.001f);
+   fact_start = fact_end;
+   if (p2d->prev_freq_fact > 0.0f && srb_pos_sec > 0.0f &&
+       fabsf(p2d->prev_freq_fact - pitch) > 1e-4f*pitch)
+   {
+      fact_start = _MAX((sfreq * p2d->prev_freq_fact)/dfreq, 0.001f);
+      pitch_norm = 0.5f*(p2d->prev_freq_fact + pitch);
+   }
+   p2d->prev_freq_fact = pitch;
+
    srb->set_paramd(srb, RB_FORWARD_SEC, dduration*pitch_norm);
    if (pitch_norm < 0.01) return NULL;
    pitch = pitch_norm;
 
    /* source time offset */
-   sfreq = srb->get_paramf(srb, RB_FREQUENCY);
    new_srb_pos_sec = srb_pos_sec + dduration*pitch;
    src_loops = (srbi->looping && !srbi->streaming);
 
@@ -109,8 +143,7 @@ _aaxRingBufferProcessMixer(MIX_T **track_ptr, _aaxRingBuffer *drb, _aaxRingBuffe
       }
    }
 
-   /* sample conversion factor */
-   dfreq = drb->get_paramf(drb, RB_FREQUENCY);
+   /* average sample conversion factor */
    fact = _MAX((sfreq * pitch)/dfreq, 0.001f);
 
    /*
@@ -160,7 +193,8 @@ _aaxRingBufferProcessMixer(MIX_T **track_ptr, _aaxRingBuffer *drb, _aaxRingBuffe
 
       /* destonation number of samples */
       dend = drb->get_parami(drb, RB_NO_SAMPLES);
-      dno_samples = dend - dest_pos;
+      if (p2d->stop_offs >= 0) dend = _MIN(dend, (size_t)p2d->stop_offs);
+      dno_samples = (dend > dest_pos) ? dend - dest_pos : 0;
 
       /* number of samples to convert */
       cno_samples = rintf(dno_samples*fact);
@@ -206,7 +240,8 @@ _aaxRingBufferProcessMixer(MIX_T **track_ptr, _aaxRingBuffer *drb, _aaxRingBuffe
          for (track=0; track<sno_tracks; track++)
          {
             int t = track % _AAX_MAX_SPEAKERS;
-            MIX_T *sptr = (MIX_T*)srbd->track[track];
+            MIX_T *sptr = (srbd->blocks || srbd->stream) ? NULL
+                                                : (MIX_T*)srbd->track[track];
             MIX_T *dst, *dptr = track_ptr[t];
             size_t samples;
             char resample;
@@ -219,64 +254,92 @@ _aaxRingBufferProcessMixer(MIX_T **track_ptr, _aaxRingBuffer *drb, _aaxRingBuffe
                rdesamps = (size_t)rintf(dde*fact);
             }
 
-            /* resample factor == 1.0f ? */
-            samples = dest_pos+dno_samples+ddesamps;
-            resample = (fabsf(fact-1.0f)*samples < 1.0f) ? 0 : 1;
-
-            /* short-cut for automatic file streaming with registered sensors */
-            if (srbd->mixer_fmt) { /* no CODEC required */
-                scratch0 = sptr+src_pos-HISTORY_SAMPS;
+            if (srbd->synth)
+            {  /* live voice: no CODEC and no resampling required */
+               dst = eff ? scratch1 : dptr;
+               _bufferRenderSynthVoice(dst+dest_pos-ddesamps,
+                                       scratch0-ddesamps, srbd->synth,
+                                       srbi->synth_phase, ddesamps,
+                                       dno_samples, dfreq, pitch);
             }
-            else /* CODEC required */
+            else
             {
-               size_t samples = cno_samples+HISTORY_SAMPS;
-               size_t send = sno_samples;
-
-               if (srbi->streaming) {
-                  send += HISTORY_SAMPS;
+               /* resample factor == 1.0f ? */
+               samples = dest_pos+dno_samples+ddesamps;
+               resample = (fabsf(fact-1.0f)*samples < 1.0f) ? 0 : 1;
+               if (fact_start != fact_end || delayed_start) resample = 1;
+
+               /* short-cut for automatic file streaming with registered sensors */
+               if (srbd->mixer_fmt) { /* no CODEC required */
+                   scratch0 = sptr+src_pos-HISTORY_SAMPS;
                }
-
-               if (!resample && !eff) { /* codec performs directly on dptr */
-                  scratch0 = dptr+dest_pos;
+               else /* CODEC required */
+               {
+                  size_t samples = cno_samples+HISTORY_SAMPS;
+                  size_t send = sno_samples;
+
+                  if (srbi->streaming) {
+                     send += HISTORY_SAMPS;
+                  }
+
+                  if (!resample && !eff) { /* codec performs directly on dptr */
+                     scratch0 = dptr+dest_pos;
+                  }
+
+//                DBG_MEMCLR(1, scratch0, dend, sizeof(int32_t));
+                  if (srbd->blocks) { /* decode the blocks to be played */
+                     _aaxRingBufferProcessBlocks((int32_t*)scratch0, srbi,
+                                                 track, src_pos, sstart, send,
+                                                 samples, src_loops);
+                  } else if (srbd->stream) { /* read-ahead from disk */
+                     _aaxRingBufferProcessStream((int32_t*)scratch0, srbi,
+                                                 track, src_pos, sstart, send,
+                                                 samples, src_loops);
+                  } else {
+                     srbi->codec((int32_t*)scratch0, sptr, srbd->codec,
+                                  src_pos, sstart, send, 0, samples,
+                                  sbps, src_loops);
+                  }
+
+                  // convert from int32_t to float32
+                  _batch_cvtps24_24(scratch0, scratch0, samples);
+                  DBG_TESTNAN(scratch0, samples);
                }
 
-//             DBG_MEMCLR(1, scratch0, dend, sizeof(int32_t));
-               srbi->codec((int32_t*)scratch0, sptr, srbd->codec,
-                            src_pos, sstart, send, 0, samples,
-                            sbps, src_loops);
-
-               // convert from int32_t to float32
-               _batch_cvtps24_24(scratch0, scratch0, samples);
-               DBG_TESTNAN(scratch0, samples);
-            }
-
-            /* update the history */
-            if (!delay_effect && history)
-            {
-               size_t size = sizeof(history[t]);
-               _aax_memcpy(scratch0-HISTORY_SAMPS, history[t], size);
-               _aax_memcpy(history[t],scratch0-HISTORY_SAMPS+cno_samples, size);
-            }
-//          DBG_MEMCLR(1, dst-ddesamps, ddesamps+dend, sizeof(MIX_T));
+               /* update the history */
+               if (!delay_effect && history)
+               {
+                  size_t size = sizeof(history[t]);
+                  _aax_memcpy(scratch0-HISTORY_SAMPS, history[t], size);
+                  _aax_memcpy(history[t],scratch0-HISTORY_SAMPS+cno_samples, size);
+               }
+//             DBG_MEMCLR(1, dst-ddesamps, ddesamps+dend, sizeof(MIX_T));
 
-            if (!resample)
-            {
-               dst = dptr;
-               if (eff)
+               if (!resample)
                {
-                  assert(ddesamps == rdesamps);
-                  dst = scratch0;
+                  dst = dptr;
+                  if (eff)
+                  {
+                     assert(ddesamps == rdesamps);
+                     dst = scratch0;
+                  }
+                  else if (srbd->mixer_fmt) {
+                     memcpy(dptr, scratch0, samples*sizeof(MIX_T));
+                  }
+                  /* else case handled above: codec performs directly on dptr */
                }
-               else if (srbd->mixer_fmt) {
-                  memcpy(dptr, scratch0, samples*sizeof(MIX_T));
+               else
+               {
+                  dst = eff ? scratch1 : dptr;
+                  if (fact_start != fact_end) {
+                     drbd->resample_ramp(dst-ddesamps, scratch0-rdesamps,
+                                         dest_pos, samples, smu,
+                                         fact_start, fact_end);
+                  } else {
+                     drbd->resample(dst-ddesamps, scratch0-rdesamps,
+                                    dest_pos, samples, smu, fact);
+                  }
                }
-               /* else case handled above: codec performs directly on dptr */
-            }
-            else
-            {
-               dst = eff ? scratch1 : dptr;
-               drbd->resample(dst-ddesamps, scratch0-rdesamps,
-                              dest_pos, samples, smu, fact);
             }
             DBG_TESTNAN(dst-ddesamps+dest_pos, dno_samples+ddesamps);
 
@@ -22,6 +22,7 @@
 #include <dsp/filters.h>
 #include <dsp/effects.h>
 #include <dsp/lfo.h>
+#include <dsp/automation.h>
 
 #include <api.h>
 #include <ringbuffer.h>
@@ -86,6 +87,9 @@ _aaxRingBufferMixMulti16(_aaxRingBuffer *drb, _aaxRingBuffer *srb, const void *r
    // TODO: Why won't data->scratch work?
    scratch = (MIX_T**)drbd->scratch;
 
+   /** Scheduled parameter changes */
+   _automation_prepare(ep2d, info->curr_sample, drbd->no_samples);
+
    /** Pitch */
    pitch = _EFFECT_GET(ep2d, PITCH_EFFECT, AAX_PITCH);
 
@@ -201,7 +205,9 @@ _aaxRingBufferMixMulti16(_aaxRingBuffer *drb, _aaxRingBuffer *srb, const void *r
    volume = (fp2d) ? _FILTER_GET(fp2d, VOLUME_FILTER, AAX_GAIN) : 1.0f;
 
    /* Final emitter volume */
-   volume *= _FILTER_GET(ep2d, VOLUME_FILTER, AAX_GAIN);
+   if (!_AUTOMATION_ACTIVE(ep2d->automation, AUTOMATION_GAIN)) {
+      volume *= _FILTER_GET(ep2d, VOLUME_FILTER, AAX_GAIN);
+   }
    if (volume > 1.0f) volume = 1.0f;
    if (genv) genv->value_total = gain*volume;
 
@@ -261,11 +267,23 @@ _aaxRingBufferMixMulti16(_aaxRingBuffer *drb, _aaxRingBuffer *srb, const void *r
          srbi->playing = !srbi->stopped;
       }
 
+      if (_AUTOMATION_ACTIVE(ep2d->automation, AUTOMATION_GAIN))
+      {
+         unsigned int t, no_tracks = srb->get_parami(srb, RB_NO_TRACKS);
+         for (t=0; t<no_tracks; ++t)
+         {
+            MIX_PTR_T s = (MIX_PTR_T)sptr[t] + offs;
+            _automation_apply_gain(ep2d, s, info->curr_sample+offs, dno_samples);
+         }
+      }
+
       gain *= gnvel;
       drbd->mixmn(drbd, srbd, sptr, info->router, ep2d, offs, dno_samples,
                   gain, svol, evol);
    }
 
+   _automation_finish(ep2d, info->curr_sample + drbd->no_samples);
+
    if (ret >= -1 && !drbi->playing && drbi->stopped) {
       ret = 0;
    }
@@ -0,0 +1,602 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2005-2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2009-2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <assert.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#ifdef HAVE_RMALLOC_H
+# include <rmalloc.h>
+#else
+# include <stdlib.h>
+#endif
+
+#include <base/types.h>
+#include <base/memory.h>
+#include <base/jobpool.h>
+
+#include <ringbuffer.h>
+#include <arch.h>
+#include <stream/device.h>
+
+#include "rbuf_int.h"
+#include "audio.h"
+
+/*
+ * Disk streamed samples keep the first no_resident samples of every track
+ * in memory. Every voice which plays the sample holds its own read-ahead
+ * ring which is filled by the I/O thread pool of the stream driver, one
+ * chunk per job. Jobs of voices which started earlier are executed first.
+ *
+ * A looping voice also keeps the samples at the start of the loop in
+ * memory, read before the ring is filled, so playback continues from there
+ * while the ring is refilled after jumping back.
+ *
+ * The mixer never waits for the disk: samples which did not arrive in time
+ * are rendered as silence.
+ */
+#define RB_STREAM_CHUNK		8192
+#define RB_STREAM_LOOP		(2*RB_STREAM_CHUNK)
+
+typedef struct
+{
+   mtx_t mutex;
+   _aaxJobGroup group;
+   const _aaxRingBufferSample *rbd;
+   const _aaxRingBufferStream *stream;
+   void *io;
+
+   unsigned int priority;	/* voice start time in ms */
+   unsigned int generation;	/* incremented when the ring is reset */
+   bool started;
+   bool queued;
+   bool failed;
+   bool closing;
+
+   size_t size;		/* ring size in samples */
+   size_t first;	/* sample position of the first sample in the ring */
+   size_t head;		/* ring index of the first sample */
+   size_t count;	/* no. samples available in the ring */
+   size_t last;		/* sample position after the last request */
+
+   unsigned int loop_generation; /* incremented when the loop moves */
+   size_t loop_first;	/* sample position of the first loop sample */
+   size_t loop_size;	/* no. loop samples to keep, zero if not looping */
+   size_t loop_count;	/* no. loop samples read */
+
+   int32_t *ring[RB_MAX_TRACKS];
+   int32_t *chunk[RB_MAX_TRACKS];
+   int32_t *loop[RB_MAX_TRACKS];
+} _aaxRingBufferStreamVoice;
+
+static void _aaxRingBufferStreamInit(void);
+static unsigned int _aaxRingBufferStreamStart(void);
+static void _aaxRingBufferStreamReset(_aaxRingBufferStreamVoice*, size_t);
+static void _aaxRingBufferStreamLoop(_aaxRingBufferStreamVoice*, size_t);
+static bool _aaxRingBufferStreamNeedsFill(_aaxRingBufferStreamVoice*);
+static int _aaxRingBufferStreamFill(void*);
+
+static once_flag _stream_once = ONCE_FLAG_INIT;
+static mtx_t _stream_mutex;
+static _aaxJobPool *_stream_pool = NULL;
+static unsigned int _stream_refs = 0;
+
+_aaxRingBufferStream*
+_aaxRingBufferStreamCreate(unsigned int no_tracks, size_t no_resident)
+{
+   _aaxRingBufferStream *rv = NULL;
+   _aaxJobPool *pool;
+   size_t size;
+
+   if (!no_tracks || no_tracks > RB_MAX_TRACKS || !no_resident) {
+      return rv;
+   }
+
+   size = SIZE_ALIGNED(no_resident*sizeof(int32_t));
+   rv = calloc(1, sizeof(_aaxRingBufferStream) + no_tracks*size);
+   if (rv)
+   {
+      char *ptr = (char*)(rv+1);
+      unsigned int t;
+
+      rv->no_resident = no_resident;
+      for (t=0; t<no_tracks; ++t)
+      {
+         rv->head[t] = (int32_t*)ptr;
+         ptr += size;
+      }
+
+      call_once(&_stream_once, _aaxRingBufferStreamInit);
+      mtx_lock(&_stream_mutex);
+      if (!_stream_pool) {
+         _stream_pool = _aaxStreamDriverSharedIOStart();
+      }
+      pool = _stream_pool;
+      if (pool) {
+         _stream_refs++;
+      }
+      mtx_unlock(&_stream_mutex);
+
+      if (!pool) // the I/O pool could not start
+      {
+         free(rv);
+         rv = NULL;
+      }
+   }
+
+   return rv;
+}
+
+void
+_aaxRingBufferStreamDestroy(_aaxRingBufferStream *stream)
+{
+   if (stream)
+   {
+      if (stream->free) stream->free(stream->data);
+
+      mtx_lock(&_stream_mutex);
+      if (--_stream_refs == 0)
+      {
+         _aaxStreamDriverSharedIOStop();
+         _stream_pool = NULL;
+      }
+      mtx_unlock(&_stream_mutex);
+
+      free(stream);
+   }
+}
+
+/* Read the complete sample into tracks, blocks until done. */
+bool
+_aaxRingBufferStreamRead(const _aaxRingBufferSample *rbd, void **tracks)
+{
+   const _aaxRingBufferStream *stream = rbd->stream;
+   size_t pos, no_samples = rbd->no_samples;
+   int32_t *dptr[RB_MAX_TRACKS];
+   bool rv = false;
+   void *io;
+   int t;
+
+   assert(stream);
+
+   for (t=0; t<rbd->no_tracks; ++t) {
+      memcpy(tracks[t], stream->head[t], stream->no_resident*sizeof(int32_t));
+   }
+
+   io = stream->open(stream->data);
+   if (io)
+   {
+      pos = stream->no_resident;
+      while (pos < no_samples)
+      {
+         ssize_t res;
+
+         for (t=0; t<rbd->no_tracks; ++t) {
+            dptr[t] = (int32_t*)tracks[t] + pos;
+         }
+         res = stream->read(io, dptr, pos, _MIN(no_samples-pos, RB_STREAM_CHUNK));
+         if (res <= 0) break;
+         pos += res;
+      }
+      stream->close(io);
+      rv = (pos == no_samples) ? true : false;
+   }
+
+   return rv;
+}
+
+void*
+_aaxRingBufferStreamVoiceCreate(const _aaxRingBufferSample *rbd)
+{
+   const _aaxRingBufferStream *stream = rbd->stream;
+   _aaxRingBufferStreamVoice *voice;
+   size_t ring_size, size;
+
+   assert(stream);
+
+   ring_size = _MAX(stream->no_resident, 2*RB_STREAM_CHUNK);
+   size = ring_size + RB_STREAM_CHUNK + RB_STREAM_LOOP;
+
+   voice = calloc(1, sizeof(_aaxRingBufferStreamVoice) +
+                     rbd->no_tracks*size*sizeof(int32_t));
+   if (voice)
+   {
+      int32_t *ptr = (int32_t*)(voice+1);
+      int t;
+
+      mtx_init(&voice->mutex, mtx_plain);
+      _aaxJobGroupInit(&voice->group);
+      voice->rbd = rbd;
+      voice->stream = stream;
+      voice->size = ring_size;
+      for (t=0; t<rbd->no_tracks; ++t)
+      {
+         voice->ring[t] = ptr;
+         ptr += ring_size;
+         voice->chunk[t] = ptr;
+         ptr += RB_STREAM_CHUNK;
+         voice->loop[t] = ptr;
+         ptr += RB_STREAM_LOOP;
+      }
+      _aaxRingBufferStreamReset(voice, stream->no_resident);
+   }
+
+   return voice;
+}
+
+void
+_aaxRingBufferStreamVoiceDestroy(void *id)
+{
+   _aaxRingBufferStreamVoice *voice = id;
+
+   if (voice)
+   {
+      const _aaxRingBufferStream *stream = voice->stream;
+
+      mtx_lock(&voice->mutex);
+      voice->closing = true;
+      mtx_unlock(&voice->mutex);
+
+      _aaxJobPoolWait(_stream_pool, &voice->group);
+
+      if (voice->io) stream->close(voice->io);
+      mtx_destroy(&voice->mutex);
+      free(voice);
+   }
+}
+
+/*
+ * Copy no_samples samples of a track starting at sample position pos,
+ * the samples which are not available (yet) are set to zero.
+ */
+static void
+_aaxRingBufferStreamSamples(int32_t *dst, _aaxRingBufferData *rbi, int track, size_t pos, size_t no_samples)
+{
+   const _aaxRingBufferStream *stream = rbi->sample->stream;
+   _aaxRingBufferStreamVoice *voice = rbi->stream_voice;
+   size_t need, loop_end, no_resident = stream->no_resident;
+   bool queue = false;
+
+   if (pos < no_resident)
+   {
+      size_t len = _MIN(no_samples, no_resident - pos);
+
+      memcpy(dst, stream->head[track]+pos, len*sizeof(int32_t));
+      dst += len;
+      pos += len;
+      no_samples -= len;
+   }
+
+   if (!voice)
+   {
+      memset(dst, 0, no_samples*sizeof(int32_t));
+      return;
+   }
+
+   mtx_lock(&voice->mutex);
+
+   if (!voice->started)
+   {
+      voice->priority = _aaxRingBufferStreamStart();
+      voice->started = true;
+   }
+
+   /* the start of the loop is used only once it is read completely */
+   loop_end = voice->loop_first;
+   if (voice->loop_size && voice->loop_count == voice->loop_size) {
+      loop_end += voice->loop_size;
+   }
+
+   if (no_samples && pos >= voice->loop_first && pos < loop_end)
+   {
+      size_t len = _MIN(no_samples, loop_end - pos);
+
+      memcpy(dst, voice->loop[track]+pos-voice->loop_first,
+             len*sizeof(int32_t));
+      dst += len;
+      pos += len;
+      no_samples -= len;
+   }
+
+   if (no_samples && pos >= voice->first && pos <= voice->first+voice->count)
+   {
+      size_t skip = pos - voice->first;
+      size_t head = (voice->head + skip) % voice->size;
+      size_t len, offs;
+
+      len = _MIN(no_samples, voice->count - skip);
+      offs = _MIN(len, voice->size - head);
+      memcpy(dst, voice->ring[track]+head, offs*sizeof(int32_t));
+      memcpy(dst+offs, voice->ring[track], (len-offs)*sizeof(int32_t));
+      dst += len;
+      no_samples -= len;
+   }
+
+   /*
+    * All tracks are requested in order for the same position, the ring
+    * moves to the next sample to read from disk after the last track.
+    */
+   if (track == voice->rbd->no_tracks-1)
+   {
+      need = _MAX(pos, no_resident);
+      if (need >= voice->loop_first && need < loop_end) {
+         need = loop_end;
+      }
+      if (need < voice->first || need > voice->first+voice->count) {
+         _aaxRingBufferStreamReset(voice, need);
+      }
+      else /* samples before need are not required anymore */
+      {
+         size_t skip = need - voice->first;
+
+         voice->head = (voice->head + skip) % voice->size;
+         voice->first = need;
+         voice->count -= skip;
+      }
+
+      if (!voice->queued && _aaxRingBufferStreamNeedsFill(voice)) {
+         voice->queued = queue = true;
+      }
+   }
+   mtx_unlock(&voice->mutex);
+
+   if (no_samples) {
+      memset(dst, 0, no_samples*sizeof(int32_t));
+   }
+
+   if (queue) {
+      _aaxJobPoolAddPriority(_stream_pool, &voice->group,
+                             _aaxRingBufferStreamFill, voice, voice->priority);
+   }
+}
+
+/*
+ * The disk streamed counterpart of _aaxRingBufferProcessCodec:
+ * it copies the samples of one track which are about to be played,
+ * taking care of looping of the source buffer.
+ *
+ * @dst destination buffer for the 24-bit samples.
+ * @rbi the source ringbuffer.
+ * @track the track to copy.
+ * @src_pos starting sample position within the source track.
+ * @loop_start sample position to start from when looping.
+ * @sno_samples total length (in samples) of the source buffer.
+ * @dno_samples total length (in samples) of the destination buffer.
+ * @src_loops boolean, 0 = no srource looping, otherwise the source loops.
+ */
+void
+_aaxRingBufferProcessStream(int32_t *dst, _aaxRingBufferData *rbi, int track,
+                 size_t src_pos, size_t loop_start, size_t sno_samples,
+                 size_t dno_samples, char src_loops)
+{
+   const size_t sbuflen = sno_samples - loop_start;
+   size_t new_len, dbuflen = dno_samples;
+   int32_t *dptr = dst;
+
+   assert(rbi->sample->stream);
+   assert(src_pos <= sno_samples);
+
+   if (rbi->stream_voice && track == 0)
+   {
+      _aaxRingBufferStreamVoice *voice = rbi->stream_voice;
+      const _aaxRingBufferSample *rbd = rbi->sample;
+
+      mtx_lock(&voice->mutex);
+      /* moving back, other than by looping, restarts the voice */
+      if (src_pos < voice->last && (!src_loops || src_pos < loop_start)) {
+         voice->started = false;
+      }
+      voice->last = src_pos + _MIN(dbuflen, sno_samples - src_pos);
+
+      /* loop_start is zero until the voice passed the loop start */
+      if (src_loops) {
+         _aaxRingBufferStreamLoop(voice,
+                          (size_t)floorf(rbd->loop_start_sec*rbd->frequency_hz));
+      }
+      mtx_unlock(&voice->mutex);
+   }
+
+   if (dbuflen >= (sno_samples-src_pos)) {
+      new_len = sno_samples - src_pos;
+   } else {
+      new_len = dbuflen;
+   }
+
+   _aaxRingBufferStreamSamples(dptr, rbi, track, src_pos, new_len);
+   dbuflen -= new_len;
+
+   if (dbuflen && src_loops && sbuflen)
+   {
+      int32_t *start_dptr;
+
+      dptr += new_len;
+      start_dptr = dptr;
+
+      new_len = (dbuflen > sbuflen) ? sbuflen : dbuflen;
+      _aaxRingBufferStreamSamples(dptr, rbi, track, loop_start, new_len);
+      dbuflen -= new_len;
+      dptr += new_len;
+
+      /* repeat the already copied loop if required */
+      while (dbuflen)
+      {
+         new_len = (dbuflen > sbuflen) ? sbuflen : dbuflen;
+         _aax_memcpy(dptr, start_dptr, new_len*sizeof(int32_t));
+         dbuflen -= new_len;
+         dptr += new_len;
+      }
+   }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void
+_aaxRingBufferStreamInit(void)
+{
+   mtx_init(&_stream_mutex, mtx_plain);
+}
+
+/*
+ * Milliseconds since the I/O pool was created, the same time base the
+ * stream driver uses for the priority of its jobs.
+ */
+static unsigned int
+_aaxRingBufferStreamStart(void)
+{
+   double rv = _aaxStreamDriverSharedIOTime();
+   return _MIN(rv*1000.0, (double)(UINT_MAX-1));
+}
+
+/* Must be called with the voice mutex locked. */
+static void
+_aaxRingBufferStreamReset(_aaxRingBufferStreamVoice *voice, size_t pos)
+{
+   voice->generation++;
+   voice->failed = false;
+   voice->first = pos;
+   voice->head = 0;
+   voice->count = 0;
+}
+
+/*
+ * Keep the samples after loop_start which are not resident in memory.
+ * Must be called with the voice mutex locked.
+ */
+static void
+_aaxRingBufferStreamLoop(_aaxRingBufferStreamVoice *voice, size_t loop_start)
+{
+   size_t no_samples = voice->rbd->no_samples;
+   size_t first = _MAX(loop_start, voice->stream->no_resident);
+
+   if (first != voice->loop_first || !voice->loop_size)
+   {
+      voice->loop_generation++;
+      voice->loop_first = first;
+      voice->loop_size = 0;
+      if (first < no_samples) {
+         voice->loop_size = _MIN(RB_STREAM_LOOP, no_samples - first);
+      }
+      voice->loop_count = 0;
+      voice->failed = false;
+   }
+}
+
+/* Must be called with the voice mutex locked. */
+static bool
+_aaxRingBufferStreamNeedsFill(_aaxRingBufferStreamVoice *voice)
+{
+   bool rv = false;
+
+   if (!voice->failed && !voice->closing)
+   {
+      if (voice->loop_count < voice->loop_size) {
+         rv = true;
+      } else if ((voice->size - voice->count) >= RB_STREAM_CHUNK &&
+                 (voice->first + voice->count) < voice->rbd->no_samples) {
+         rv = true;
+      }
+   }
+
+   return rv;
+}
+
+/*
+ * Read the next chunk from disk into the loop start of the voice, or into
+ * the ring once the loop start is complete.
+ */
+static int
+_aaxRingBufferStreamFill(void *id)
+{
+   _aaxRingBufferStreamVoice *voice = id;
+   const _aaxRingBufferSample *rbd = voice->rbd;
+   const _aaxRingBufferStream *stream = voice->stream;
+   unsigned int generation;
+   size_t pos, len;
+   ssize_t res = 0;
+   bool again, loop;
+
+   mtx_lock(&voice->mutex);
+   loop = (voice->loop_count < voice->loop_size) ? true : false;
+   if (loop)
+   {
+      generation = voice->loop_generation;
+      pos = voice->loop_first + voice->loop_count;
+      len = _MIN(voice->loop_size - voice->loop_count, RB_STREAM_CHUNK);
+   }
+   else
+   {
+      generation = voice->generation;
+      pos = voice->first + voice->count;
+      len = _MIN(voice->size - voice->count, RB_STREAM_CHUNK);
+      if (pos + len > rbd->no_samples) {
+         len = (pos < rbd->no_samples) ? rbd->no_samples - pos : 0;
+      }
+   }
+   if (voice->closing) len = 0;
+   mtx_unlock(&voice->mutex);
+
+   if (len)
+   {
+      if (!voice->io) voice->io = stream->open(stream->data);
+      res = voice->io ? stream->read(voice->io, voice->chunk, pos, len) : -1;
+   }
+
+   mtx_lock(&voice->mutex);
+   if (loop && generation == voice->loop_generation)
+   {
+      if (res > 0)
+      {
+         int t;
+         for (t=0; t<rbd->no_tracks; ++t) {
+            memcpy(voice->loop[t]+voice->loop_count, voice->chunk[t],
+                   res*sizeof(int32_t));
+         }
+         voice->loop_count += res;
+      }
+      else if (len) {
+         voice->failed = true;
+      }
+   }
+   else if (!loop && generation == voice->generation)
+   {
+      if (res > 0)
+      {
+         size_t tail = (voice->head + voice->count) % voice->size;
+         size_t offs = _MIN((size_t)res, voice->size - tail);
+         int t;
+
+         for (t=0; t<rbd->no_tracks; ++t)
+         {
+            memcpy(voice->ring[t]+tail, voice->chunk[t], offs*sizeof(int32_t));
+            memcpy(voice->ring[t], voice->chunk[t]+offs,
+                   (res-offs)*sizeof(int32_t));
+         }
+         voice->count += res;
+      }
+      else if (len) {
+         voice->failed = true;
+      }
+   }
+
+   again = _aaxRingBufferStreamNeedsFill(voice);
+   voice->queued = again;
+   mtx_unlock(&voice->mutex);
+
+   if (again) {
+      _aaxJobPoolAddPriority(_stream_pool, &voice->group,
+                             _aaxRingBufferStreamFill, voice, voice->priority);
+   }
+
+   return true;
+}
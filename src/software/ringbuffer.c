@@ -47,6 +47,9 @@ float _aax_cubic_threshold = 0.25f;
 
 static int _aaxRingBufferClear(_aaxRingBufferData*, int, bool);
 static void _aaxRingBufferInitFunctions(_aaxRingBuffer*);
+static void _aaxRingBufferSynthReset(_aaxRingBufferData*);
+static void _aaxRingBufferExpandBlocks(_aaxRingBufferData*);
+static void _aaxRingBufferExpandStream(_aaxRingBufferData*);
 
 static _aaxFormat_t _aaxRingBufferFormat[AAX_FORMAT_MAX];
 
@@ -84,6 +87,38 @@ _aaxRingBufferAlloc()
    return rb;
 }
 
+static void
+_aaxRingBufferSetMix1N(_aaxRingBufferData *rbi)
+{
+   _aaxRingBufferSample *rbd = rbi->sample;
+
+   if (rbd->ambisonics_order > 0) {
+      rbd->mix1n = _aaxRingBufferMixMono16Ambisonics;
+   }
+   else
+   {
+      switch(rbi->mode)
+      {
+      case AAX_MODE_WRITE_SPATIAL:
+         rbd->mix1n = _aaxRingBufferMixMono16Spatial;
+         break;
+      case AAX_MODE_WRITE_SURROUND:
+         rbd->mix1n = _aaxRingBufferMixMono16Surround;
+         break;
+      case AAX_MODE_WRITE_SPATIAL_SURROUND:
+         rbd->mix1n = _aaxRingBufferMixMono16SpatialSurround;
+         break;
+      case AAX_MODE_WRITE_HRTF:
+         rbd->mix1n = _aaxRingBufferMixMono16HRTF;
+         break;
+      case AAX_MODE_WRITE_STEREO:
+      default:
+         rbd->mix1n = _aaxRingBufferMixMono16Stereo;
+         break;
+      }
+   }
+}
+
 _aaxRingBuffer *
 _aaxRingBufferCreate(float dde, enum aaxRenderMode mode)
 {
@@ -134,29 +169,12 @@ _aaxRingBufferCreate(float dde, enum aaxRenderMode mode)
          rbd->track_len_set = false;
          rbd->freqfilter = _batch_freqfilter_float;
          rbd->resample = _batch_resample_float;
+         rbd->resample_ramp = _batch_resample_ramp_float;
          rbd->multiply = _batch_fmul_value;
          rbd->add = _batch_fmadd;
          rbd->mix1 = _aaxRingBufferMixMono16Mono;
          rbd->mixmn = _aaxRingBufferMixStereo16;
-         switch(rbi->mode)
-         {
-         case AAX_MODE_WRITE_SPATIAL:
-           rbd->mix1n = _aaxRingBufferMixMono16Spatial;
-            break;
-         case AAX_MODE_WRITE_SURROUND:
-            rbd->mix1n = _aaxRingBufferMixMono16Surround;
-            break;
-         case AAX_MODE_WRITE_SPATIAL_SURROUND:
-            rbd->mix1n = _aaxRingBufferMixMono16SpatialSurround;
-            break;
-         case AAX_MODE_WRITE_HRTF:
-            rbd->mix1n = _aaxRingBufferMixMono16HRTF;
-            break;
-         case AAX_MODE_WRITE_STEREO:
-         default:
-            rbd->mix1n = _aaxRingBufferMixMono16Stereo;
-            break;
-         }
+         _aaxRingBufferSetMix1N(rbi);
 
          ddesamps = ceilf(dde * rbd->frequency_hz);
          rbd->dde_samples = ddesamps ? ddesamps : HISTORY_SAMPS;
@@ -192,12 +210,36 @@ _aaxRingBufferDestroy(_aaxRingBuffer *rb)
          if (rbd->track) _aax_free(rbd->track);
          rbd->track = NULL;
 
+         free(rbd->blocks);
+         rbd->blocks = NULL;
+
+         _aaxRingBufferStreamDestroy(rbd->stream);
+         rbd->stream = NULL;
+
          if (rbd->scratch) free(rbd->scratch);
          rbd->scratch = NULL;
 
+         _aaxRingBufferTruePeakLimiterDestroy(rbd->limiter);
+         rbd->limiter = NULL;
+
+         _aaxRingBufferHRIRDestroy(rbd->hrir);
+         rbd->hrir = NULL;
+
+         _aaxRingBufferAmbisonicsDestroy(rbd->ambisonics);
+         rbd->ambisonics = NULL;
+
+         free(rbd->synth);
+         rbd->synth = NULL;
+
          free(rbi->sample);
          rbi->sample = NULL;
       }
+      free(rbi->block_cache);
+      rbi->block_cache = NULL;
+
+      _aaxRingBufferStreamVoiceDestroy(rbi->stream_voice);
+      rbi->stream_voice = NULL;
+
       rb->id = FADEDBAD;
       free(rb);
    }
@@ -279,6 +321,48 @@ _aaxRingBufferInitTracks(_aaxRingBufferData *rbi)
    while (0);
 }
 
+/* decode the compressed blocks into newly allocated tracks */
+static void
+_aaxRingBufferExpandBlocks(_aaxRingBufferData *rbi)
+{
+   _aaxRingBufferSample *rbd = rbi->sample;
+   float loop_start_sec = rbd->loop_start_sec;
+   float loop_end_sec = rbd->loop_end_sec;
+
+   assert(rbd->blocks);
+   assert(!rbd->track);
+
+   _aaxRingBufferInitTracks(rbi);
+   rbd->loop_start_sec = loop_start_sec;
+   rbd->loop_end_sec = loop_end_sec;
+
+   if (rbd->track) {
+      _aaxRingBufferBlocksDecode(rbd, rbd->track);
+   }
+}
+
+/* read the disk streamed sample into newly allocated tracks */
+static void
+_aaxRingBufferExpandStream(_aaxRingBufferData *rbi)
+{
+   _aaxRingBufferSample *rbd = rbi->sample;
+   float loop_start_sec = rbd->loop_start_sec;
+   float loop_end_sec = rbd->loop_end_sec;
+
+   assert(rbd->stream);
+   assert(!rbd->track);
+
+   _aaxRingBufferInitTracks(rbi);
+   rbd->loop_start_sec = loop_start_sec;
+   rbd->loop_end_sec = loop_end_sec;
+
+   if (rbd->track && !_aaxRingBufferStreamRead(rbd, rbd->track))
+   {
+      _aax_free(rbd->track);
+      rbd->track = NULL;
+   }
+}
+
 MIX_T**
 _aaxRingBufferCreateScratch(_aaxRingBuffer *rb)
 {
@@ -376,6 +460,19 @@ _aaxRingBufferReference(_aaxRingBuffer *ringbuffer)
       rbi->curr_pos_sec = 0.0;
       rbi->curr_sample = 0;
       rbi->sample->scratch = NULL;
+      _aaxRingBufferSynthReset(rbi);
+
+      /* every reference decodes compressed data independently */
+      rbi->block_cache = NULL;
+      if (rbi->sample->blocks) {
+         rbi->block_cache = _aaxRingBufferBlockCacheCreate(rbi->sample);
+      }
+
+      /* every reference streams from disk independently */
+      rbi->stream_voice = NULL;
+      if (rbi->sample->stream) {
+         rbi->stream_voice = _aaxRingBufferStreamVoiceCreate(rbi->sample);
+      }
 
 #ifndef NDEBUG
       rbi->parent = rb;
@@ -417,6 +514,8 @@ _aaxRingBufferDuplicate(_aaxRingBuffer *ringbuffer, bool copy, bool dde)
       _aax_memcpy(drbi, srbi, sizeof(_aaxRingBufferData));
       drbi->access = RB_RW_MAX;
       drbi->sample = drbd;
+      drbi->block_cache = NULL;
+      drbi->stream_voice = NULL;
 #ifndef NDEBUG
       drbi->parent = drb;
 #endif
@@ -425,6 +524,19 @@ _aaxRingBufferDuplicate(_aaxRingBuffer *ringbuffer, bool copy, bool dde)
       _aax_memcpy(drbd, srbd, sizeof(_aaxRingBufferSample));
       drbd->track = ptr;
       drbd->scratch = NULL;
+      drbd->limiter = NULL;
+      drbd->hrir = NULL;
+      drbd->ambisonics = NULL;
+      drbd->synth = NULL;
+      drbd->blocks = NULL;
+      drbd->stream = NULL;
+      if (srbd->synth)
+      {
+         drbd->synth = malloc(sizeof(_aaxSynthVoice));
+         if (drbd->synth) {
+            memcpy(drbd->synth, srbd->synth, sizeof(_aaxSynthVoice));
+         }
+      }
       if (!dde)
       {
          drbd->dde_sec = 0.0f;
@@ -445,7 +557,19 @@ _aaxRingBufferDuplicate(_aaxRingBuffer *ringbuffer, bool copy, bool dde)
 
       _aaxRingBufferInit(drb, add_scratchbuf);
 
-      if ((copy || dde) && drbd->track)
+      if (copy && srbd->blocks && !srbd->track)
+      {
+         if (drbd->track) {
+            _aaxRingBufferBlocksDecode(srbd, drbd->track);
+         }
+      }
+      else if (copy && srbd->stream && !srbd->track)
+      {
+         if (drbd->track) {
+            _aaxRingBufferStreamRead(srbd, drbd->track);
+         }
+      }
+      else if ((copy || dde) && drbd->track)
       {
          size_t t, ds, tracksize;
 
@@ -510,6 +634,11 @@ _aaxRingBufferGetTracksPtr(_aaxRingBuffer *rb, enum _aaxRingBufferMode mode)
    if (rbd)
    {
       rbi->access = mode;
+      if (rbd->blocks && !rbd->track) {
+         _aaxRingBufferExpandBlocks(rbi);
+      } else if (rbd->stream && !rbd->track) {
+         _aaxRingBufferExpandStream(rbi);
+      }
       if (rbd->mixer_fmt && (rbi->access & RB_READ))
       {
          _aaxRingBufferSample *rbd = rbi->sample;
@@ -552,6 +681,36 @@ _aaxRingBufferReleaseTracksPtr(_aaxRingBuffer *rb)
          _batch_cvtps24_24(tracks[track], tracks[track], no_samples);
       }
    }
+
+   /* compressed data is only expanded while the tracks are accessed */
+   if (rbd->blocks && rbd->track)
+   {
+      if (!(rbi->access & RB_WRITE))
+      {
+         _aax_free(rbd->track);
+         rbd->track = NULL;
+      }
+      else if (!_aaxRingBufferBlocksEncode(rbd))
+      {  /* keep the new data uncompressed */
+         free(rbd->blocks);
+         rbd->blocks = NULL;
+      }
+   }
+
+   /* disk streamed data is only read while the tracks are accessed */
+   if (rbd->stream && rbd->track)
+   {
+      if (!(rbi->access & RB_WRITE))
+      {
+         _aax_free(rbd->track);
+         rbd->track = NULL;
+      }
+      else if (rbd->ref_counter == 1)
+      {  /* keep the new data resident */
+         _aaxRingBufferStreamDestroy(rbd->stream);
+         rbd->stream = NULL;
+      }
+   }
    rbi->access = RB_RW_MAX;
    return true;
 }
@@ -600,6 +759,7 @@ _aaxRingBufferSetState(_aaxRingBuffer *rb, enum _aaxRingBufferState state)
    case RB_CLEARED_DDE:
       _aaxRingBufferClear(rbi, RB_ALL_TRACKS,
                           (state == RB_CLEARED) ? false : true);
+      _aaxRingBufferHRIRClear(rbi->sample);
 
       rbi->elapsed_sec = 0.0f;
       rbi->pitch_norm = 1.0;
@@ -638,6 +798,7 @@ _aaxRingBufferSetState(_aaxRingBuffer *rb, enum _aaxRingBufferState state)
          rbi->curr_sample = 0;
 //       rbi->looping = 0;
       }
+      _aaxRingBufferSynthReset(rbi);
       break;
    case RB_FORWARDED:
       rbi->curr_pos_sec = rbi->sample->duration_sec;
@@ -676,7 +837,8 @@ _aaxRingBufferGetState(_aaxRingBuffer *rb, enum _aaxRingBufferState state)
    switch (state)
    {
    case RB_IS_VALID:
-      if (rb && rbi->sample && rbi->sample->track) {
+      if (rb && rbi->sample && (rbi->sample->track || rbi->sample->blocks ||
+                                  rbi->sample->stream)) {
          rv = -1;
       }
       break;
@@ -777,6 +939,9 @@ _aaxRingBufferSetParamf(_aaxRingBuffer *rb, enum _aaxRingBufferParam param, floa
    case RB_AGC_VALUE:
       rbi->gain_agc = fval;
       break;
+   case RB_LIMITER_LOOKAHEAD:
+      rbd->lookahead_sec = fval;
+      break;
    case RB_FREQUENCY:
       rbd->frequency_hz = fval;
       rbd->duration_sec = (fval > 0) ? (float)rbd->no_samples/fval : 0.0f;
@@ -935,6 +1100,24 @@ _aaxRingBufferSetParami(_aaxRingBuffer *rb, enum _aaxRingBufferParam param, unsi
       }
       rbd->mixer_fmt = (val != 0) ? true : false;
       break;
+   case RB_COMPRESSED:
+      if (val) {
+         rv = rbd->blocks ? true : _aaxRingBufferBlocksEncode(rbd);
+      }
+      else if (rbd->blocks)
+      {
+         if (!rbd->track) _aaxRingBufferExpandBlocks(rbi);
+         if (rbd->track)
+         {
+            free(rbd->blocks);
+            rbd->blocks = NULL;
+            rv = true;
+         }
+      }
+      else {
+         rv = true;
+      }
+      break;
    case RB_BYTES_SAMPLE:
       if (rbd->track == NULL) {
          rbd->bits_sample = val*8;
@@ -960,6 +1143,17 @@ _aaxRingBufferSetParami(_aaxRingBuffer *rb, enum _aaxRingBufferParam param, unsi
       rbd->no_layers = val;
       rv = true;
       break;
+   case RB_AMBISONICS_ORDER:
+      if (val <= _AAX_MAX_AMBISONICS_ORDER)
+      {
+         if (rbd->ambisonics_order != val)
+         {
+            rbd->ambisonics_order = val;
+            _aaxRingBufferSetMix1N(rbi);
+         }
+         rv = true;
+      }
+      break;
    case RB_LOOPING:
       rbi->loop_mode = val ? true : false;
       rbi->looping = rbi->loop_mode;
@@ -1250,6 +1444,12 @@ _aaxRingBufferGetParami(const _aaxRingBuffer *rb, enum _aaxRingBufferParam param
    case RB_IS_MIXER_BUFFER:
       rv = (rbd->mixer_fmt != false) ? true : false;
       break;
+   case RB_COMPRESSED:
+      rv = rbd->blocks ? true : false;
+      break;
+   case RB_AMBISONICS_ORDER:
+      rv = rbd->ambisonics_order;
+      break;
    default:
       if ((param >= RB_PEAK_VALUE) &&
           (param <= RB_PEAK_VALUE_MAX))
@@ -1524,7 +1724,8 @@ _aaxRingBufferDataLimiter(_aaxRingBuffer *rb, enum _aaxLimiterType type)
       { 0.5f, 0.0f },		// Electronic
       { 0.9f, 0.0f }, 		// Digital
       { 0.2f, 0.9f },		// Valve
-      { 0.0f, 0.0f }		// Comress
+      { 0.0f, 0.0f },		// Comress
+      { 0.0f, 0.0f }		// True-peak
    };
 
    _aaxRingBufferData *rbi = rb->handle;
@@ -1541,6 +1742,11 @@ _aaxRingBufferDataLimiter(_aaxRingBuffer *rb, enum _aaxLimiterType type)
 
    maxrms = maxpeak = 0;
    tracks = (MIX_T**)rbd->track;
+   if (type == RB_LIMITER_TRUEPEAK)
+   {  // the gain is linked across all tracks
+      _aaxRingBufferTruePeakLimiter(rbd, tracks, no_tracks, no_samples);
+   }
+
    for (track=0; track<no_tracks; track++)
    {
       MIX_T *dptr = tracks[track];
@@ -1551,7 +1757,7 @@ _aaxRingBufferDataLimiter(_aaxRingBuffer *rb, enum _aaxLimiterType type)
 
       if (type == RB_COMPRESS) {
          _aaxRingBufferCompress(dptr, no_samples, _val[type][0], _val[type][1]);
-      } else {
+      } else if (type != RB_LIMITER_TRUEPEAK) {
          _aaxRingBufferLimiter(dptr, no_samples, _val[type][0], _val[type][1]);
       }
 
@@ -1615,6 +1821,20 @@ _aaxRingBufferClear(_aaxRingBufferData *rbi, int t, bool dde)
    return true;
 }
 
+/* restart the oscillators of a live voice at their initial phase */
+static void
+_aaxRingBufferSynthReset(_aaxRingBufferData *rbi)
+{
+   _aaxSynthVoice *synth = rbi->sample->synth;
+   if (synth)
+   {
+      unsigned int i;
+      for (i=0; i<synth->no_oscillators; ++i) {
+         rbi->synth_phase[i] = synth->osc[i].phase;
+      }
+   }
+}
+
 static void
 _aaxRingBufferInitFunctions(_aaxRingBuffer *rb)
 {
@@ -276,6 +276,7 @@ _aaxSensorCapture(_aaxRingBuffer *drb, const _aaxDriverBackend* be, void *be_han
       float freq, dt = GMATH_E1 * (*delay);
       size_t frames, nframes;
       ssize_t res, offs;
+      char mixer_fmt;
       void **sbuf;
 
       if (agc_rr > 0.0f)
@@ -287,7 +288,12 @@ _aaxSensorCapture(_aaxRingBuffer *drb, const _aaxDriverBackend* be, void *be_han
       offs = 0;
       nframes = frames = drb->get_parami(drb, RB_NO_SAMPLES);
 
-      sbuf = (void**)drb->get_tracks_ptr(drb, RB_WRITE);
+      // backends which can deliver the mixer format skip the conversion
+      mixer_fmt = false;
+      if (be->set_param) {
+         mixer_fmt = be->set_param(be_handle, DRIVER_MIXER_FORMAT, true);
+      }
+      sbuf = (void**)drb->get_tracks_ptr(drb, mixer_fmt ? RB_NONE : RB_WRITE);
       res = be->capture(be_handle, sbuf, &offs, &nframes,
                         scratch[SCRATCH_BUFFER0]-ds, 2*2*ds+frames, gain,
                         batched);
@@ -303,7 +309,7 @@ _aaxSensorCapture(_aaxRingBuffer *drb, const _aaxDriverBackend* be, void *be_han
       // be->capture can capture one extra sample to keep synchronised with
       // the capture buffer but it is in int32_t format while the mixer format
       // might be float. Convert this sample to float ourselves.
-      if (offs < 0)
+      if (offs < 0 && !mixer_fmt)
       {
          assert (offs == -1);
          for (track=0; track<no_tracks; track++)
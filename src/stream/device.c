@@ -31,7 +31,9 @@
 #include <xml.h>
 
 #include <base/types.h>
+#include <base/timer.h>
 #include <base/logging.h>
+#include <base/bytering.h>
 
 #include <api.h>
 #include <arch.h>
@@ -70,6 +72,7 @@ static _aaxDriverGetName _aaxStreamDriverGetName;
 static _aaxDriverRender _aaxStreamDriverRender;
 static _aaxDriverState _aaxStreamDriverState;
 static _aaxDriverParam _aaxStreamDriverParam;
+static _aaxDriverSetParam _aaxStreamDriverSetParam;
 static _aaxDriverThread _aaxStreamDriverThread;
 
 static char _file_default_renderer[MAX_ID_STRLEN] = DEFAULT_RENDERER;
@@ -110,7 +113,9 @@ const _aaxDriverBackend _aaxStreamDriverBackend =
 
    (_aaxDriverState *)&_aaxStreamDriverState,
    (_aaxDriverParam *)&_aaxStreamDriverParam,
-   (_aaxDriverLog *)&_aaxStreamDriverLog
+   (_aaxDriverLog *)&_aaxStreamDriverLog,
+
+   (_aaxDriverSetParam *)&_aaxStreamDriverSetParam
 };
 
 typedef struct
@@ -121,9 +126,12 @@ typedef struct
    struct _meta_t meta;
 
    char use_iothread;
+   char use_shared_io;
    char copy_to_buffer; // true if Capture has to copy the data unmodified
+   char mixer_fmt; // true if Capture returns the data in the mixer format
    char start_with_fill;
    char end_of_file;
+   atomic_bool flush; // discard ioRing and rawBuffer after a seek
 
    uint8_t bits_sample;
    uint8_t no_channels;
@@ -152,15 +160,28 @@ typedef struct
    //  * ioBuffer for reading/writing data from or to a file or socket.
    //  * rawBuffer for managing data to or from a device, could be encoded.
    //
-   // data has to be transfered between the two when capturing or writing.
-   // ioBuffer needs to be locked if accessed, rawBuffer does not.
+   // data is transfered between the two through ioRing, a single-producer
+   // single-consumer ring, so the mixer thread never has to wait for the
+   // I/O thread which may block in recv or write.
+   // ioBuffer is only used by the I/O side, ioBufLock serializes it with
+   // seeking. rawBuffer is only used by the mixer thread.
    _aaxMutex *ioBufLock;
+   _aaxJobGroup io_group; // pending read or decode job of the shared pool
+   uint64_t io_bytes;     // no. bytes moved to rawBuffer by the shared I/O
+   uint64_t io_frames;    // no. frames produced from them
+   _aaxByteRing *ioRing;
    _data_t *ioBuffer;
    _data_t *rawBuffer;
 
-   // the recv function can block causing ioBufLock to be held for too long.
-   // use a separate buffer for recv to circumvent this problem.
-   _data_t *captureBuffer;
+   // decoding ahead by the shared pool, see _aaxStreamDriverDecodeJob.
+   // the pool decodes into pcmRing, one ring per track, and owns the
+   // extension, ioRing and rawBuffer. The mixer only reads from pcmRing.
+   char decode_ahead;
+   char decode_float;     // pcmRing holds MIX_T instead of int32_t samples
+   atomic_bool decode_eof;
+   size_t decode_frames;  // no. frames decoded at once
+   int32_t *decode_tracks[_AAX_MAX_SPEAKERS];
+   _aaxByteRing *pcmRing[_AAX_MAX_SPEAKERS];
 
 #if USE_PID
    struct {
@@ -175,11 +196,57 @@ typedef struct
 } _driver_t;
 
 static _ext_t* _aaxGetFormat(const char*, enum aaxRenderMode);
+static void _aaxStreamDriverFreeExt(_driver_t*);
 
 static int _aaxStreamDriverReadThread(void*);
 static int _aaxStreamDriverWriteThread(void*);
 static size_t _aaxStreamDriverWriteChunk(const void*);
 static ssize_t _aaxStreamDriverReadChunk(const void*);
+static ssize_t _aaxStreamDriverReadData(_driver_t*);
+static void _aaxStreamDriverSharedIOInit(void);
+static bool _aaxStreamDriverSharedIOEnabled(void);
+static void _aaxStreamDriverSharedRead(_driver_t*, char);
+static bool _aaxStreamDriverDecodeStart(_driver_t*);
+static void _aaxStreamDriverDecodeStop(_driver_t*);
+static void _aaxStreamDriverSharedDecode(_driver_t*);
+static int _aaxStreamDriverDecodeJob(void*);
+static ssize_t _aaxStreamDriverDecoded(_driver_t*, void**, ssize_t, size_t*, char);
+static ssize_t _aaxStreamDriverDecode(_driver_t*, int32_t**, ssize_t*, ssize_t*, size_t*, char, char);
+
+/*
+ * Local files opened for reading can share a pool of I/O threads instead
+ * of every stream starting one of its own, see AAX_STREAM_SHARED_IO.
+ * Disk streamed buffer samples always use this pool for their read-ahead.
+ * The capture callback queues a read job which fills the I/O buffer.
+ *
+ * Jobs are executed in the order in which the streams would run out of
+ * data: the priority of a job is the time (in ms.) at which the data
+ * already buffered for the stream is used up.
+ *
+ * AAX_STREAM_IO_THREADS sets the number of threads of the pool and
+ * AAX_STREAM_READ_AHEAD_MS limits the amount of data read ahead for
+ * every stream, by default the I/O buffer is filled completely.
+ *
+ * Streams which are decoded by the stream driver are decoded ahead by the
+ * pool as well: a decode job reads, decodes and queues the samples in a
+ * ring per track until the rings hold AAX_STREAM_READ_AHEAD_MS of audio
+ * (SHARED_DECODE_AHEAD_MS by default). The job priority is the time at
+ * which the decoded samples are used up, so the stream which is about to
+ * underrun decodes first. The job holds ioBufLock while it uses the
+ * extension, which serializes it with seeking. The capture callback of
+ * the mixer only copies from the rings and never waits for the pool,
+ * samples which are not decoded in time are returned as silence.
+ */
+#define SHARED_IO_THREADS	2
+#define SHARED_DECODE_AHEAD_MS	200
+
+static once_flag _shared_io_once = ONCE_FLAG_INIT;
+static mtx_t _shared_io_mutex;
+static _aaxJobPool *_shared_io_pool = NULL;
+static unsigned int _shared_io_refs = 0;
+static unsigned int _shared_io_read_ahead = 0;
+static _aaxTimer *_shared_io_timer = NULL;
+static double _shared_io_time = 0.0;
 
 static char default_renderer[256];
 
@@ -199,9 +266,17 @@ _aaxStreamDriverNewHandle(enum aaxRenderMode mode)
       handle->mode = mode;
       handle->rawBuffer = _aaxDataCreate(1, IOBUF_SIZE, 1);
       handle->ioBuffer = _aaxDataCreate(1, IOBUF_SIZE, 1);
+      handle->ioRing = _aaxByteRingCreate(IOBUF_SIZE);
+      if (!handle->rawBuffer || !handle->ioBuffer || !handle->ioRing)
+      {
+         _aaxByteRingDestroy(handle->ioRing);
+         _aaxDataDestroy(handle->ioBuffer);
+         _aaxDataDestroy(handle->rawBuffer);
+         free(handle);
+         return NULL;
+      }
 #if USE_CAPTURE_THREAD
       handle->use_iothread = 1;
-      handle->captureBuffer = _aaxDataCreate(1, IOBUF_SIZE, 1);
 #elif USE_PLAYBACK_THREAD
       handle->use_iothread = 1;
 #endif
@@ -363,14 +438,21 @@ _aaxStreamDriverDisconnect(void *id)
 
    if (handle)
    {
+      if (handle->use_shared_io)
+      {
+         _aaxJobPoolWaitOwn(_shared_io_pool, &handle->io_group);
+         _aaxStreamDriverSharedIOStop();
+         _aaxStreamDriverDecodeStop(handle);
+         handle->use_shared_io = false;
+      }
+
       if (handle->iothread.started)
       {
          handle->iothread.started = false;
 
-         _aaxSignalTrigger(&handle->iothread.signal);
+         _aaxByteRingWake(handle->ioRing);
          _aaxThreadJoin(handle->iothread.ptr);
       }
-      _aaxSignalFree(&handle->iothread.signal);
       _aaxMutexDestroy(handle->ioBufLock);
 
       if (handle->iothread.ptr) {
@@ -408,7 +490,7 @@ _aaxStreamDriverDisconnect(void *id)
             }
          }
          handle->ext->close(handle->ext);
-         handle->ext = _ext_free(handle->ext);
+         _aaxStreamDriverFreeExt(handle);
       }
       if (handle->io)
       {
@@ -422,11 +504,9 @@ _aaxStreamDriverDisconnect(void *id)
          free(handle->render);
       }
 
+      _aaxByteRingDestroy(handle->ioRing);
       _aaxDataDestroy(handle->ioBuffer);
       _aaxDataDestroy(handle->rawBuffer);
-#if USE_CAPTURE_THREAD
-      _aaxDataDestroy(handle->captureBuffer);
-#endif
       if (handle->interfaces) {
          free(handle->interfaces);
       }
@@ -532,7 +612,7 @@ _aaxStreamDriverSetup(const void *id, float *refresh_rate, int *fmt,
             int fmt = handle->io->get_param(handle->io, __F_EXTENSION);
             if (fmt)
             {
-               handle->ext = _ext_free(handle->ext);
+               _aaxStreamDriverFreeExt(handle);
                handle->ext = _ext_create(fmt);
                if (handle->ext)
                {
@@ -542,7 +622,7 @@ _aaxStreamDriverSetup(const void *id, float *refresh_rate, int *fmt,
             }
             else
             {
-               handle->ext = _ext_free(handle->ext);
+               _aaxStreamDriverFreeExt(handle);
                handle->ext = _aaxGetFormat(handle->name, handle->mode);
                if (handle->ext)
                {
@@ -569,7 +649,7 @@ _aaxStreamDriverSetup(const void *id, float *refresh_rate, int *fmt,
          handle->io->set_param(handle->io, __F_FLAGS, handle->mode);
          if (handle->io->open(handle->io, ioBuffer, path, NULL) >= 0)
          {
-            handle->ext = _ext_free(handle->ext);
+            _aaxStreamDriverFreeExt(handle);
             handle->ext = _aaxGetFormat(handle->name, handle->mode);
             if (handle->ext)
             {
@@ -710,19 +790,37 @@ _aaxStreamDriverSetup(const void *id, float *refresh_rate, int *fmt,
 
             if (handle->use_iothread)
             {
-               _aaxSignalInit(&handle->iothread.signal);
-
-               handle->iothread.ptr = _aaxThreadCreate();
-               if (handle->mode == AAX_MODE_READ) {
-                  handle->ioBufLock = _aaxMutexCreate(handle->ioBufLock);
+               handle->ioBufLock = _aaxMutexCreate(handle->ioBufLock);
+               if (handle->mode == AAX_MODE_READ &&
+                   handle->io->protocol == PROTOCOL_DIRECT &&
+                   _aaxStreamDriverSharedIOEnabled() &&
+                   _aaxStreamDriverSharedIOStart())
+               {
+                  handle->use_shared_io = true;
 
-                  res = _aaxThreadStart(handle->iothread.ptr,
-                                        _aaxStreamDriverReadThread, handle, 20,
-					"aaxStreamRead");
-               } else {
-                  res = _aaxThreadStart(handle->iothread.ptr,
-                                       _aaxStreamDriverWriteThread, handle, 20,
-				       "aaxStreamWrite");
+                  _aaxJobGroupInit(&handle->io_group);
+                  if (!handle->copy_to_buffer)
+                  {
+                     if (_aaxStreamDriverDecodeStart(handle)) {
+                        _aaxStreamDriverSharedDecode(handle);
+                     } else {
+                        _aaxStreamDriverSharedRead(handle, false);
+                     }
+                  }
+                  res = thrd_success;
+               }
+               else
+               {
+                  handle->iothread.ptr = _aaxThreadCreate();
+                  if (handle->mode == AAX_MODE_READ) {
+                     res = _aaxThreadStart(handle->iothread.ptr,
+                                           _aaxStreamDriverReadThread, handle, 20,
+					   "aaxStreamRead");
+                  } else {
+                     res = _aaxThreadStart(handle->iothread.ptr,
+                                          _aaxStreamDriverWriteThread, handle, 20,
+				          "aaxStreamWrite");
+                  }
                }
             }
             else {
@@ -731,7 +829,7 @@ _aaxStreamDriverSetup(const void *id, float *refresh_rate, int *fmt,
 
             if (res == thrd_success)
             {
-               if (handle->use_iothread) {
+               if (handle->use_iothread && !handle->use_shared_io) {
                   handle->iothread.started = true;
                }
 
@@ -761,7 +859,7 @@ _aaxStreamDriverSetup(const void *id, float *refresh_rate, int *fmt,
 
          if (!rv)
          {
-            handle->ext = _ext_free(handle->ext);
+            _aaxStreamDriverFreeExt(handle);
             handle->io->close(handle->io);
             handle->io = _io_free(handle->io);
          }
@@ -841,19 +939,17 @@ _aaxStreamDriverPlayback(const void *id, void *src, UNUSED(float pitch), float g
    }
    _aaxDataIncreaseOffset(handle->rawBuffer, 0, res);
 
-   // Move data from rawBuffer to ioBuffer
-   if (!_aaxMutexLockTimed(handle->ioBufLock, handle->dt))
-   {
-      res = _aaxDataGetDataAvail(handle->rawBuffer, 0);
-      _aaxDataMoveData(handle->rawBuffer, 0, handle->ioBuffer, 0, res);
-      _aaxMutexUnLock(handle->ioBufLock);
-   }
+   // Move data from rawBuffer to ioRing
+   res = _aaxDataGetDataAvail(handle->rawBuffer, 0);
+   res = _aaxByteRingWrite(handle->ioRing,
+                           _aaxDataGetData(handle->rawBuffer, 0), res);
+   _aaxDataMove(handle->rawBuffer, 0, NULL, res);
 
    if (batched) {
       _aaxStreamDriverWriteChunk(id);
    } else {
 #if USE_PLAYBACK_THREAD
-      _aaxSignalTrigger(&handle->iothread.signal);
+      _aaxByteRingWake(handle->ioRing);
 #else
       _aaxStreamDriverWriteChunk(id);
 #endif
@@ -866,167 +962,261 @@ static ssize_t
 _aaxStreamDriverCapture(const void *id, void **dst, ssize_t *offset, size_t *frames, UNUSED(void *scratch), UNUSED(size_t scratchSize), float gain, char batched)
 {
    _driver_t *handle = (_driver_t *)id;
-   int file_tracks = handle->ext->get_param(handle->ext, __F_TRACKS);
    ssize_t offs = *offset, xoffs = *offset;
-// size_t xframes = *frames;
-   int num = 5*file_tracks;
    size_t bytes = 0;
+   int file_tracks;
 
    assert(*frames);
 
+   // the extension of a stream which is decoded ahead belongs to the pool
+   if (handle->decode_ahead) {
+      file_tracks = handle->no_channels;
+   } else {
+      file_tracks = handle->ext->get_param(handle->ext, __F_TRACKS);
+   }
+
    *offset = 0;
    if (handle->io->fds.fd >= 0 && frames && dst)
    {
       int32_t **tracks = (int32_t**)dst;
-      unsigned char *data;
-      ssize_t res, no_samples;
-      float new_rate;
-      size_t samples;
-
-      no_samples = (ssize_t)*frames;
-      *frames = 0;
-
-      data = NULL;
-      bytes = 0;
-      samples = no_samples;
-      res = __F_NEED_MORE;	// for handle->start_with_fill == true
-      do
+
+      // Data read before a seek is cleared before the flag is, nothing is
+      // queued while the flag is set so no data of after the seek is lost.
+      if (atomic_load(&handle->flush))
       {
-         // handle->start_with_fill == true if the previous session was
-         // a call to  handle->ext->fill and it returned __F_NEED_MORE
-         if (!handle->start_with_fill)
+         if (handle->decode_ahead)
          {
-            if (!data)
+            int t;
+            for (t=0; t<handle->no_channels; ++t) {
+               _aaxByteRingClear(handle->pcmRing[t]);
+            }
+         }
+         else
+         {
+            _aaxByteRingClear(handle->ioRing);
+            _aaxDataClear(handle->rawBuffer, 0);
+            handle->start_with_fill = false;
+         }
+         atomic_store(&handle->flush, false);
+      }
+
+      if (handle->decode_ahead)
+      {
+         bytes = _aaxStreamDriverDecoded(handle, dst, offs, frames, batched);
+         offs += *frames;
+      }
+      else
+      {
+         bytes = _aaxStreamDriverDecode(handle, tracks, &offs, &xoffs,
+                                        frames, handle->mixer_fmt, batched);
+
+         // Some formats may change the sample rate mid-stream to save
+         // bandwith, the rate of a stream which is decoded ahead is fixed.
+         handle->frequency = (float)handle->ext->get_param(handle->ext,
+                                                           __F_FREQUENCY);
+      }
+
+      if (!handle->copy_to_buffer && (ssize_t)bytes > 0)
+      {
+         /* gain is netagive for auto-gain mode */
+         gain = fabsf(gain);
+         if (fabsf(gain - 1.0f) > 0.05f)
+         {
+            int t;
+            for (t=0; t<file_tracks; t++)
             {
-               // copy or convert data from ext's internal buffer to tracks[]
-               // this allows ext or fmt to convert it to a supported format.
-               if (handle->copy_to_buffer)
+               if (handle->mixer_fmt)
                {
-                  do
-                  {
-                     res = handle->ext->copy(handle->ext, tracks[0], offs, &samples);
-                     offs += samples;
-                     no_samples -= samples;
-                     *frames += samples;
-                     if (res > 0) bytes += res;
-                  }
-                  while (res > 0);
+                  MIX_T *ptr = (MIX_T*)tracks[t] + offs;
+                  _batch_fmul_value(ptr, ptr, *frames, gain, 1.0f);
                }
                else
                {
-                  res = handle->ext->cvt_from_intl(handle->ext, tracks, offs, &samples);
+                  int32_t *ptr = (int32_t*)tracks[t] + offs;
+                  _batch_imul_value(ptr, ptr, sizeof(int32_t), *frames, gain);
+               }
+            }
+         }
+      }
+      *offset = offs-xoffs;
+   }
+
+   return bytes;
+}
+
+/*
+ * Decode up to *frames frames from the extension into tracks, starting at
+ * *offset. *frames returns the number of frames decoded and *offset the
+ * position after them, *xoffset the buffer fill error if data was read.
+ */
+static ssize_t
+_aaxStreamDriverDecode(_driver_t *handle, int32_t **tracks, ssize_t *offset, ssize_t *xoffset, size_t *frames, char mixer_fmt, char batched)
+{
+   int file_tracks = handle->ext->get_param(handle->ext, __F_TRACKS);
+   ssize_t offs = *offset, xoffs = *xoffset;
+   int num = 5*file_tracks;
+   size_t bytes, samples;
+   unsigned char *data;
+   ssize_t res, no_samples;
+   char stalled, drained;
+
+   no_samples = (ssize_t)*frames;
+   *frames = 0;
+
+   data = NULL;
+   bytes = 0;
+   drained = false;
+   samples = no_samples;
+   res = __F_NEED_MORE;	// for handle->start_with_fill == true
+   do
+   {
+      stalled = false;
+
+      // handle->start_with_fill == true if the previous session was
+      // a call to  handle->ext->fill and it returned __F_NEED_MORE
+      if (!handle->start_with_fill)
+      {
+         if (!data)
+         {
+            // copy or convert data from ext's internal buffer to tracks[]
+            // this allows ext or fmt to convert it to a supported format.
+            if (handle->copy_to_buffer)
+            {
+               do
+               {
+                  res = handle->ext->copy(handle->ext, tracks[0], offs, &samples);
                   offs += samples;
                   no_samples -= samples;
                   *frames += samples;
                   if (res > 0) bytes += res;
                }
+               while (res > 0);
             }
-            else	/* convert data still in the buffer */
+            else
             {
-               ssize_t avail = _aaxDataGetDataAvail(handle->rawBuffer, 0);
-               res = handle->ext->fill(handle->ext, data, &avail);
-               _aaxDataMove(handle->rawBuffer, 0, NULL, avail);
+               if (mixer_fmt) {
+                  res = handle->ext->cvt_from_intl_float(handle->ext,
+                                      (MIX_PTRPTR_T)tracks, offs, &samples);
+               } else {
+                  res = handle->ext->cvt_from_intl(handle->ext, tracks, offs, &samples);
+               }
+               offs += samples;
+               no_samples -= samples;
+               *frames += samples;
+               if (res > 0) bytes += res;
             }
-         } /* handle->start_with_fill */
-         handle->start_with_fill = false;
-
-         if (res == __F_EOF) {
-            handle->end_of_file = true;
-            bytes = __F_EOF;
-            break;
          }
-
-         if (handle->end_of_file && res == __F_NEED_MORE)
+         else	/* convert data still in the buffer */
          {
-            handle->start_with_fill = true;
-            bytes = __F_EOF;
-            break;
+            ssize_t avail = _aaxDataGetDataAvail(handle->rawBuffer, 0);
+            res = handle->ext->fill(handle->ext, data, &avail);
+            _aaxDataMove(handle->rawBuffer, 0, NULL, avail);
+            stalled = (avail == 0);
          }
+      } /* handle->start_with_fill */
+      handle->start_with_fill = false;
+
+      if (res == __F_EOF) {
+         handle->end_of_file = true;
+         bytes = __F_EOF;
+         break;
+      }
 
-         /* res holds the number of bytes that are actually converted */
-         /* or (-3) __F_PROCESS if the next chunk can be processed         */
-         /* or (-2) __F_NEED_MORE if fmt->fill requires more data          */
-         /* or (-1) __F_EOF if an error occured, or end of file            */
-         if (res == __F_PROCESS)
+      // a small file may be read completely before the extension
+      // has processed all of it. Once all of it is passed to the
+      // extension, convert what it still holds before it ends.
+      if (handle->end_of_file && res == __F_NEED_MORE &&
+          !_aaxByteRingGetDataAvail(handle->ioRing) &&
+          (stalled || !_aaxDataGetDataAvail(handle->rawBuffer, 0)))
+      {
+         if (data && !drained)
          {
+            drained = true;
             data = NULL;
             samples = no_samples;
+            continue;
          }
-         else if (res == __F_NEED_MORE || no_samples > 0)
-         {
-            ssize_t avail;
+         handle->start_with_fill = true;
+         bytes = __F_EOF;
+         break;
+      }
 
-            if (handle->use_iothread && !batched)
-            {
-               if (handle->io->protocol == PROTOCOL_DIRECT)
-               {
-                  _aaxSignalTrigger(&handle->iothread.signal);
-                  usecSleep(1);
-               }
-            }
-            else {
-               _aaxStreamDriverReadChunk(id);
-            }
+      /* res holds the number of bytes that are actually converted */
+      /* or (-3) __F_PROCESS if the next chunk can be processed         */
+      /* or (-2) __F_NEED_MORE if fmt->fill requires more data          */
+      /* or (-1) __F_EOF if an error occured, or end of file            */
+      if (res == __F_PROCESS)
+      {
+         data = NULL;
+         samples = no_samples;
+      }
+      else if (res == __F_NEED_MORE || no_samples > 0)
+      {
+         float target, input, err, P, I; // , D
+         float freq, delay_sec;
+         ssize_t avail;
 
-            // Move data from ioBuffer to rawBuffer
-            if (!_aaxMutexLockTimed(handle->ioBufLock, handle->dt))
-            {
-               float target, input, err, P, I; // , D
-               float freq, delay_sec;
+         if (handle->decode_ahead) {
+            _aaxStreamDriverReadData(handle);
+         }
+         else if (handle->use_shared_io) {
+            _aaxStreamDriverSharedRead(handle, batched);
+         }
+         else if (!handle->use_iothread || batched) {
+            _aaxStreamDriverReadChunk(handle);
+         }
 
-               avail = _aaxDataGetDataAvail(handle->ioBuffer, 0);
-               res = _aaxDataMoveData(handle->ioBuffer, 0, handle->rawBuffer, 0, avail);
-               _aaxMutexUnLock(handle->ioBufLock);
+         // Move data from ioRing to rawBuffer
+         avail = _aaxByteRingGetDataAvail(handle->ioRing);
+         res = _MIN(avail, _aaxDataGetFreeSpace(handle->rawBuffer, 0));
+         res = _aaxByteRingRead(handle->ioRing,
+                                _aaxDataGetPtr(handle->rawBuffer, 0), res);
+         _aaxDataIncreaseOffset(handle->rawBuffer, 0, res);
 
-               delay_sec = 1.0f/handle->refresh_rate;
-               freq = handle->frequency;
+         // let the read thread refill the space which became available
+         if (handle->use_iothread && !handle->use_shared_io && !batched &&
+             handle->io->protocol == PROTOCOL_DIRECT)
+         {
+            _aaxByteRingWake(handle->ioRing);
+         }
+
+         if (handle->use_shared_io && res > 0) {
+            handle->io_bytes += res;
+         }
 
-               /* present error */
-               target = handle->fill.aim*freq/IOBUF_THRESHOLD;
-               input = (float)avail/IOBUF_THRESHOLD;
-               P = err = input - target;
+         delay_sec = 1.0f/handle->refresh_rate;
+         freq = handle->frequency;
 
-               /* accumulation of past errors */
-               I = _MINMAX(handle->PID.I + err*delay_sec, 0.5f, 1.5f);
-               handle->PID.I = I;
+         /* present error */
+         target = handle->fill.aim*freq/IOBUF_THRESHOLD;
+         input = (float)avail/IOBUF_THRESHOLD;
+         P = err = input - target;
 
-               /* prediction of future errors, from current rate of change */
-//             D = (handle->PID.err - err)/delay_sec;
-//             handle->PID.err = err;
+         /* accumulation of past errors */
+         I = _MINMAX(handle->PID.I + err*delay_sec, 0.5f, 1.5f);
+         handle->PID.I = I;
 
-               err = _MINMAX(0.40f*P + 0.97f*I, -1.0, 1.0);
-               handle->buffer_fill = err;
-               xoffs = err;
+         /* prediction of future errors, from current rate of change */
+//          D = (handle->PID.err - err)/delay_sec;
+//          handle->PID.err = err;
+
+         err = _MINMAX(0.40f*P + 0.97f*I, -1.0, 1.0);
+         handle->buffer_fill = err;
+         xoffs = err;
 # if 0
  float fact = _MINMAX((1.0f + err), 0.9f, 1.1f);
  printf("target: %2.1f, avail: %2.1f, err: %2.1f (\033[92;4mP: %2.1f, I: %2.1f\033[0m), fact: %2.1f, xoffs: %li\n", target, input, err, P, I, fact, xoffs);
 # endif
-            }
-            data = _aaxDataGetData(handle->rawBuffer, 0); // needed above
-         }
+         data = _aaxDataGetData(handle->rawBuffer, 0); // needed above
       }
-      while (no_samples > 0 && --num);
-
-      // Some formats may change the sample rate mid-stream to save bandwith
-      new_rate = (float)handle->ext->get_param(handle->ext, __F_FREQUENCY);
-      handle->frequency = new_rate;
+   }
+   while (no_samples > 0 && --num);
 
-      if (!handle->copy_to_buffer && bytes > 0)
-      {
-         /* gain is netagive for auto-gain mode */
-         gain = fabsf(gain);
-         if (fabsf(gain - 1.0f) > 0.05f)
-         {
-            int t;
-            for (t=0; t<file_tracks; t++)
-            {
-               int32_t *ptr = (int32_t*)tracks[t] + offs;
-               _batch_imul_value(ptr, ptr, sizeof(int32_t), *frames, gain);
-            }
-         }
-      }
-      *offset = offs-xoffs;
+   if (handle->use_shared_io) {
+      handle->io_frames += *frames;
    }
+   *offset = offs;
+   *xoffset = xoffs;
 
    return bytes;
 }
@@ -1421,6 +1611,9 @@ _aaxStreamDriverParam(const void *id, enum _aaxDriverParam param)
       case DRIVER_BATCHED_MODE:
          rv = (float)true;
          break;
+      case DRIVER_MIXER_FORMAT:
+         rv = (float)handle->mixer_fmt;
+         break;
       case DRIVER_SHARED_MODE:
       default:
          /* envelopes */
@@ -1442,6 +1635,33 @@ _aaxStreamDriverParam(const void *id, enum _aaxDriverParam param)
    return rv;
 }
 
+static int
+_aaxStreamDriverSetParam(const void *id, enum _aaxDriverParam param, float value)
+{
+   _driver_t *handle = (_driver_t *)id;
+   int rv = false;
+
+   if (handle)
+   {
+      switch(param)
+      {
+      case DRIVER_MIXER_FORMAT:
+         // decode straight into the mixer format, skipping int32_t
+         handle->mixer_fmt = false;
+         if (value && handle->ext && !handle->copy_to_buffer &&
+             handle->ext->cvt_from_intl_float)
+         {
+            handle->mixer_fmt = true;
+         }
+         rv = handle->mixer_fmt;
+         break;
+      default:
+         break;
+      }
+   }
+   return rv;
+}
+
 static int
 _aaxStreamDriverSetPosition(const void *id, off_t samples)
 {
@@ -1450,8 +1670,35 @@ _aaxStreamDriverSetPosition(const void *id, off_t samples)
 
    if (handle->ext)
    {
-      off_t bytes = handle->ext->set_param(handle->ext, __F_POSITION, samples);
-      rv = handle->io->set_param(handle->io, __F_POSITION, bytes);
+      off_t bytes;
+
+      _aaxMutexLock(handle->ioBufLock);
+      if (handle->ext->seek) {
+         bytes = handle->ext->seek(handle->ext, samples);
+      } else {
+         bytes = handle->ext->set_param(handle->ext, __F_POSITION, samples);
+      }
+      if (bytes >= 0)
+      {
+         rv = handle->io->set_param(handle->io, __F_POSITION, bytes);
+         if (rv >= 0 && handle->mode == AAX_MODE_READ)
+         {
+            // data read before the seek is of no use anymore,
+            // ioRing is cleared by the mixer thread which reads from it,
+            // or here if the pool decodes ahead and reads from it.
+            _aaxDataClear(handle->ioBuffer, 0);
+            handle->end_of_file = false;
+            if (handle->decode_ahead)
+            {
+               _aaxByteRingClear(handle->ioRing);
+               _aaxDataClear(handle->rawBuffer, 0);
+               handle->start_with_fill = false;
+               atomic_store(&handle->decode_eof, false);
+            }
+            atomic_store(&handle->flush, true);
+         }
+      }
+      _aaxMutexUnLock(handle->ioBufLock);
    }
    return rv;
 }
@@ -1598,38 +1845,44 @@ _aaxStreamDriverWriteChunk(const void *id)
    if (handle->io)
    {
       _data_t *buf = handle->ioBuffer;
-      while (_aaxDataGetDataAvail(buf, 0))
-      {
-         ssize_t res = 0;
+      bool error = false;
 
-         if (!_aaxMutexLockTimed(handle->ioBufLock, handle->dt))
-         {
-            res = handle->io->write(handle->io, buf);
-            _aaxMutexUnLock(handle->ioBufLock);
-         }
+      _aaxMutexLock(handle->ioBufLock);
+      do
+      {
+         // Move data from ioRing to ioBuffer
+         size_t size = _aaxDataGetFreeSpace(buf, 0);
+         size = _aaxByteRingRead(handle->ioRing, _aaxDataGetPtr(buf, 0), size);
+         _aaxDataIncreaseOffset(buf, 0, size);
 
-         if (res > 0)
+         while (!error && _aaxDataGetDataAvail(buf, 0))
          {
-            rv += res;
-            if (handle->ext->update)
+            ssize_t res = handle->io->write(handle->io, buf);
+            if (res > 0)
             {
-               size_t spos = 0;
-               ssize_t usize;
-               void *buf = handle->ext->update(handle->ext, &spos, &usize,
-                                               false);
-
-               // if update returns non NULL then header needs updating.
-               if (buf && handle->io->update_header) {
-                  res = handle->io->update_header(handle->io, buf, usize);
+               rv += res;
+               if (handle->ext->update)
+               {
+                  size_t spos = 0;
+                  ssize_t usize;
+                  void *buf = handle->ext->update(handle->ext, &spos, &usize,
+                                                  false);
+
+                  // if update returns non NULL then header needs updating.
+                  if (buf && handle->io->update_header) {
+                     res = handle->io->update_header(handle->io, buf, usize);
+                  }
                }
             }
-         }
-         else
-         {
-            _AAX_FILEDRVLOG(strerror(errno));
-            break;
+            else
+            {
+               _AAX_FILEDRVLOG(strerror(errno));
+               error = true;
+            }
          }
       }
+      while (!error && _aaxByteRingGetDataAvail(handle->ioRing));
+      _aaxMutexUnLock(handle->ioBufLock);
    }
 
    return rv;
@@ -1779,39 +2032,56 @@ _aaxStreamDriverWriteThread(void *id)
 {
    _driver_t *handle = (_driver_t*)id;
 
-   _aaxMutexLock(handle->iothread.signal.mutex);
-
    do
    {
-      _aaxSignalWait(&handle->iothread.signal);
+      _aaxByteRingWaitTimed(handle->ioRing, handle->dt);
       _aaxStreamDriverWriteChunk(id);
    }
    while(handle->iothread.started);
 
+   // the mixer thread has stopped, write what is left in rawBuffer
    do
    {
       size_t res = _aaxDataGetDataAvail(handle->rawBuffer, 0);
-      _aaxDataMoveData(handle->rawBuffer, 0, handle->ioBuffer, 0, res);
+      res = _aaxByteRingWrite(handle->ioRing,
+                              _aaxDataGetData(handle->rawBuffer, 0), res);
+      _aaxDataMove(handle->rawBuffer, 0, NULL, res);
    }
    while (_aaxStreamDriverWriteChunk(id));
 
-   _aaxMutexUnLock(handle->iothread.signal.mutex);
-
    return handle ? true : false;
 }
 
+/*
+ * Queue the data of ioBuffer in ioRing for the mixer thread, must be called
+ * with ioBufLock locked. After a seek nothing is queued until the mixer
+ * thread has cleared ioRing.
+ */
+static void
+_aaxStreamDriverQueueData(_driver_t *handle)
+{
+   _data_t *ioBuffer = handle->ioBuffer;
+   size_t res;
+
+   if (!atomic_load(&handle->flush))
+   {
+      res = _aaxDataGetDataAvail(ioBuffer, 0);
+      res = _aaxByteRingWrite(handle->ioRing, _aaxDataGetData(ioBuffer, 0), res);
+      _aaxDataMove(ioBuffer, 0, NULL, res);
+   }
+}
+
+/* Fill ioBuffer and queue it, must be called with ioBufLock locked. */
 static ssize_t
-_aaxStreamDriverReadChunk(const void *id)
+_aaxStreamDriverReadData(_driver_t *handle)
 {
-   _driver_t *handle = (_driver_t*)id;
    _data_t *ioBuffer = handle->ioBuffer;
    size_t size;
    ssize_t res;
 
-   _aaxMutexLock(handle->ioBufLock);
    size = _aaxDataGetFreeSpace(ioBuffer, 0);
    res = handle->io->read(handle->io, ioBuffer, size);
-   _aaxMutexUnLock(handle->ioBufLock);
+   _aaxStreamDriverQueueData(handle);
 
    if (res == -1) {
       handle->end_of_file = true;
@@ -1821,32 +2091,14 @@ _aaxStreamDriverReadChunk(const void *id)
 }
 
 static ssize_t
-_aaxStreamDriverThreadReadChunk(const void *id)
+_aaxStreamDriverReadChunk(const void *id)
 {
    _driver_t *handle = (_driver_t*)id;
-   _data_t *captureBuffer = handle->captureBuffer;
-   ssize_t res = 0;
-   size_t size;
-
-   size = _aaxDataGetFreeSpace(captureBuffer, 0);
-   if (size) {
-      res = handle->io->read(handle->io, captureBuffer, size);
-   }
-
-   size = _aaxDataGetDataAvail(captureBuffer, 0);
-   if (size)
-   {
-      // Move data from captureBuffer to ioBuffer
-      if (!_aaxMutexLockTimed(handle->ioBufLock, handle->dt))
-      {
-         res = _aaxDataMoveData(captureBuffer, 0, handle->ioBuffer, 0, size);
-         _aaxMutexUnLock(handle->ioBufLock);
-      }
-   }
+   ssize_t res;
 
-   if (res == -1) {
-      handle->end_of_file = true;
-   }
+   _aaxMutexLock(handle->ioBufLock);
+   res = _aaxStreamDriverReadData(handle);
+   _aaxMutexUnLock(handle->ioBufLock);
 
    return res;
 }
@@ -1855,34 +2107,419 @@ static int
 _aaxStreamDriverReadThread(void *id)
 {
    _driver_t *handle = (_driver_t*)id;
+   bool seekable;
    ssize_t res;
 
+   // only live network streams can not seek
+   seekable = (handle->io->protocol == PROTOCOL_DIRECT ||
+               handle->io->get_param(handle->io, __F_POSITION) != -1);
+
    /* read (clear) all bytes already sent from the server */
    /* until the threshold is reached                      */
-   if (handle->io->protocol != PROTOCOL_DIRECT)
+   if (!seekable)
    {
       do
       {
-         _aaxDataSetOffset(handle->ioBuffer, 0, 0);
-         res = _aaxStreamDriverThreadReadChunk(id);
+         _aaxMutexLock(handle->ioBufLock);
+         _aaxDataClear(handle->ioBuffer, 0);
+         res = handle->io->read(handle->io, handle->ioBuffer, IOBUF_SIZE);
+         _aaxMutexUnLock(handle->ioBufLock);
       }
       while (res > IOBUF_THRESHOLD);
+
+      if (res == -1) {
+         handle->end_of_file = true;
+      }
    }
 
    if (!handle->copy_to_buffer) {
       res = _aaxStreamDriverReadChunk(id);
    }
 
-   // wait for our first job
-   _aaxMutexLock(handle->iothread.signal.mutex);
-
+   // keep going after the end of a file, a seek may continue the stream
    do {
-      _aaxSignalWaitTimed(&handle->iothread.signal, handle->dt);
+      _aaxByteRingWaitTimed(handle->ioRing, handle->dt);
       res = _aaxStreamDriverReadChunk(id);
    }
-   while(res >= 0 && handle->iothread.started);
-
-   _aaxMutexUnLock(handle->iothread.signal.mutex);
+   while((res >= 0 || seekable) && handle->iothread.started);
 
    return handle ? true : false;
 }
+
+/* Seconds since the shared I/O pool was created. */
+double
+_aaxStreamDriverSharedIOTime(void)
+{
+   double rv;
+
+   mtx_lock(&_shared_io_mutex);
+   _shared_io_time += _aaxTimerElapsed(_shared_io_timer);
+   rv = _shared_io_time;
+   mtx_unlock(&_shared_io_mutex);
+
+   return rv;
+}
+
+/* The mixer format depends on the extension, reset it with the extension. */
+static void
+_aaxStreamDriverFreeExt(_driver_t *handle)
+{
+   handle->ext = _ext_free(handle->ext);
+   handle->mixer_fmt = false;
+}
+
+/* The number of bytes the stream consumes per second, zero if unknown. */
+static double
+_aaxStreamDriverByteRate(_driver_t *handle)
+{
+   double rv = 0.0;
+   if (handle->io_frames) {
+      rv = (double)handle->io_bytes*handle->frequency/handle->io_frames;
+   }
+   return rv;
+}
+
+static int
+_aaxStreamDriverReadJob(void *id)
+{
+   _driver_t *handle = (_driver_t*)id;
+   _data_t *ioBuffer = handle->ioBuffer;
+   double byte_rate;
+   ssize_t res = 0;
+   size_t size;
+
+   _aaxMutexLock(handle->ioBufLock);
+   size = _aaxDataGetFreeSpace(ioBuffer, 0);
+
+   byte_rate = _aaxStreamDriverByteRate(handle);
+   if (_shared_io_read_ahead && byte_rate > 0.0)
+   {
+      size_t avail = _aaxDataGetDataAvail(ioBuffer, 0);
+      avail += _aaxByteRingGetDataAvail(handle->ioRing);
+      size_t depth = _shared_io_read_ahead*byte_rate/1000.0;
+
+      depth = _MAX(depth, PERIOD_SIZE);
+      size = (depth > avail) ? _MIN(size, depth - avail) : 0;
+   }
+
+   if (size) {
+      res = handle->io->read(handle->io, ioBuffer, size);
+   }
+   _aaxStreamDriverQueueData(handle);
+   _aaxMutexUnLock(handle->ioBufLock);
+
+   if (res == -1) {
+      handle->end_of_file = true;
+   }
+
+   return (res >= 0) ? true : false;
+}
+
+static void
+_aaxStreamDriverSharedIOInit(void)
+{
+   mtx_init(&_shared_io_mutex, mtx_plain);
+}
+
+static bool
+_aaxStreamDriverSharedIOEnabled(void)
+{
+   const char *env = getenv("AAX_STREAM_SHARED_IO");
+   return (env && _aax_getbool(env)) ? true : false;
+}
+
+/* Take a reference to the shared I/O pool, NULL if it could not start. */
+_aaxJobPool*
+_aaxStreamDriverSharedIOStart(void)
+{
+   _aaxJobPool *rv;
+
+   call_once(&_shared_io_once, _aaxStreamDriverSharedIOInit);
+   mtx_lock(&_shared_io_mutex);
+   if (!_shared_io_pool)
+   {
+      unsigned int no_threads = SHARED_IO_THREADS;
+      const char *env;
+
+      env = getenv("AAX_STREAM_IO_THREADS");
+      if (env && atoi(env) > 0) {
+         no_threads = atoi(env);
+      }
+
+      env = getenv("AAX_STREAM_READ_AHEAD_MS");
+      _shared_io_read_ahead = (env && atoi(env) > 0) ? atoi(env) : 0;
+
+      _shared_io_timer = _aaxTimerCreate();
+      if (_shared_io_timer)
+      {
+         _aaxTimerStart(_shared_io_timer);
+         _shared_io_time = 0.0;
+         _shared_io_pool = _aaxJobPoolCreate(no_threads, "aaxStreamIO");
+      }
+      if (!_shared_io_pool)
+      {
+         _aaxTimerDestroy(_shared_io_timer);
+         _shared_io_timer = NULL;
+      }
+   }
+   if (_shared_io_pool) {
+      _shared_io_refs++;
+   }
+   rv = _shared_io_pool;
+   mtx_unlock(&_shared_io_mutex);
+
+   return rv;
+}
+
+void
+_aaxStreamDriverSharedIOStop(void)
+{
+   mtx_lock(&_shared_io_mutex);
+   if (--_shared_io_refs == 0)
+   {
+      _aaxJobPoolDestroy(_shared_io_pool);
+      _shared_io_pool = NULL;
+      _aaxTimerDestroy(_shared_io_timer);
+      _shared_io_timer = NULL;
+   }
+   mtx_unlock(&_shared_io_mutex);
+}
+
+/*
+ * Queue a read job for the stream unless one is pending already.
+ * Only a batched capture waits for it if the I/O buffer ran dry, without
+ * running the read jobs of other streams. The mixer thread returns what
+ * it has and lets the pool refill the buffer.
+ */
+static void
+_aaxStreamDriverSharedRead(_driver_t *handle, char batched)
+{
+   size_t avail = _aaxByteRingGetDataAvail(handle->ioRing);
+
+   if (!_aaxJobPoolBusy(_shared_io_pool, &handle->io_group))
+   {
+      double byte_rate = _aaxStreamDriverByteRate(handle);
+      double deadline = _aaxStreamDriverSharedIOTime();
+      unsigned int priority;
+
+      if (byte_rate > 0.0)
+      {
+         size_t buffered = avail + _aaxDataGetDataAvail(handle->rawBuffer, 0);
+         deadline += buffered/byte_rate;
+      }
+      priority = _MIN(deadline*1000.0, (double)(UINT_MAX-1));
+
+      _aaxJobPoolAddPriority(_shared_io_pool, &handle->io_group,
+                             _aaxStreamDriverReadJob, handle, priority);
+   }
+
+   if (!avail && batched) {
+      _aaxJobPoolWaitOwn(_shared_io_pool, &handle->io_group);
+   }
+}
+
+/*
+ * Create a ring per track for the samples which are decoded ahead and the
+ * tracks the pool decodes into. Returns false if the stream can not be
+ * decoded ahead, the capture callback then decodes it.
+ */
+static bool
+_aaxStreamDriverDecodeStart(_driver_t *handle)
+{
+   size_t frames;
+   int t;
+
+   // the rings hold int32_t or MIX_T samples
+   assert(sizeof(MIX_T) == sizeof(int32_t));
+
+   if (_shared_io_read_ahead) {
+      frames = _shared_io_read_ahead*handle->frequency/1000;
+   } else {
+      frames = SHARED_DECODE_AHEAD_MS*handle->frequency/1000;
+   }
+   frames = _MAX(frames, 4*handle->no_samples);
+
+   handle->decode_frames = handle->no_samples;
+   handle->decode_float = handle->ext->cvt_from_intl_float ? true : false;
+   atomic_store(&handle->decode_eof, false);
+
+   for (t=0; t<handle->no_channels; ++t)
+   {
+      handle->pcmRing[t] = _aaxByteRingCreate(frames*sizeof(int32_t));
+      handle->decode_tracks[t] = malloc(handle->decode_frames*sizeof(int32_t));
+      if (!handle->pcmRing[t] || !handle->decode_tracks[t]) break;
+   }
+
+   if (t == handle->no_channels && handle->decode_frames) {
+      handle->decode_ahead = true;
+   } else {
+      _aaxStreamDriverDecodeStop(handle);
+   }
+
+   return handle->decode_ahead;
+}
+
+static void
+_aaxStreamDriverDecodeStop(_driver_t *handle)
+{
+   int t;
+
+   for (t=0; t<_AAX_MAX_SPEAKERS; ++t)
+   {
+      _aaxByteRingDestroy(handle->pcmRing[t]);
+      handle->pcmRing[t] = NULL;
+      free(handle->decode_tracks[t]);
+      handle->decode_tracks[t] = NULL;
+   }
+   handle->decode_ahead = false;
+}
+
+/* The number of frames the mixer can read, decoded ahead by the pool. */
+static size_t
+_aaxStreamDriverDecodedAvail(_driver_t *handle)
+{
+   size_t rv = SIZE_MAX;
+   int t;
+
+   for (t=0; t<handle->no_channels; ++t) {
+      rv = _MIN(rv, _aaxByteRingGetDataAvail(handle->pcmRing[t]));
+   }
+
+   return rv/sizeof(int32_t);
+}
+
+/* The number of frames the pool can decode ahead. */
+static size_t
+_aaxStreamDriverDecodeSpace(_driver_t *handle)
+{
+   size_t rv = SIZE_MAX;
+   int t;
+
+   for (t=0; t<handle->no_channels; ++t) {
+      rv = _MIN(rv, _aaxByteRingGetFreeSpace(handle->pcmRing[t]));
+   }
+
+   return rv/sizeof(int32_t);
+}
+
+/*
+ * Decode until the rings of the stream are full or up to the end of the
+ * file. Nothing is decoded after a seek until the mixer thread cleared the
+ * rings.
+ */
+static int
+_aaxStreamDriverDecodeJob(void *id)
+{
+   _driver_t *handle = (_driver_t*)id;
+   ssize_t res = 0;
+
+   _aaxMutexLock(handle->ioBufLock);
+   while (!atomic_load(&handle->flush) && !atomic_load(&handle->decode_eof) &&
+          _aaxStreamDriverDecodeSpace(handle) >= handle->decode_frames)
+   {
+      size_t frames = handle->decode_frames;
+      ssize_t offs = 0, xoffs = 0;
+      int t;
+
+      res = _aaxStreamDriverDecode(handle, handle->decode_tracks, &offs,
+                                   &xoffs, &frames, handle->decode_float, true);
+      for (t=0; t<handle->no_channels; ++t) {
+         _aaxByteRingWrite(handle->pcmRing[t], handle->decode_tracks[t],
+                           frames*sizeof(int32_t));
+      }
+
+      if (res == __F_EOF) {
+         atomic_store(&handle->decode_eof, true);
+      } else if (!frames) {
+         break;
+      }
+   }
+   _aaxMutexUnLock(handle->ioBufLock);
+
+   return (res >= 0) ? true : false;
+}
+
+/*
+ * Queue a decode job for the stream unless one is pending already. Its
+ * priority is the time at which the samples decoded ahead are used up.
+ */
+static void
+_aaxStreamDriverSharedDecode(_driver_t *handle)
+{
+   if (!_aaxJobPoolBusy(_shared_io_pool, &handle->io_group))
+   {
+      double deadline = _aaxStreamDriverSharedIOTime();
+      unsigned int priority;
+
+      if (handle->frequency > 0.0f) {
+         deadline += _aaxStreamDriverDecodedAvail(handle)/handle->frequency;
+      }
+      priority = _MIN(deadline*1000.0, (double)(UINT_MAX-1));
+
+      _aaxJobPoolAddPriority(_shared_io_pool, &handle->io_group,
+                             _aaxStreamDriverDecodeJob, handle, priority);
+   }
+}
+
+/*
+ * Copy the samples which the pool decoded ahead to the tracks. Only a
+ * batched capture waits for the pool, the mixer thread gets silence for
+ * the samples which are not decoded in time.
+ */
+static ssize_t
+_aaxStreamDriverDecoded(_driver_t *handle, void **tracks, ssize_t offs, size_t *frames, char batched)
+{
+   size_t no_samples = *frames;
+   ssize_t rv = 0;
+   int t;
+
+   *frames = 0;
+   do
+   {
+      bool eof = atomic_load(&handle->decode_eof);
+      size_t avail = _aaxStreamDriverDecodedAvail(handle);
+      size_t num = _MIN(avail, no_samples - *frames);
+
+      for (t=0; t<handle->no_channels; ++t)
+      {
+         int32_t *ptr = (int32_t*)tracks[t] + offs + *frames;
+
+         _aaxByteRingRead(handle->pcmRing[t], ptr, num*sizeof(int32_t));
+         if (handle->decode_float && !handle->mixer_fmt) {
+            _batch_cvt24_ps24(ptr, ptr, num);
+         }
+      }
+      *frames += num;
+      rv += num*handle->no_channels*sizeof(int32_t);
+
+      _aaxStreamDriverSharedDecode(handle);
+
+      if (*frames == no_samples) break;
+      if (eof && avail == num)
+      {
+         if (!*frames) rv = __F_EOF;
+         break;
+      }
+
+      if (!batched)
+      {
+         for (t=0; t<handle->no_channels; ++t)
+         {
+            int32_t *ptr = (int32_t*)tracks[t] + offs + *frames;
+            memset(ptr, 0, (no_samples - *frames)*sizeof(int32_t));
+         }
+         break;
+      }
+
+      _aaxJobPoolWaitOwn(_shared_io_pool, &handle->io_group);
+      if (atomic_load(&handle->flush) ||
+          (!atomic_load(&handle->decode_eof) &&
+           !_aaxStreamDriverDecodedAvail(handle)))
+      {
+         break;
+      }
+   }
+   while (true);
+
+   return rv;
+}
@@ -19,6 +19,7 @@ extern "C" {
 #endif
 
 
+#include <base/jobpool.h>
 #include <backends/driver.h>
 
 #define COPY_TO_BUFFER	"_ctb237676265365"
@@ -32,6 +33,11 @@ extern const _aaxDriverBackend _aaxStreamDriverBackend;
 extern const _intBuffers _aaxStreamDriverExtensionString;
 extern const _intBuffers _aaxStreamDriverEnumValues;
 
+/* I/O thread pool shared by file streams and disk streamed samples */
+_aaxJobPool* _aaxStreamDriverSharedIOStart(void);
+void _aaxStreamDriverSharedIOStop(void);
+double _aaxStreamDriverSharedIOTime(void);
+
 #define MSIMA_BLOCKSIZE_TO_SMP(b, t)	(((b)-4*(t))*2)/(t)
 #define SMP_TO_MSBLOCKSIZE(s, t)	(((s)*(t)/2)+4*(t))
 
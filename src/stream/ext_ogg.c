@@ -29,9 +29,11 @@
 #include <base/memory.h>
 
 #include <api.h>
+#include <arch.h>
 
 #include "audio.h"
 #include "ext_ogg.h"
+#include "seekindex.h"
 
 
 // https://xiph.org/ogg/
@@ -51,6 +53,11 @@
 #define OGG_WRITE_PACKET_SIZE	(OGG_WRITE_SAMPLES*sizeof(float)*handle->no_tracks)
 #define OGG_WRITE_BUFFER_SIZE	(2*OGG_WRITE_PACKET_SIZE)
 #define OGG_HEADER_SIZE		8
+#define OGG_SEEK_DISTANCE	4096	/* minimum no. samples between entries */
+#define OGG_VORBIS_PREROLL	4096	/* half the largest Vorbis block */
+#define OGG_OPUS_PREROLL	3840	/* 80 ms at 48 kHz */
+#define OGG_NO_GRANULE		((uint64_t)-1)
+#define OGG_NO_OFFSET		((uint64_t)-1)
 
 typedef struct
 {
@@ -111,6 +118,19 @@ typedef struct
    _data_t *oggBuffer;
    size_t datasize;
 
+   /* seeking */
+   _seek_index_t *index;
+   uint64_t bytes_in;		// no. bytes of the stream read so far
+   uint64_t last_granule;	// last known granule position
+   uint64_t page_granule;	// granule position at the start of the page
+   uint64_t prev_offset;	// offset of the previous audio page
+   size_t skip_samples;		// no. samples to drop after a seek
+   char resync;			// accept the next page after a seek
+
+   /* gapless playback */
+   uint64_t out_granule;	// granule position of the next decoded sample
+   uint64_t end_granule;	// granule position of the end-of-stream page
+
    _driver_write_t *out;
 
    /* Vorbis */
@@ -124,9 +144,21 @@ typedef struct
 
 
 static int _aaxFormatDriverReadHeader(_driver_t*);
-static int _getOggPageHeader(_driver_t*, uint8_t*, size_t, char);
+static int _getOggPageHeader(_driver_t*, uint8_t*, size_t);
 static int _aaxOggInitFormat(_driver_t*, unsigned char*, ssize_t*);
+static void _aaxOggIndexPage(_driver_t*, uint64_t);
+static bool _aaxOggFirstPage(_driver_t*, uint8_t*, size_t);
+static int _aaxOggFillAudio(_driver_t*, uint8_t*, size_t, size_t*);
+static size_t _aaxOggCollectPage(_driver_t*, uint8_t*, size_t);
+static bool _aaxOggPageReady(uint8_t*, size_t);
+static size_t _aaxOggNextPage(const uint8_t*, size_t);
+static int _aaxOggFillPage(_driver_t*, uint8_t*, size_t, uint64_t, size_t*);
+static off_t _aaxOggSeek(_driver_t*, uint64_t);
+static void _aaxOggSkipSamples(_driver_t*, void_ptrptr, size_t, size_t*);
+static size_t _aaxOggDecode(_driver_t*, void_ptrptr, size_t, size_t*, char);
 static void crc32_init(void);
+static size_t _aaxOggPageSize(const uint8_t*, size_t);
+static bool _aaxOggPageValid(const uint8_t*, size_t);
 
 /*
  * This handler does peek into the Ogg page header to determine it's serial
@@ -208,6 +240,8 @@ _ogg_setup(_ext_t *ext, int mode, size_t *bufsize, int freq, int tracks, int for
          if (handle->capturing)
          {
             handle->no_samples = UINT_MAX;
+            handle->index = _seek_index_create(OGG_SEEK_DISTANCE);
+            handle->prev_offset = OGG_NO_OFFSET;
             *bufsize = 4096;
          }
          else /* playback */
@@ -329,7 +363,7 @@ _ogg_open(_ext_t *ext, void_ptr buf, ssize_t *bufsize, size_t fsize)
          assert(bufsize);
 
          if (!handle->oggBuffer) {
-            handle->oggBuffer = _aaxDataCreate(1, OGG_WRITE_BUFFER_SIZE, 1);
+            handle->oggBuffer = _aaxDataCreateRing(1, OGG_WRITE_BUFFER_SIZE, 1);
          }
 
          if (handle->oggBuffer)
@@ -339,6 +373,7 @@ _ogg_open(_ext_t *ext, void_ptr buf, ssize_t *bufsize, size_t fsize)
 
             handle->datasize = fsize;
             res = _aaxDataAdd(handle->oggBuffer, 0, buf, size);
+            handle->bytes_in += res;
             *bufsize = res;
 
             res = _aaxFormatDriverReadHeader(handle);
@@ -361,6 +396,7 @@ _ogg_open(_ext_t *ext, void_ptr buf, ssize_t *bufsize, size_t fsize)
          int res;
 
          res = _aaxDataAdd(handle->oggBuffer, 0, buf, size);
+         handle->bytes_in += res;
          *bufsize = res;
 
          res = _aaxFormatDriverReadHeader(handle);
@@ -386,6 +422,7 @@ _ogg_close(_ext_t *ext)
    if (handle)
    {
       _aaxDataDestroy(handle->oggBuffer);
+      _seek_index_free(handle->index);
       if (handle->fmt)
       {
          handle->fmt->close(handle->fmt);
@@ -411,26 +448,36 @@ _ogg_update(UNUSED(_ext_t *ext), UNUSED(size_t *offs), UNUSED(ssize_t *size), UN
    return NULL;
 }
 
+/*
+ * Audio pages which are complete in the data received from the stream are
+ * passed to the decoder straight from sptr. Only a page which spans two
+ * reads is collected in oggBuffer, up to the end of that page, after which
+ * the following pages are read from sptr again.
+ */
 size_t
 _ogg_fill(_ext_t *ext, void_ptr sptr, ssize_t *bytes)
 {
    _driver_t *handle = ext->id;
    int res, rv = __F_PROCESS;
+   size_t size = 0, used = 0;
    uint8_t *header;
-   ssize_t avail;
 
    handle->need_more = false;
-   if (sptr && bytes)
-   {
-      res = _aaxDataAdd(handle->oggBuffer, 0, sptr, *bytes);
-      *bytes = res;
+   if (sptr && bytes) {
+      size = *bytes;
    }
 
    // vorbis stream may reset the stream at the start of each song with
    // a packet indicated as a first page followed by a new comment page.
-   header = _aaxDataGetData(handle->oggBuffer, 0);
-   if (header[5] == PACKET_FIRST_PAGE || handle->page_sequence_no < 2)
+   if (handle->page_sequence_no < 2 || _aaxOggFirstPage(handle, sptr, size))
    {
+      if (size)
+      {
+         used = _aaxDataAdd(handle->oggBuffer, 0, sptr, size);
+         handle->bytes_in += used;
+      }
+
+      header = _aaxDataGetData(handle->oggBuffer, 0);
       if (!handle->page_size)
       {
          if (header[5] == PACKET_FIRST_PAGE)
@@ -438,46 +485,230 @@ _ogg_fill(_ext_t *ext, void_ptr sptr, ssize_t *bytes)
             handle->bitstream_serial_no = 0;
             handle->page_sequence_no = 0;
 
+            /* the granule positions of a new logical stream start at zero */
+            handle->last_granule = 0;
+            handle->page_granule = 0;
+            handle->out_granule = 0;
+            handle->end_granule = 0;
+            handle->prev_offset = OGG_NO_OFFSET;
+
+            /* only the Opus header sets the pre-skip again, skip_samples */
+            /* may hold the target of a seek which restarted the stream.  */
+            handle->pre_skip = 0;
+
             _aax_free_meta(&handle->meta);
 
-            handle->fmt->close(handle->fmt);
-            _fmt_free(handle->fmt);
-            handle->fmt = NULL;
+            if (handle->fmt)
+            {
+               handle->fmt->close(handle->fmt);
+               _fmt_free(handle->fmt);
+               handle->fmt = NULL;
+            }
          }
 
-         rv = _aaxFormatDriverReadHeader(handle);
-         if (rv <= 0)
+         res = _aaxFormatDriverReadHeader(handle);
+         if (res <= 0)
          {
-            if (rv == __F_NEED_MORE) {
+            if (res == __F_NEED_MORE) {
                handle->need_more = true;
             }
          }
+         rv = res;
       }
    }
-   else
+   else {
+      rv = _aaxOggFillAudio(handle, sptr, size, &used);
+   }
+
+   if (bytes) {
+      *bytes = used;
+   }
+
+// printf("ogg_fill: %i\n", rv);
+   return rv;
+}
+
+/* Returns true if the next page to process starts a new logical stream. */
+static bool
+_aaxOggFirstPage(_driver_t *handle, uint8_t *sptr, size_t size)
+{
+   bool rv = false;
+
+   if (!handle->page_size)
    {
-      header = _aaxDataGetData(handle->oggBuffer, 0);
+      size_t avail = _aaxDataGetDataAvail(handle->oggBuffer, 0);
+      uint8_t *ptr = sptr;
+
+      if (avail)
+      {
+         ptr = _aaxDataGetData(handle->oggBuffer, 0);
+         size = avail;
+      }
+      rv = (ptr && size > 5 && ptr[5] == PACKET_FIRST_PAGE);
+   }
+   return rv;
+}
+
+static int
+_aaxOggFillAudio(_driver_t *handle, uint8_t *sptr, size_t size, size_t *used)
+{
+   _data_t *buf = handle->oggBuffer;
+   size_t avail = _aaxDataGetDataAvail(buf, 0);
+   uint8_t *page;
+   int rv;
+
+   *used = 0;
+   if (!avail && (handle->page_size || _aaxOggPageReady(sptr, size)))
+   {
+      rv = _aaxOggFillPage(handle, sptr, size, handle->bytes_in, used);
+      handle->bytes_in += *used;
+      return rv;
+   }
+
+   /* collect the page which continues in the next read */
+   if (!handle->page_size)
+   {
+      *used = _aaxOggCollectPage(handle, sptr, size);
+      handle->bytes_in += *used;
+   }
+
+   page = _aaxDataGetData(buf, 0);
+   avail = _aaxDataGetDataAvail(buf, 0);
+   if (handle->page_size || _aaxOggPageReady(page, avail))
+   {
+      size_t consumed;
+
+      rv = _aaxOggFillPage(handle, page, avail, handle->bytes_in - avail,
+                           &consumed);
+      _aaxDataMove(buf, 0, NULL, consumed);
+   }
+   else {
+      rv = __F_NEED_MORE;
+   }
+
+   return rv;
+}
+
+/*
+ * Add the bytes of sptr which belong to the page at the start of oggBuffer,
+ * but nothing beyond the end of that page.
+ */
+static size_t
+_aaxOggCollectPage(_driver_t *handle, uint8_t *sptr, size_t size)
+{
+   size_t avail, need, rv = 0;
+   uint8_t *page;
+
+   do
+   {
+      page = _aaxDataGetData(handle->oggBuffer, 0);
       avail = _aaxDataGetDataAvail(handle->oggBuffer, 0);
-      if (handle->page_size ||
-          (rv = _getOggPageHeader(handle, header, avail, true)) > 0)
+      if (avail < 27) {
+         need = 27 - avail;
+      } else if (avail < 27U + page[26]) {
+         need = 27 + page[26] - avail;
+      } else {
+         need = _aaxOggPageSize(page, avail);
+         need = (need > avail) ? need - avail : 0;
+      }
+
+      need = _MIN(need, size - rv);
+      need = _aaxDataAdd(handle->oggBuffer, 0, sptr+rv, need);
+      rv += need;
+   }
+   while (need && rv < size);
+
+   return rv;
+}
+
+/*
+ * Returns true if a complete page is available at ptr, or if ptr does not
+ * start with a page at all so _aaxOggFillPage can skip to the next page.
+ */
+static bool
+_aaxOggPageReady(uint8_t *ptr, size_t size)
+{
+   size_t page_size;
+
+   if (size >= 4 && memcmp(ptr, "OggS", 4)) {
+      return true;
+   }
+
+   page_size = _aaxOggPageSize(ptr, size);
+   return (page_size && page_size <= size);
+}
+
+/*
+ * Return the offset of the next capture pattern after the start of ptr,
+ * or of the last three bytes which may hold the start of one.
+ */
+static size_t
+_aaxOggNextPage(const uint8_t *ptr, size_t size)
+{
+   size_t rv = 1;
+   while (rv+4 <= size && memcmp(ptr+rv, "OggS", 4)) ++rv;
+   return rv;
+}
+
+/*
+ * Pass (the rest of) the page at ptr to the decoder without copying it.
+ * On return used holds the number of bytes of ptr which were processed.
+ */
+static int
+_aaxOggFillPage(_driver_t *handle, uint8_t *ptr, size_t size, uint64_t offset, size_t *used)
+{
+   size_t header_size = 0;
+   ssize_t avail;
+   int rv;
+
+   if (!handle->page_size)
+   {
+      size_t page_size;
+
+      if (memcmp(ptr, "OggS", 4))
       {
-         handle->fmt->set(handle->fmt, __F_BLOCK_SIZE, handle->page_size);
+         _AAX_FILEDRVLOG("OGG: lost page synchronization");
+         *used = _aaxOggNextPage(ptr, size);
+         return __F_PROCESS;
+      }
 
-         avail = _aaxDataGetDataAvail(handle->oggBuffer, 0);
-         if (avail >= handle->page_size)
-         {
-            avail = handle->page_size;
-            rv = handle->fmt->fill(handle->fmt, header, &avail);
-            if (avail)
-            {
-               _aaxDataMove(handle->oggBuffer, 0, NULL, avail);
-               handle->page_size -= avail;
-            }
-         }
+      page_size = _aaxOggPageSize(ptr, size);
+#if OGG_CALCULATE_CRC
+      /* the capture pattern may have been a false one: resync from there */
+      if (!_aaxOggPageValid(ptr, page_size))
+      {
+         _AAX_FILEDRVLOG("OGG: page checksum mismatch");
+         handle->prev_offset = OGG_NO_OFFSET;
+         *used = _aaxOggNextPage(ptr, size);
+         return __F_PROCESS;
+      }
+#endif
+
+      /* skip pages out of sequence or from another logical stream */
+      if (_getOggPageHeader(handle, ptr, size) <= 0)
+      {
+         handle->prev_offset = OGG_NO_OFFSET;
+         handle->page_size = 0;
+         *used = page_size;
+         return __F_PROCESS;
+      }
+      _aaxOggIndexPage(handle, offset);
+
+      if (!handle->keep_ogg_header)
+      {
+         header_size = handle->header_size;
+         handle->page_size -= header_size;
       }
    }
 
-// printf("ogg_fill: %i\n", rv);
+   handle->fmt->set(handle->fmt, __F_BLOCK_SIZE, handle->page_size);
+
+   avail = _MIN(handle->page_size, size - header_size);
+   rv = handle->fmt->fill(handle->fmt, ptr+header_size, &avail);
+   handle->page_size -= avail;
+
+   *used = header_size + avail;
+
    return rv;
 }
 
@@ -491,19 +722,45 @@ _ogg_copy(_ext_t *ext, int32_ptr dptr, size_t offs, size_t *num)
 size_t
 _ogg_cvt_from_intl(_ext_t *ext, int32_ptrptr dptr, size_t offset, size_t *num)
 {
-   _driver_t *handle = ext->id;
+   return _aaxOggDecode(ext->id, (void_ptrptr)dptr, offset, num, false);
+}
+
+size_t
+_ogg_cvt_from_intl_float(_ext_t *ext, MIX_PTRPTR_T dptr, size_t offset, size_t *num)
+{
+   return _aaxOggDecode(ext->id, (void_ptrptr)dptr, offset, num, true);
+}
+
+/*
+ * Decode the audio into dptr, as int32_t or in the float mixer format.
+ * Formats without a float decoder are converted to the mixer format
+ * afterwards.
+ */
+static size_t
+_aaxOggDecode(_driver_t *handle, void_ptrptr dptr, size_t offset, size_t *num, char mixer_fmt)
+{
+   _fmt_t *fmt = handle->fmt;
    size_t rv = __F_EOF;
+   char cvt_float;
 
-   if (handle->need_more)
+   /* the format is created again when a new logical stream starts */
+   if (handle->need_more || !fmt)
    {
       *num = 0;
       rv = __F_NEED_MORE;
    }
    else
    {
+      cvt_float = (mixer_fmt && fmt->cvt_from_intl_float);
       if (handle->keep_ogg_header)
       {
-         int ret = handle->fmt->cvt_from_intl(handle->fmt, dptr, offset, num);
+         int ret;
+
+         if (cvt_float) {
+            ret = fmt->cvt_from_intl_float(fmt, (MIX_PTRPTR_T)dptr, offset, num);
+         } else {
+            ret = fmt->cvt_from_intl(fmt, (int32_ptrptr)dptr, offset, num);
+         }
 
          if (handle->packet_no != handle->no_packets)
          {
@@ -523,12 +780,41 @@ _ogg_cvt_from_intl(_ext_t *ext, int32_ptrptr dptr, size_t offset, size_t *num)
             size_t packetSize;
 
             packetSize = handle->packet_offset[i+1] - handle->packet_offset[i];
-            handle->fmt->set(handle->fmt, __F_BLOCK_SIZE, packetSize);
+            fmt->set(fmt, __F_BLOCK_SIZE, packetSize);
 
-            ret = handle->fmt->cvt_from_intl(handle->fmt, dptr, offset, num);
+            if (cvt_float) {
+               ret = fmt->cvt_from_intl_float(fmt, (MIX_PTRPTR_T)dptr, offset, num);
+            } else {
+               ret = fmt->cvt_from_intl(fmt, (int32_ptrptr)dptr, offset, num);
+            }
             rv += ret;
          }
       }
+
+      if (mixer_fmt && !cvt_float)
+      {
+         int t;
+         for (t=0; t<handle->no_tracks; ++t)
+         {
+            int32_t *ptr = (int32_t*)dptr[t] + offset;
+            _batch_cvtps24_24(ptr, ptr, *num);
+         }
+      }
+
+      /* drop the end padding of the last page */
+      if (handle->end_granule)
+      {
+         uint64_t end = handle->end_granule;
+         uint64_t start = handle->out_granule;
+         if (start + *num > end) {
+            *num = (end > start) ? end - start : 0;
+         }
+      }
+      handle->out_granule += *num;
+
+      if (handle->skip_samples) {
+         _aaxOggSkipSamples(handle, dptr, offset, num);
+      }
    }
 
 // printf("ogg_cvt_from: %li\n", rv);
@@ -817,6 +1103,9 @@ _ogg_get(_ext_t *ext, int type)
    if (type == __F_NO_SAMPLES && handle->no_samples == -handle->pre_skip) {
       rv = -1;
    }
+   else if (type == __F_POSITION && handle->index) {
+      rv = true;
+   }
    return rv;
 }
 
@@ -826,8 +1115,27 @@ _ogg_set(_ext_t *ext, int type, float value)
    _driver_t *handle = ext->id;
    float rv = 0.0f;
 
-   if (handle->fmt) {
-      rv = handle->fmt->set(handle->fmt, type, value);
+   /* seeking is done by _ogg_seek which returns the exact byte offset */
+   if (type != __F_POSITION)
+   {
+      if (type == __F_IS_STREAM && value) {
+         handle->index = _seek_index_free(handle->index);
+      }
+      if (handle->fmt) {
+         rv = handle->fmt->set(handle->fmt, type, value);
+      }
+   }
+   return rv;
+}
+
+off_t
+_ogg_seek(_ext_t *ext, off_t sample)
+{
+   _driver_t *handle = ext->id;
+   off_t rv = __F_EOF;
+
+   if (handle->index && sample >= 0) {
+      rv = _aaxOggSeek(handle, sample);
    }
    return rv;
 }
@@ -838,21 +1146,97 @@ static int _getOggOpusComment(_driver_t*, unsigned char*, size_t);
 static int _getOggVorbisComment(_driver_t*, unsigned char*, size_t);
 
 #define CRC32_POLY		0x04c11db7   // from spec
-#define CRC32_UPDATE(c,b)	c = ((c) << 8) ^ crc_table[(b) ^ ((c) >> 24)]
-static uint32_t crc_table[256];
+static uint32_t crc_table[8][256];
+static once_flag _crc32_once = ONCE_FLAG_INIT;
 
+/*
+ * Slice-by-8 tables for the (non reflected) Ogg CRC32:
+ * crc_table[k][i] is the CRC of byte i followed by k zero bytes.
+ */
 static void
-crc32_init(void)
+_crc32_init(void)
 {
-   int i,j;
+   int i, j, k;
    uint32_t s;
    for(i=0; i < 256; i++) {
       for (s=(uint32_t) i << 24, j=0; j < 8; ++j)
          s = (s << 1) ^ (s >= (1U<<31) ? CRC32_POLY : 0);
-      crc_table[i] = s;
+      crc_table[0][i] = s;
+   }
+   for (k=1; k < 8; ++k) {
+      for(i=0; i < 256; i++) {
+         s = crc_table[k-1][i];
+         crc_table[k][i] = (s << 8) ^ crc_table[0][s >> 24];
+      }
    }
 }
 
+static void
+crc32_init(void)
+{
+   call_once(&_crc32_once, _crc32_init);
+}
+
+static uint32_t
+crc32_update(uint32_t crc, const uint8_t *p, size_t len)
+{
+   while (len >= 8)
+   {
+      crc ^= (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+             (uint32_t)p[2] << 8 | p[3];
+      crc = crc_table[7][crc >> 24] ^ crc_table[6][(crc >> 16) & 0xFF] ^
+            crc_table[5][(crc >> 8) & 0xFF] ^ crc_table[4][crc & 0xFF] ^
+            crc_table[3][p[4]] ^ crc_table[2][p[5]] ^
+            crc_table[1][p[6]] ^ crc_table[0][p[7]];
+      p += 8;
+      len -= 8;
+   }
+   while (len--) {
+      crc = (crc << 8) ^ crc_table[0][*p++ ^ (crc >> 24)];
+   }
+   return crc;
+}
+
+/*
+ * Return the size of the complete page (header, segment table and body)
+ * at ptr or 0 if the header and segment table are not yet available.
+ */
+static size_t
+_aaxOggPageSize(const uint8_t *ptr, size_t size)
+{
+   size_t i, no_segments, rv = 0;
+
+   if (size >= 27)
+   {
+      no_segments = ptr[26];
+      if (size >= 27+no_segments)
+      {
+         rv = 27+no_segments;
+         for (i=0; i<no_segments; ++i) {
+            rv += ptr[27+i];
+         }
+      }
+   }
+   return rv;
+}
+
+/* The checksum covers the whole page with the checksum field set to zero. */
+static bool
+_aaxOggPageValid(const uint8_t *page, size_t page_size)
+{
+   static const uint8_t zero[4] = { 0, 0, 0, 0 };
+   uint32_t crc, stored;
+
+   stored = (uint32_t)page[22] | (uint32_t)page[23] << 8 |
+            (uint32_t)page[24] << 16 | (uint32_t)page[25] << 24;
+
+   crc = crc32_update(0, page, 22);
+   crc = crc32_update(crc, zero, 4);
+   crc = crc32_update(crc, page+26, page_size-26);
+
+   return (crc == stored);
+}
+
 static int
 _aaxOggInitFormat(_driver_t *handle, unsigned char *oggbuf, ssize_t *bufsize)
 {
@@ -904,11 +1288,129 @@ _aaxOggInitFormat(_driver_t *handle, unsigned char *oggbuf, ssize_t *bufsize)
    return rv;
 }
 
+/*
+ * Add the audio page to the seek index, keyed by the granule position of the
+ * previous page: the position of the first sample of the page. Only pages
+ * which start with a new packet and directly follow a page of the stream
+ * are indexed. Vorbis decoding starts one page early: stb_vorbis drops the
+ * page it synchronises on and takes its granule position from there.
+ */
+static void
+_aaxOggIndexPage(_driver_t *handle, uint64_t offset)
+{
+   if (handle->index && !handle->continued &&
+       handle->prev_offset != OGG_NO_OFFSET)
+   {
+      uint64_t start = handle->keep_ogg_header ? handle->prev_offset : offset;
+      _seek_index_add(handle->index, handle->page_granule, start);
+   }
+   handle->prev_offset = offset;
+}
+
+/*
+ * Position the stream in front of the requested sample and return the byte
+ * offset to continue reading from. The decoding starts early enough for the
+ * decoder to settle, the samples up to the requested position are dropped.
+ */
+static off_t
+_aaxOggSeek(_driver_t *handle, uint64_t sample)
+{
+   uint64_t preroll = 0, start = 0;
+   _seek_point_t point;
+   off_t rv = __F_EOF;
+   float align = 0.0f;
+   bool found;
+
+   if (!handle->fmt) {
+      return rv;
+   }
+
+   if (handle->format_type == _FMT_OPUS) {
+      preroll = OGG_OPUS_PREROLL;
+   } else if (handle->keep_ogg_header) {
+      preroll = OGG_VORBIS_PREROLL;
+   }
+
+   /* the index holds granule positions which include the pre-skip */
+   sample += handle->pre_skip;
+   found = _seek_index_find(handle->index,
+                            (sample > preroll) ? sample - preroll : 0, &point);
+   if (found)
+   {
+      /*
+       * The first packet after the page stb_vorbis synchronises on is only
+       * used to prime the decoder, the output starts up to half a block
+       * later. Let the decoder start the output at a fixed distance.
+       */
+      start = point.sample;
+      if (handle->keep_ogg_header)
+      {
+         align = OGG_VORBIS_PREROLL;
+         start += OGG_VORBIS_PREROLL;
+      }
+      rv = point.offset;
+   }
+   else if (handle->keep_ogg_header)
+   {
+      /* restart at the first page, the header pages are read again */
+      point.sample = 0;
+      point.offset = 0;
+      rv = 0;
+   }
+
+   if (rv >= 0)
+   {
+      _aaxDataClear(handle->oggBuffer, 0);
+      handle->bytes_in = point.offset;
+      handle->last_granule = point.sample;
+      handle->out_granule = start;
+      handle->skip_samples = sample - start;
+      handle->prev_offset = OGG_NO_OFFSET;
+      handle->page_size = 0;
+      handle->packet_no = handle->no_packets = 0;
+      handle->need_more = false;
+
+      if (found)
+      {
+         /* accept the following audio pages, which all come after the   */
+         /* header pages, without returning to header processing.        */
+         handle->page_sequence_no = 2;
+         handle->resync = true;
+
+         handle->fmt->set(handle->fmt, __F_POSITION, align);
+      }
+      else
+      {
+         /* the next page starts the stream and resets the decoder */
+         handle->page_sequence_no = 0;
+         handle->need_more = true;
+      }
+   }
+
+   return rv;
+}
+
+static void
+_aaxOggSkipSamples(_driver_t *handle, void_ptrptr dptr, size_t offset, size_t *num)
+{
+   size_t skip = _MIN(handle->skip_samples, *num);
+   int t;
+
+   /* int32_t and MIX_T samples have the same size */
+   for (t=0; t<handle->no_tracks; ++t)
+   {
+      int32_t *ptr = (int32_t*)dptr[t] + offset;
+      memmove(ptr, ptr+skip, (*num - skip)*sizeof(int32_t));
+   }
+   handle->skip_samples -= skip;
+   *num -= skip;
+}
+
 // https://www.ietf.org/rfc/rfc3533.txt
 static int
-_getOggPageHeader(_driver_t *handle, uint8_t *header, size_t size, char remove_header)
+_getOggPageHeader(_driver_t *handle, uint8_t *header, size_t size)
 {
-   size_t bufsize = _aaxDataGetDataAvail(handle->oggBuffer, 0);
+   size_t bufsize = size;
    uint8_t *ch = header;
    int rv = 0;
 
@@ -997,17 +1499,28 @@ _getOggPageHeader(_driver_t *handle, uint8_t *header, size_t size, char remove_h
       no_segments = read8(&ch, &bufsize);
       handle->header_size = 27 + no_segments;
 
-      if ((bufsize >= handle->header_size) && (version == 0x0))
+      if ((size >= handle->header_size) && (version == 0x0))
       {
          if (serial_no == handle->bitstream_serial_no)
          {
-            if (!handle->page_sequence_no ||
+            if (!handle->page_sequence_no || handle->resync ||
                 sequence_no > handle->page_sequence_no)
             {
                unsigned int i;
 
+               handle->resync = false;
+
                handle->page_sequence_no = sequence_no;
 
+               handle->page_granule = handle->last_granule;
+               if (handle->granule_position != OGG_NO_GRANULE)
+               {
+                  handle->last_granule = handle->granule_position;
+                  if (handle->last_page) {
+                     handle->end_granule = handle->granule_position;
+                  }
+               }
+
                if (no_segments > 0)
                {
                   unsigned int p = 0;
@@ -1035,28 +1548,9 @@ _getOggPageHeader(_driver_t *handle, uint8_t *header, size_t size, char remove_h
   printf(" %i: %u\n", i, handle->packet_offset[i+1] - handle->packet_offset[i]);
 #endif
 
-#if OGG_CALCULATE_CRC
-                  if (handle->page_size <= bufsize)
-                  {
-                     for (i=0; i<handle->page_size; i++) {
-                        CRC32_UPDATE(crc32, ch[i]);
-                     }
-                  }
-                  else {
+                  if (handle->page_size > size) {
                      handle->page_sequence_no--;
                   }
-#else
-                  if (handle->page_size > bufsize) {
-                     handle->page_sequence_no--;
-                  }
-#endif
-                  if (remove_header && !handle->keep_ogg_header)
-                  {
-                     size_t hs = handle->header_size;
-                     _aaxDataMove(handle->oggBuffer, 0, NULL, hs);
-                     handle->page_size -= hs;
-                  }
-
                   rv = handle->header_size;
                }
                else {
@@ -1112,7 +1606,7 @@ _getOggPageHeader(_driver_t *handle, uint8_t *header, size_t size, char remove_h
             }
          }
       }
-      else if (bufsize < handle->header_size) {
+      else if (size < handle->header_size) {
          rv = __F_NEED_MORE;
       } else {
          rv = __F_EOF;
@@ -1229,6 +1723,9 @@ _aaxFormatDriverReadOpusHeader(_driver_t *handle, char *h, size_t len)
          handle->frequency = read32le(&ch, &len);
          handle->no_samples = -handle->pre_skip;
 
+         /* the decoder output starts pre_skip samples early */
+         handle->skip_samples = handle->pre_skip;
+
          gain = read16le(&ch, &len);
          handle->gain = pow(10, (float)gain/(20.0f*256.0f));
 
@@ -1657,7 +2154,7 @@ _aaxFormatDriverReadHeader(_driver_t *handle)
    {
       do
       {
-         rv = _getOggPageHeader(handle, header, bufsize, false);
+         rv = _getOggPageHeader(handle, header, bufsize);
          if ((rv >= 0) && (handle->segment_size > 0) &&
              (handle->page_sequence_no < 2))
          {
@@ -1704,6 +2201,7 @@ _aaxFormatDriverReadHeader(_driver_t *handle)
                      {
                         _aaxDataMove(handle->oggBuffer, 0, NULL, page_size);
                         handle->page_size -= page_size;
+                        header = _aaxDataGetData(handle->oggBuffer, 0);
                         bufsize = _aaxDataGetDataAvail(handle->oggBuffer, 0);
                      }
                      else if (rv > 0) {
@@ -1747,8 +2245,14 @@ _aaxFormatDriverReadHeader(_driver_t *handle)
                      // remove the page from the stream
                      if (!buf && page_size)
                      {
+                        // decoding may start at the first audio page, but
+                        // stb_vorbis can not synchronise on a header page
+                        if (!handle->keep_ogg_header) {
+                           handle->prev_offset = handle->bytes_in - bufsize;
+                        }
                         _aaxDataMove(handle->oggBuffer, 0, NULL, page_size);
                         handle->page_size -= page_size;
+                        header = _aaxDataGetData(handle->oggBuffer, 0);
                         bufsize = _aaxDataGetDataAvail(handle->oggBuffer, 0);
                      }
                      else {
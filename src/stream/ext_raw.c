@@ -60,6 +60,12 @@ _raw_setup(_ext_t *ext, int mode, size_t *bufsize, int freq, int tracks, int for
          handle->format = format;
          handle->fmt = fmt;
 
+         // only offer the mixer format when the format can decode to it
+         ext->cvt_from_intl_float = NULL;
+         if (fmt->cvt_from_intl_float) {
+            ext->cvt_from_intl_float = _raw_cvt_from_intl_float;
+         }
+
          handle->fmt->open(handle->fmt, handle->mode, NULL, NULL, 0);
          handle->fmt->set(handle->fmt, __F_FREQUENCY, freq);
          handle->fmt->set(handle->fmt, __F_BITRATE, bitrate);
@@ -142,6 +148,13 @@ _raw_cvt_from_intl(_ext_t *ext, int32_ptrptr dptr, size_t offset, size_t *num)
    return handle->fmt->cvt_from_intl(handle->fmt, dptr, offset, num);
 }
 
+size_t
+_raw_cvt_from_intl_float(_ext_t *ext, MIX_PTRPTR_T dptr, size_t offset, size_t *num)
+{
+   _driver_t *handle = ext->id;
+   return handle->fmt->cvt_from_intl_float(handle->fmt, dptr, offset, num);
+}
+
 size_t
 _raw_cvt_to_intl(_ext_t *ext, void_ptr dptr, const_int32_ptrptr sptr, size_t offs, size_t *num, void_ptr scratch, size_t scratchlen)
 {
@@ -90,10 +90,12 @@ _ext_create(_ext_type_t extension)
 
          rv->get_param = _ogg_get;
          rv->set_param = _ogg_set;
+         rv->seek = _ogg_seek;
 
          rv->copy = _ogg_copy;
          rv->fill = _ogg_fill;
          rv->cvt_from_intl = _ogg_cvt_from_intl;
+         rv->cvt_from_intl_float = _ogg_cvt_from_intl_float;
          rv->cvt_to_intl = _ogg_cvt_to_intl;
       }
       break;
@@ -148,6 +148,15 @@ typedef float (_ext_get_param_fn)(struct _ext_st *handle, int param);
 // value: the value to set the parameter to
 typedef float (_ext_set_param_fn)(struct _ext_st *handle, int param, float value);
 
+// Position the extension at a sample offset (optional)
+//
+// handle must have been created using _ext_create(type);
+// sample: the requested sample position
+//
+// Returns the byte offset in the stream to continue reading from
+//         or a negative value if seeking is not possible
+typedef off_t (_ext_seek_fn)(struct _ext_st *handle, off_t sample);
+
 // Fill the extension and/or formats internal buffer with new data
 //
 // handle must have been created using _ext_create(type);
@@ -186,6 +195,7 @@ typedef size_t (_ext_copy_fn)(struct _ext_st *handle, int32_ptr buffer, size_t o
 //         __F_NEED_MORE if more data is required before processing can start
 //         0 in case of an error
 typedef size_t (_ext_cvt_from_intl_fn)(struct _ext_st *handle, int32_ptrptr buf, size_t offset, size_t *num);
+typedef size_t (_ext_cvt_from_intl_float_fn)(struct _ext_st *handle, MIX_PTRPTR_T buf, size_t offset, size_t *num);
 
 // Covert interleaved PCM data to an extension native format
 //
@@ -224,10 +234,12 @@ struct _ext_st
 
    _ext_get_param_fn *get_param;
    _ext_set_param_fn *set_param;
+   _ext_seek_fn *seek;			// optional
 
    _ext_copy_fn *copy;
    _ext_fill_fn *fill;
    _ext_cvt_from_intl_fn *cvt_from_intl;
+   _ext_cvt_from_intl_float_fn *cvt_from_intl_float;	// optional
    _ext_cvt_to_intl_fn *cvt_to_intl;
    _ext_cvt_to_intl_float_fn *cvt_to_intl_float;
 };
@@ -289,10 +301,12 @@ char* _ogg_interfaces(int, int);
 int _ogg_extension(char*);
 float _ogg_get(_ext_t*, int);
 float _ogg_set(_ext_t*, int, float);
+off_t _ogg_seek(_ext_t*, off_t);
 
 size_t _ogg_copy(_ext_t*, int32_ptr, size_t, size_t*);
 size_t _ogg_fill(_ext_t*, void_ptr, ssize_t*);
 size_t _ogg_cvt_from_intl(_ext_t*, int32_ptrptr, size_t, size_t*);
+size_t _ogg_cvt_from_intl_float(_ext_t*, MIX_PTRPTR_T, size_t, size_t*);
 size_t _ogg_cvt_to_intl(_ext_t*, void_ptr, const_int32_ptrptr, size_t, size_t*, void_ptr, size_t);
 
 /* SND */
@@ -351,6 +365,7 @@ float _raw_set(_ext_t*, int, float);
 size_t _raw_copy(_ext_t*, int32_ptr, size_t, size_t*);
 size_t _raw_fill(_ext_t*, void_ptr, ssize_t*);
 size_t _raw_cvt_from_intl(_ext_t*, int32_ptrptr, size_t, size_t*);
+size_t _raw_cvt_from_intl_float(_ext_t*, MIX_PTRPTR_T, size_t, size_t*);
 size_t _raw_cvt_to_intl(_ext_t*, void_ptr, const_int32_ptrptr, size_t, size_t*, void_ptr, size_t);
 size_t _raw_cvt_to_intl_float(_ext_t*, void_ptr, CONST_MIX_PTRPTR_T, size_t, size_t*, void_ptr, size_t);
 
@@ -97,7 +97,7 @@ _binary_open(_fmt_t *fmt, int mode, void *buf, ssize_t *bufsize, UNUSED(size_t f
    if (handle && buf && bufsize)
    {
       if (!handle->rawBuffer) {
-         handle->rawBuffer = _aaxDataCreate(1, 16384, 1);
+         handle->rawBuffer = _aaxDataCreateRing(1, 16384, 1);
       }
 
       if (handle->rawBuffer)
@@ -102,7 +102,7 @@ _flac_open(_fmt_t *fmt, int mode, void *buf, ssize_t *bufsize, size_t fsize)
       if (!handle->id)
       {
          if (!handle->flacBuffer) {
-            handle->flacBuffer = _aaxDataCreate(1, MAX_FLACBUFSIZE, 1);
+            handle->flacBuffer = _aaxDataCreateRing(1, MAX_FLACBUFSIZE, 1);
          }
 
          if (handle->flacBuffer)
@@ -63,6 +63,7 @@ DECL_FUNCTION(mpg123_feed);
 DECL_FUNCTION(mpg123_read);
 DECL_FUNCTION(mpg123_delete);
 DECL_FUNCTION(mpg123_format);
+DECL_FUNCTION(mpg123_format_none);
 DECL_FUNCTION(mpg123_info);
 DECL_FUNCTION(mpg123_getformat);
 DECL_FUNCTION(mpg123_length);
@@ -116,6 +117,8 @@ typedef struct
    char id3_found;
    char streaming;
    char internal;
+   char copy_data;
+   char pcm_float; // mp3Buffer holds float instead of int16_t samples
 
    uint8_t no_tracks;
    uint8_t bits_sample;
@@ -128,12 +131,22 @@ typedef struct
    struct mp3_frameinfo info;
    struct _meta_t meta;
 
+   /* gapless playback for the internal decoder, from the LAME tag */
+   size_t decoded;
+   size_t start_sample;
+   size_t end_sample;
+
    _data_t *mp3Buffer;
 
 } _driver_t;
 
 static int _getFormatFromMP3Format(int);
+static void _mp3_set_output(_driver_t*);
+static size_t _mp3_decode(_fmt_t*, void_ptrptr, size_t, size_t*, char);
+static void _mp3_cvt_pcm(_driver_t*, void_ptrptr, const_void_ptr, size_t, size_t, char);
 static void _detect_mp3_song_info(_driver_t*);
+static void _detect_mp3_gapless_info(_driver_t*, const uint8_t*, size_t);
+static size_t _mp3_gapless_trim(_driver_t*, unsigned char**, size_t);
 #ifndef NDEBUG
 static void _aax_lame_log(const char*, va_list);
 #endif
@@ -218,6 +231,7 @@ _mp3_detect(UNUSED(_fmt_t *fmt), int mode)
                TIE_FUNCTION(mpg123_meta_check);
                TIE_FUNCTION(mpg123_id3);
                TIE_FUNCTION(mpg123_plain_strerror);
+               TIE_FUNCTION(mpg123_format_none);
 
                pmp3_length = pmpg123_length;
                pmp3_set_filesize = pmpg123_set_filesize;
@@ -325,8 +339,10 @@ _mp3_open(_fmt_t *fmt, int mode, void *buf, ssize_t *bufsize, size_t fsize)
             handle->id = pmp3_new(NULL, &error_no);
             if (handle->id)
             {
-               if (pmp3_open_feed(handle->id) == MP3_OK) {
+               if (pmp3_open_feed(handle->id) == MP3_OK)
+               {
                   handle->mp3Buffer = _aaxDataCreate(1, 16384, 1);
+                  _detect_mp3_gapless_info(handle, buf, *bufsize);
                }
                else
                {
@@ -371,13 +387,18 @@ _mp3_open(_fmt_t *fmt, int mode, void *buf, ssize_t *bufsize, size_t fsize)
                pmp3_param(handle->id, MP3_ADD_FLAGS, MP3_FUZZY, 1);
                pmp3_param(handle->id, MP3_ADD_FLAGS, MP3_PICTURE, 1);
                pmp3_param(handle->id, MP3_RESYNC_LIMIT, -1, 0.0);
+
+               // let the frame index grow over the whole file, seeking to
+               // an already decoded position then does not need a scan.
+               // positions beyond it are estimated from the Xing TOC.
+               if (!handle->streaming) {
+                  pmp3_param(handle->id, MP3_INDEX_SIZE, -1024, 0.0);
+               }
                pmp3_param(handle->id, MP3_REMOVE_FLAGS,
                                          MP3_AUTO_RESAMPLE, 0);
                pmp3_param(handle->id, MP3_RVA, MP3_RVA_MIX, 0.0);
 
-               pmp3_format(handle->id, handle->info.rate,
-                                    MP3_MONO | MP3_STEREO,
-                                    MP3_ENC_SIGNED_16);
+               _mp3_set_output(handle);
 
                if (pmp3_open_feed(handle->id) == MP3_OK)
                {
@@ -739,6 +760,10 @@ _mp3_copy(_fmt_t *fmt, int32_ptr dptr, size_t dptr_offs, size_t *num)
    {
       unsigned char *ptr = (unsigned char*)dptr;
 
+      if (handle->end_sample) {
+         size = _mp3_gapless_trim(handle, &buf, size);
+      }
+
       ptr += dptr_offs*blocksize;
       memcpy(ptr, buf, size);
 
@@ -757,15 +782,65 @@ _mp3_copy(_fmt_t *fmt, int32_ptr dptr, size_t dptr_offs, size_t *num)
 
 size_t
 _mp3_cvt_from_intl(_fmt_t *fmt, int32_ptrptr dptr, size_t dptr_offs, size_t *num)
+{
+   return _mp3_decode(fmt, (void_ptrptr)dptr, dptr_offs, num, false);
+}
+
+size_t
+_mp3_cvt_from_intl_float(_fmt_t *fmt, MIX_PTRPTR_T dptr, size_t dptr_offs, size_t *num)
+{
+   return _mp3_decode(fmt, (void_ptrptr)dptr, dptr_offs, num, true);
+}
+
+/*
+ * Convert interleaved decoder output to int32_t or to the float mixer
+ * format. Float output is scaled directly when the mixer format is requested.
+ */
+static void
+_mp3_cvt_pcm(_driver_t *handle, void_ptrptr dptr, const_void_ptr sptr, size_t offs, size_t num, char mixer_fmt)
+{
+   unsigned int t, tracks = handle->no_tracks;
+
+   if (handle->pcm_float && mixer_fmt)
+   {
+      for (t=0; t<tracks; t++)
+      {
+         const float *s = (const float*)sptr + t;
+         MIX_T *d = (MIX_T*)dptr[t] + offs;
+         size_t i;
+
+         for (i=0; i<num; i++) {
+            d[i] = s[i*tracks]*AAX_PEAK_MAX;
+         }
+      }
+   }
+   else if (handle->pcm_float) {
+      _batch_cvt24_ps_intl((int32_ptrptr)dptr, sptr, offs, tracks, num);
+   }
+   else
+   {
+      _batch_cvt24_16_intl((int32_ptrptr)dptr, sptr, offs, tracks, num);
+      if (mixer_fmt)
+      {
+         for (t=0; t<tracks; t++)
+         {
+            int32_t *ptr = (int32_t*)dptr[t] + offs;
+            _batch_cvtps24_24(ptr, ptr, num);
+         }
+      }
+   }
+}
+
+static size_t
+_mp3_decode(_fmt_t *fmt, void_ptrptr dptr, size_t dptr_offs, size_t *num, char mixer_fmt)
 {
    _driver_t *handle = fmt->id;
    size_t bytes, bufsize, size = 0;
-   unsigned int blocksize, tracks;
+   unsigned int blocksize;
    unsigned char *buf;
    size_t rv = __F_NEED_MORE;
    int ret;
 
-   tracks = handle->no_tracks;
    blocksize = handle->blocksize;
    bytes = *num*blocksize;
 
@@ -807,8 +882,12 @@ _mp3_cvt_from_intl(_fmt_t *fmt, int32_ptrptr dptr, size_t dptr_offs, size_t *num
    }
    else if (ret == MP3_OK || ret == MP3_NEED_MORE)
    {
+      if (handle->end_sample) {
+         size = _mp3_gapless_trim(handle, &buf, size);
+      }
+
       *num = size/blocksize;
-      _batch_cvt24_16_intl(dptr, buf, dptr_offs, tracks, *num);
+      _mp3_cvt_pcm(handle, dptr, buf, dptr_offs, *num, mixer_fmt);
 
       handle->no_samples += *num;
       if (ret == MP3_OK) {
@@ -1032,6 +1111,9 @@ _mp3_set(_fmt_t *fmt, int type, float value)
    case __F_IS_STREAM:
       handle->streaming = true;
       break;
+   case __F_COPY_DATA:
+      handle->copy_data = value;
+      break;
    case __F_POSITION:
       if (pmp3_feedseek)
       {
@@ -1086,12 +1168,150 @@ _getFormatFromMP3Format(int enc)
    case MP3_ENC_SIGNED_32:
       rv = AAX_PCM32S;
       break;
+   case MP3_ENC_FLOAT_32:
+      rv = AAX_FLOAT;
+      break;
    default:
       rv = AAX_FORMAT_NONE;
    }
    return rv;
 }
 
+/*
+ * Let libmpg123 decode to float when it can, the samples are then converted
+ * or scaled straight into the mixer format without passing int16_t.
+ * Data that is copied unmodified keeps the signed 16-bit output.
+ */
+static void
+_mp3_set_output(_driver_t *handle)
+{
+   static const long rates[] = {
+      8000, 11025, 12000, 16000, 22050, 24000, 32000, 44100, 48000
+   };
+   int enc = MP3_ENC_SIGNED_16;
+   unsigned int i;
+
+   handle->pcm_float = false;
+   if (pmpg123_format_none && !handle->copy_data)
+   {
+      handle->pcm_float = true;
+      enc = MP3_ENC_FLOAT_32;
+   }
+
+   if (pmpg123_format_none)
+   {
+      unsigned int num = sizeof(rates)/sizeof(long);
+
+      pmpg123_format_none(handle->id);
+      for (i=0; i<num; ++i) {
+         if (pmp3_format(handle->id, rates[i], MP3_MONO | MP3_STEREO, enc) != MP3_OK) break;
+      }
+
+      if (i < num && handle->pcm_float) // no float output available
+      {
+         handle->pcm_float = false;
+         pmpg123_format_none(handle->id);
+         for (i=0; i<num; ++i) {
+            pmp3_format(handle->id, rates[i], MP3_MONO | MP3_STEREO, MP3_ENC_SIGNED_16);
+         }
+      }
+   }
+   else {
+      pmp3_format(handle->id, handle->info.rate, MP3_MONO | MP3_STEREO, enc);
+   }
+}
+
+/*
+ * The internal decoder does not handle gapless playback, get the encoder
+ * delay and padding from the LAME tag in the Xing or Info header of the
+ * first frame. This frame is decoded as a frame of silence.
+ */
+#define MP3_DECODER_DELAY	529
+static void
+_detect_mp3_gapless_info(_driver_t *handle, const uint8_t *buf, size_t len)
+{
+   size_t pos = 0, side_info, frames = 0, spf;
+   unsigned int flags, delay, padding;
+   char mpeg1, mono;
+
+   if (!buf || handle->streaming) return;
+
+   if (len > 10 && !memcmp(buf, "ID3", 3))
+   {
+      pos = 10 + (((buf[6] & 0x7F) << 21) | ((buf[7] & 0x7F) << 14) |
+                  ((buf[8] & 0x7F) << 7) | (buf[9] & 0x7F));
+      if (buf[5] & 0x10) pos += 10; // footer
+   }
+
+   // MPEG audio layer III frame header
+   if (pos+4 > len || buf[pos] != 0xFF || (buf[pos+1] & 0xE6) != 0xE2) {
+      return;
+   }
+   mpeg1 = ((buf[pos+1] & 0x18) == 0x18);
+   mono = ((buf[pos+3] & 0xC0) == 0xC0);
+   if (mpeg1) side_info = mono ? 17 : 32;
+   else side_info = mono ? 9 : 17;
+
+   pos += 4 + side_info;
+   if (pos+8 > len || (memcmp(buf+pos, "Xing", 4) && memcmp(buf+pos, "Info", 4)))
+   {
+      return;
+   }
+
+   flags = ((uint32_t)buf[pos+4] << 24) | (buf[pos+5] << 16) | (buf[pos+6] << 8) | buf[pos+7];
+   pos += 8;
+   if (flags & 0x1)
+   {
+      if (pos+4 > len) return;
+      frames = ((uint32_t)buf[pos] << 24) | (buf[pos+1] << 16) | (buf[pos+2] << 8) | buf[pos+3];
+      pos += 4;
+   }
+   if (flags & 0x2) pos += 4;	// bytes
+   if (flags & 0x4) pos += 100;	// TOC
+   if (flags & 0x8) pos += 4;	// quality
+
+   // LAME extension: the encoder delay and padding are 12-bits each
+   if (!frames || pos+24 > len || (memcmp(buf+pos, "LAME", 4) &&
+       memcmp(buf+pos, "Lavf", 4) && memcmp(buf+pos, "Lavc", 4)))
+   {
+      return;
+   }
+
+   delay = (buf[pos+21] << 4) | (buf[pos+22] >> 4);
+   padding = ((buf[pos+22] & 0xF) << 8) | buf[pos+23];
+
+   spf = mpeg1 ? 1152 : 576;
+   frames *= spf;
+   if (frames > delay + padding)
+   {
+      handle->start_sample = spf + delay + MP3_DECODER_DELAY;
+      handle->end_sample = spf + frames - padding + MP3_DECODER_DELAY;
+   }
+}
+
+/* Drop the decoded samples which are outside of the encoded range. */
+static size_t
+_mp3_gapless_trim(_driver_t *handle, unsigned char **buf, size_t size)
+{
+   size_t blocksize = handle->blocksize;
+   size_t start = handle->decoded;
+   size_t num = size/blocksize;
+
+   handle->decoded += num;
+   if (handle->decoded > handle->end_sample) {
+      num = (handle->end_sample > start) ? handle->end_sample - start : 0;
+   }
+
+   if (start < handle->start_sample)
+   {
+      size_t skip = _MIN(handle->start_sample - start, num);
+      *buf += skip*blocksize;
+      num -= skip;
+   }
+
+   return num*blocksize;
+}
+
 static void
 _detect_mp3_song_info(_driver_t *handle)
 {
@@ -262,6 +262,7 @@ typedef int (*mpg123_param_proc)(void*, enum mp3_parms, long, double);
 typedef int (*mpg123_getparam_proc)(void*, enum mp3_parms, long*, double*);
 typedef int (*mpg123_feature_proc)(const enum mp3_feature_set);
 typedef int (*mpg123_format_proc)(void*, long, int, int);
+typedef int (*mpg123_format_none_proc)(void*);
 typedef int (*mpg123_info_proc)(void*, struct mp3_frameinfo*);
 typedef int (*mpg123_getformat_proc)(void*, long*, int*, int*);
 typedef int (*mpg123_set_filesize_proc)(void*, off_t);
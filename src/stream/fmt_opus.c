@@ -35,12 +35,13 @@
 #define OPUS_BUFFER_SIZE	(2*MAX_PACKET_SIZE)
 // #define OPUS_BUFFER_SIZE	16384
 
-#define MAX_PCMBUFSIZE	(MAX_FRAME_SIZE*_AAX_MAX_SPEAKERS*sizeof(int16_t))
+#define MAX_PCMBUFSIZE	(MAX_FRAME_SIZE*_AAX_MAX_SPEAKERS*sizeof(float))
 
 DECL_FUNCTION(opus_decoder_create);
 DECL_FUNCTION(opus_decoder_destroy);
 DECL_FUNCTION(opus_decoder_ctl);
 DECL_FUNCTION(opus_decode);
+DECL_FUNCTION(opus_decode_float);
 
 DECL_FUNCTION(opus_encoder_create);
 DECL_FUNCTION(opus_encoder_destroy);
@@ -59,6 +60,7 @@ typedef struct
    int mode;
    char capturing;
    char recover;
+   char pcm_float; // pcmBuffer holds float instead of int16_t samples
 
    uint8_t no_tracks;
    uint8_t bits_sample;
@@ -86,6 +88,9 @@ typedef struct
 
 } _driver_t;
 
+static size_t _opus_decode(_fmt_t*, void_ptrptr, size_t, size_t*, char);
+static void _opus_cvt_pcm(_driver_t*, void_ptrptr, const_void_ptr, size_t, size_t, char);
+
 static void *audio = NULL;
 
 int
@@ -132,6 +137,9 @@ return rv;
          /* not required but useful */
          TIE_FUNCTION(opus_strerror);
          TIE_FUNCTION(opus_get_version_string);
+         if (!mode) {
+            TIE_FUNCTION(opus_decode_float);
+         }
 
          rv = true;
       }
@@ -162,6 +170,7 @@ _opus_open(_fmt_t *fmt, int mode, void *buf, ssize_t *bufsize, UNUSED(size_t fsi
          handle->format = AAX_PCM16S;
          handle->bits_sample = aaxGetBitsPerSample(handle->format);
          handle->capturing = (mode == 0) ? 1 : 0;
+         handle->pcm_float = (popus_decode_float != NULL);
          handle->blocksize = FRAME_SIZE;
       }
       else {
@@ -172,11 +181,11 @@ _opus_open(_fmt_t *fmt, int mode, void *buf, ssize_t *bufsize, UNUSED(size_t fsi
    if (handle)
    {
       if (!handle->opusBuffer) {
-         handle->opusBuffer = _aaxDataCreate(1, OPUS_BUFFER_SIZE, 1);
+         handle->opusBuffer = _aaxDataCreateRing(1, OPUS_BUFFER_SIZE, 1);
       }
 
       if (!handle->pcmBuffer) {
-         handle->pcmBuffer = _aaxDataCreate(1, MAX_PCMBUFSIZE, 1);
+         handle->pcmBuffer = _aaxDataCreateRing(1, MAX_PCMBUFSIZE, 1);
       }
 
       if (handle->opusBuffer && handle->pcmBuffer)
@@ -299,10 +308,11 @@ _opus_copy(_fmt_t *fmt, int32_ptr dptr, size_t dptr_offs, size_t *num)
    packet_sz = FRAME_SIZE;
    *num = 0;
 
-   pcmBuffer = (int16_t*)_aaxDataGetData(handle->pcmBuffer, 0);
    do
    {
       size_t avail = _aaxDataGetDataAvail(handle->pcmBuffer, 0);
+
+      pcmBuffer = (int16_t*)_aaxDataGetData(handle->pcmBuffer, 0);
       if (avail > 0)
       {
          unsigned int max = _MIN(req, avail/framesize);
@@ -326,6 +336,7 @@ _opus_copy(_fmt_t *fmt, int32_ptr dptr, size_t dptr_offs, size_t *num)
             size_t pcmsmp = _aaxDataGetSize(handle->pcmBuffer)/framesize;
             unsigned char *buf = _aaxDataGetData(handle->opusBuffer, 0);
 
+            pcmBuffer = (int16_t*)_aaxDataGetData(handle->pcmBuffer, 0);
             n = popus_decode(handle->id, buf, bufsize, pcmBuffer, pcmsmp,
                                    0);
             if (n <= 0) break;
@@ -345,18 +356,69 @@ _opus_copy(_fmt_t *fmt, int32_ptr dptr, size_t dptr_offs, size_t *num)
 
 size_t
 _opus_cvt_from_intl(_fmt_t *fmt, int32_ptrptr dptr, size_t dptr_offs, size_t *num)
+{
+   return _opus_decode(fmt, (void_ptrptr)dptr, dptr_offs, num, false);
+}
+
+size_t
+_opus_cvt_from_intl_float(_fmt_t *fmt, MIX_PTRPTR_T dptr, size_t dptr_offs, size_t *num)
+{
+   return _opus_decode(fmt, (void_ptrptr)dptr, dptr_offs, num, true);
+}
+
+/*
+ * Convert interleaved decoder output to int32_t or to the float mixer
+ * format. Float output is scaled directly when the mixer format is requested.
+ */
+static void
+_opus_cvt_pcm(_driver_t *handle, void_ptrptr dptr, const_void_ptr sptr, size_t offs, size_t num, char mixer_fmt)
+{
+   unsigned int t, tracks = handle->no_tracks;
+
+   if (handle->pcm_float && mixer_fmt)
+   {
+      for (t=0; t<tracks; t++)
+      {
+         const float *s = (const float*)sptr + t;
+         MIX_T *d = (MIX_T*)dptr[t] + offs;
+         size_t i;
+
+         for (i=0; i<num; i++) {
+            d[i] = s[i*tracks]*AAX_PEAK_MAX;
+         }
+      }
+   }
+   else if (handle->pcm_float) {
+      _batch_cvt24_ps_intl((int32_ptrptr)dptr, sptr, offs, tracks, num);
+   }
+   else
+   {
+      _batch_cvt24_16_intl((int32_ptrptr)dptr, sptr, offs, tracks, num);
+      if (mixer_fmt)
+      {
+         for (t=0; t<tracks; t++)
+         {
+            int32_t *ptr = (int32_t*)dptr[t] + offs;
+            _batch_cvtps24_24(ptr, ptr, num);
+         }
+      }
+   }
+}
+
+static size_t
+_opus_decode(_fmt_t *fmt, void_ptrptr dptr, size_t dptr_offs, size_t *num, char mixer_fmt)
 {
    _driver_t *handle = fmt->id;
    unsigned int req, bps, tracks;
    uint8_t *opusBuf;
-   int16_t *pcmBuf;
+   void *pcmBuf;
    size_t pcmBufAvail;
    size_t rv = 0;
    int ret;
 
    req = *num;
    tracks = handle->no_tracks;
-   bps = tracks*sizeof(int16_t);
+   bps = tracks*(handle->pcm_float ? sizeof(float) : sizeof(int16_t));
 
    // there is still data left in the buffer from the previous run
    *num = 0;
@@ -365,7 +427,7 @@ _opus_cvt_from_intl(_fmt_t *fmt, int32_ptrptr dptr, size_t dptr_offs, size_t *nu
       unsigned int max = _MIN(req, pcmBufAvail/bps);
 
       pcmBuf = _aaxDataGetData(handle->pcmBuffer, 0);
-      _batch_cvt24_16_intl(dptr, pcmBuf, dptr_offs, tracks, max);
+      _opus_cvt_pcm(handle, dptr, pcmBuf, dptr_offs, max, mixer_fmt);
 
       _aaxDataMove(handle->pcmBuffer, 0, NULL, max*bps);
       handle->no_samples += max;
@@ -395,9 +457,15 @@ _opus_cvt_from_intl(_fmt_t *fmt, int32_ptrptr dptr, size_t dptr_offs, size_t *nu
 
 
          // store the next chunk into the pcmBuffer
-         ret = popus_decode(handle->id,
-                            handle->recover ? NULL : opusBuf, packetSize,
-                            pcmBuf, frameSpace, 0);
+         if (handle->pcm_float) {
+            ret = popus_decode_float(handle->id,
+                                     handle->recover ? NULL : opusBuf,
+                                     packetSize, pcmBuf, frameSpace, 0);
+         } else {
+            ret = popus_decode(handle->id,
+                               handle->recover ? NULL : opusBuf, packetSize,
+                               pcmBuf, frameSpace, 0);
+         }
          if (ret > 0)
          {
             rv += _aaxDataMove(handle->opusBuffer, 0, NULL, packetSize);
@@ -413,7 +481,7 @@ _opus_cvt_from_intl(_fmt_t *fmt, int32_ptrptr dptr, size_t dptr_offs, size_t *nu
                   unsigned int max = _MIN(req, pcmBufAvail/bps);
 
                   pcmBuf = _aaxDataGetData(handle->pcmBuffer, 0);
-                  _batch_cvt24_16_intl(dptr, pcmBuf, dptr_offs, tracks, max);
+                  _opus_cvt_pcm(handle, dptr, pcmBuf, dptr_offs, max, mixer_fmt);
 
                   _aaxDataMove(handle->pcmBuffer, 0, NULL, max*bps);
                   handle->no_samples += max;
@@ -651,6 +719,14 @@ _opus_set(_fmt_t *fmt, int type, float value)
    case __F_IS_STREAM:
       break;
    case __F_POSITION:
+      if (handle->id && handle->capturing)
+      {
+         popus_decoder_ctl(handle->id, OPUS_RESET_STATE);
+         _aaxDataClear(handle->opusBuffer, 0);
+         _aaxDataClear(handle->pcmBuffer, 0);
+         handle->recover = false;
+         rv = value;
+      }
       break;
    default:
       break;
@@ -13,6 +13,7 @@
 #define OPUS_GET_LAST_PACKET_DURATION_REQUEST 4039
 #define __opus_check_int_ptr(ptr) ((ptr) + ((ptr) - (int32_t*)(ptr)))
 #define OPUS_GET_LAST_PACKET_DURATION(x) OPUS_GET_LAST_PACKET_DURATION_REQUEST, __opus_check_int_ptr(x)
+#define OPUS_RESET_STATE	4028
 
 #define OPUS_OK			 0
 #define OPUS_BAD_ARG 		-1
@@ -96,7 +96,7 @@ _pcm_open(_fmt_t *fmt, int mode, void *buf, ssize_t *bufsize, UNUSED(size_t fsiz
    if (handle && buf && bufsize)
    {
       if (!handle->pcmBuffer) {
-         handle->pcmBuffer = _aaxDataCreate(1, 16384, 1);
+         handle->pcmBuffer = _aaxDataCreateRing(1, 16384, 1);
       }
 
       if (!handle->pcmBuffer)
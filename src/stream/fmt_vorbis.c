@@ -63,11 +63,20 @@ typedef struct
    unsigned int out_pos;
    unsigned int out_size;
 
+   uint32_t sync_loc;		// sample position of the page synchronised on
+   unsigned int seek_skip;	// output starts this many samples later
+   char sync_valid;
+   char seeking;
+
    _driver_write_t *out;
 
 } _driver_t;
 
 static void _detect_vorbis_song_info(_driver_t*);
+static void _vorbis_cvt_track(void_ptr, const float*, size_t, char);
+static size_t _vorbis_decode(_fmt_t*, void_ptrptr, size_t, size_t*, char);
+static unsigned int _vorbis_decode_frame(_driver_t*, size_t*, int*);
+static void _vorbis_seek_frame(_driver_t*, int*);
 
 
 #define FRAME_SIZE		4096
@@ -177,7 +186,7 @@ _vorbis_open(_fmt_t *fmt, int mode, void *buf, ssize_t *bufsize, size_t fsize)
    if (handle)
    {
       if (!handle->vorbisBuffer) {
-         handle->vorbisBuffer = _aaxDataCreate(1, VORBIS_BUFFER_SIZE, 1);
+         handle->vorbisBuffer = _aaxDataCreateRing(1, VORBIS_BUFFER_SIZE, 1);
       }
 
       if (handle->vorbisBuffer)
@@ -376,8 +385,7 @@ size_t
 _vorbis_copy(_fmt_t *fmt, int32_ptr dptr, size_t dptr_offs, size_t *num)
 {
    _driver_t *handle = fmt->id;
-   size_t outbufavail, rv = 0;
-   unsigned char *outbuf;
+   size_t rv = 0;
    unsigned int req, ret;
    int tracks;
    int n;
@@ -390,9 +398,6 @@ _vorbis_copy(_fmt_t *fmt, int32_ptr dptr, size_t dptr_offs, size_t *num)
    tracks = handle->info.channels;
    *num = 0;
 
-   outbuf = _aaxDataGetData(handle->vorbisBuffer, 0);
-   outbufavail = _aaxDataGetDataAvail(handle->vorbisBuffer, 0);
-
    /* there is still data left in the buffer from the previous run */
    if (handle->out_pos > 0)
    {
@@ -415,17 +420,7 @@ _vorbis_copy(_fmt_t *fmt, int32_ptr dptr, size_t dptr_offs, size_t *num)
 
    while (req > 0)
    {
-      do
-      {
-         ret = stb_vorbis_decode_frame_pushdata(handle->id, outbuf, outbufavail,
-                                                NULL, &handle->outputs, &n);
-         if (ret > 0)
-         {
-            rv += _aaxDataMove(handle->vorbisBuffer, 0, NULL, ret);
-            outbufavail = _aaxDataGetDataAvail(handle->vorbisBuffer, 0);
-         }
-      }
-      while (ret && n == 0);
+      ret = _vorbis_decode_frame(handle, &rv, &n);
 
       if (ret > 0)
       {
@@ -468,10 +463,47 @@ _vorbis_copy(_fmt_t *fmt, int32_ptr dptr, size_t dptr_offs, size_t *num)
 
 size_t
 _vorbis_cvt_from_intl(_fmt_t *fmt, int32_ptrptr dptr, size_t dptr_offs, size_t *num)
+{
+   return _vorbis_decode(fmt, (void_ptrptr)dptr, dptr_offs, num, false);
+}
+
+/*
+ * stb_vorbis decodes to float, scale it to the mixer format directly
+ * instead of converting it to int32_t and back again.
+ */
+size_t
+_vorbis_cvt_from_intl_float(_fmt_t *fmt, MIX_PTRPTR_T dptr, size_t dptr_offs, size_t *num)
+{
+   return _vorbis_decode(fmt, (void_ptrptr)dptr, dptr_offs, num, true);
+}
+
+/*
+ * The SIMD versions of _batch_fmul_value use an approximated reciprocal
+ * which is off by up to 1/4096, scale the samples exactly like
+ * _batch_cvt24_ps does instead.
+ */
+static void
+_vorbis_cvt_track(void_ptr dptr, const float *sptr, size_t num, char mixer_fmt)
+{
+   if (mixer_fmt)
+   {
+      MIX_T *d = (MIX_T*)dptr;
+      size_t i;
+
+      for (i=0; i<num; ++i) {
+         d[i] = sptr[i]*AAX_PEAK_MAX;
+      }
+   }
+   else {
+      _batch_cvt24_ps(dptr, sptr, num);
+   }
+}
+
+static size_t
+_vorbis_decode(_fmt_t *fmt, void_ptrptr dptr, size_t dptr_offs, size_t *num, char mixer_fmt)
 {
    _driver_t *handle = fmt->id;
-   size_t outbufavail, rv = 0;
-   unsigned char *outbuf;
+   size_t rv = 0;
    unsigned int req, ret;
    int n, i, tracks;
 
@@ -479,9 +511,6 @@ _vorbis_cvt_from_intl(_fmt_t *fmt, int32_ptrptr dptr, size_t dptr_offs, size_t *
    tracks = handle->info.channels;
    *num = 0;
 
-   outbuf = _aaxDataGetData(handle->vorbisBuffer, 0);
-   outbufavail = _aaxDataGetDataAvail(handle->vorbisBuffer, 0);
-
    /* there is still data left in the buffer from the previous run */
    if (handle->out_pos > 0)
    {
@@ -489,7 +518,8 @@ _vorbis_cvt_from_intl(_fmt_t *fmt, int32_ptrptr dptr, size_t dptr_offs, size_t *
       unsigned int max = _MIN(req, handle->out_size - pos);
 
       for (i=0; i<tracks; i++) {
-         _batch_cvt24_ps(dptr[i]+dptr_offs, handle->outputs[i]+pos, max);
+         _vorbis_cvt_track((int32_t*)dptr[i]+dptr_offs, handle->outputs[i]+pos,
+                           max, mixer_fmt);
       }
       dptr_offs += max;
       handle->out_pos += max;
@@ -503,19 +533,7 @@ _vorbis_cvt_from_intl(_fmt_t *fmt, int32_ptrptr dptr, size_t dptr_offs, size_t *
 
    while (req > 0)
    {
-      ret = 0;
-      do
-      {
-         ret = stb_vorbis_decode_frame_pushdata(handle->id, outbuf, outbufavail,
-                                                NULL, &handle->outputs, &n);
-         if (ret > 0)
-         {
-            rv += _aaxDataMove(handle->vorbisBuffer, 0, NULL, ret);
-
-            outbufavail = _aaxDataGetDataAvail(handle->vorbisBuffer, 0);
-         }
-      }
-      while (ret && n == 0);
+      ret = _vorbis_decode_frame(handle, &rv, &n);
 
       if (ret > 0)
       {
@@ -536,7 +554,8 @@ _vorbis_cvt_from_intl(_fmt_t *fmt, int32_ptrptr dptr, size_t dptr_offs, size_t *
          handle->no_samples += n;
 
          for (i=0; i<tracks; i++) {
-            _batch_cvt24_ps(dptr[i]+dptr_offs, handle->outputs[i], n);
+            _vorbis_cvt_track((int32_t*)dptr[i]+dptr_offs, handle->outputs[i],
+                              n, mixer_fmt);
          }
          dptr_offs += n;
       }
@@ -769,6 +788,20 @@ _vorbis_set(_fmt_t *fmt, int type, float value)
    case __F_IS_STREAM:
       break;
    case __F_POSITION:
+      if (handle->id && handle->capturing)
+      {
+         /* the next data is not contiguous with the previous data */
+         stb_vorbis_flush_pushdata(handle->id);
+         _aaxDataClear(handle->vorbisBuffer, 0);
+         handle->out_pos = 0;
+
+         /* the output starts value samples after the granule position */
+         /* of the page the decoder synchronises on.                   */
+         handle->seek_skip = value;
+         handle->sync_valid = false;
+         handle->seeking = (handle->seek_skip > 0);
+         rv = value;
+      }
       break;
    default:
       break;
@@ -777,6 +810,80 @@ _vorbis_set(_fmt_t *fmt, int type, float value)
 }
 
 /* -------------------------------------------------------------------------- */
+
+/*
+ * Decode the next frame which produces output, n holds the number of
+ * samples per track. Returns zero if more data is required.
+ */
+static unsigned int
+_vorbis_decode_frame(_driver_t *handle, size_t *rv, int *n)
+{
+   unsigned int ret;
+
+   do
+   {
+      unsigned char *outbuf = _aaxDataGetData(handle->vorbisBuffer, 0);
+      size_t outbufavail = _aaxDataGetDataAvail(handle->vorbisBuffer, 0);
+
+      ret = stb_vorbis_decode_frame_pushdata(handle->id, outbuf, outbufavail,
+                                             NULL, &handle->outputs, n);
+      if (ret > 0)
+      {
+         *rv += _aaxDataMove(handle->vorbisBuffer, 0, NULL, ret);
+         if (handle->seeking) {
+            _vorbis_seek_frame(handle, n);
+         }
+      }
+   }
+   while (ret && *n == 0);
+
+   return ret;
+}
+
+/*
+ * After a flush stb_vorbis skips the first page it finds to get the sample
+ * position from it and drops the output of the first packet after that.
+ * Drop the samples up to seek_skip samples after that page instead, which
+ * makes the output start at a known sample position.
+ */
+static void
+_vorbis_seek_frame(_driver_t *handle, int *n)
+{
+   int loc = stb_vorbis_get_sample_offset(handle->id);
+
+   if (!handle->sync_valid && loc != -1)
+   {
+      handle->sync_loc = loc;
+      handle->sync_valid = true;
+   }
+
+   if (*n > 0)
+   {
+      if (handle->sync_valid)
+      {
+         uint32_t end = (uint32_t)loc - handle->sync_loc;
+         uint32_t start = end - *n;
+
+         if (start < handle->seek_skip)
+         {
+            unsigned int skip = _MIN(*n, handle->seek_skip - start);
+            int i;
+
+            for (i=0; i<handle->info.channels; i++) {
+               handle->outputs[i] += skip;
+            }
+            *n -= skip;
+         }
+         if (end >= handle->seek_skip) {
+            handle->seeking = false;
+         }
+      }
+      else { /* the position is unknown until the end of a page */
+         *n = 0;
+      }
+   }
+}
+
 static void
 _detect_vorbis_song_info(_driver_t *handle)
 {
@@ -64,6 +64,7 @@ _fmt_create(_fmt_type_t format, int mode)
             rv->update = _mp3_update;
             rv->cvt_to_intl_float = _mp3_cvt_to_intl_float;
             rv->cvt_from_intl = _mp3_cvt_from_intl;
+            rv->cvt_from_intl_float = _mp3_cvt_from_intl_float;
             rv->fill = _mp3_fill;
             rv->copy = _mp3_copy;
 
@@ -91,6 +92,7 @@ _fmt_create(_fmt_type_t format, int mode)
 
             rv->cvt_to_intl = _opus_cvt_to_intl;
             rv->cvt_from_intl = _opus_cvt_from_intl;
+            rv->cvt_from_intl_float = _opus_cvt_from_intl_float;
             rv->fill = _opus_fill;
             rv->copy = _opus_copy;
 
@@ -118,6 +120,7 @@ _fmt_create(_fmt_type_t format, int mode)
 
             rv->cvt_to_intl = _vorbis_cvt_to_intl;
             rv->cvt_from_intl = _vorbis_cvt_from_intl;
+            rv->cvt_from_intl_float = _vorbis_cvt_from_intl_float;
             rv->fill = _vorbis_fill;
             rv->copy = _vorbis_copy;
 
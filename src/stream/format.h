@@ -50,6 +50,7 @@ typedef char* (_fmt_name_fn)(struct _fmt_st*, enum _aaxStreamParam);
 typedef void* (_fmt_update_fn)(struct _fmt_st*, size_t*, ssize_t*, char);
 typedef void (_fmt_cvt_fn)(struct _fmt_st*, void_ptr, size_t);
 typedef size_t (_fmt_cvt_from_fn)(struct _fmt_st*, int32_ptrptr, size_t, size_t*);
+typedef size_t (_fmt_cvt_from_float_fn)(struct _fmt_st*, MIX_PTRPTR_T, size_t, size_t*);
 typedef size_t (_fmt_cvt_to_fn)(struct _fmt_st*, void_ptr, const_int32_ptrptr, size_t, size_t*, void_ptr, size_t);
 typedef size_t (_fmt_cvt_to_float_fn)(struct _fmt_st*, void_ptr, CONST_MIX_PTRPTR_T, size_t, size_t*, void_ptr, size_t);
 typedef size_t (_fmt_fill_fn)(struct _fmt_st*, void_ptr, ssize_t*);
@@ -74,6 +75,7 @@ struct _fmt_st
    _fmt_cvt_to_fn *cvt_to_intl;			// convert to file format
    _fmt_cvt_to_float_fn *cvt_to_intl_float;	// convert float to file format
    _fmt_cvt_from_fn *cvt_from_intl;		// convert to mixer format
+   _fmt_cvt_from_float_fn *cvt_from_intl_float;	// convert to float mixer format
    _fmt_fill_fn *fill;
    _fmt_copy_fn *copy;				// copy raw sound data
 
@@ -110,6 +112,7 @@ void _mp3_close(_fmt_t*);
 void* _mp3_update(_fmt_t*, size_t*, ssize_t*, char);
 size_t _mp3_cvt_to_intl_float(_fmt_t*, void_ptr, CONST_MIX_PTRPTR_T, size_t, size_t*, void_ptr, size_t);
 size_t _mp3_cvt_from_intl(_fmt_t*, int32_ptrptr, size_t, size_t*);
+size_t _mp3_cvt_from_intl_float(_fmt_t*, MIX_PTRPTR_T, size_t, size_t*);
 size_t _mp3_fill(_fmt_t*, void_ptr, ssize_t*);
 size_t _mp3_copy(_fmt_t*, int32_ptr, size_t, size_t*);
 char* _mp3_name(_fmt_t*, enum _aaxStreamParam);
@@ -126,6 +129,7 @@ void* _opus_open(_fmt_t*, int, void*, ssize_t*, size_t);
 void _opus_close(_fmt_t*);
 size_t _opus_cvt_to_intl(_fmt_t*, void_ptr, const_int32_ptrptr, size_t, size_t*, void_ptr, size_t);
 size_t _opus_cvt_from_intl(_fmt_t*, int32_ptrptr, size_t, size_t*);
+size_t _opus_cvt_from_intl_float(_fmt_t*, MIX_PTRPTR_T, size_t, size_t*);
 size_t _opus_fill(_fmt_t*, void_ptr, ssize_t*);
 size_t _opus_copy(_fmt_t*, int32_ptr, size_t, size_t*);
 char* _opus_name(_fmt_t*, enum _aaxStreamParam);
@@ -140,6 +144,7 @@ void* _vorbis_open(_fmt_t*, int, void*, ssize_t*, size_t);
 void _vorbis_close(_fmt_t*);
 size_t _vorbis_cvt_to_intl(_fmt_t*, void_ptr, const_int32_ptrptr, size_t, size_t*, void_ptr, size_t);
 size_t _vorbis_cvt_from_intl(_fmt_t*, int32_ptrptr, size_t, size_t*);
+size_t _vorbis_cvt_from_intl_float(_fmt_t*, MIX_PTRPTR_T, size_t, size_t*);
 size_t _vorbis_fill(_fmt_t*, void_ptr, ssize_t*);
 size_t _vorbis_copy(_fmt_t*, int32_ptr, size_t, size_t*);
 char* _vorbis_name(_fmt_t*, enum _aaxStreamParam);
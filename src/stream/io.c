@@ -75,6 +75,8 @@ _io_free(_io_t* io)
    if (io->prot) {
       io->prot = _prot_free(io->prot);
    }
+   free(io->server);
+   free(io->path);
    free(io);
    return 0;
 }
@@ -63,6 +63,17 @@ struct _io_st
    void *ssl;
    void *ssl_ctx;
 
+   /* socket: the resource of the last request, used to request ranges */
+   char *server;
+   char *path;
+   struct _socket_segments_s *segments;
+
+   /* memory mapped file contents in read mode, NULL otherwise */
+   void *map;
+   size_t map_size;
+   size_t map_pos;
+   size_t map_ahead;
+
    _prot_t *prot;
 };
 typedef struct _io_st _io_t;
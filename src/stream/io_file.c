@@ -18,6 +18,9 @@
 #ifdef HAVE_UNISTD_H
 # include <unistd.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
 #ifdef HAVE_RMALLOC_H
 # include <rmalloc.h>
 #else
@@ -34,12 +37,24 @@
 # define O_BINARY	0
 #endif
 
+/* the number of bytes ahead of the read position the kernel should fetch */
+#define READ_AHEAD	(256*1024)
+
+static void _file_map(_io_t*);
+static void _file_unmap(_io_t*);
+static void _file_check_map(_io_t*);
+static void _file_advise(_io_t*);
+
 int
 _file_open(_io_t *io, UNUSED(_data_t *buf), const char* pathname, UNUSED(const char *path))
 {
    io->fds.fd = open(pathname, io->param[_IO_FILE_FLAGS], io->param[_IO_FILE_MODE]);
    io->timer = _aaxTimerCreate();
 
+   if (io->fds.fd >= 0 && !(io->param[_IO_FILE_FLAGS] & (O_WRONLY|O_RDWR))) {
+      _file_map(io);
+   }
+
    return io->fds.fd;
 }
 
@@ -47,6 +62,9 @@ int
 _file_close(_io_t *io)
 {
    int rv = 0;
+
+   _file_unmap(io);
+
    if (io->fds.fd >= 0)
    {
       close(io->fds.fd);
@@ -65,7 +83,26 @@ _file_read(_io_t *io, _data_t* buf, size_t count)
    void *ptr = _aaxDataGetPtr(buf, 0);
    ssize_t rv = 0;
 
-   if (size)
+   if (size && io->map) {
+      _file_check_map(io);
+   }
+
+   if (size && io->map)
+   {
+      if (io->map_pos < io->map_size)
+      {
+         rv = _MIN(size, io->map_size - io->map_pos);
+         memcpy(ptr, (char*)io->map + io->map_pos, rv);
+         _aaxDataIncreaseOffset(buf, 0, rv);
+
+         io->map_pos += rv;
+         _file_advise(io);
+      }
+      else {
+         rv = __F_EOF;
+      }
+   }
+   else if (size)
    {
       do {
          rv = read(io->fds.fd, ptr, size);
@@ -133,7 +170,19 @@ _file_set(_io_t *io, enum _aaxStreamParam ptype, ssize_t param)
    switch (ptype)
    {
    case __F_POSITION:
-      rv = lseek(io->fds.fd, param, SEEK_SET);
+      if (io->map)
+      {
+         if (param >= 0)
+         {
+            io->map_pos = param;
+            io->map_ahead = param;
+            _file_advise(io);
+            rv = param;
+         }
+      }
+      else {
+         rv = lseek(io->fds.fd, param, SEEK_SET);
+      }
       break;
    case __F_FLAGS:
       io->param[_IO_FILE_FLAGS] = _flags[(param == AAX_MODE_READ) ? 1 : 0];
@@ -164,7 +213,8 @@ _file_get(_io_t *io, enum _aaxStreamParam ptype)
       break;
    }
    case __F_POSITION:
-      rv = lseek(io->fds.fd, 0L, SEEK_CUR);
+      if (io->map) rv = io->map_pos;
+      else rv = lseek(io->fds.fd, 0L, SEEK_CUR);
       break;
    default:
       break;
@@ -178,3 +228,82 @@ _file_name(_io_t *io, enum _aaxStreamParam ptype)
    return NULL;
 }
 
+/*
+ * Regular files opened for reading are memory mapped: reading then is a
+ * copy from the page cache without a system call and seeking only updates
+ * the read position. Files which can not be mapped use read() instead.
+ *
+ * Accessing pages beyond the end of a file which was truncated while
+ * mapped raises SIGBUS, so every read first checks the file size and
+ * switches to read() when it changed. This also picks up files which are
+ * still growing.
+ */
+static void
+_file_map(_io_t *io)
+{
+#ifdef HAVE_SYS_MMAN_H
+   struct stat st;
+
+   if (!fstat(io->fds.fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0)
+   {
+      void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, io->fds.fd, 0);
+      if (map != MAP_FAILED)
+      {
+         io->map = map;
+         io->map_size = st.st_size;
+         io->map_pos = 0;
+         io->map_ahead = 0;
+# ifdef MADV_SEQUENTIAL
+         madvise(map, io->map_size, MADV_SEQUENTIAL);
+# endif
+         _file_advise(io);
+      }
+   }
+#endif
+}
+
+static void
+_file_unmap(_io_t *io)
+{
+#ifdef HAVE_SYS_MMAN_H
+   if (io->map)
+   {
+      munmap(io->map, io->map_size);
+      io->map = NULL;
+   }
+#endif
+}
+
+/* Continue with read() at the same position if the file size changed. */
+static void
+_file_check_map(_io_t *io)
+{
+   struct stat st;
+
+   if (fstat(io->fds.fd, &st) || (size_t)st.st_size != io->map_size)
+   {
+      size_t pos = io->map_pos;
+
+      _file_unmap(io);
+      lseek(io->fds.fd, pos, SEEK_SET);
+   }
+}
+
+/* Ask the kernel to fetch the pages ahead of the read position. */
+static void
+_file_advise(_io_t *io)
+{
+#if defined(HAVE_SYS_MMAN_H) && defined(MADV_WILLNEED)
+   if (io->map_pos >= io->map_ahead && io->map_pos < io->map_size)
+   {
+      size_t page_size = sysconf(_SC_PAGESIZE);
+      size_t start = io->map_pos & ~(page_size-1);
+      size_t end = _MIN(io->map_pos + READ_AHEAD, io->map_size);
+
+      madvise((char*)io->map + start, end - start, MADV_WILLNEED);
+
+      /* advise again when half of the window was read */
+      io->map_ahead = io->map_pos + READ_AHEAD/2;
+   }
+#endif
+}
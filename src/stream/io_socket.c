@@ -14,6 +14,7 @@
 #include <errno.h>
 #include <stdarg.h>
 #include <assert.h>
+#include <time.h>
 #if HAVE_ERROR_H
 # include <error.h>
 #endif
@@ -24,6 +25,9 @@
 # include <rmalloc.h>
 #else
 # include <string.h>
+# if HAVE_STRINGS_H
+#  include <strings.h>
+# endif
 #endif
 #include <stdio.h>
 #if HAVE_SYS_SOCKET_H
@@ -45,9 +49,72 @@
 #include <base/types.h>
 #include <base/timer.h>
 #include <base/dlsym.h>
+#include <base/xthreads.h>
+#include <base/jobpool.h>
 
 #include "io.h"
 
+/* connections kept open for reuse after the response was read completely */
+#define IDLE_SOCKETS_MAX	8
+#define IDLE_TIMEOUT_SEC	15
+
+/* parallel segment prefetch, see AAX_STREAM_HTTP_SEGMENTS */
+#define SEGMENTS_MAX		8
+#define SEGMENT_SIZE		(256*1024)
+#define RESPONSE_SIZE		8192
+
+typedef struct
+{
+   char *server;
+   int port;
+   int protocol;
+   int fd;
+   void *ssl;
+   void *ssl_ctx;
+   time_t since;
+} _socket_idle_t;
+
+typedef struct
+{
+   struct _socket_segments_s *segments;
+   _io_t *io;
+   _data_t *data;
+   size_t start;
+   size_t end;
+   _aaxJobGroup group;
+} _socket_segment_t;
+
+struct _socket_segments_s
+{
+   _aaxJobPool *pool;
+   char *server;
+   char *path;
+   size_t no_bytes;
+
+   atomic_bool cancel;
+   unsigned int no_segments;
+   unsigned int first;	/* the segment which will be read next */
+   size_t next;		/* start position of the next segment to request */
+
+   _socket_segment_t segment[SEGMENTS_MAX];
+};
+typedef struct _socket_segments_s _socket_segments_t;
+
+static int _socket_connect(_io_t*, const char*);
+static int _socket_disconnect(_io_t*);
+static int _socket_request(_io_t*, _data_t*, char**, const char*);
+static int _socket_seek(_io_t*, size_t);
+static bool _socket_idle_get(_io_t*, const char*);
+static bool _socket_idle_put(_io_t*);
+static void _socket_segments_create(_io_t*, unsigned int);
+static void _socket_segments_free(_io_t*);
+static void _socket_segments_start(_socket_segments_t*, size_t);
+static ssize_t _socket_segments_read(_io_t*, _data_t*, size_t);
+
+static _socket_idle_t _socket_idle[IDLE_SOCKETS_MAX];
+static once_flag _socket_idle_once = ONCE_FLAG_INIT;
+static mtx_t _socket_idle_mutex;
+
 DECL_FUNCTION(OPENSSL_init_ssl);
 DECL_FUNCTION(SSL_new);
 DECL_FUNCTION(SSL_free);
@@ -126,119 +193,23 @@ _socket_open(_io_t *io, _data_t *buf, const char *remote, const char *pathname)
       int slen = strlen(remote);
       if (slen < 256)
       {
-         errno = 0;
-         fd = socket(AF_INET, SOCK_STREAM, 0);
-         if (fd >= 0)
-         {
-            struct addrinfo *addr, hints = {0};
-            struct timeval tv;
-            char port_str[16];
-            int status;
-            int on = 1;
-
-            tv.tv_sec = timeout_us / 1000000;
-            tv.tv_usec = timeout_us % 1000000;
-            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof(tv));
-#ifdef SO_NOSIGPIPE
-            setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, (const char*)&on, sizeof(on));
-#endif
-            setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, (const char*)&on,sizeof(on));
-            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (const char*)&size, sizeof(size));
-#if 0
- unsigned int m;
- int n;
-
- printf("timeout_us: %i\n", timeout_us);
- printf("error_max: %i\n", io->error_max);
-
- m = sizeof(n);
- getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &n, &m);
- printf("socket receive buffer size: %u\n", n);
-#endif
-
-            hints.ai_family = AF_UNSPEC;     // don't care IPv4 or IPv6
-            hints.ai_socktype = SOCK_STREAM; // TCP stream sockets
-            hints.ai_flags = AI_PASSIVE;
-            snprintf(port_str, 16, "%i", port);
-            status = getaddrinfo(remote, port_str, &hints, &addr);
-            if (status == 0)
-            {
-               if (connect(fd, addr->ai_addr, addr->ai_addrlen) >= 0)
-               {
-                  io->fds.fd = fd;
-
-                  if (io->protocol == PROTOCOL_HTTPS && pSSL_new)
-                  {
-                     void *method = pTLS_client_method();
-                     io->ssl_ctx = pSSL_CTX_new(method);
-                     if (io->ssl_ctx)
-                     {
-                        io->ssl = pSSL_new(io->ssl_ctx);
-                        if (io->ssl)
-                        {
-                           int err = SSL_ERROR_NONE;
-                           int ctr = 300; // 300msec
-                           pSSL_set_fd(io->ssl, fd);
-                           do {
-                              res = pSSL_connect(io->ssl);
-                              if (res < 0) {
-                                 err = pSSL_get_error(io->ssl, res);
-                                 msecSleep(1);
-                              }
-                           } while (--ctr && (err == SSL_ERROR_WANT_READ ||
-                                              err == SSL_ERROR_WANT_WRITE));
-
-                           if (res <= 0)
-                           {
-                              errno = pSSL_get_error(io->ssl, res);
-                              pSSL_free(io->ssl);
-                              io->ssl = NULL;
-                           }
-                        }
-                     }
-
-                     if (!io->ssl)
-                     {
-                        pSSL_CTX_free(io->ssl_ctx);
-                        closesocket(fd);
-                        fd = -1;
-                     }
-                  }
-                  else if (io->protocol == PROTOCOL_HTTPS)
-                  {
-                     errno = ENOPROTOOPT;
-                     if (fd != -1)
-                     {
-                        closesocket(fd);
-                        fd = -1;
-                     }
-                  }
-               }
-            }
-            else
-            {
-               errno = status;
-               closesocket(fd);
-               fd = -1;
-            }
-         }
-
-         if (fd != -1 && recursive < 5)
+         if (recursive < 5)
          {
-            const char *agent = aaxGetString(AAX_VERSION_STRING);
             char *protname, *server, *extension;
             char *path = (char*)pathname;
             char *s = (char*)remote;
 
-            res = io->prot->connect(io->prot, buf, io, &s, path, agent);
-            if (res == -300)
+            res = _socket_request(io, buf, &s, path);
+            fd = io->fds.fd;
+            if (res == -300 && s)
             {
+               char *location = s; // allocated by the protocol
                _protocol_t protocol;
 
                io->prot = _prot_free(io->prot);
                _socket_close(io);
 
-               protocol = _url_split(s, &protname, &server, &path,
+               protocol = _url_split(location, &protname, &server, &path,
                                         &extension, &port);
 #if 0
  printf("\nredirect name: '%s'\n", remote);
@@ -253,21 +224,24 @@ _socket_open(_io_t *io, _data_t *buf, const char *remote, const char *pathname)
                if (io->prot) { // recursively call _socket_open
                   fd = _socket_open(io, buf, server, path);
                }
+               free(location);
             }
             else if (res < 0)
             {
-               closesocket(fd);
+               _socket_disconnect(io);
                fd = -1;
             }
+            else if (io->prot->seekable)
+            {
+               const char *env = getenv("AAX_STREAM_HTTP_SEGMENTS");
+               if (env && atoi(env) > 0) {
+                  _socket_segments_create(io, _MIN(atoi(env), SEGMENTS_MAX));
+               }
+            }
          }
-         else if (recursive == 5)
+         else
          {
             errno = EMLINK;
-            if (fd != -1)
-            {
-               closesocket(fd);
-               fd = -1;
-            }
          }
       }
       else {
@@ -283,21 +257,24 @@ _socket_open(_io_t *io, _data_t *buf, const char *remote, const char *pathname)
    return fd;
 }
 
+/*
+ * A connection of which the response was read completely is kept open
+ * for the next request to the same server if the server allows it.
+ */
 int
 _socket_close(_io_t *io)
 {
-   int rv;
+   _prot_t *prot = io->prot;
+   int rv = 0;
 
-   if (io->ssl)
+   _socket_segments_free(io);
+
+   if (io->fds.fd < 0 || !prot || !prot->keep_alive ||
+       prot->offset < prot->body_end || !_socket_idle_put(io))
    {
-      pSSL_shutdown(io->ssl);
-      pSSL_free(io->ssl);
-      pSSL_CTX_free(io->ssl_ctx);
-      io->ssl = NULL;
+      rv = _socket_disconnect(io);
    }
 
-   rv = closesocket(io->fds.fd);
-   io->fds.fd = -1;
    return rv;
 }
 
@@ -306,8 +283,23 @@ _socket_read(_io_t *io, _data_t *buf, size_t count)
 {
    size_t size = _MIN(count, _aaxDataGetFreeSpace(buf, 0));
    void *ptr = _aaxDataGetPtr(buf, 0);
+   _prot_t *prot = io->prot;
    ssize_t rv = 0;
 
+   if (io->segments) {
+      return _socket_segments_read(io, buf, size);
+   }
+
+   // do not wait for data beyond the response body
+   if (size && prot && prot->body_end)
+   {
+      if (prot->offset < prot->body_end) {
+         size = _MIN(size, prot->body_end - prot->offset);
+      } else {
+         return __F_EOF;
+      }
+   }
+
    if (size)
    {
       errno = 0;
@@ -342,6 +334,10 @@ _socket_read(_io_t *io, _data_t *buf, size_t count)
             errno = 0;
             rv = recv(io->fds.fd, ptr, size, 0);
          } while (rv < 0 && errno == EINTR);
+
+         if (rv == 0) {
+            rv = __F_EOF; // the server closed the connection
+         }
       }
 
       if (rv >= 0)
@@ -352,8 +348,10 @@ _socket_read(_io_t *io, _data_t *buf, size_t count)
  printf("fill: %8li (%8li)\r", _aaxDataGetDataAvail(buf, 0), _aaxDataGetSize(buf));
 #endif
 
-         if (io->prot) {
-            rv = io->prot->process(io->prot, buf);
+         if (prot)
+         {
+            if (prot->body_end) prot->offset += rv;
+            rv = prot->process(prot, buf);
          }
       }
       else if (errno == EAGAIN || errno == EWOULDBLOCK)
@@ -449,7 +447,11 @@ _socket_set(_io_t *io, enum _aaxStreamParam ptype, ssize_t param)
       rv = 0;
       break;
    case __F_POSITION:
-      rv = 0;
+      if (io->prot && io->prot->seekable) {
+         rv = _socket_seek(io, param);
+      } else {
+         rv = 0;
+      }
       break;
    default:
       break;
@@ -464,7 +466,11 @@ _socket_get(UNUSED(_io_t *io), enum _aaxStreamParam ptype)
    switch (ptype)
    {
    case __F_POSITION:
-      rv = -1;
+      if (io->prot && io->prot->seekable) {
+         rv = io->prot->offset;
+      } else {
+         rv = -1;
+      }
       break;
    case __F_NO_BYTES:
       break;
@@ -486,3 +492,574 @@ _socket_name(_io_t *io, enum _aaxStreamParam ptype)
    }
    return rv;
 }
+
+/* -------------------------------------------------------------------------- */
+
+static int
+_socket_connect(_io_t *io, const char *remote)
+{
+   int size = io->param[_IO_SOCKET_SIZE];
+   int port = io->param[_IO_SOCKET_PORT];
+   int timeout_us = io->param[_IO_SOCKET_TIMEOUT];
+   int res, fd;
+
+   if (timeout_us < 5000) {
+      timeout_us = 5000;
+   }
+
+   errno = 0;
+   fd = socket(AF_INET, SOCK_STREAM, 0);
+   if (fd >= 0)
+   {
+      struct addrinfo *addr, hints = {0};
+      struct timeval tv;
+      char port_str[16];
+      int status;
+      int on = 1;
+
+      tv.tv_sec = timeout_us / 1000000;
+      tv.tv_usec = timeout_us % 1000000;
+      setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof(tv));
+#ifdef SO_NOSIGPIPE
+      setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, (const char*)&on, sizeof(on));
+#endif
+      setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, (const char*)&on,sizeof(on));
+      setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (const char*)&size, sizeof(size));
+#if 0
+ unsigned int m;
+ int n;
+
+ printf("timeout_us: %i\n", timeout_us);
+ printf("error_max: %i\n", io->error_max);
+
+ m = sizeof(n);
+ getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &n, &m);
+ printf("socket receive buffer size: %u\n", n);
+#endif
+
+      hints.ai_family = AF_UNSPEC;     // don't care IPv4 or IPv6
+      hints.ai_socktype = SOCK_STREAM; // TCP stream sockets
+      hints.ai_flags = AI_PASSIVE;
+      snprintf(port_str, 16, "%i", port);
+      status = getaddrinfo(remote, port_str, &hints, &addr);
+      if (status == 0)
+      {
+         res = connect(fd, addr->ai_addr, addr->ai_addrlen);
+         freeaddrinfo(addr);
+
+         if (res >= 0)
+         {
+            io->fds.fd = fd;
+
+            if (io->protocol == PROTOCOL_HTTPS && pSSL_new)
+            {
+               void *method = pTLS_client_method();
+               io->ssl_ctx = pSSL_CTX_new(method);
+               if (io->ssl_ctx)
+               {
+                  io->ssl = pSSL_new(io->ssl_ctx);
+                  if (io->ssl)
+                  {
+                     int err = SSL_ERROR_NONE;
+                     int ctr = 300; // 300msec
+                     pSSL_set_fd(io->ssl, fd);
+                     do {
+                        res = pSSL_connect(io->ssl);
+                        if (res < 0) {
+                           err = pSSL_get_error(io->ssl, res);
+                           msecSleep(1);
+                        }
+                     } while (--ctr && (err == SSL_ERROR_WANT_READ ||
+                                        err == SSL_ERROR_WANT_WRITE));
+
+                     if (res <= 0)
+                     {
+                        errno = pSSL_get_error(io->ssl, res);
+                        pSSL_free(io->ssl);
+                        io->ssl = NULL;
+                     }
+                  }
+               }
+
+               if (!io->ssl)
+               {
+                  pSSL_CTX_free(io->ssl_ctx);
+                  io->ssl_ctx = NULL;
+                  closesocket(fd);
+                  fd = -1;
+               }
+            }
+            else if (io->protocol == PROTOCOL_HTTPS)
+            {
+               errno = ENOPROTOOPT;
+               closesocket(fd);
+               fd = -1;
+            }
+         }
+         else
+         {
+            closesocket(fd);
+            fd = -1;
+         }
+      }
+      else
+      {
+         errno = status;
+         closesocket(fd);
+         fd = -1;
+      }
+   }
+   io->fds.fd = fd;
+
+   return fd;
+}
+
+static int
+_socket_disconnect(_io_t *io)
+{
+   int rv = 0;
+
+   if (io->ssl)
+   {
+      pSSL_shutdown(io->ssl);
+      pSSL_free(io->ssl);
+      pSSL_CTX_free(io->ssl_ctx);
+      io->ssl = NULL;
+      io->ssl_ctx = NULL;
+   }
+
+   if (io->fds.fd >= 0) {
+      rv = closesocket(io->fds.fd);
+   }
+   io->fds.fd = -1;
+
+   return rv;
+}
+
+/*
+ * Send the request over an idle connection to the same server if there is
+ * one, or over a new connection otherwise. An idle connection which was
+ * closed by the server in the meantime is replaced by a new connection.
+ *
+ * Returns the result of the protocol connect function, *remote is updated
+ * on a redirect.
+ */
+static int
+_socket_request(_io_t *io, _data_t *buf, char **remote, const char *path)
+{
+   const char *agent = aaxGetString(AAX_VERSION_STRING);
+   const char *server = *remote;
+   int rv = __F_EOF;
+   bool reused;
+
+   reused = _socket_idle_get(io, server);
+   if (reused || _socket_connect(io, server) >= 0)
+   {
+      rv = io->prot->connect(io->prot, buf, io, remote, path, agent);
+      if (rv == __F_EOF && reused)
+      {
+         _socket_disconnect(io);
+         _aaxDataClear(buf, 0);
+         if (_socket_connect(io, server) >= 0) {
+            rv = io->prot->connect(io->prot, buf, io, remote, path, agent);
+         }
+      }
+   }
+
+   if (rv >= 0 && io->server != server)
+   {
+      free(io->server);
+      io->server = strdup(server);
+      free(io->path);
+      io->path = strdup(path);
+   }
+
+   return rv;
+}
+
+/*
+ * Continue reading at byte position pos using a range request.
+ * A server which ignores the range sends the resource from the start, the
+ * data up to pos is skipped in that case.
+ */
+static int
+_socket_seek(_io_t *io, size_t pos)
+{
+   _prot_t *prot = io->prot;
+   int rv = -1;
+
+   if (pos > prot->no_bytes || !io->server) {
+      errno = EINVAL;
+   }
+   else if (io->segments)
+   {
+      _socket_segments_start(io->segments, pos);
+      prot->offset = pos;
+      rv = pos;
+   }
+   else if (pos == prot->offset && io->fds.fd >= 0) {
+      rv = pos;
+   }
+   else
+   {
+      _data_t *buf = _aaxDataCreate(1, RESPONSE_SIZE, 1);
+      if (buf)
+      {
+         char *server = io->server;
+         int res = 0;
+
+         _socket_close(io);
+         prot->offset = pos;
+         prot->range_end = 0;
+         if (pos < prot->no_bytes) {
+            res = _socket_request(io, buf, &server, io->path);
+         }
+         if (server != io->server) {
+            free(server); // redirected
+         }
+
+         while (res >= 0 && prot->offset < pos)
+         {
+            _aaxDataClear(buf, 0);
+            res = _socket_read(io, buf, pos - prot->offset);
+         }
+
+         if (res >= 0 && prot->offset == pos) {
+            rv = pos;
+         }
+         _aaxDataDestroy(buf);
+      }
+   }
+
+   return rv;
+}
+
+static void
+_socket_idle_init(void)
+{
+   mtx_init(&_socket_idle_mutex, mtx_plain);
+}
+
+/* Take an idle connection to the server of io, if there is one. */
+static bool
+_socket_idle_get(_io_t *io, const char *server)
+{
+   int port = io->param[_IO_SOCKET_PORT];
+   time_t now = time(NULL);
+   bool rv = false;
+   int i;
+
+   call_once(&_socket_idle_once, _socket_idle_init);
+
+   mtx_lock(&_socket_idle_mutex);
+   for (i=0; i<IDLE_SOCKETS_MAX; ++i)
+   {
+      _socket_idle_t *idle = &_socket_idle[i];
+      bool expired, take;
+      _io_t conn;
+
+      if (!idle->server) continue;
+
+      expired = (now - idle->since > IDLE_TIMEOUT_SEC);
+      take = (!rv && !expired && idle->port == port &&
+              idle->protocol == io->protocol &&
+              !strcasecmp(idle->server, server));
+      if (!take && !expired) continue;
+
+      conn.fds.fd = idle->fd;
+      conn.fds.events = POLLIN;
+      conn.ssl = idle->ssl;
+      conn.ssl_ctx = idle->ssl_ctx;
+#if HAVE_POLL_H
+      // a connection closed by the server reports end-of-file
+      if (take && poll(&conn.fds, 1, 0) != 0) {
+         take = false;
+      }
+#endif
+      if (take)
+      {
+         io->fds.fd = conn.fds.fd;
+         io->ssl = conn.ssl;
+         io->ssl_ctx = conn.ssl_ctx;
+         rv = true;
+      }
+      else {
+         _socket_disconnect(&conn);
+      }
+
+      free(idle->server);
+      idle->server = NULL;
+   }
+   mtx_unlock(&_socket_idle_mutex);
+
+   return rv;
+}
+
+/* Keep the connection of io open for reuse, replaces the oldest one. */
+static bool
+_socket_idle_put(_io_t *io)
+{
+   _socket_idle_t *idle = &_socket_idle[0];
+   bool rv = false;
+   int i;
+
+   call_once(&_socket_idle_once, _socket_idle_init);
+
+   mtx_lock(&_socket_idle_mutex);
+   for (i=0; i<IDLE_SOCKETS_MAX; ++i)
+   {
+      if (!_socket_idle[i].server)
+      {
+         idle = &_socket_idle[i];
+         break;
+      }
+      if (_socket_idle[i].since < idle->since) {
+         idle = &_socket_idle[i];
+      }
+   }
+
+   if (idle->server)
+   {
+      _io_t conn;
+
+      conn.fds.fd = idle->fd;
+      conn.ssl = idle->ssl;
+      conn.ssl_ctx = idle->ssl_ctx;
+      _socket_disconnect(&conn);
+      free(idle->server);
+   }
+
+   idle->server = strdup(io->server);
+   if (idle->server)
+   {
+      idle->port = io->param[_IO_SOCKET_PORT];
+      idle->protocol = io->protocol;
+      idle->fd = io->fds.fd;
+      idle->ssl = io->ssl;
+      idle->ssl_ctx = io->ssl_ctx;
+      idle->since = time(NULL);
+
+      io->fds.fd = -1;
+      io->ssl = NULL;
+      io->ssl_ctx = NULL;
+      rv = true;
+   }
+   mtx_unlock(&_socket_idle_mutex);
+
+   return rv;
+}
+
+/*
+ * Parallel segment prefetch for seekable resources:
+ * The resource is requested in consecutive byte ranges of SEGMENT_SIZE,
+ * each segment over its own connection. Up to no_segments segments are
+ * downloaded at the same time by a pool of worker threads and are read
+ * back in order.
+ */
+static int
+_socket_segment_fetch(void *id)
+{
+   _socket_segment_t *seg = (_socket_segment_t*)id;
+   _socket_segments_t *segments = seg->segments;
+   size_t len = seg->end - seg->start;
+   _io_t *io = seg->io;
+   ssize_t res = __F_EOF;
+
+   if (!atomic_load(&segments->cancel))
+   {
+      char *server = segments->server;
+
+      io->prot->offset = seg->start;
+      io->prot->range_end = seg->end;
+      res = _socket_request(io, seg->data, &server, segments->path);
+      if (server != segments->server) {
+         free(server); // redirected
+      }
+      if (res >= 0 && io->prot->offset != seg->start) {
+         res = __F_EOF;
+      }
+   }
+
+   while (res >= 0 && !atomic_load(&segments->cancel))
+   {
+      size_t avail = _aaxDataGetDataAvail(seg->data, 0);
+      if (avail == len) break;
+
+      res = _socket_read(io, seg->data, len - avail);
+   }
+   _socket_close(io);
+
+   return (_aaxDataGetDataAvail(seg->data, 0) == len);
+}
+
+static void
+_socket_segment_queue(_socket_segments_t *segments, _socket_segment_t *seg)
+{
+   seg->start = segments->next;
+   seg->end = _MIN(seg->start + SEGMENT_SIZE, segments->no_bytes);
+
+   _aaxDataClear(seg->data, 0);
+   _aaxJobGroupInit(&seg->group);
+   if (seg->start < seg->end)
+   {
+      segments->next = seg->end;
+      _aaxJobPoolAdd(segments->pool, &seg->group, _socket_segment_fetch, seg);
+   }
+}
+
+/* Drop all segments and start requesting again at byte position pos. */
+static void
+_socket_segments_start(_socket_segments_t *segments, size_t pos)
+{
+   unsigned int i;
+
+   atomic_store(&segments->cancel, true);
+   for (i=0; i<segments->no_segments; ++i) {
+      _aaxJobPoolWait(segments->pool, &segments->segment[i].group);
+   }
+   atomic_store(&segments->cancel, false);
+
+   segments->first = 0;
+   segments->next = pos;
+   for (i=0; i<segments->no_segments; ++i) {
+      _socket_segment_queue(segments, &segments->segment[i]);
+   }
+}
+
+static void
+_socket_segments_create(_io_t *io, unsigned int no_segments)
+{
+   _socket_segments_t *segments;
+
+   segments = calloc(1, sizeof(_socket_segments_t));
+   if (segments)
+   {
+      unsigned int i;
+
+      segments->pool = _aaxJobPoolCreate(no_segments, "aaxHTTPSegments");
+      segments->server = io->server;
+      segments->path = io->path;
+      segments->no_bytes = io->prot->no_bytes;
+      atomic_init(&segments->cancel, false);
+
+      for (i=0; i<no_segments; ++i)
+      {
+         _socket_segment_t *seg = &segments->segment[i];
+
+         seg->segments = segments;
+         seg->data = _aaxDataCreate(1, SEGMENT_SIZE+RESPONSE_SIZE, 1);
+         seg->io = _io_create(io->protocol);
+         if (!seg->data || !seg->io) break;
+
+         memcpy(seg->io->param, io->param, sizeof(io->param));
+         seg->io->error_max = io->error_max;
+         _aaxJobGroupInit(&seg->group);
+      }
+      segments->no_segments = i;
+
+      if (segments->pool && segments->no_segments == no_segments)
+      {
+         // the segments take over from the first request, its connection
+         // is left unread until the stream is closed and never reused
+         io->prot->keep_alive = false;
+         io->segments = segments;
+         _socket_segments_start(segments, io->prot->offset);
+      }
+      else
+      {
+         io->segments = segments;
+         _socket_segments_free(io);
+      }
+   }
+}
+
+static void
+_socket_segments_free(_io_t *io)
+{
+   _socket_segments_t *segments = io->segments;
+
+   if (segments)
+   {
+      unsigned int i;
+
+      io->segments = NULL;
+      if (segments->pool)
+      {
+         atomic_store(&segments->cancel, true);
+         for (i=0; i<segments->no_segments; ++i) {
+            _aaxJobPoolWait(segments->pool, &segments->segment[i].group);
+         }
+         _aaxJobPoolDestroy(segments->pool);
+      }
+
+      for (i=0; i<SEGMENTS_MAX; ++i)
+      {
+         _socket_segment_t *seg = &segments->segment[i];
+         if (seg->data) _aaxDataDestroy(seg->data);
+         if (seg->io)
+         {
+            _socket_close(seg->io);
+            _io_free(seg->io);
+         }
+      }
+      free(segments);
+   }
+}
+
+/*
+ * Read from the segment at the current position. Wait for it only if
+ * buf ran dry, there is nothing else to play in that case. Only the fetch
+ * of this segment may run on the reading thread, downloading a later
+ * segment here would delay the data which is needed first.
+ * A segment which failed to download switches back to a single connection.
+ */
+static ssize_t
+_socket_segments_read(_io_t *io, _data_t *buf, size_t size)
+{
+   _socket_segments_t *segments = io->segments;
+   _socket_segment_t *seg = &segments->segment[segments->first];
+   _prot_t *prot = io->prot;
+   ssize_t rv = 0;
+
+   if (prot->offset >= prot->no_bytes) {
+      rv = __F_EOF;
+   }
+   else if (size)
+   {
+      if (!_aaxDataGetDataAvail(buf, 0) ||
+          !_aaxJobPoolBusy(segments->pool, &seg->group))
+      {
+         bool complete = _aaxJobPoolWaitOwn(segments->pool, &seg->group);
+         size_t avail = _aaxDataGetDataAvail(seg->data, 0);
+
+         if (complete)
+         {
+            void *ptr = _aaxDataGetPtr(buf, 0);
+
+            size = _aaxDataMove(seg->data, 0, ptr, _MIN(size, avail));
+            _aaxDataIncreaseOffset(buf, 0, size);
+            prot->offset += size;
+
+            if (size == avail)
+            {
+               _socket_segment_queue(segments, seg);
+               segments->first = (segments->first+1) % segments->no_segments;
+            }
+            rv = _aaxDataGetDataAvail(buf, 0);
+         }
+         else
+         {
+            size_t pos = prot->offset;
+
+            _AAX_SYSLOG("HTTP: segment prefetch failed");
+            _socket_segments_free(io);
+
+            // the first connection was never read, reconnect at pos
+            _socket_disconnect(io);
+            rv = (_socket_seek(io, pos) >= 0) ? 0 : __F_EOF;
+         }
+      }
+   }
+
+   return rv;
+}
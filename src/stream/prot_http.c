@@ -38,41 +38,82 @@
 #endif
 
 #define INCLUDE_ICY	0
-#define MAX_HEADER	512
+#define MAX_HEADER	1024
 #define STREAMTITLE	"StreamTitle='"
 #define HEADERLEN	strlen(STREAMTITLE)
 
-static int _http_send_request(_io_t*, const char*, const char*, const char*, const char*);
+static int _http_send_request(_io_t*, const char*, const char*, const char*, const char*, size_t, size_t);
 static int _http_get_response(_io_t*, _data_t*, int*);
-static const char *_get_yaml(_data_t*, const char*);
+static const char *_get_yaml(_data_t*, const char*, char*, size_t);
 
 
 ssize_t
 _http_connect(_prot_t *prot, _data_t *buf, _io_t *io, char **server, const char *path, const char *agent)
 {
-   int res = _http_send_request(io, "GET", *server, path, agent);
+   int res;
 
+   prot->body_end = 0;
+   prot->keep_alive = false;
+   res = _http_send_request(io, "GET", *server, path, agent,
+                            prot->offset, prot->range_end);
    if (res > 0)
    {
       int size = _http_get_response(io, buf, &res);
       if (res >= 200 && res < 300)
       {
+         bool partial = (res == 206);
+         unsigned long first, last, total;
+         char value[MAX_HEADER];
+         size_t length = 0;
          const char *s;
 
-         s = _get_yaml(buf, "content-length");
+         s = _get_yaml(buf, "content-length", value, sizeof(value));
          if (s)
          {
-            prot->no_bytes = strtol(s, NULL, 10);
-            res = prot->no_bytes;
+            length = strtol(s, NULL, 10);
+            res = length;
          }
 
-         s = _get_yaml(buf, "content-type");
-         if (s) {
+         // Content-Range: bytes <first>-<last>/<total>
+         s = NULL;
+         if (partial) {
+            s = _get_yaml(buf, "content-range", value, sizeof(value));
+         }
+         if (s && sscanf(s, "bytes %lu-%lu/%lu", &first, &last, &total) == 3)
+         {
+            prot->offset = first;
+            prot->body_end = last+1;
+            prot->no_bytes = total;
+            prot->seekable = true;
+         }
+         else if (partial) {
+            prot->body_end = length ? prot->offset + length : 0;
+         }
+         else
+         {
+            prot->offset = 0;
+            prot->body_end = length;
+            prot->no_bytes = length;
+
+            s = _get_yaml(buf, "accept-ranges", value, sizeof(value));
+            prot->seekable = (s && !strncasecmp(s, "bytes", 5));
+         }
+
+         s = _get_yaml(buf, "connection", value, sizeof(value));
+         if (s && !strncasecmp(s, "keep-alive", 10)) {
+            prot->keep_alive = (prot->body_end > 0);
+         }
+
+         s = _get_yaml(buf, "content-type", value, sizeof(value));
+         if (s && prot->meta.comments) {
+            s = NULL; // reconnected after a seek
+         }
+         else if (s) {
             prot->meta.comments = strdup(s);
          }
          if (s && _http_get(prot, __F_EXTENSION) != _EXT_NONE)
          {
-            s = _get_yaml(buf, "icy-name");
+            s = _get_yaml(buf, "icy-name", value, sizeof(value));
             if (s)
             {
                prot->meta.artist_changed = true;
@@ -80,7 +121,7 @@ _http_connect(_prot_t *prot, _data_t *buf, _io_t *io, char **server, const char
                prot->meta.composer = strdup(s);
             }
 
-            s = _get_yaml(buf, "icy-description");
+            s = _get_yaml(buf, "icy-description", value, sizeof(value));
             if (s)
             {
                prot->meta.title_changed = true;
@@ -88,13 +129,13 @@ _http_connect(_prot_t *prot, _data_t *buf, _io_t *io, char **server, const char
                prot->meta.album = strdup(s);
             }
 
-            s = _get_yaml(buf, "icy-genre");
+            s = _get_yaml(buf, "icy-genre", value, sizeof(value));
             if (s) prot->meta.genre = strdup(s);
 
-            s = _get_yaml(buf, "icy-url");
+            s = _get_yaml(buf, "icy-url", value, sizeof(value));
             if (s) prot->meta.website = strdup(s);
 
-            s = _get_yaml(buf, "icy-metaint");
+            s = _get_yaml(buf, "icy-metaint", value, sizeof(value));
             if (s)
             {
                errno = 0;
@@ -105,13 +146,23 @@ _http_connect(_prot_t *prot, _data_t *buf, _io_t *io, char **server, const char
                }
             }
          }
+
+         // byte positions of the body are unknown with inline meta data
+         if (prot->meta_interval || !prot->no_bytes) {
+            prot->seekable = false;
+         }
       }
       else
       {
-         res = -res;
+         res = res ? -res : __F_EOF;
          if (res <= -300 && res >= -400) // Moved
          {
-            *server = (char*)_get_yaml(buf, "Location");
+            char value[MAX_HEADER];
+            const char *s;
+
+            // the caller frees the new location
+            s = _get_yaml(buf, "Location", value, sizeof(value));
+            *server = s ? strdup(s) : NULL;
             errno = EREMCHG;
             res = -300;
          }
@@ -142,7 +193,7 @@ _http_connect(_prot_t *prot, _data_t *buf, _io_t *io, char **server, const char
       _aaxDataMove(buf, 0, NULL, size);
    }
    else {
-      res = -res;
+      res = __F_EOF;
    }
 
    return res;
@@ -451,24 +502,36 @@ _http_get_response_data(_io_t *io, _data_t *databuf)
    return i;
 }
 
+/*
+ * from and to are byte positions of the requested range where to is the
+ * position after the last byte. Both zero requests the whole resource.
+ */
 int
-_http_send_request(_io_t *io, const char *command, const char *server, const char *path, const char *user_agent)
+_http_send_request(_io_t *io, const char *command, const char *server, const char *path, const char *user_agent, size_t from, size_t to)
 {
    _data_t *buf = _aaxDataCreate(1, MAX_HEADER, 0);
    char *header = _aaxDataGetData(buf, 0);
+   char range[64] = "";
    int hlen, rv = 0;
 
+   if (to > from) {
+      snprintf(range, 64, "Range: bytes=%zu-%zu\r\n", from, to-1);
+   } else if (from) {
+      snprintf(range, 64, "Range: bytes=%zu-\r\n", from);
+   }
+
    snprintf(header, MAX_HEADER+1,
             "%s /%.256s HTTP/1.0\r\n"
             "User-Agent: %s\r\n"
             "Accept: */*\r\n"
             "Host: %s\r\n"
+            "%s"
             "Connection: Keep-Alive\r\n"
 #if INCLUDE_ICY
             "Icy-MetaData:1\r\n"
 #endif
             "\r\n",
-            command, path, user_agent, server);
+            command, path, user_agent, server, range);
 
    hlen = strlen(header);
    _aaxDataIncreaseOffset(buf, 0, hlen);
@@ -496,7 +559,7 @@ _http_get_response(_io_t *io, _data_t *buf, int *code)
       res = sscanf(ptr, "HTTP/1.%*d %03d", code);
       if (res != 1)
       {
-         res =  sscanf(ptr, "ICY %03d", (int*)&rv);
+         res =  sscanf(ptr, "ICY %03d", code);
          if (res != 1) {
             rv = __F_EOF;
          }
@@ -505,12 +568,15 @@ _http_get_response(_io_t *io, _data_t *buf, int *code)
    return rv;
 }
 
+/*
+ * Copy the value of the header field needle into buf, which is size bytes.
+ * Returns buf or NULL if the field was not found.
+ */
 static const char*
-_get_yaml(_data_t *databuf, const char *needle)
+_get_yaml(_data_t *databuf, const char *needle, char *buf, size_t size)
 {
    size_t haystacklen = _aaxDataGetSize(databuf);
    const char *haystack = _aaxDataGetData(databuf, 0);
-   static char buf[1024];
    char *start, *end;
    size_t pos;
 
@@ -537,8 +603,8 @@ _get_yaml(_data_t *databuf, const char *needle)
             end++;
          }
 
-         if ((end-start) > 1024) {
-            end = start + 1024;
+         if ((size_t)(end-start) >= size) {
+            end = start + size-1;
          }
          memcpy(buf, start, (end-start));
          buf[end-start] = '\0';
@@ -55,6 +55,13 @@ struct _prot_st
    size_t meta_interval;
    size_t meta_offset;
 
+   /* byte positions, relative to the start of the resource */
+   size_t offset;	/* position of the next byte which will be read */
+   size_t body_end;	/* end of the current response body, 0 if unknown */
+   size_t range_end;	/* request up to this position, 0 for all */
+   bool seekable;	/* the server accepts byte range requests */
+   bool keep_alive;	/* the connection may be reused after the body */
+
    bool metadata_changed;
    struct _meta_t meta;
 };
@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <assert.h>
+#ifdef HAVE_RMALLOC_H
+# include <rmalloc.h>
+#else
+# include <stdlib.h>
+#endif
+
+#include "seekindex.h"
+
+#define SEEK_INDEX_STEP		256
+
+_seek_index_t*
+_seek_index_create(uint64_t distance)
+{
+   _seek_index_t *rv = calloc(1, sizeof(_seek_index_t));
+   if (rv) {
+      rv->distance = distance;
+   }
+   return rv;
+}
+
+void*
+_seek_index_free(_seek_index_t *index)
+{
+   if (index)
+   {
+      free(index->point);
+      free(index);
+   }
+   return NULL;
+}
+
+/*
+ * Entries which do not advance the sample and byte positions are ignored,
+ * this allows adding entries again when the stream is read a second time.
+ */
+bool
+_seek_index_add(_seek_index_t *index, uint64_t sample, uint64_t offset)
+{
+   _seek_point_t *last;
+
+   assert(index);
+
+   last = index->no_points ? &index->point[index->no_points-1] : NULL;
+   if (last && (sample <= last->sample || offset <= last->offset ||
+                sample - last->sample < index->distance)) {
+      return false;
+   }
+
+   if (index->no_points == index->max_points)
+   {
+      size_t max = index->max_points + SEEK_INDEX_STEP;
+      _seek_point_t *ptr = realloc(index->point, max*sizeof(_seek_point_t));
+      if (!ptr) return false;
+
+      index->point = ptr;
+      index->max_points = max;
+   }
+
+   index->point[index->no_points].sample = sample;
+   index->point[index->no_points].offset = offset;
+   index->no_points++;
+
+   return true;
+}
+
+/*
+ * Find the last entry which starts at or before the requested sample
+ * position. For positions beyond the indexed part of the stream this is
+ * the last entry, decoding has to continue from there.
+ */
+bool
+_seek_index_find(const _seek_index_t *index, uint64_t sample, _seek_point_t *point)
+{
+   size_t lo, hi;
+
+   assert(index);
+   assert(point);
+
+   if (!index->no_points || sample < index->point[0].sample) {
+      return false;
+   }
+
+   lo = 0;
+   hi = index->no_points;
+   while (hi - lo > 1)
+   {
+      size_t mid = lo + (hi - lo)/2;
+      if (index->point[mid].sample <= sample) lo = mid;
+      else hi = mid;
+   }
+   *point = index->point[lo];
+
+   return true;
+}
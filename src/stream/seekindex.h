@@ -0,0 +1,53 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave Audio eXtentions library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#ifndef _AAX_SEEKINDEX_H
+#define _AAX_SEEKINDEX_H 1
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Maps sample positions to the byte offset of the page or frame which
+ * starts at that sample position. Entries are added in stream order while
+ * the stream is read for the first time.
+ */
+typedef struct
+{
+   uint64_t sample;
+   uint64_t offset;
+} _seek_point_t;
+
+typedef struct
+{
+   uint64_t distance;	/* minimum no. samples between two entries */
+   size_t no_points;
+   size_t max_points;
+   _seek_point_t *point;
+} _seek_index_t;
+
+_seek_index_t* _seek_index_create(uint64_t);
+void* _seek_index_free(_seek_index_t*);
+
+bool _seek_index_add(_seek_index_t*, uint64_t, uint64_t);
+bool _seek_index_find(const _seek_index_t*, uint64_t, _seek_point_t*);
+
+#if defined(__cplusplus)
+}  /* extern "C" */
+#endif
+
+#endif /* !_AAX_SEEKINDEX_H */
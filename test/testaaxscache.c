@@ -0,0 +1,454 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <aax/aax.h>
+
+#include <base/timer.h>
+#include <api.h>
+
+#define DEVNAME			"None"
+
+/*
+ * Rendered AAXS buffers are cached on disk in $HOME/.aax/cache.
+ * Only the base level is rendered when the buffer is created, the other
+ * mip levels are rendered on first use and added to the cache file.
+ */
+static const char *aaxs =
+ "<?xml version=\"1.0\"?>"
+ "<aeonwave>"
+ " <sound frequency=\"220\" duration=\"0.5\">"
+ "  <waveform src=\"sine\"/>"
+ " </sound>"
+ "</aeonwave>";
+
+static const char *other_aaxs =
+ "<?xml version=\"1.0\"?>"
+ "<aeonwave>"
+ " <sound frequency=\"440\" duration=\"0.5\">"
+ "  <waveform src=\"square\"/>"
+ " </sound>"
+ "</aeonwave>";
+
+static char home[] = "/tmp/testaaxscacheXXXXXX";
+
+static aaxBuffer
+create_from(aaxConfig config, const char *aaxs)
+{
+   aaxBuffer buffer = aaxBufferCreate(config, 1, 1, AAX_AAXS24S);
+   if (buffer && !aaxBufferSetData(buffer, aaxs))
+   {
+      aaxBufferDestroy(buffer);
+      buffer = NULL;
+   }
+   return buffer;
+}
+
+static aaxBuffer
+create(aaxConfig config) {
+   return create_from(config, aaxs);
+}
+
+/* request a mip level and return the level which is available right now */
+static int
+level(aaxBuffer buffer, int mip)
+{
+   _aaxRingBuffer *rb = _bufGetMipLevel((_buffer_t*)buffer, &mip);
+   return rb ? mip : -1;
+}
+
+/* wait until a requested mip level was rendered */
+static int
+wait_level(aaxBuffer buffer, int mip)
+{
+   int i, rv = -1;
+   for (i=0; i<500 && rv != mip; ++i)
+   {
+      rv = level(buffer, mip);
+      if (rv != mip) msecSleep(10);
+   }
+   return rv;
+}
+
+static void
+clear_cache(void)
+{
+   char path[256];
+   DIR *dir;
+
+   snprintf(path, sizeof(path), "%s/.aax/cache", home);
+   dir = opendir(path);
+   if (dir)
+   {
+      struct dirent *entry;
+      while ((entry = readdir(dir)) != NULL)
+      {
+         char file[512];
+         if (entry->d_name[0] == '.') continue;
+         snprintf(file, sizeof(file), "%s/%s", path, entry->d_name);
+         unlink(file);
+      }
+      closedir(dir);
+   }
+}
+
+static void
+cleanup(void)
+{
+   char path[256];
+
+   clear_cache();
+   snprintf(path, sizeof(path), "%s/.aax/cache", home);
+   rmdir(path);
+   snprintf(path, sizeof(path), "%s/.aax", home);
+   rmdir(path);
+   rmdir(home);
+}
+
+/* the name of the only cache file, returns the number of cache files */
+static int
+cache_file(char *file, size_t len)
+{
+   char path[256];
+   int rv = 0;
+   DIR *dir;
+
+   snprintf(path, sizeof(path), "%s/.aax/cache", home);
+   dir = opendir(path);
+   if (dir)
+   {
+      struct dirent *entry;
+      while ((entry = readdir(dir)) != NULL)
+      {
+         if (entry->d_name[0] == '.') continue;
+         snprintf(file, len, "%s/%s", path, entry->d_name);
+         rv++;
+      }
+      closedir(dir);
+   }
+   return rv;
+}
+
+/* a cache file is replaced, not changed, when the buffer is rendered */
+static ino_t
+inode(const char *file)
+{
+   struct stat st;
+   return stat(file, &st) ? 0 : st.st_ino;
+}
+
+static void*
+read_file(const char *file, size_t *size)
+{
+   FILE *fp = fopen(file, "rb");
+   void *rv = NULL;
+
+   if (fp)
+   {
+      fseek(fp, 0, SEEK_END);
+      *size = ftell(fp);
+      fseek(fp, 0, SEEK_SET);
+      rv = malloc(*size);
+      if (rv && fread(rv, *size, 1, fp) != 1)
+      {
+         free(rv);
+         rv = NULL;
+      }
+      fclose(fp);
+   }
+   return rv;
+}
+
+/* overwrite the file in place so it keeps its inode */
+static void
+write_file(const char *file, size_t offs, const void *data, size_t size)
+{
+   FILE *fp = fopen(file, "r+b");
+   if (fp)
+   {
+      fseek(fp, offs, SEEK_SET);
+      fwrite(data, size, 1, fp);
+      fclose(fp);
+   }
+}
+
+/* compare the base level of two buffers */
+static int
+compare(aaxBuffer buffer, aaxBuffer reference)
+{
+   _aaxRingBuffer *rb = ((_buffer_t*)buffer)->ringbuffer[0];
+   _aaxRingBuffer *ref = ((_buffer_t*)reference)->ringbuffer[0];
+   size_t no_samples;
+   int32_t **t1, **t2;
+   int rv = -1;
+
+   no_samples = ref->get_parami(ref, RB_NO_SAMPLES);
+   if (rb->get_parami(rb, RB_NO_SAMPLES) == no_samples)
+   {
+      t1 = (int32_t**)rb->get_tracks_ptr(rb, RB_READ);
+      t2 = (int32_t**)ref->get_tracks_ptr(ref, RB_READ);
+      if (!memcmp(t1[0], t2[0], no_samples*sizeof(int32_t))) rv = 0;
+      rb->release_tracks_ptr(rb);
+      ref->release_tracks_ptr(ref);
+   }
+   return rv;
+}
+
+/* create a buffer and test if the cache file was used or replaced */
+static int
+reload(aaxConfig config, aaxBuffer reference, const char *name, bool cached)
+{
+   char file[512];
+   aaxBuffer buffer;
+   ino_t ino = 0;
+   int rv = -1;
+
+   if (cache_file(file, sizeof(file)) == 1) ino = inode(file);
+
+   buffer = create(config);
+   if (!buffer) {
+      printf("%s: the buffer could not be created\n", name);
+   }
+   else if (compare(buffer, reference)) {
+      printf("%s: the samples differ from the rendered buffer\n", name);
+   }
+   else if (cache_file(file, sizeof(file)) != 1) {
+      printf("%s: there is no cache file\n", name);
+   }
+   else if (cached && inode(file) != ino) {
+      printf("%s: the buffer was rendered instead of read\n", name);
+   }
+   else if (!cached && inode(file) == ino) {
+      printf("%s: the cache file was used\n", name);
+   }
+   else {
+      rv = 0;
+   }
+   if (buffer) aaxBufferDestroy(buffer);
+
+   return rv;
+}
+
+static int
+test_cache(aaxConfig config)
+{
+   aaxBuffer reference;
+   char file[512];
+   void *data = NULL;
+   size_t size = 0;
+   int rv = 0;
+
+   clear_cache();
+   reference = create(config);
+   if (!reference)
+   {
+      printf("AAXS rendering is not available, skipped\n");
+      return 0;
+   }
+
+   if (cache_file(file, sizeof(file)) != 1)
+   {
+      printf("cache: the rendered buffer was not cached\n");
+      aaxBufferDestroy(reference);
+      return -1;
+   }
+
+   // the samples read from the cache are the rendered samples
+   rv |= reload(config, reference, "round-trip", true);
+
+   // a corrupted file fails the checksum test and is rendered again
+   data = read_file(file, &size);
+   if (data)
+   {
+      char c = ~((char*)data)[size-1];
+
+      write_file(file, size-1, &c, 1);
+      rv |= reload(config, reference, "corrupted", false);
+   }
+
+   // a truncated file does not match the size in the header
+   if (data && !truncate(file, size/2)) {
+      rv |= reload(config, reference, "truncated", false);
+   }
+
+   // a file of another cache version is ignored
+   if (data)
+   {
+      uint32_t version = ((uint32_t*)data)[1] + 1;
+
+      write_file(file, sizeof(uint32_t), &version, sizeof(uint32_t));
+      rv |= reload(config, reference, "version", false);
+   }
+   free(data);
+   data = NULL;
+
+   // the valid cache file of another instrument does not match the key
+   clear_cache();
+   {
+      aaxBuffer other = create_from(config, other_aaxs);
+      if (other)
+      {
+         if (cache_file(file, sizeof(file)) == 1) {
+            data = read_file(file, &size);
+         }
+         aaxBufferDestroy(other);
+      }
+   }
+   clear_cache();
+   aaxBufferDestroy(create(config));
+   if (data && cache_file(file, sizeof(file)) == 1)
+   {
+      FILE *fp = fopen(file, "wb");
+      if (fp)
+      {
+         fwrite(data, size, 1, fp);
+         fclose(fp);
+      }
+      rv |= reload(config, reference, "key", false);
+   }
+   else
+   {
+      printf("key: the cache file of another instrument is not available\n");
+      rv = -1;
+   }
+   free(data);
+
+   aaxBufferDestroy(reference);
+
+   return rv;
+}
+
+static int
+test_lazy(aaxConfig config)
+{
+   aaxBuffer buffer, other, cached;
+   int levels, rv = 0;
+
+   buffer = create(config);
+   if (!buffer)
+   {
+      printf("AAXS rendering is not available, skipped\n");
+      return 0;
+   }
+
+   levels = ((_buffer_t*)buffer)->mip_levels;
+   if (levels < 3)
+   {
+      printf("lazy: %i mip levels instead of at least 3\n", levels);
+      aaxBufferDestroy(buffer);
+      return -1;
+   }
+
+   // a second buffer of the same instrument is created from the cache
+   other = create(config);
+
+   // an unused mip level falls back to the nearest lower level first
+   if (level(buffer, 1) != 0)
+   {
+      printf("lazy: mip level 1 was rendered before it was used\n");
+      rv = -1;
+   }
+   if (wait_level(buffer, 1) != 1)
+   {
+      printf("lazy: mip level 1 was not rendered on first use\n");
+      rv = -1;
+   }
+
+   // the second buffer renders another mip level, the cache file keeps both
+   if (level(other, 2) == 2)
+   {
+      printf("lazy: mip level 2 was rendered before it was used\n");
+      rv = -1;
+   }
+   if (wait_level(other, 2) != 2)
+   {
+      printf("lazy: mip level 2 was not rendered on first use\n");
+      rv = -1;
+   }
+
+   cached = create(config);
+   if (cached)
+   {
+      if (level(cached, 1) != 1 || level(cached, 2) != 2)
+      {
+         printf("cache: the mip levels of both buffers were not cached\n");
+         rv = -1;
+      }
+      aaxBufferDestroy(cached);
+   }
+
+   aaxBufferDestroy(other);
+   aaxBufferDestroy(buffer);
+
+   return rv;
+}
+
+int main()
+{
+   aaxConfig config;
+   int rv = -1;
+
+   if (!mkdtemp(home))
+   {
+      printf("Unable to create a temporary directory\n");
+      return rv;
+   }
+   setenv("HOME", home, 1);
+
+   config = aaxDriverOpenByName(DEVNAME, AAX_MODE_WRITE_STEREO);
+   if (config)
+   {
+      rv = test_cache(config);
+      clear_cache();
+      rv |= test_lazy(config);
+
+      aaxDriverClose(config);
+      aaxDriverDestroy(config);
+   }
+   else {
+      printf("Unable to open the %s device\n", DEVNAME);
+   }
+   cleanup();
+
+   if (rv == 0) printf("AAXS cache test passed\n");
+
+   return rv;
+}
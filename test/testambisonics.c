@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <aax/aax.h>
+
+#include <base/memory.h>
+#include <software/rbuf_int.h>
+
+#define SAMPLE_FREQUENCY	48000
+#define NO_SAMPLES		256
+#define NO_SPEAKERS		6
+#define NO_DIRECTIONS		64
+
+// octahedron: right, left, up, down, front, back in the listener frame
+static const float speaker[NO_SPEAKERS][3] = {
+   { 1.0f, 0.0f, 0.0f }, {-1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f },
+   { 0.0f,-1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f,-1.0f }
+};
+
+// render a constant signal from direction dir and return the speaker gains
+static void
+render(_aaxRingBuffer *rb, const _aaxMixerInfo *info, const float dir[3],
+       float gain[NO_SPEAKERS])
+{
+   static MIX_T src[NO_SAMPLES];
+   static _aax2dProps ep2d;
+   _aaxRingBufferData *rbi = rb->handle;
+   _aaxRingBufferSample *rbd = rbi->sample;
+   const MIX_T *s = src;
+   MIX_T **track;
+   int i, t;
+
+   for (i=0; i<NO_SAMPLES; ++i) src[i] = 1.0f;
+
+   memset(&ep2d, 0, sizeof(ep2d));
+   for (i=0; i<3; ++i) ep2d.direction.v4[i] = dir[i];
+   ep2d.direction.v4[3] = 1.0f;
+
+   rb->set_state(rb, RB_CLEARED);
+   rbd->mix1n(rbd, &s, info->router, &ep2d, 0, 0, NO_SAMPLES,
+              SAMPLE_FREQUENCY, 1.0f, 1.0f, 1.0f);
+   _aaxRingBufferAmbisonicsFlush(rb, info);
+
+   // the gain ramps up from zero, the last sample holds the final gain
+   track = (MIX_T**)rbd->track;
+   for (t=0; t<NO_SPEAKERS; ++t) {
+      gain[t] = track[t][NO_SAMPLES-1];
+   }
+}
+
+int main()
+{
+   static _aaxMixerInfo info;
+   _aaxRingBuffer *rb;
+   int rv = -1;
+
+   memset(&info, 0, sizeof(info));
+   info.mode = AAX_MODE_WRITE_SPATIAL;
+   info.no_tracks = NO_SPEAKERS;
+   for (int t=0; t<NO_SPEAKERS; ++t)
+   {
+      for (int i=0; i<3; ++i) info.speaker[t].v4[i] = speaker[t][i];
+      info.speaker[t].v4[3] = 1.0f;
+      info.router[t] = t;
+   }
+
+   rb = _aaxRingBufferCreate(0.0f, AAX_MODE_WRITE_SPATIAL);
+   if (rb)
+   {
+      float energy = -1.0f;
+      int d;
+
+      rb->set_format(rb, AAX_PCM24S, true);
+      rb->set_parami(rb, RB_NO_TRACKS, NO_SPEAKERS);
+      rb->set_paramf(rb, RB_FREQUENCY, SAMPLE_FREQUENCY);
+      rb->set_parami(rb, RB_NO_SAMPLES, NO_SAMPLES);
+      rb->init(rb, true);
+      rb->set_parami(rb, RB_AMBISONICS_ORDER, 1);
+
+      rv = 0;
+      for (d=0; d<NO_DIRECTIONS; ++d)
+      {
+         // spiral of directions covering the sphere
+         float y = 1.0f - (2.0f*d + 1.0f)/NO_DIRECTIONS;
+         float r = sqrtf(1.0f - y*y);
+         float phi = 2.399963f*d;
+         float dir[3] = { r*cosf(phi), y, r*sinf(phi) };
+         float gain[NO_SPEAKERS], e = 0.0f, dp = -2.0f;
+         int t, max = 0, nearest = 0;
+
+         render(rb, &info, dir, gain);
+         for (t=0; t<NO_SPEAKERS; ++t)
+         {
+            float p = speaker[t][0]*dir[0] + speaker[t][1]*dir[1] +
+                      speaker[t][2]*dir[2];
+            if (p > dp) { dp = p; nearest = t; }
+            if (gain[t] > gain[max]) max = t;
+            e += gain[t]*gain[t];
+         }
+
+         if (energy < 0.0f) energy = e;
+         if (fabsf(e - energy) > 1e-3f*energy)
+         {
+            printf("direction %i: energy %f, expected %f\n", d, e, energy);
+            rv = -1;
+         }
+         if (max != nearest)
+         {
+            printf("direction %i: loudest speaker %i, nearest speaker %i\n",
+                    d, max, nearest);
+            rv = -1;
+         }
+      }
+      rb->destroy(rb);
+   }
+
+   if (!rv) printf("Ambisonics rendering passed\n");
+
+   return rv;
+}
@@ -56,8 +56,10 @@ extern _batch_dsp_1param_proc _batch_dc_shift;
 extern _batch_dsp_1param_proc _batch_wavefold;
 extern _batch_fmadd_proc _batch_fmul_value;
 extern _batch_resample_float_proc _batch_resample_float;
+extern _batch_resample_ramp_float_proc _batch_resample_ramp_float;
 extern _batch_get_average_rms_proc _batch_get_average_rms;
 extern _batch_freqfilter_float_proc _batch_freqfilter_float;
+extern _batch_freqfilter_bank_proc _batch_freqfilter_bank;
 extern _batch_ema_float_proc _batch_movingaverage_float;
 extern _batch_ema_float_proc _batch_allpass_float;
 extern _aax_generate_waveform_proc _aax_generate_waveform_float;
@@ -70,6 +72,7 @@ _batch_dsp_1param_proc batch_dc_shift;
 _batch_dsp_1param_proc batch_wavefold;
 _batch_fmadd_proc batch_fmul_value;
 _batch_resample_float_proc batch_resample_float;
+_batch_resample_ramp_float_proc batch_resample_ramp_float;
 _batch_get_average_rms_proc batch_get_average_rms;
 _batch_freqfilter_float_proc batch_freqfilter_float;
 _batch_ema_float_proc batch_movingaverage_float;
@@ -105,6 +108,28 @@ char check_cpuid_ecx(unsigned int);
 # define FMA3   neon64
 #endif
 
+static void
+grapheq_serial(float *dst, float *tmp, const float *src, _aaxRingBufferEqualizerData *eq)
+{
+   int b, i;
+
+   memset(dst, 0, MAXNUM*sizeof(float));
+   for (b=0; b<eq->no_bands; ++b)
+   {
+      _aaxRingBufferFreqFilterData *band = &eq->band[b];
+      float gain = band->gain;
+
+      // apply the gain here to be independent of _batch_fmul_value
+      band->gain = 1.0f;
+      _batch_freqfilter_float_cpu(tmp, src, 0, MAXNUM, band);
+      band->gain = gain;
+
+      for (i=0; i<MAXNUM; ++i) {
+         dst[i] += tmp[i]*gain;
+      }
+   }
+}
+
 int main()		// x86		X86_64		ARM
 {			// -------	-------		-------
    bool simd = 0;	// SSE2		SSE2		VFPV4
@@ -147,7 +172,7 @@ int main()		// x86		X86_64		ARM
       float rms1, rms2, peak1, peak2;
       float alpha, h[4];
       double cpu, cpu2, eps;
-      int i;
+      int i, r;
 
       src = (float*)_aaxDataGetData(buf, 0);
       dst1 = (float*)_aaxDataGetData(buf, 1);
@@ -721,6 +746,37 @@ int main()		// x86		X86_64		ARM
          TESTFN("cubic "MKSTR(FMA3), dst1, dst2, 1e-3f);
       }
 
+      /*
+       * resample with a changing pitch: cubic and linear interpolation
+       */
+      for (r=0; r<2; ++r)
+      {
+         float fact_start = r ? 0.9f : 0.15f;
+         float fact_end = r ? 1.1f : 0.2f;
+         const char *name = r ? "linear" : "cubic";
+
+         batch_resample_ramp_float = _batch_resample_ramp_float_cpu;
+         TIMEFN(batch_resample_ramp_float(dst1, src, 0, MAXNUM, 0.0, fact_start, fact_end), cpu, MAXNUM);
+         printf("%s ramp " CPU ":\t%f ms %c\n", name, cpu*1e3, (batch_resample_ramp_float == _batch_resample_ramp_float) ? '*' : ' ');
+
+         if (simd)
+         {
+            batch_resample_ramp_float = GLUE(_batch_resample_ramp_float, SIMD);
+
+            TIMEFN(batch_resample_ramp_float(dst2, src, 0, MAXNUM, 0.0, fact_start, fact_end), eps, MAXNUM);
+            printf("%s ramp "MKSTR(SIMD)":\t%f ms - cpu x %3.2f %c", name, eps*1e3, cpu/eps, (batch_resample_ramp_float == _batch_resample_ramp_float) ? '*' : ' ');
+            TESTFN("ramp "MKSTR(SIMD), dst1, dst2, 1e-3f);
+         }
+         if (simd1)
+         {
+            batch_resample_ramp_float = GLUE(_batch_resample_ramp_float, SIMD1);
+
+            TIMEFN(batch_resample_ramp_float(dst2, src, 0, MAXNUM, 0.0, fact_start, fact_end), eps, MAXNUM);
+            printf("%s ramp "MKSTR(SIMD1)":\t%f ms - cpu x %3.2f %c", name, eps*1e3, cpu/eps, (batch_resample_ramp_float == _batch_resample_ramp_float) ? '*' : ' ');
+            TESTFN("ramp "MKSTR(SIMD1), dst1, dst2, 1e-3f);
+         }
+      }
+
       /*
        * batch freqfilter calulculation
        */
@@ -880,6 +936,67 @@ int main()		// x86		X86_64		ARM
          TESTF("freq "MKSTR(FMA3), dst1, dst2);
       }
 
+      /*
+       * batch graphic equalizer filter-bank
+       */
+      printf("\n== Graphic equalizer filter-bank (%i bands):\n", _AAX_MAX_EQBANDS);
+      {
+         static _aaxRingBufferFreqFilterHistoryData eq_history[_AAX_MAX_EQBANDS];
+         static _aaxRingBufferEqualizerData eq;
+         _batch_freqfilter_bank_proc batch_freqfilter_bank;
+         float *tmp = (float*)_aaxDataGetData(buf, 3);
+         int b;
+
+         memset(&eq, 0, sizeof(eq));
+         eq.no_bands = _AAX_MAX_EQBANDS;
+         for (b=0; b<_AAX_MAX_EQBANDS; ++b)
+         {
+            _aaxRingBufferFreqFilterData *band = &eq.band[b];
+
+            band->freqfilter = &eq_history[b];
+            band->fs = 48000.0f;
+            band->high_gain = 0.5f + (float)b/_AAX_MAX_EQBANDS;
+            band->low_gain = 0.0f;
+            band->no_stages = 2;
+            band->Q = 0.66f;
+            if (b == 0) band->type = LOWPASS;
+            else if (b == _AAX_MAX_EQBANDS-1) band->type = HIGHPASS;
+            else band->type = BANDPASS;
+            _freqfilter_normalize_gains(band);
+            _aax_butterworth_compute(43.0f*powf(1.5f, b), band);
+         }
+
+         memset(eq_history, 0, sizeof(eq_history));
+         TIMEFN(grapheq_serial(dst1, tmp, src, &eq), cpu2, MAXNUM);
+         printf("serial " CPU ":\t%f ms\n", cpu2*1e3);
+
+         memset(eq_history, 0, sizeof(eq_history));
+         batch_freqfilter_bank = _batch_freqfilter_bank_cpu;
+
+         TIMEFN(batch_freqfilter_bank(dst2, src, 0, MAXNUM, &eq, false), cpu, MAXNUM);
+         printf("bank " CPU ":\t%f ms - serial x %3.2f %c", cpu*1e3, cpu2/cpu, (batch_freqfilter_bank == _batch_freqfilter_bank) ? '*' : ' ');
+         TESTF("bank " CPU, dst1, dst2);
+
+         if (simd)
+         {
+            memset(eq_history, 0, sizeof(eq_history));
+            batch_freqfilter_bank = GLUE(_batch_freqfilter_bank, SIMD);
+
+            TIMEFN(batch_freqfilter_bank(dst2, src, 0, MAXNUM, &eq, false), eps, MAXNUM);
+            printf("bank %s:\t%f ms - cpu x %3.2f %c", MKSTR(SIMD), eps*1e3, cpu/eps, (batch_freqfilter_bank == _batch_freqfilter_bank) ? '*' : ' ');
+            TESTF("bank "MKSTR(SIMD), dst1, dst2);
+         }
+         if (simd1)
+         {
+            memset(eq_history, 0, sizeof(eq_history));
+            batch_freqfilter_bank = GLUE(_batch_freqfilter_bank, SIMD1);
+
+            TIMEFN(batch_freqfilter_bank(dst2, src, 0, MAXNUM, &eq, false), eps, MAXNUM);
+            printf("bank "MKSTR(SIMD1)":\t%f ms - cpu x %3.2f %c", eps*1e3, cpu/eps, (batch_freqfilter_bank == _batch_freqfilter_bank) ? '*' : ' ');
+            TESTF("bank "MKSTR(SIMD1), dst1, dst2);
+         }
+      }
+
       /*
        * batch DC
        */
@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <aax/aax.h>
+
+#include <software/rbuf_int.h>
+#include <software/renderer.h>
+#include <dsp/automation.h>
+#include <dsp/filters.h>
+#include <dsp/effects.h>
+#include <objects.h>
+
+#define SAMPLE_FREQUENCY	48000.0f
+#define NO_SAMPLES		1024
+#define SRC_SAMPLES		(4*NO_SAMPLES)
+#define MAX_ERROR		1e-5f
+
+static int
+test_queue(_aaxAutomationQueue *q)
+{
+   static float d[NO_SAMPLES];
+   int i, rv = 0;
+
+   // start at 1.0, step to 0.5 at 100, ramp to 0.0 at 300, step to 1.0 at 800
+   // the events are added out of order on purpose
+   _automation_add(q, 800, 1.0f, false, 1.0f);
+   _automation_add(q, 100, 0.5f, false, 1.0f);
+   _automation_add(q, 300, 0.0f, true, 1.0f);
+   if (q->no_events != 3 || q->event[0].time != 100 || q->event[2].time != 800)
+   {
+      printf("events are not sorted\n");
+      rv = -1;
+   }
+
+   q->time = 0;
+   for (i=0; i<NO_SAMPLES; ++i) d[i] = 1.0f;
+   _automation_multiply(q, d, 0, NO_SAMPLES);
+
+   for (i=0; i<NO_SAMPLES; ++i)
+   {
+      float expected;
+
+      if (i < 100) expected = 1.0f;
+      else if (i < 300) expected = 0.5f - 0.5f*(i - 100)/200.0f;
+      else if (i < 800) expected = 0.0f;
+      else expected = 1.0f;
+
+      if (fabsf(d[i] - expected) > MAX_ERROR)
+      {
+         printf("multiply: sample %i is %f instead of %f\n", i, d[i], expected);
+         rv = -1;
+         break;
+      }
+      if (fabsf(_automation_get(q, i) - expected) > MAX_ERROR)
+      {
+         printf("get: sample %i is %f instead of %f\n", i,
+                 _automation_get(q, i), expected);
+         rv = -1;
+         break;
+      }
+   }
+
+   // consuming the events in periods should not change the outcome
+   for (i=0; i<NO_SAMPLES; i += 256)
+   {
+      float v = _automation_get(q, i+200);
+      _automation_advance(q, i+128);
+      if (fabsf(_automation_get(q, i+200) - v) > MAX_ERROR)
+      {
+         printf("advance: sample %i changed from %f to %f\n", i+200,
+                 v, _automation_get(q, i+200));
+         rv = -1;
+      }
+   }
+   if (q->no_events || q->value != 1.0f)
+   {
+      printf("advance: %i events left, value: %f\n", q->no_events, q->value);
+      rv = -1;
+   }
+
+   return rv;
+}
+
+static void
+set_props(_aax2dProps *p2d, float gain)
+{
+   memset(p2d, 0, sizeof(_aax2dProps));
+   _aaxSetDefault2dProps(p2d);
+   _aaxSetDefaultFilter2d(&p2d->filter[VOLUME_FILTER], VOLUME_FILTER, 0);
+   _aaxSetDefaultEffect2d(&p2d->effect[PITCH_EFFECT], PITCH_EFFECT, 0);
+   _aaxSetDefault2dFiltersEffects(p2d);
+   _FILTER_SET(p2d, VOLUME_FILTER, AAX_GAIN, gain);
+   p2d->final.gain_max = 1.0f;
+   p2d->final.k = 1.0f;
+}
+
+/*
+ * Mix a constant source which starts at start samples into the first period
+ * for no_periods periods. When time >= 0 a gain step to value at sample time
+ * time is scheduled just before the last period is mixed.
+ * Returns a copy of the first track of the last period.
+ */
+static const float*
+mix(bool mono, size_t start, float gain, int64_t time, float value,
+    int no_periods)
+{
+   static _aax2dProps ep2d, fp2d;
+   static float rv[NO_SAMPLES];
+   _aaxRingBuffer *drb, *srb;
+   _aaxMixerInfo *info = NULL;
+   _aaxRendererData data;
+   _aaxRingBufferData *rbi;
+   _aax3dProps *fp3d;
+   float *track;
+   int i, p;
+
+   _aaxSetDefaultInfo(&info, NULL);
+   info->frequency = SAMPLE_FREQUENCY;
+   info->curr_sample = 0;
+
+   set_props(&fp2d, 1.0f);
+   set_props(&ep2d, gain);
+   ep2d.start_offs = start;
+   fp3d = _aax3dPropsCreate();
+
+   drb = _aaxRingBufferCreate(0.0f, AAX_MODE_WRITE_STEREO);
+   drb->set_format(drb, AAX_PCM24S, true);
+   drb->set_parami(drb, RB_NO_TRACKS, 2);
+   drb->set_paramf(drb, RB_FREQUENCY, SAMPLE_FREQUENCY);
+   drb->set_parami(drb, RB_NO_SAMPLES, NO_SAMPLES);
+   drb->init(drb, true);
+
+   srb = _aaxRingBufferCreate(0.0f, AAX_MODE_READ);
+   srb->set_format(srb, AAX_PCM24S, true);
+   srb->set_parami(srb, RB_NO_TRACKS, 1);
+   srb->set_paramf(srb, RB_FREQUENCY, SAMPLE_FREQUENCY);
+   srb->set_parami(srb, RB_NO_SAMPLES, SRC_SAMPLES);
+   srb->init(srb, true);
+
+   rbi = srb->handle;
+   track = rbi->sample->track[0];
+   for (i=0; i<SRC_SAMPLES; ++i) track[i] = 0.25f*AAX_PEAK_MAX;
+   srb->set_state(srb, RB_STARTED);
+
+   memset(&data, 0, sizeof(data));
+   data.info = info;
+   data.drb = drb;
+   data.fp2d = &fp2d;
+   data.fp3d = fp3d;
+
+   for (p=0; p<no_periods; ++p)
+   {
+      if (time >= 0 && p == no_periods-1)
+      {
+         _aaxAutomationData *automation = _automation_create();
+         _automation_add(&automation->param[AUTOMATION_GAIN], time, value,
+                         false, gain);
+         ep2d.automation = automation;
+      }
+
+      drb->set_state(drb, RB_CLEARED);
+      drb->set_state(drb, RB_REWINDED);
+      if (mono) {
+         drb->mix3d(drb, srb, &ep2d, &data, 0, 1.0f, NULL);
+      } else {
+         drb->mix2d(drb, srb, &data, &ep2d, 1.0f, NULL);
+      }
+      info->curr_sample += NO_SAMPLES;
+   }
+
+   rbi = drb->handle;
+   memcpy(rv, rbi->sample->track[0], sizeof(rv));
+
+   _automation_destroy(ep2d.automation);
+   ep2d.automation = NULL;
+   _aaxRingBufferFree(srb);
+   _aaxRingBufferFree(drb);
+   _aax3dPropsDestory(fp3d);
+
+   return rv;
+}
+
+/*
+ * Compare the mixed output with a gain step against the same mix without
+ * automation. The step to half the gain should happen at exactly step
+ * samples into the last period, no matter where the emitter started.
+ */
+static int
+test_mix(const char *name, bool mono, size_t start, int no_periods)
+{
+   static float ref[NO_SAMPLES];
+   size_t i, step = 700;
+   int64_t t0 = (no_periods-1)*NO_SAMPLES;
+   const float *d;
+   int rv = 0;
+
+   d = mix(mono, start, 0.8f, -1, 0.0f, no_periods);
+   memcpy(ref, d, sizeof(ref));
+   d = mix(mono, start, 0.8f, t0+step, 0.4f, no_periods);
+
+   for (i=0; i<NO_SAMPLES; ++i)
+   {
+      float expected = (i < step) ? ref[i] : 0.5f*ref[i];
+      if (fabsf(d[i] - expected) > MAX_ERROR*AAX_PEAK_MAX)
+      {
+         printf("%s: sample %zu is %f instead of %f\n", name, i,
+                 d[i], expected);
+         rv = -1;
+         break;
+      }
+   }
+
+   return rv;
+}
+
+int main()
+{
+   _aaxRingBuffer *rb;
+   int rv = -1;
+
+   rb = _aaxRingBufferCreate(0.0f, AAX_MODE_WRITE_STEREO);
+   if (rb)
+   {
+      _aaxAutomationData *automation = _automation_create();
+      if (automation)
+      {
+         rv = test_queue(&automation->param[AUTOMATION_GAIN]);
+         _automation_destroy(automation);
+      }
+
+      // an emitter which starts halfway the period
+      rv |= test_mix("stereo, delayed start", false, 300, 1);
+      rv |= test_mix("mono, delayed start", true, 300, 1);
+
+      // automation which starts while the emitter is already playing
+      rv |= test_mix("stereo, playing", false, 300, 2);
+      rv |= test_mix("mono, playing", true, 300, 2);
+      _aaxRingBufferFree(rb);
+   }
+
+   if (rv == 0) printf("Automation test passed\n");
+
+   return rv;
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <aax/aax.h>
+
+#include <software/rbuf_int.h>
+
+#define FS			44100.0f
+#define NO_SAMPLES		1020	/* not a multiple of the block size */
+#define LOOP_START		300
+#define MAX_ERROR		0.02f
+
+static int32_t ref[NO_SAMPLES];
+static int32_t dst[4*NO_SAMPLES];
+
+static int
+compare(const char *name, const int32_t *a, const int32_t *b, int no_samples, float max_error)
+{
+   int i;
+   for (i=0; i<no_samples; ++i)
+   {
+      if (fabsf((float)(a[i] - b[i]))/8388608.0f > max_error)
+      {
+         printf("%s: sample %i is %i instead of %i\n", name, i, b[i], a[i]);
+         return -1;
+      }
+   }
+   return 0;
+}
+
+int main()
+{
+   _aaxRingBuffer *rb;
+   int rv = -1;
+
+   rb = _aaxRingBufferCreate(0.0f, AAX_MODE_WRITE_STEREO);
+   if (rb)
+   {
+      _aaxRingBufferData *rbi = rb->handle;
+      _aaxRingBuffer *erb;
+      int32_t **tracks;
+      int i;
+
+      rb->set_format(rb, AAX_PCM24S, false);
+      rb->set_parami(rb, RB_NO_TRACKS, 1);
+      rb->set_paramf(rb, RB_FREQUENCY, FS);
+      rb->set_parami(rb, RB_NO_SAMPLES, NO_SAMPLES);
+      rb->init(rb, false);
+
+      for (i=0; i<NO_SAMPLES; ++i) {
+         ref[i] = 0.7f*8388607.0f*sinf(2.0f*GMATH_PI*440.0f*i/FS);
+      }
+      tracks = rb->get_tracks_ptr(rb, RB_WRITE);
+      memcpy(tracks[0], ref, sizeof(ref));
+      rb->release_tracks_ptr(rb);
+
+      rv = 0;
+      if (!rb->set_parami(rb, RB_COMPRESSED, true) ||
+          !rb->get_parami(rb, RB_COMPRESSED) || rbi->sample->track ||
+          !rb->get_state(rb, RB_IS_VALID))
+      {
+         printf("compress: the sample data was not compressed\n");
+         rv = -1;
+      }
+
+      // the tracks are only expanded while accessed
+      tracks = rb->get_tracks_ptr(rb, RB_READ);
+      rv |= compare("expand", ref, tracks[0], NO_SAMPLES, MAX_ERROR);
+      memcpy(dst, tracks[0], sizeof(ref));
+      rb->release_tracks_ptr(rb);
+      if (rbi->sample->track)
+      {
+         printf("release: the expanded tracks were not released\n");
+         rv = -1;
+      }
+
+      // decoding parts of the sample by an emitter matches the expanded data
+      erb = rb->reference(rb);
+      if (erb)
+      {
+         _aaxRingBufferData *erbi = erb->handle;
+         int32_t *ptr = dst + NO_SAMPLES;
+         size_t pos = 0;
+
+         memcpy(ref, dst, sizeof(ref));
+         while (pos < NO_SAMPLES)
+         {
+            size_t len = _MIN(37, NO_SAMPLES - pos);
+            _aaxRingBufferProcessBlocks(ptr+pos, erbi, 0, pos, 0, NO_SAMPLES,
+                                        len, false);
+            pos += len;
+         }
+         rv |= compare("periods", ref, ptr, NO_SAMPLES, 0.0f);
+
+         // looping repeats the section from the loop start
+         _aaxRingBufferProcessBlocks(ptr, erbi, 0, NO_SAMPLES-10, LOOP_START,
+                                     NO_SAMPLES, 2*NO_SAMPLES, true);
+         rv |= compare("loop end", ref+NO_SAMPLES-10, ptr, 10, 0.0f);
+         ptr += 10;
+         for (i=0; i<2*NO_SAMPLES-10; i += NO_SAMPLES-LOOP_START)
+         {
+            int len = _MIN(NO_SAMPLES-LOOP_START, 2*NO_SAMPLES-10-i);
+            rv |= compare("loop", ref+LOOP_START, ptr+i, len, 0.0f);
+         }
+         // a streaming voice mixes HISTORY_SAMPS beyond the end of the buffer
+         ptr = dst + NO_SAMPLES;
+         memset(ptr, 0xff, (37+HISTORY_SAMPS)*sizeof(int32_t));
+         _aaxRingBufferProcessBlocks(ptr, erbi, 0, NO_SAMPLES-37, 0,
+                                     NO_SAMPLES+HISTORY_SAMPS,
+                                     37+HISTORY_SAMPS, false);
+         rv |= compare("last period", ref+NO_SAMPLES-37, ptr, 37, 0.0f);
+         for (i=37; i<37+HISTORY_SAMPS; ++i)
+         {
+            if (ptr[i] != 0)
+            {
+               printf("last period: sample %i beyond the end is %i\n",
+                      NO_SAMPLES-37+i, ptr[i]);
+               rv = -1;
+               break;
+            }
+         }
+         erb->destroy(erb);
+      }
+
+      // uncompress restores the tracks
+      if (!rb->set_parami(rb, RB_COMPRESSED, false) ||
+          rb->get_parami(rb, RB_COMPRESSED) || !rbi->sample->track)
+      {
+         printf("uncompress: the sample data was not restored\n");
+         rv = -1;
+      }
+      else
+      {
+         tracks = rb->get_tracks_ptr(rb, RB_READ);
+         rv |= compare("uncompress", ref, tracks[0], NO_SAMPLES, 0.0f);
+         rb->release_tracks_ptr(rb);
+      }
+
+      _aaxRingBufferFree(rb);
+   }
+
+   if (rv == 0) printf("Compressed sample storage test passed\n");
+
+   return rv;
+}
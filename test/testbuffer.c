@@ -1,11 +1,19 @@
 
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 
 #include <aax/aax.h>
 
+#include <base/xthreads.h>
+
 #define SAMPLE_FREQUENCY	44100
 #define DEVNAME			"AeonWave Loopback"
+#define NO_THREADS		8
+#define NO_RUNS			64
 
 static const char* aaxs_data_sax =   // A2, 200Hz
 " <aeonwave>                                          \
@@ -32,12 +40,56 @@ void testForState(int i, char *s)
    }
 }
 
+static aaxBuffer async_buffer;
+
+static int
+get_no_samples(void *id)
+{
+   return aaxBufferGetSetup(async_buffer, AAX_NO_SAMPLES);
+}
+
+/*
+ * Every thread which references a buffer with a pending asynchronous
+ * generation waits for it, the results are only collected once.
+ */
+void testAsync(aaxConfig config)
+{
+   int run, i, res;
+
+   for (run=0; run<NO_RUNS; ++run)
+   {
+      thrd_t thread[NO_THREADS];
+      int no_samples[NO_THREADS];
+
+      async_buffer = aaxBufferCreate(config, SAMPLE_FREQUENCY, 1, AAX_AAXS16S);
+      testForError(async_buffer, "Unable to generate buffer\n");
+
+      aaxBufferSetDataAsync(async_buffer, aaxs_data_sax);
+      for (i=0; i<NO_THREADS; ++i) {
+         res = thrd_create(&thread[i], get_no_samples, NULL);
+         testForState(res == thrd_success, "thrd_create");
+      }
+      for (i=0; i<NO_THREADS; ++i) {
+         thrd_join(thread[i], &no_samples[i]);
+      }
+      for (i=1; i<NO_THREADS; ++i) {
+         testForState(no_samples[i] == no_samples[0], "aaxBufferSetDataAsync");
+      }
+
+      res = aaxBufferDestroy(async_buffer);
+      testForState(res, "aaxBufferDestroy");
+   }
+}
+
 int main()
 {
    aaxConfig config = aaxDriverOpenByName(DEVNAME, AAX_MODE_WRITE_STEREO);
    if (config)
    {
       unsigned int freq = SAMPLE_FREQUENCY;
+
+      testAsync(config);
+
       aaxBuffer buffer = aaxBufferCreate(config, freq, 1, AAX_AAXS16S);
       testForError(buffer, "Unable to generate buffer\n");
 
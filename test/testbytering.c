@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include <base/bytering.h>
+#include <base/jobpool.h>
+#include <base/timer.h>
+
+#define RING_SIZE		1000
+#define CHUNK_SIZE		300
+#define TOTAL_SIZE		(1024*1024)
+
+static atomic_int written;
+
+static unsigned int
+next_size(unsigned int *seed)
+{
+   *seed = *seed*1103515245 + 12345;
+   return 1 + (*seed >> 16) % CHUNK_SIZE;
+}
+
+static int
+producer_job(void *d)
+{
+   _aaxByteRing *ring = d;
+   unsigned char buf[CHUNK_SIZE];
+   unsigned int seed = 1;
+   size_t pos = 0;
+
+   while (pos < TOTAL_SIZE)
+   {
+      size_t i, size = next_size(&seed);
+      size_t res = 0;
+
+      if (size > TOTAL_SIZE - pos) {
+         size = TOTAL_SIZE - pos;
+      }
+
+      for (i=0; i<size; ++i) {
+         buf[i] = (pos+i) % 251;
+      }
+
+      while (res < size)
+      {
+         size_t n = _aaxByteRingWrite(ring, buf+res, size-res);
+         if (!n) msecSleep(1);
+         res += n;
+      }
+      _aaxByteRingWake(ring);
+      pos += size;
+   }
+   atomic_store(&written, 1);
+
+   return 1;
+}
+
+int main()
+{
+   unsigned char buf[CHUNK_SIZE];
+   _aaxJobPool *pool;
+   _aaxJobGroup group;
+   _aaxByteRing *ring;
+   unsigned int seed = 2;
+   size_t pos = 0;
+   int rv = 0;
+
+   ring = _aaxByteRingCreate(RING_SIZE);
+   pool = _aaxJobPoolCreate(1, "testByteRing");
+   if (!ring || !pool)
+   {
+      printf("Unable to create the byte ring\n");
+      return -1;
+   }
+
+   if (_aaxByteRingGetFreeSpace(ring) != 1024 ||
+       _aaxByteRingGetDataAvail(ring) != 0)
+   {
+      printf("wrong initial ring size\n");
+      rv = -1;
+   }
+
+   if (_aaxByteRingWaitTimed(ring, 0.01f))
+   {
+      printf("woken up without a wakeup\n");
+      rv = -1;
+   }
+   _aaxByteRingWake(ring);
+   if (!_aaxByteRingWaitTimed(ring, 0.01f))
+   {
+      printf("a wakeup before waiting was lost\n");
+      rv = -1;
+   }
+
+   /* one producer thread, the main thread is the consumer */
+   _aaxJobGroupInit(&group);
+   _aaxJobPoolAdd(pool, &group, producer_job, ring);
+
+   while (pos < TOTAL_SIZE && !rv)
+   {
+      size_t i, res = _aaxByteRingRead(ring, buf, next_size(&seed));
+      if (!res)
+      {
+         _aaxByteRingWaitTimed(ring, 0.01f);
+         continue;
+      }
+
+      for (i=0; i<res; ++i)
+      {
+         if (buf[i] != (pos+i) % 251)
+         {
+            printf("byte %zu differs: %i instead of %zu\n", pos+i, buf[i],
+                   (pos+i) % 251);
+            rv = -1;
+            break;
+         }
+      }
+      pos += res;
+   }
+   _aaxJobPoolWait(pool, &group);
+
+   if (!rv && (pos != TOTAL_SIZE || !atomic_load(&written) ||
+               _aaxByteRingGetDataAvail(ring) != 0))
+   {
+      printf("read %zu of %i bytes\n", pos, TOTAL_SIZE);
+      rv = -1;
+   }
+
+   _aaxByteRingWrite(ring, buf, 100);
+   _aaxByteRingClear(ring);
+   if (_aaxByteRingGetDataAvail(ring) != 0 ||
+       _aaxByteRingGetFreeSpace(ring) != 1024)
+   {
+      printf("the ring was not cleared\n");
+      rv = -1;
+   }
+
+   _aaxJobPoolDestroy(pool);
+   _aaxByteRingDestroy(ring);
+
+   return rv;
+}
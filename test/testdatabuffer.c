@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include <base/types.h>
+#include <base/databuffer.h>
+#include <base/random.h>
+
+#define SIZE			4096
+#define NO_OPERATIONS		100000
+
+static unsigned char src[SIZE];
+static unsigned char dst[2][SIZE];
+
+/* The ring buffer must behave exactly like the linear buffer. */
+int main()
+{
+   _data_t *ring, *linear;
+   int i, rv = 0;
+
+   for (i=0; i<SIZE; ++i) {
+      src[i] = i*7;
+   }
+
+   ring = _aaxDataCreateRing(1, SIZE, 1);
+   linear = _aaxDataCreate(1, _aaxDataGetSize(ring), 1);
+   if (!ring || !linear)
+   {
+      printf("Unable to create the data buffers\n");
+      return -1;
+   }
+
+   if (!ring->start) {
+      printf("mirrored mappings are not supported, testing the fallback\n");
+   }
+
+   for (i=0; i<NO_OPERATIONS && !rv; ++i)
+   {
+      size_t avail = _aaxDataGetDataAvail(linear, 0);
+      size_t size = _aax_rand() % (SIZE/4);
+      size_t offs = avail ? (_aax_rand() % avail) : 0;
+      size_t res[2];
+
+      switch (_aax_rand() % 5)
+      {
+      case 0:
+      case 1:
+         res[0] = _aaxDataAdd(ring, 0, src + (i % 64), size);
+         res[1] = _aaxDataAdd(linear, 0, src + (i % 64), size);
+         break;
+      case 2:
+         res[0] = _aaxDataMove(ring, 0, dst[0], size);
+         res[1] = _aaxDataMove(linear, 0, dst[1], size);
+         if (memcmp(dst[0], dst[1], res[1])) res[0] = -1;
+         break;
+      case 3:
+         size = _MIN(size, _aaxDataGetFreeSpace(linear, 0));
+         memcpy(_aaxDataGetPtr(ring, 0), src, size);
+         memcpy(_aaxDataGetPtr(linear, 0), src, size);
+         res[0] = _aaxDataIncreaseOffset(ring, 0, size);
+         res[1] = _aaxDataIncreaseOffset(linear, 0, size);
+         break;
+      default:
+         size = _MIN(size, avail - offs);
+         res[0] = _aaxDataMoveOffset(ring, 0, NULL, offs, size);
+         res[1] = _aaxDataMoveOffset(linear, 0, NULL, offs, size);
+         break;
+      }
+
+      avail = _aaxDataGetDataAvail(linear, 0);
+      if (res[0] != res[1] || _aaxDataGetDataAvail(ring, 0) != avail ||
+          _aaxDataGetFreeSpace(ring, 0) != _aaxDataGetFreeSpace(linear, 0) ||
+          memcmp(_aaxDataGetData(ring, 0), _aaxDataGetData(linear, 0), avail))
+      {
+         printf("operation %i: ring and linear buffer differ\n", i);
+         rv = -1;
+      }
+   }
+
+   _aaxDataDestroy(ring);
+   _aaxDataDestroy(linear);
+
+   return rv;
+}
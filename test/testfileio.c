@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <base/xthreads.h>
+#include <stream/io.h>
+
+#define FILENAME		"testfileio.raw"
+#define FIFONAME		"testfileio.fifo"
+#define FILE_SIZE		(700*1024+123)
+#define READ_SIZE		10000
+#define BUFFER_SIZE		65536
+
+/*
+ * Regular files opened for reading are memory mapped by the file I/O layer,
+ * files which can not be mapped, like a FIFO or an empty file, are read
+ * using read(). Both need to return the same data and end of file.
+ * A mapped file which is truncated continues with read().
+ */
+static unsigned char
+pattern(size_t pos)
+{
+   return (pos*7 + pos/251) & 0xFF;
+}
+
+static int
+write_file(const char *file)
+{
+   int fd, rv = -1;
+
+   fd = open(file, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+   if (fd >= 0)
+   {
+      unsigned char data[READ_SIZE];
+      size_t pos = 0;
+
+      rv = 0;
+      while (pos < FILE_SIZE && !rv)
+      {
+         size_t i, size = _MIN(READ_SIZE, FILE_SIZE-pos);
+
+         for (i=0; i<size; ++i) {
+            data[i] = pattern(pos+i);
+         }
+         if (write(fd, data, size) != size) rv = -1;
+         pos += size;
+      }
+      close(fd);
+   }
+
+   return rv;
+}
+
+static int
+write_fifo(void *arg)
+{
+   write_file(FIFONAME);
+   return 0;
+}
+
+static _io_t*
+open_file(const char *file, _data_t *buf)
+{
+   _io_t *io = _io_create(PROTOCOL_DIRECT);
+   if (io)
+   {
+      io->set_param(io, __F_FLAGS, AAX_MODE_READ);
+      if (io->open(io, buf, file, NULL) < 0)
+      {
+         printf("Unable to open %s\n", file);
+         io = _io_free(io);
+      }
+   }
+   return io;
+}
+
+/* Read and verify up to size bytes starting at pos, returns the number read */
+static ssize_t
+read_check(_io_t *io, _data_t *buf, size_t pos, size_t size, ssize_t *res)
+{
+   size_t num = 0;
+
+   *res = 0;
+   while (num < size)
+   {
+      unsigned char *data;
+      size_t i, avail;
+
+      *res = io->read(io, buf, _MIN(READ_SIZE, size-num));
+      data = _aaxDataGetData(buf, 0);
+      avail = _aaxDataGetDataAvail(buf, 0);
+      for (i=0; i<avail; ++i)
+      {
+         if (data[i] != pattern(pos+num+i))
+         {
+            printf("data mismatch at byte %zu\n", pos+num+i);
+            return -1;
+         }
+      }
+      num += avail;
+      _aaxDataClear(buf, 0);
+
+      if (*res < 0) break;
+   }
+
+   return num;
+}
+
+static int
+test_mapped(_data_t *buf)
+{
+   static const size_t seek[] = { 500000, 1000, FILE_SIZE-5000, 300000 };
+   _io_t *io;
+   ssize_t res;
+   int i, rv = -1;
+
+   if (write_file(FILENAME) < 0)
+   {
+      printf("Unable to write %s\n", FILENAME);
+      return rv;
+   }
+
+   io = open_file(FILENAME, buf);
+   if (!io) return rv;
+
+   if (!io->map)
+   {
+      printf("%s is not memory mapped\n", FILENAME);
+      goto out;
+   }
+   if (io->get_param(io, __F_NO_BYTES) != FILE_SIZE)
+   {
+      printf("%s: wrong file size\n", FILENAME);
+      goto out;
+   }
+
+   // the complete file, followed by the end of file
+   if (read_check(io, buf, 0, FILE_SIZE, &res) != FILE_SIZE) goto out;
+   if (io->read(io, buf, READ_SIZE) != __F_EOF)
+   {
+      printf("%s: no end of file after reading\n", FILENAME);
+      goto out;
+   }
+
+   for (i=0; i<sizeof(seek)/sizeof(seek[0]); ++i)
+   {
+      size_t pos = seek[i];
+      size_t size = _MIN(READ_SIZE, FILE_SIZE-pos);
+
+      if (io->set_param(io, __F_POSITION, pos) != pos)
+      {
+         printf("%s: seek to %zu failed\n", FILENAME, pos);
+         goto out;
+      }
+      if (read_check(io, buf, pos, size, &res) != size) goto out;
+      if (io->get_param(io, __F_POSITION) != pos+size)
+      {
+         printf("%s: wrong position after reading\n", FILENAME);
+         goto out;
+      }
+   }
+
+   // a read which crosses the end of the file is cut short
+   io->set_param(io, __F_POSITION, FILE_SIZE-100);
+   if (read_check(io, buf, FILE_SIZE-100, READ_SIZE, &res) != 100 ||
+       res != __F_EOF)
+   {
+      printf("%s: reading past the end of the file\n", FILENAME);
+      goto out;
+   }
+
+   // seeking beyond the end of the file
+   io->set_param(io, __F_POSITION, FILE_SIZE+1000);
+   if (io->read(io, buf, READ_SIZE) != __F_EOF ||
+       _aaxDataGetDataAvail(buf, 0) != 0)
+   {
+      printf("%s: reading beyond the end of the file\n", FILENAME);
+      goto out;
+   }
+   rv = 0;
+
+out:
+   io->close(io);
+   _io_free(io);
+   remove(FILENAME);
+   return rv;
+}
+
+static int
+test_truncated(_data_t *buf)
+{
+   _io_t *io;
+   ssize_t res;
+   int rv = -1;
+
+   if (write_file(FILENAME) < 0)
+   {
+      printf("Unable to write %s\n", FILENAME);
+      return rv;
+   }
+
+   io = open_file(FILENAME, buf);
+   if (!io) return rv;
+
+   // reading the unmapped pages beyond the new end raises SIGBUS
+   if (read_check(io, buf, 0, 100000, &res) != 100000) goto out;
+   if (truncate(FILENAME, 200000) < 0)
+   {
+      printf("Unable to truncate %s\n", FILENAME);
+      goto out;
+   }
+   if (read_check(io, buf, 100000, FILE_SIZE, &res) != 100000 ||
+       res != __F_EOF || io->map)
+   {
+      printf("%s: reading after truncating the file\n", FILENAME);
+      goto out;
+   }
+   rv = 0;
+
+out:
+   io->close(io);
+   _io_free(io);
+   remove(FILENAME);
+   return rv;
+}
+
+static int
+test_fallback(_data_t *buf)
+{
+   thrd_t thread;
+   _io_t *io;
+   ssize_t res;
+   int fd, rv = -1;
+
+   // a FIFO can not be mapped
+   remove(FIFONAME);
+   if (mkfifo(FIFONAME, 0644) < 0) return 0;
+   if (thrd_create(&thread, write_fifo, NULL) != thrd_success) return rv;
+
+   io = open_file(FIFONAME, buf);
+   if (io)
+   {
+      if (io->map) {
+         printf("%s is memory mapped\n", FIFONAME);
+      }
+      else if (read_check(io, buf, 0, 2*FILE_SIZE, &res) != FILE_SIZE ||
+               res != __F_EOF) {
+         printf("%s: reading with read() failed\n", FIFONAME);
+      }
+      else {
+         rv = 0;
+      }
+      io->close(io);
+      _io_free(io);
+   }
+   thrd_join(thread, NULL);
+   remove(FIFONAME);
+   if (rv < 0) return rv;
+
+   // neither can an empty file
+   rv = -1;
+   fd = open(FILENAME, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+   if (fd >= 0) close(fd);
+
+   io = open_file(FILENAME, buf);
+   if (io)
+   {
+      if (io->map) {
+         printf("The empty file is memory mapped\n");
+      } else if (io->read(io, buf, READ_SIZE) != __F_EOF) {
+         printf("The empty file did not return the end of file\n");
+      } else {
+         rv = 0;
+      }
+      io->close(io);
+      _io_free(io);
+   }
+   remove(FILENAME);
+
+   return rv;
+}
+
+int main()
+{
+   _data_t *buf;
+   int rv = -1;
+
+   buf = _aaxDataCreate(1, BUFFER_SIZE, 1);
+   if (!buf) return rv;
+
+   if (test_mapped(buf) == 0 && test_truncated(buf) == 0 &&
+       test_fallback(buf) == 0)
+   {
+      printf("testfileio: ok\n");
+      rv = 0;
+   }
+   _aaxDataDestroy(buf);
+
+   return rv;
+}
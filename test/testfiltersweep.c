@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <aax/aax.h>
+
+#include <base/memory.h>
+#include <base/random.h>
+#include <software/rbuf_int.h>
+#include <dsp/common.h>
+#include <dsp/dsp.h>
+
+#define SAMPLE_FREQUENCY	48000.0f
+#define NO_SAMPLES		1024
+#define NO_BLOCKS		(NO_SAMPLES/32)
+#define MAX_ERROR		2e-3f
+
+static void
+filter_init(_aaxRingBufferFreqFilterData *flt, int state, int stages)
+{
+   memset(flt, 0, sizeof(_aaxRingBufferFreqFilterData));
+   flt->freqfilter = _aax_aligned_alloc(sizeof(_aaxRingBufferFreqFilterHistoryData));
+   memset(flt->freqfilter, 0, sizeof(_aaxRingBufferFreqFilterHistoryData));
+   flt->fs = SAMPLE_FREQUENCY;
+   flt->high_gain = 1.0f;
+   flt->low_gain = 0.0f;
+   _freqfilter_normalize_gains(flt);
+   flt->no_stages = stages;
+   flt->state = state;
+   flt->Q = 1.0f;
+   flt->type = LOWPASS;
+}
+
+static void
+filter_compute(_aaxRingBufferFreqFilterData *flt, float fc)
+{
+   if (flt->state == AAX_BESSEL) {
+      _aax_bessel_compute(fc, flt);
+   } else {
+      _aax_butterworth_compute(fc, flt);
+   }
+}
+
+static float
+max_error(const MIX_T *a, const MIX_T *b, size_t num)
+{
+   float rv = 0.0f;
+   size_t i;
+
+   for (i=0; i<num; ++i) {
+      rv = _MAX(rv, fabsf(a[i] - b[i]));
+   }
+   return rv;
+}
+
+static int
+test_sweep(_aaxRingBufferSample *rbd, const char *name, int state, int stages,
+           float fc1, float fc2)
+{
+   static MIX_T src[NO_SAMPLES], dst[NO_SAMPLES], ref[NO_SAMPLES];
+   _aaxRingBufferFreqFilterData flt, rflt;
+   float lfc1, lfc2, err;
+   int b, rv = 0;
+
+   for (b=0; b<NO_SAMPLES; ++b) {
+      src[b] = 2.0f*_aax_random() - 1.0f;
+   }
+
+   filter_init(&flt, state, stages);
+   filter_init(&rflt, state, stages);
+
+   // a constant cutoff frequency uses the interpolated table coefficients
+   _freqfilter_sweep_run(rbd, dst, src, NO_SAMPLES, 0, 0, &flt, fc1);
+   filter_compute(&rflt, fc1);
+   rbd->freqfilter(ref, src, 0, NO_SAMPLES, &rflt);
+   err = max_error(dst, ref, NO_SAMPLES);
+   if (err > MAX_ERROR)
+   {
+      printf("%s: constant %.0f Hz, error: %f\n", name, fc1, err);
+      rv = -1;
+   }
+
+   // a sweep updates the coefficients every sub-block
+   lfc1 = log2f(fc1);
+   lfc2 = log2f(fc2);
+   _freqfilter_sweep_run(rbd, dst, src, NO_SAMPLES, 0, 0, &flt, fc2);
+   for (b=0; b<NO_BLOCKS; ++b)
+   {
+      size_t offs = b*NO_SAMPLES/NO_BLOCKS;
+      float fc = exp2f(lfc1 + (lfc2 - lfc1)*(b+1)/NO_BLOCKS);
+
+      filter_compute(&rflt, fc);
+      rbd->freqfilter(ref+offs, src+offs, 0, NO_SAMPLES/NO_BLOCKS, &rflt);
+   }
+   err = max_error(dst, ref, NO_SAMPLES);
+   if (err > MAX_ERROR)
+   {
+      printf("%s: sweep %.0f - %.0f Hz, error: %f\n", name, fc1, fc2, err);
+      rv = -1;
+   }
+
+   _aax_aligned_free(flt.freqfilter);
+   _aax_aligned_free(rflt.freqfilter);
+   free(flt.table);
+
+   return rv;
+}
+
+int main()
+{
+   _aaxRingBuffer *rb;
+   int rv = -1;
+
+   rb = _aaxRingBufferCreate(0.0f, AAX_MODE_WRITE_STEREO);
+   if (rb)
+   {
+      _aaxRingBufferData *rbi = rb->handle;
+      _aaxRingBufferSample *rbd = rbi->sample;
+
+      rv = test_sweep(rbd, "butterworth 12dB", AAX_BUTTERWORTH, 1, 200.0f, 8000.0f);
+      rv |= test_sweep(rbd, "butterworth 48dB", AAX_BUTTERWORTH, 4, 5000.0f, 300.0f);
+      rv |= test_sweep(rbd, "bessel 24dB", AAX_BESSEL, 2, 440.0f, 2200.0f);
+
+      _aaxRingBufferFree(rb);
+   }
+
+   if (rv == 0) printf("Filter sweep test passed\n");
+
+   return rv;
+}
@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <aax/aax.h>
+
+#include <base/memory.h>
+#include <software/rbuf_int.h>
+
+#define FILENAME		"testhrir.aaxh"
+#define SAMPLE_FREQUENCY	48000
+#define NO_SAMPLES		1024
+#define IR_LENGTH		32
+#define NO_RINGS		3
+
+// ring elevation in degrees and number of azimuths
+static const float elevation[NO_RINGS] = { -45.0f, 0.0f, 45.0f };
+static const int no_azimuths[NO_RINGS] = { 4, 4, 1 };
+
+// every direction d has a left ear delay of d and a right ear delay of d+2
+// cut drops the last bytes of the file
+static int
+write_hrir_set(const char *file, size_t cut)
+{
+   static uint8_t buf[4096*8];
+   size_t len = sizeof(buf)-4;
+   uint8_t *ptr = buf+4;
+   int d, r, a, t, i;
+   FILE *fp;
+
+   memcpy(buf, "AAXH", 4);
+   write32le(&ptr, 1, &len);
+   write32le(&ptr, SAMPLE_FREQUENCY, &len);
+   write32le(&ptr, IR_LENGTH, &len);
+   write32le(&ptr, NO_RINGS, &len);
+   for (d=r=0; r<NO_RINGS; ++r)
+   {
+      union { float f; uint32_t u; } v;
+
+      v.f = elevation[r];
+      write32le(&ptr, v.u, &len);
+      write32le(&ptr, no_azimuths[r], &len);
+      for (a=0; a<no_azimuths[r]; ++a, ++d)
+      {
+         for (t=0; t<2; ++t)
+         {
+            for (i=0; i<IR_LENGTH; ++i)
+            {
+               v.f = (i == d+2*t) ? 0.5f+0.25f*t : 0.0f;
+               write32le(&ptr, v.u, &len);
+            }
+         }
+      }
+   }
+
+   fp = fopen(file, "wb");
+   if (!fp) return 0;
+   fwrite(buf, 1, sizeof(buf)-len-cut, fp);
+   fclose(fp);
+
+   return 1;
+}
+
+// an emitter moving from az_prev to az is crossfaded over the period
+static int
+test_hrir(_aaxRingBuffer *rb, const char *name, float az_prev, float az,
+          float el, size_t pos, const int delay_prev[2][2],
+          const float gain_prev[2][2], const int delay[2][2],
+          const float gain[2][2])
+{
+   static const unsigned char router[2] = { 0, 1 };
+   static MIX_T src[NO_SAMPLES];
+   static _aax2dProps ep2d;
+   _aaxRingBufferData *rbi = rb->handle;
+   _aaxRingBufferSample *rbd = rbi->sample;
+   CONST_MIX_PTRPTR_T sptr;
+   const MIX_T *s = src;
+   float w = (float)pos/NO_SAMPLES;
+   int i, t, rv = 0;
+   MIX_T **track;
+   size_t j;
+
+   memset(&ep2d, 0, sizeof(ep2d));
+   ep2d.prev_gain[0] = 1.0f;
+   ep2d.hrir_dir[0] = az*GMATH_DEG_TO_RAD;
+   ep2d.hrir_dir[1] = el*GMATH_DEG_TO_RAD;
+   ep2d.hrir_dir_prev[0] = az_prev*GMATH_DEG_TO_RAD;
+   ep2d.hrir_dir_prev[1] = el*GMATH_DEG_TO_RAD;
+   ep2d.hrir_dir_set = true;
+
+   memset(src, 0, sizeof(src));
+   src[pos] = 1.0f;
+   sptr = &s;
+
+   rb->set_state(rb, RB_CLEARED);
+   if (!_aaxRingBufferHRIRMix(rbd, sptr, router, &ep2d, 0, 0, NO_SAMPLES,
+                              1.0f, 1.0f, 1.0f))
+   {
+      printf("%s: HRIR set not used\n", name);
+      return -1;
+   }
+   _aaxRingBufferHRIRFlush(rb);
+
+   // the convolution tail ends up in the next period
+   track = (MIX_T**)rbd->track;
+   for (t=0; t<2; ++t)
+   {
+      for (j=0; j<NO_SAMPLES; ++j)
+      {
+         float expected = 0.0f;
+         for (i=0; i<2; ++i)
+         {
+            if (j == pos+delay_prev[t][i]) expected += (1.0f-w)*gain_prev[t][i];
+            if (j == pos+delay[t][i]) expected += w*gain[t][i];
+         }
+         if (fabsf(track[t][j] - expected) > 1e-4f)
+         {
+            printf("%s: track %i, sample %zu: %f, expected %f\n",
+                    name, t, j, track[t][j], expected);
+            rv = -1;
+            break;
+         }
+      }
+   }
+
+   rb->set_state(rb, RB_CLEARED);
+   for (t=0; t<2; ++t)
+   {
+      for (j=0; j<IR_LENGTH; ++j)
+      {
+         float expected = 0.0f;
+         for (i=0; i<2; ++i)
+         {
+            if (j+NO_SAMPLES == pos+delay_prev[t][i]) {
+               expected += (1.0f-w)*gain_prev[t][i];
+            }
+            if (j+NO_SAMPLES == pos+delay[t][i]) expected += w*gain[t][i];
+         }
+         if (fabsf(track[t][j] - expected) > 1e-4f)
+         {
+            printf("%s: tail track %i, sample %zu: %f, expected %f\n",
+                    name, t, j, track[t][j], expected);
+            rv = -1;
+            break;
+         }
+      }
+   }
+
+   return rv;
+}
+
+int main()
+{
+   // left (90 degrees) is direction 5 of the horizontal ring
+   static const int left[2][2] = { { 5, 5 }, { 7, 7 } };
+   static const float left_gain[2][2] = { { 0.5f, 0.0f }, { 0.75f, 0.0f } };
+   // 45 degrees in between directions 4 and 5 of the horizontal ring
+   static const int front_left[2][2] = { { 4, 5 }, { 6, 7 } };
+   static const float front_left_gain[2][2] = {{ 0.25f, 0.25f },
+                                               { 0.375f, 0.375f }};
+   _aaxRingBufferData *rbi;
+   _aaxRingBuffer *rb;
+   void *set1, *set2;
+   int rv = -1;
+
+   // a truncated set must not load
+   if (!write_hrir_set(FILENAME, 4))
+   {
+      printf("Unable to write %s\n", FILENAME);
+      return -1;
+   }
+   set1 = _aaxRingBufferHRIRLoad(FILENAME, false);
+   if (set1)
+   {
+      printf("truncated: the HRIR set was loaded\n");
+      _aaxRingBufferHRIRUnload(set1);
+      remove(FILENAME);
+      return -1;
+   }
+
+   if (!write_hrir_set(FILENAME, 0))
+   {
+      printf("Unable to write %s\n", FILENAME);
+      return -1;
+   }
+
+   rb = _aaxRingBufferCreate(0.0f, AAX_MODE_WRITE_HRTF);
+   if (rb)
+   {
+      rb->set_format(rb, AAX_PCM24S, true);
+      rb->set_parami(rb, RB_NO_TRACKS, 2);
+      rb->set_paramf(rb, RB_FREQUENCY, SAMPLE_FREQUENCY);
+      rb->set_parami(rb, RB_NO_SAMPLES, NO_SAMPLES);
+      rb->init(rb, true);
+
+      set1 = _aaxRingBufferHRIRLoad(FILENAME, false);
+      if (set1)
+      {
+         rv = test_hrir(rb, "nearest", 90.0f, 90.0f, 10.0f, 100,
+                        left, left_gain, left, left_gain);
+         rv |= test_hrir(rb, "tail", 90.0f, 90.0f, 0.0f, NO_SAMPLES-4,
+                         left, left_gain, left, left_gain);
+         set2 = _aaxRingBufferHRIRLoad(FILENAME, true);
+         if (set2)
+         {
+            rv |= test_hrir(rb, "bilinear", 45.0f, 45.0f, 0.0f, 500,
+                            front_left, front_left_gain,
+                            front_left, front_left_gain);
+
+            // the tails of both directions are kept
+            rv |= test_hrir(rb, "crossfade", 90.0f, 45.0f, 0.0f, NO_SAMPLES-6,
+                            left, left_gain, front_left, front_left_gain);
+
+            // the set stays loaded until the last user unloads it
+            _aaxRingBufferHRIRUnload(set2);
+            rv |= test_hrir(rb, "unload", 45.0f, 45.0f, 0.0f, 500,
+                            front_left, front_left_gain,
+                            front_left, front_left_gain);
+         }
+         _aaxRingBufferHRIRUnload(set1);
+         rbi = rb->handle;
+         if (_aaxRingBufferHRIRMix(rbi->sample, NULL, NULL, NULL, 0, 0,
+                                   NO_SAMPLES, 1.0f, 1.0f, 1.0f))
+         {
+            printf("unload: the HRIR set is still used\n");
+            rv = -1;
+         }
+      }
+      else {
+         printf("Unable to load %s\n", FILENAME);
+      }
+      rb->destroy(rb);
+   }
+   remove(FILENAME);
+
+   if (!rv) printf("HRIR rendering passed\n");
+
+   return rv;
+}
@@ -0,0 +1,355 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <base/xthreads.h>
+#include <stream/io.h>
+
+#define FILE_SIZE		(1536*1024+123)
+#define READ_SIZE		10000
+#define BUFFER_SIZE		65536
+
+#define FAIL_POS		1000000
+
+/*
+ * A stand-in for a HTTP server which serves FILE_SIZE bytes of a pattern
+ * with byte range and keep-alive support. /ignore.raw advertises byte
+ * ranges but always sends the complete file, /fail.raw breaks off a range
+ * request with an end position which includes FAIL_POS and /moved.raw
+ * redirects to /test4.raw.
+ */
+static atomic_int connections;
+static atomic_int requests;
+static int server_port;
+
+static unsigned char
+pattern(size_t pos)
+{
+   return (pos*7 + pos/251) & 0xFF;
+}
+
+static int
+serve_connection(void *arg)
+{
+   int fd = (int)(intptr_t)arg;
+   char request[2048];
+   int len = 0;
+
+   do
+   {
+      char *end, header[256], body[16384];
+      unsigned long first = 0, last = FILE_SIZE-1;
+      bool partial = false, fail = false;
+      ssize_t res;
+      size_t pos;
+      char *s;
+
+      res = recv(fd, request+len, sizeof(request)-1-len, 0);
+      if (res <= 0) break;
+
+      len += res;
+      request[len] = '\0';
+      end = strstr(request, "\r\n\r\n");
+      if (!end) continue;
+
+      atomic_fetch_add(&requests, 1);
+      if (strstr(request, "/moved.raw"))
+      {
+         snprintf(header, sizeof(header), "HTTP/1.1 301 Moved Permanently\r\n"
+                  "Location: http://127.0.0.1:%i/test4.raw\r\n"
+                  "Content-Length: 0\r\n\r\n", server_port);
+         send(fd, header, strlen(header), MSG_NOSIGNAL);
+         break;
+      }
+
+      s = strstr(request, "Range: bytes=");
+      if (s && !strstr(request, "/ignore.raw"))
+      {
+         int n = sscanf(s, "Range: bytes=%lu-%lu", &first, &last);
+         if (n < 2 || last >= FILE_SIZE) last = FILE_SIZE-1;
+         else if (strstr(request, "/fail.raw")) {
+            fail = (first <= FAIL_POS && FAIL_POS <= last);
+         }
+         partial = true;
+      }
+
+      if (partial) {
+         snprintf(header, sizeof(header), "HTTP/1.1 206 Partial Content\r\n"
+                 "Content-Range: bytes %lu-%lu/%u\r\n", first, last, FILE_SIZE);
+      } else {
+         snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\n");
+      }
+      send(fd, header, strlen(header), MSG_NOSIGNAL);
+
+      snprintf(header, sizeof(header), "Content-Type: application/octet-stream\r\n"
+              "Accept-Ranges: bytes\r\n"
+              "Content-Length: %lu\r\n"
+              "Connection: keep-alive\r\n\r\n", last-first+1);
+      send(fd, header, strlen(header), MSG_NOSIGNAL);
+
+      if (fail) last = first + (last-first)/2;
+      for (pos=first; pos<=last; )
+      {
+         size_t i, n = last+1 - pos;
+         if (n > sizeof(body)) n = sizeof(body);
+         for (i=0; i<n; ++i) body[i] = pattern(pos+i);
+         res = send(fd, body, n, MSG_NOSIGNAL);
+         if (res <= 0) break;
+         pos += res;
+      }
+      if (pos <= last || fail) break;
+
+      len -= (end+4 - request);
+      memmove(request, end+4, len);
+   }
+   while (1);
+
+   close(fd);
+   return 0;
+}
+
+static int
+serve(void *arg)
+{
+   int lfd = (int)(intptr_t)arg;
+
+   do
+   {
+      int fd = accept(lfd, NULL, NULL);
+      if (fd >= 0)
+      {
+         thrd_t thread;
+
+         atomic_fetch_add(&connections, 1);
+         if (thrd_create(&thread, serve_connection, (void*)(intptr_t)fd) == thrd_success) {
+            thrd_detach(thread);
+         } else {
+            close(fd);
+         }
+      }
+   }
+   while (1);
+
+   return 0;
+}
+
+static int
+start_server(void)
+{
+   struct sockaddr_in addr;
+   socklen_t alen = sizeof(addr);
+   thrd_t thread;
+   int fd;
+
+   fd = socket(AF_INET, SOCK_STREAM, 0);
+   if (fd < 0) return -1;
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   addr.sin_port = 0;
+   if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+       listen(fd, 16) < 0 ||
+       getsockname(fd, (struct sockaddr*)&addr, &alen) < 0)
+   {
+      close(fd);
+      return -1;
+   }
+
+   if (thrd_create(&thread, serve, (void*)(intptr_t)fd) != thrd_success)
+   {
+      close(fd);
+      return -1;
+   }
+   thrd_detach(thread);
+
+   server_port = ntohs(addr.sin_port);
+   return server_port;
+}
+
+static _io_t*
+open_stream(int port, const char *path, _data_t *buf)
+{
+   _io_t *io = _io_create(PROTOCOL_HTTP);
+   if (io)
+   {
+      io->set_param(io, __F_NO_BYTES, BUFFER_SIZE);
+      io->set_param(io, __F_PORT, port);
+      if (io->open(io, buf, "127.0.0.1", path) < 0)
+      {
+         printf("Unable to open http://127.0.0.1:%i/%s\n", port, path);
+         io = _io_free(io);
+      }
+   }
+   return io;
+}
+
+/* Read and verify up to size bytes starting at pos, returns the number read */
+static ssize_t
+read_check(_io_t *io, _data_t *buf, size_t pos, size_t size)
+{
+   size_t num = 0;
+
+   while (num < size)
+   {
+      ssize_t res = io->read(io, buf, size-num);
+      unsigned char *data = _aaxDataGetData(buf, 0);
+      size_t i, avail = _aaxDataGetDataAvail(buf, 0);
+
+      for (i=0; i<avail; ++i)
+      {
+         if (data[i] != pattern(pos+num+i))
+         {
+            printf("data mismatch at byte %zu\n", pos+num+i);
+            return -1;
+         }
+      }
+      num += avail;
+      _aaxDataClear(buf, 0);
+
+      if (res < 0) break;
+   }
+
+   return num;
+}
+
+static int
+test_stream(int port, const char *path, _data_t *buf)
+{
+   static const size_t seek[] = { 700000, 1000, FILE_SIZE-5000, 300000 };
+   _io_t *io;
+   int i, rv = -1;
+
+   io = open_stream(port, path, buf);
+   if (!io) return rv;
+
+   if (io->get_param(io, __F_POSITION) != 0)
+   {
+      printf("%s: stream is not seekable\n", path);
+      goto out;
+   }
+
+   if (read_check(io, buf, 0, READ_SIZE) != READ_SIZE) goto out;
+
+   for (i=0; i<sizeof(seek)/sizeof(seek[0]); ++i)
+   {
+      size_t pos = seek[i];
+      size_t size = _MIN(READ_SIZE, FILE_SIZE-pos);
+
+      if (io->set_param(io, __F_POSITION, pos) != pos)
+      {
+         printf("%s: seek to %zu failed\n", path, pos);
+         goto out;
+      }
+      if (read_check(io, buf, pos, size) != size) goto out;
+      if (io->get_param(io, __F_POSITION) != pos+size)
+      {
+         printf("%s: wrong position after reading\n", path);
+         goto out;
+      }
+   }
+
+   // read up to the end of the file
+   i = read_check(io, buf, 300000+READ_SIZE, FILE_SIZE);
+   if (i != FILE_SIZE-(300000+READ_SIZE))
+   {
+      printf("%s: read %i bytes up to the end of the file\n", path, i);
+      goto out;
+   }
+   rv = 0;
+
+out:
+   io->close(io);
+   _io_free(io);
+   return rv;
+}
+
+int main()
+{
+   _data_t *buf;
+   int port, num, req, rv = -1;
+
+   port = start_server();
+   if (port < 0)
+   {
+      printf("Unable to start the HTTP server\n");
+      return 0; // no networking available
+   }
+
+   buf = _aaxDataCreate(1, BUFFER_SIZE, 1);
+   if (!buf) return -1;
+
+   // seeking with range requests
+   if (test_stream(port, "test.raw", buf) < 0) goto out;
+
+   // a fully read response leaves the connection open for the next one
+   num = atomic_load(&connections);
+   req = atomic_load(&requests);
+   if (test_stream(port, "test2.raw", buf) < 0) goto out;
+   if (atomic_load(&connections) - num >= atomic_load(&requests) - req)
+   {
+      printf("The idle connection was not reused\n");
+      goto out;
+   }
+
+   // a server which ignores the range request
+   if (test_stream(port, "ignore.raw", buf) < 0) goto out;
+
+   // parallel segment prefetch
+   setenv("AAX_STREAM_HTTP_SEGMENTS", "3", 1);
+   if (test_stream(port, "test3.raw", buf) < 0) goto out;
+
+   // a failed segment continues over a single new connection
+   if (test_stream(port, "fail.raw", buf) < 0) goto out;
+   unsetenv("AAX_STREAM_HTTP_SEGMENTS");
+
+   // a redirect to another resource
+   if (test_stream(port, "moved.raw", buf) < 0) goto out;
+
+   rv = 0;
+
+out:
+   _aaxDataDestroy(buf);
+   return rv;
+}
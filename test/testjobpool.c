@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include <base/jobpool.h>
+#include <base/random.h>
+#include <base/timer.h>
+
+#define NO_WORKERS		4
+#define NO_JOBS			64
+#define NO_NESTED		8
+#define NO_VALUES		1024
+
+static _aaxJobPool *pool;
+static atomic_int counter;
+static atomic_int blocked;
+static atomic_int order[4];
+
+static int
+count_job(void *d)
+{
+   atomic_fetch_add(&counter, 1);
+   return (d == NULL);
+}
+
+static int
+nested_job(void *d)
+{
+   _aaxJobGroup group;
+   int i;
+
+   _aaxJobGroupInit(&group);
+   for (i=0; i<NO_NESTED; ++i) {
+      _aaxJobPoolAdd(pool, &group, count_job, NULL);
+   }
+   return _aaxJobPoolWait(pool, &group);
+}
+
+static int
+seeded_job(void *d)
+{
+   uint64_t *values = d;
+   int i;
+
+   _aax_srand(0x27918072);
+   for (i=0; i<NO_VALUES; ++i) {
+      values[i] = _aax_rand();
+   }
+   return 1;
+}
+
+static int
+blocking_job(void *d)
+{
+   atomic_store(&blocked, 1);
+   while (atomic_load(&blocked) == 1) {
+      msecSleep(1);
+   }
+   return 1;
+}
+
+static int
+order_job(void *d)
+{
+   int n = atomic_fetch_add(&counter, 1);
+   atomic_store(&order[n], (int)(size_t)d);
+   return 1;
+}
+
+/* jobs with a lower priority value run first, the pool has one worker */
+static int
+run_priority(const char *name)
+{
+   _aaxJobGroup group;
+   int rv = 0;
+
+   atomic_store(&counter, 0);
+   atomic_store(&blocked, 0);
+   _aaxJobGroupInit(&group);
+   _aaxJobPoolAddPriority(pool, &group, blocking_job, NULL, 0);
+   while (atomic_load(&blocked) == 0) {
+      msecSleep(1);
+   }
+
+   _aaxJobPoolAdd(pool, &group, order_job, (void*)4);
+   _aaxJobPoolAddPriority(pool, &group, order_job, (void*)3, 30);
+   _aaxJobPoolAddPriority(pool, &group, order_job, (void*)1, 10);
+   _aaxJobPoolAddPriority(pool, &group, order_job, (void*)2, 20);
+   atomic_store(&blocked, 2);
+   _aaxJobPoolWait(pool, &group);
+
+   if (atomic_load(&order[0]) != 1 || atomic_load(&order[1]) != 2 ||
+       atomic_load(&order[2]) != 3 || atomic_load(&order[3]) != 4)
+   {
+      printf("%s: jobs executed in the wrong order: %i %i %i %i\n", name,
+             atomic_load(&order[0]), atomic_load(&order[1]),
+             atomic_load(&order[2]), atomic_load(&order[3]));
+      rv = -1;
+   }
+
+   return rv;
+}
+
+/* waiting for one group runs its queued jobs but not those of other groups */
+static int
+run_own(const char *name)
+{
+   _aaxJobGroup busy, other, own;
+   int rv = 0;
+
+   atomic_store(&counter, 0);
+   atomic_store(&blocked, 0);
+   _aaxJobGroupInit(&busy);
+   _aaxJobPoolAdd(pool, &busy, blocking_job, NULL);
+   while (atomic_load(&blocked) == 0) {
+      msecSleep(1);
+   }
+
+   _aaxJobGroupInit(&other);
+   _aaxJobGroupInit(&own);
+   _aaxJobPoolAdd(pool, &other, order_job, (void*)2);
+   _aaxJobPoolAdd(pool, &own, order_job, (void*)1);
+   _aaxJobPoolWaitOwn(pool, &own);
+
+   if (atomic_load(&counter) != 1 || atomic_load(&order[0]) != 1)
+   {
+      printf("%s: %i jobs executed, the first was job %i\n", name,
+              atomic_load(&counter), atomic_load(&order[0]));
+      rv = -1;
+   }
+
+   atomic_store(&blocked, 2);
+   _aaxJobPoolWait(pool, &other);
+   _aaxJobPoolWaitOwn(pool, &busy);
+   if (atomic_load(&counter) != 2)
+   {
+      printf("%s: %i of 2 jobs finished\n", name, atomic_load(&counter));
+      rv = -1;
+   }
+
+   return rv;
+}
+
+static int
+run(const char *name)
+{
+   static uint64_t values[NO_JOBS][NO_VALUES];
+   _aaxJobGroup group;
+   int i, rv = 0;
+
+   atomic_store(&counter, 0);
+   _aaxJobGroupInit(&group);
+   for (i=0; i<NO_JOBS; ++i) {
+      _aaxJobPoolAdd(pool, &group, count_job, NULL);
+   }
+   if (!_aaxJobPoolWait(pool, &group) || atomic_load(&counter) != NO_JOBS)
+   {
+      printf("%s: %i of %i jobs finished\n", name, atomic_load(&counter), NO_JOBS);
+      rv = -1;
+   }
+
+   _aaxJobGroupInit(&group);
+   _aaxJobPoolAdd(pool, &group, count_job, NULL);
+   _aaxJobPoolAdd(pool, &group, count_job, &group);
+   if (_aaxJobPoolWait(pool, &group) != false)
+   {
+      printf("%s: a failed job was not reported\n", name);
+      rv = -1;
+   }
+
+   atomic_store(&counter, 0);
+   _aaxJobGroupInit(&group);
+   for (i=0; i<NO_JOBS; ++i) {
+      _aaxJobPoolAdd(pool, &group, nested_job, NULL);
+   }
+   if (!_aaxJobPoolWait(pool, &group) ||
+       atomic_load(&counter) != NO_JOBS*NO_NESTED)
+   {
+      printf("%s: %i of %i nested jobs finished\n", name,
+              atomic_load(&counter), NO_JOBS*NO_NESTED);
+      rv = -1;
+   }
+
+   _aaxJobGroupInit(&group);
+   for (i=0; i<NO_JOBS; ++i) {
+      _aaxJobPoolAdd(pool, &group, seeded_job, values[i]);
+   }
+   _aaxJobPoolWait(pool, &group);
+   for (i=1; i<NO_JOBS; ++i)
+   {
+      if (memcmp(values[0], values[i], NO_VALUES*sizeof(uint64_t)))
+      {
+         printf("%s: seeded random values of job %i differ\n", name, i);
+         rv = -1;
+         break;
+      }
+   }
+
+   return rv;
+}
+
+int main()
+{
+   int rv;
+
+   pool = NULL;
+   rv = run("synchronous");
+
+   pool = _aaxJobPoolCreate(NO_WORKERS, "testjobpool");
+   if (pool)
+   {
+      rv |= run("job pool");
+      _aaxJobPoolDestroy(pool);
+   }
+   else
+   {
+      printf("Unable to create the job pool\n");
+      rv = -1;
+   }
+
+   pool = _aaxJobPoolCreate(1, "testjobpool");
+   if (pool)
+   {
+      rv |= run_priority("priority");
+      rv |= run_own("own group");
+      _aaxJobPoolDestroy(pool);
+   }
+   else
+   {
+      printf("Unable to create the job pool\n");
+      rv = -1;
+   }
+
+   if (rv == 0) printf("Job pool test passed\n");
+
+   return rv;
+}
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <aax/aax.h>
+
+#include <backends/driver.h>
+#include <stream/device.h>
+
+#define FILENAME		"testmp3.mp3"
+#define NO_TRACKS		2
+#define FRAME_SAMPLES		1152
+#define FRAME_SIZE		417	/* 128 kbps at 44.1 kHz */
+#define SIDE_INFO		32	/* MPEG-1 stereo */
+#define NO_FRAMES		40
+#define DECODER_DELAY		529
+#define ENCODER_DELAY		576
+#define NO_SAMPLES		(NO_FRAMES*FRAME_SAMPLES-ENCODER_DELAY-ENCODER_PADDING)
+#define MAX_SAMPLES		((NO_FRAMES+1)*FRAME_SAMPLES)
+
+/* The internal decoder leaves the frames in the last 1152 bytes of a file */
+/* undecoded, the padding must cover them for the end trimming to show.   */
+#define ENCODER_PADDING		3000
+
+typedef struct
+{
+   uint8_t *data;
+   size_t bit;
+} bits_t;
+
+static void
+put_bits(bits_t *b, uint32_t v, int n)
+{
+   while (n--)
+   {
+      if ((v >> n) & 1) b->data[b->bit >> 3] |= 0x80 >> (b->bit & 7);
+      b->bit++;
+   }
+}
+
+static void
+put32be(uint8_t *p, uint32_t v)
+{
+   p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+/*
+ * MPEG-1 Layer III frames with a single spectral line in every granule of
+ * both channels: Huffman table 1 with the pair (1,0), no scale factors.
+ * The first frame is silent and holds the Info header, and optionally the
+ * LAME tag with the encoder delay and padding.
+ */
+static int
+write_mp3(const char *file, int lame_tag)
+{
+   static const uint8_t header[4] = { 0xFF, 0xFB, 0x90, 0x00 };
+   uint8_t frame[FRAME_SIZE];
+   int gr, ch, i;
+   bits_t b;
+   FILE *fp;
+
+   fp = fopen(file, "wb");
+   if (!fp) return -1;
+
+   memset(frame, 0, FRAME_SIZE);
+   memcpy(frame, header, 4);
+   memcpy(frame+4+SIDE_INFO, "Info", 4);
+   put32be(frame+4+SIDE_INFO+4, 0x1);		// the frames field is present
+   put32be(frame+4+SIDE_INFO+8, NO_FRAMES);
+   if (lame_tag)
+   {
+      uint8_t *tag = frame+4+SIDE_INFO+12;
+
+      memcpy(tag, "LAME3.100", 9);
+      tag[21] = ENCODER_DELAY >> 4;
+      tag[22] = ((ENCODER_DELAY & 0xF) << 4) | (ENCODER_PADDING >> 8);
+      tag[23] = ENCODER_PADDING & 0xFF;
+   }
+   fwrite(frame, 1, FRAME_SIZE, fp);
+
+   memset(frame, 0, FRAME_SIZE);
+   memcpy(frame, header, 4);
+
+   b.data = frame+4;
+   b.bit = 0;
+   put_bits(&b, 0, 9);			// main_data_begin
+   put_bits(&b, 0, 3);			// private bits
+   put_bits(&b, 0, 8);			// scfsi
+   for (gr=0; gr<2; ++gr) {
+      for (ch=0; ch<NO_TRACKS; ++ch)
+      {
+         put_bits(&b, 3, 12);		// part2_3_length
+         put_bits(&b, 1, 9);		// big_values
+         put_bits(&b, 210, 8);		// global_gain: 1.0
+         put_bits(&b, 0, 4);		// scalefac_compress
+         put_bits(&b, 0, 1);		// window_switching_flag
+         put_bits(&b, 1, 5);		// table_select[0]
+         put_bits(&b, 0, 5);
+         put_bits(&b, 0, 5);
+         put_bits(&b, 0, 4);		// region0_count
+         put_bits(&b, 0, 3);		// region1_count
+         put_bits(&b, 0, 3);		// preflag, scalefac_scale, count1
+      }
+   }
+
+   b.data = frame+4+SIDE_INFO;
+   b.bit = 0;
+   for (i=0; i<2*NO_TRACKS; ++i)
+   {
+      put_bits(&b, 0x1, 2);		// (1,0)
+      put_bits(&b, 0, 1);		// positive
+   }
+
+   for (i=0; i<NO_FRAMES; ++i) {
+      fwrite(frame, 1, FRAME_SIZE, fp);
+   }
+   fclose(fp);
+
+   return 0;
+}
+
+/* Decode the file the way the sensor does and return the no. samples. */
+static size_t
+decode(const char *file, int32_t **data)
+{
+   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
+   float refrate = 50.0f, period_rate = 50.0f, rate = 44100.0f;
+   unsigned int tracks = NO_TRACKS;
+   int fmt = AAX_PCM24S, brate = 0;
+   int empty = 0;
+   size_t rv = 0;
+   ssize_t res;
+   void *id;
+
+   id = stream->new_handle(AAX_MODE_READ);
+   id = stream->connect(NULL, id, NULL, file, AAX_MODE_READ);
+   if (id && stream->setup(id, &refrate, &fmt, &tracks, &rate, &brate,
+                           false, period_rate))
+   {
+      do
+      {
+         ssize_t offs = rv;
+         size_t frames = MAX_SAMPLES - rv;
+
+         res = stream->capture(id, (void**)data, &offs, &frames, NULL, 0,
+                               1.0f, true);
+         rv += frames;
+         if (frames) empty = 0;
+         else if (++empty == 8) break;
+      }
+      while (res >= 0 && rv < MAX_SAMPLES);
+   }
+   else {
+      printf("Unable to open %s\n", file);
+   }
+   if (id) stream->disconnect(id);
+
+   return rv;
+}
+
+/*
+ * Without the LAME tag every decoded frame is returned, starting with the
+ * Info frame as a frame of silence. With the tag the encoder delay, the
+ * decoder delay and the padding are dropped: the output must match the
+ * untrimmed output from the first sample after those.
+ */
+int main()
+{
+   int32_t *ref[NO_TRACKS], *out[NO_TRACKS];
+   size_t i, num, rnum, start, end;
+   int t, rv = -1;
+
+   for (t=0; t<NO_TRACKS; ++t)
+   {
+      ref[t] = calloc(MAX_SAMPLES, sizeof(int32_t));
+      out[t] = calloc(MAX_SAMPLES, sizeof(int32_t));
+   }
+
+   if (write_mp3(FILENAME, false) < 0)
+   {
+      printf("Unable to write %s\n", FILENAME);
+      goto done;
+   }
+   rnum = decode(FILENAME, ref);
+
+   start = FRAME_SAMPLES + ENCODER_DELAY + DECODER_DELAY;
+   end = (NO_FRAMES+1)*FRAME_SAMPLES - ENCODER_PADDING + DECODER_DELAY;
+   if (rnum < end)
+   {
+      printf("no LAME tag: %zu samples, at least %zu expected\n", rnum, end);
+      goto done;
+   }
+   for (i=0; i<FRAME_SAMPLES; ++i) {
+      if (ref[0][i]) break;
+   }
+   if (i < FRAME_SAMPLES)
+   {
+      printf("no LAME tag: the Info frame is not silent at sample %zu\n", i);
+      goto done;
+   }
+
+   write_mp3(FILENAME, true);
+   num = decode(FILENAME, out);
+   if (num != NO_SAMPLES)
+   {
+      printf("LAME tag: %zu samples instead of %i\n", num, NO_SAMPLES);
+      goto done;
+   }
+
+   rv = 0;
+   for (t=0; t<NO_TRACKS && !rv; ++t) {
+      for (i=0; i<num; ++i) {
+         if (out[t][i] != ref[t][start+i])
+         {
+            printf("LAME tag: track %i, sample %zu differs\n", t, i);
+            rv = -1;
+            break;
+         }
+      }
+   }
+
+done:
+   remove(FILENAME);
+   for (t=0; t<NO_TRACKS; ++t)
+   {
+      free(ref[t]);
+      free(out[t]);
+   }
+   return rv;
+}
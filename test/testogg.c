@@ -0,0 +1,1275 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include <aax/aax.h>
+
+#include <backends/driver.h>
+#include <stream/device.h>
+#include <stream/extension.h>
+
+#define FILENAME		"testogg.ogg"
+#define SPLITNAME		"testogg-split.ogg"
+#define CHAINNAME		"testogg-chain.ogg"
+#define LINKNAME		"testogg-link.ogg"
+#define OPUSNAME		"testogg.opus"
+#define WAVNAME			"testogg.wav"
+#define FS			44100
+#define NO_TRACKS		2
+#define NO_PACKETS		400
+#define PACKETS_PER_PAGE	16
+#define BLOCKSIZE		256	/* short blocks only */
+#define PACKET_SAMPLES		(BLOCKSIZE/2)
+#define NO_SAMPLES		((NO_PACKETS-1)*PACKET_SAMPLES)
+#define MAX_PACKET_SIZE		4096
+#define MAX_PAGE_BODY		(255*255)
+#define PERIOD_FRAMES		1024	/* frames captured at once */
+#define IDENT_PAGE_CRC		0xBEB19D3D	/* for serial number 0x1234 */
+
+/*
+ * A minimal Vorbis encoder for test streams: one floor1 without partitions
+ * and one residue with a 16 entry VQ book. The packets are filled with
+ * pseudo random values so every part of the decoded stream differs.
+ */
+typedef struct
+{
+   uint8_t data[MAX_PACKET_SIZE];
+   size_t bit;
+} packet_t;
+
+static void
+put_bits(packet_t *p, uint32_t v, int n)
+{
+   int i;
+   for (i=0; i<n; ++i, ++p->bit)
+   {
+      if ((p->bit & 7) == 0) p->data[p->bit >> 3] = 0;
+      if ((v >> i) & 1) p->data[p->bit >> 3] |= 1 << (p->bit & 7);
+   }
+}
+
+/* Huffman codewords are stored with their most significant bit first */
+static void
+put_codeword(packet_t *p, uint32_t entry, int len)
+{
+   while (len--) put_bits(p, entry >> len, 1);
+}
+
+static void
+put_bytes(packet_t *p, const char *s, size_t len)
+{
+   while (len--) put_bits(p, (uint8_t)*s++, 8);
+}
+
+static size_t
+packet_size(packet_t *p) {
+   return (p->bit + 7) >> 3;
+}
+
+static size_t
+vorbis_ident(packet_t *p)
+{
+   p->bit = 0;
+   put_bytes(p, "\1vorbis", 7);
+   put_bits(p, 0, 32);			// version
+   put_bits(p, NO_TRACKS, 8);
+   put_bits(p, FS, 32);
+   put_bits(p, 0, 32);			// maximum bitrate
+   put_bits(p, 0, 32);			// nominal bitrate
+   put_bits(p, 0, 32);			// minimum bitrate
+   put_bits(p, 8, 4);			// blocksize_0: 256
+   put_bits(p, 8, 4);			// blocksize_1: 256
+   put_bits(p, 1, 8);			// framing
+   return packet_size(p);
+}
+
+static size_t
+vorbis_comment(packet_t *p)
+{
+   p->bit = 0;
+   put_bytes(p, "\3vorbis", 7);
+   put_bits(p, 7, 32);
+   put_bytes(p, "testogg", 7);
+   put_bits(p, 0, 32);			// no comments
+   put_bits(p, 1, 8);			// framing
+   return packet_size(p);
+}
+
+static size_t
+vorbis_setup(packet_t *p)
+{
+   int i;
+
+   p->bit = 0;
+   put_bytes(p, "\5vorbis", 7);
+
+   put_bits(p, 2-1, 8);			// codebooks
+
+   // book 0: residue classification, two classes
+   put_bits(p, 0x564342, 24);
+   put_bits(p, 1, 16);			// dimensions
+   put_bits(p, 2, 24);			// entries
+   put_bits(p, 0, 1);			// not ordered
+   put_bits(p, 0, 1);			// not sparse
+   for (i=0; i<2; ++i) put_bits(p, 1-1, 5);
+   put_bits(p, 0, 4);			// no lookup
+
+   // book 1: residue values -8 .. 7
+   put_bits(p, 0x564342, 24);
+   put_bits(p, 1, 16);
+   put_bits(p, 16, 24);
+   put_bits(p, 0, 1);
+   put_bits(p, 0, 1);
+   for (i=0; i<16; ++i) put_bits(p, 4-1, 5);
+   put_bits(p, 1, 4);			// lookup type 1
+   put_bits(p, 0x80000000 | (791 << 21) | 1, 32);	// minimum: -8.0
+   put_bits(p, (788 << 21) | 1, 32);			// delta: 1.0
+   put_bits(p, 4-1, 4);			// value bits
+   put_bits(p, 0, 1);			// no sequence
+   for (i=0; i<16; ++i) put_bits(p, i, 4);
+
+   put_bits(p, 1-1, 6);			// time domain transforms
+   put_bits(p, 0, 16);
+
+   put_bits(p, 1-1, 6);			// floors
+   put_bits(p, 1, 16);			// floor type 1
+   put_bits(p, 0, 5);			// no partitions
+   put_bits(p, 2-1, 2);			// multiplier: range 128
+   put_bits(p, 7, 4);			// rangebits: BLOCKSIZE/2
+
+   put_bits(p, 1-1, 6);			// residues
+   put_bits(p, 1, 16);			// residue type 1
+   put_bits(p, 0, 24);			// begin
+   put_bits(p, BLOCKSIZE/2, 24);	// end
+   put_bits(p, 32-1, 24);		// partition size
+   put_bits(p, 2-1, 6);			// classifications
+   put_bits(p, 0, 8);			// classbook
+   put_bits(p, 0, 3);			// class 0: silent
+   put_bits(p, 0, 1);
+   put_bits(p, 1, 3);			// class 1: book 1 in the first pass
+   put_bits(p, 0, 1);
+   put_bits(p, 1, 8);
+
+   put_bits(p, 1-1, 6);			// mappings
+   put_bits(p, 0, 16);			// mapping type 0
+   put_bits(p, 0, 1);			// one submap
+   put_bits(p, 0, 1);			// no coupling
+   put_bits(p, 0, 2);			// reserved
+   put_bits(p, 0, 8);			// time
+   put_bits(p, 0, 8);			// floor
+   put_bits(p, 0, 8);			// residue
+
+   put_bits(p, 1-1, 6);			// modes
+   put_bits(p, 0, 1);			// short block
+   put_bits(p, 0, 16);			// window type
+   put_bits(p, 0, 16);			// transform type
+   put_bits(p, 0, 8);			// mapping
+
+   put_bits(p, 1, 1);			// framing
+   return packet_size(p);
+}
+
+static uint32_t
+test_random(uint32_t *seed)
+{
+   *seed = *seed*1103515245 + 12345;
+   return (*seed >> 16) & 0x7FFF;
+}
+
+static size_t
+vorbis_audio(packet_t *p, uint32_t *seed)
+{
+   int cls[NO_TRACKS];
+   int t, part, i;
+
+   p->bit = 0;
+   put_bits(p, 0, 1);			// audio packet, mode 0
+   for (t=0; t<NO_TRACKS; ++t)
+   {
+      put_bits(p, 1, 1);			// floor in use
+      put_bits(p, 40 + test_random(seed) % 40, 7);
+      put_bits(p, 40 + test_random(seed) % 40, 7);
+   }
+
+   for (part=0; part<(BLOCKSIZE/2)/32; ++part)
+   {
+      for (t=0; t<NO_TRACKS; ++t)
+      {
+         cls[t] = (test_random(seed) % 8) ? 1 : 0;
+         put_codeword(p, cls[t], 1);
+      }
+      for (t=0; t<NO_TRACKS; ++t) {
+         if (cls[t]) {
+            for (i=0; i<32; ++i) {
+               put_codeword(p, test_random(seed) % 16, 4);
+            }
+         }
+      }
+   }
+   return packet_size(p);
+}
+
+/* Ogg pages, the checksum is calculated the slow way on purpose */
+typedef struct
+{
+   FILE *fp;
+   uint32_t serial;
+   uint32_t sequence;
+   uint64_t granule;
+   char bos;
+   char continued;
+   size_t max_body;
+   size_t body_size;
+   int segments;
+   uint8_t lacing[255];
+   uint8_t body[MAX_PAGE_BODY];
+} ogg_t;
+
+static uint32_t
+ogg_crc(uint32_t crc, const uint8_t *p, size_t len)
+{
+   int i;
+   while (len--)
+   {
+      crc ^= (uint32_t)*p++ << 24;
+      for (i=0; i<8; ++i) {
+         crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04c11db7 : crc << 1;
+      }
+   }
+   return crc;
+}
+
+static void
+put32le(uint8_t *p, uint32_t v)
+{
+   p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static void
+ogg_flush(ogg_t *o, char eos)
+{
+   uint8_t header[27+255];
+   size_t size = 27 + o->segments;
+   uint32_t crc;
+
+   memcpy(header, "OggS", 4);
+   header[4] = 0;
+   header[5] = (o->continued ? 1 : 0) | (o->bos ? 2 : 0) | (eos ? 4 : 0);
+   put32le(header+6, o->granule);
+   put32le(header+10, o->granule >> 32);
+   put32le(header+14, o->serial);
+   put32le(header+18, o->sequence++);
+   put32le(header+22, 0);
+   header[26] = o->segments;
+   memcpy(header+27, o->lacing, o->segments);
+
+   crc = ogg_crc(0, header, size);
+   crc = ogg_crc(crc, o->body, o->body_size);
+   put32le(header+22, crc);
+
+   fwrite(header, 1, size, o->fp);
+   fwrite(o->body, 1, o->body_size, o->fp);
+
+   o->bos = 0;
+   o->continued = 0;
+   o->granule = -1;
+   o->segments = 0;
+   o->body_size = 0;
+}
+
+/* Packets are split across pages when they do not fit in max_body. */
+static void
+ogg_packet(ogg_t *o, const packet_t *p, uint64_t granule)
+{
+   size_t n, pos = 0, size = packet_size((packet_t*)p);
+
+   do
+   {
+      n = size - pos;
+      if (n > 255) n = 255;
+      if (o->segments == 255 || o->body_size + n > o->max_body)
+      {
+         ogg_flush(o, 0);
+         o->continued = (pos > 0);
+      }
+      o->lacing[o->segments++] = n;
+      memcpy(o->body + o->body_size, p->data + pos, n);
+      o->body_size += n;
+      pos += n;
+   }
+   while (n == 255);
+   o->granule = granule;
+}
+
+static void
+ogg_init(ogg_t *o, FILE *fp, uint32_t serial, size_t max_body)
+{
+   memset(o, 0, sizeof(ogg_t));
+   o->fp = fp;
+   o->serial = serial;
+   o->bos = 1;
+   o->granule = -1;
+   o->max_body = max_body;
+}
+
+/*
+ * Write a logical Vorbis stream of no_packets audio packets. The granule
+ * position of the last page drops end_trim samples of the final packet.
+ * Audio packets are padded with zeros up to pad bytes, which the decoder
+ * ignores, to have packets which continue on the next page.
+ */
+static void
+write_vorbis(FILE *fp, uint32_t serial, uint32_t seed, size_t max_body, size_t pad, int no_packets, int end_trim)
+{
+   packet_t p;
+   ogg_t o;
+   int i;
+
+   ogg_init(&o, fp, serial, max_body);
+
+   vorbis_ident(&p);
+   ogg_packet(&o, &p, 0);
+   ogg_flush(&o, 0);
+
+   vorbis_comment(&p);
+   ogg_packet(&o, &p, 0);
+   vorbis_setup(&p);
+   ogg_packet(&o, &p, 0);
+   ogg_flush(&o, 0);
+
+   for (i=0; i<no_packets; ++i)
+   {
+      uint64_t granule = (uint64_t)i*PACKET_SAMPLES;
+      vorbis_audio(&p, &seed);
+      while (packet_size(&p) < pad) put_bits(&p, 0, 8);
+      if (i == no_packets-1) granule -= end_trim;
+      ogg_packet(&o, &p, granule);
+      if (i == no_packets-1) ogg_flush(&o, 1);
+      else if ((i % PACKETS_PER_PAGE) == PACKETS_PER_PAGE-1) ogg_flush(&o, 0);
+   }
+}
+
+static int
+write_ogg(const char *file, size_t max_body, size_t pad)
+{
+   FILE *fp = fopen(file, "wb");
+   if (!fp) return -1;
+
+   write_vorbis(fp, 0x1234, 1, max_body, pad, NO_PACKETS, 0);
+   fclose(fp);
+
+   return 0;
+}
+
+/*
+ * A chained file of two logical streams and the second stream on its own.
+ * The second stream is shorter and drops part of its final packet.
+ */
+#define LINK_PACKETS		150
+#define LINK_END_TRIM		50
+#define LINK_SAMPLES		((LINK_PACKETS-1)*PACKET_SAMPLES-LINK_END_TRIM)
+
+static int
+write_chain(const char *chain, const char *link)
+{
+   FILE *fp = fopen(chain, "wb");
+   if (!fp) return -1;
+
+   write_vorbis(fp, 0x1234, 1, MAX_PAGE_BODY, 0, NO_PACKETS, 0);
+   write_vorbis(fp, 0x5678, 2, MAX_PAGE_BODY, 0, LINK_PACKETS, LINK_END_TRIM);
+   fclose(fp);
+
+   fp = fopen(link, "wb");
+   if (!fp) return -1;
+
+   write_vorbis(fp, 0x5678, 2, MAX_PAGE_BODY, 0, LINK_PACKETS, LINK_END_TRIM);
+   fclose(fp);
+
+   return 0;
+}
+
+/*
+ * An Opus stream of packets without frame data which decode to 20 ms of
+ * silence each. The decoder output starts OPUS_PRE_SKIP samples early and
+ * the granule position of the last page drops OPUS_END_TRIM samples.
+ */
+#define OPUS_PACKETS		100
+#define OPUS_FRAME		960
+#define OPUS_PRE_SKIP		312
+#define OPUS_END_TRIM		500
+#define OPUS_SAMPLES		(OPUS_PACKETS*OPUS_FRAME-OPUS_PRE_SKIP-OPUS_END_TRIM)
+
+static int
+write_opus(const char *file)
+{
+   packet_t p;
+   ogg_t o;
+   FILE *fp;
+   int i;
+
+   fp = fopen(file, "wb");
+   if (!fp) return -1;
+
+   ogg_init(&o, fp, 0x4321, MAX_PAGE_BODY);
+
+   p.bit = 0;
+   put_bytes(&p, "OpusHead", 8);
+   put_bits(&p, 1, 8);			// version
+   put_bits(&p, NO_TRACKS, 8);
+   put_bits(&p, OPUS_PRE_SKIP, 16);
+   put_bits(&p, 48000, 32);
+   put_bits(&p, 0, 16);			// output gain
+   put_bits(&p, 0, 8);			// channel mapping family
+   ogg_packet(&o, &p, 0);
+   ogg_flush(&o, 0);
+
+   p.bit = 0;
+   put_bytes(&p, "OpusTags", 8);
+   put_bits(&p, 7, 32);
+   put_bytes(&p, "testogg", 7);
+   put_bits(&p, 0, 32);			// no comments
+   ogg_packet(&o, &p, 0);
+   ogg_flush(&o, 0);
+
+   for (i=0; i<OPUS_PACKETS; ++i)
+   {
+      uint64_t granule = (uint64_t)(i+1)*OPUS_FRAME;
+
+      p.bit = 0;
+      put_bits(&p, (31 << 3) | 0x4, 8);	// CELT FB 20 ms stereo, one frame
+      if (i == OPUS_PACKETS-1) granule -= OPUS_END_TRIM;
+      ogg_packet(&o, &p, granule);
+      if (i == OPUS_PACKETS-1) ogg_flush(&o, 1);
+      else if ((i % PACKETS_PER_PAGE) == PACKETS_PER_PAGE-1) ogg_flush(&o, 0);
+   }
+   fclose(fp);
+
+   return 0;
+}
+
+static void
+wav16le(FILE *fp, unsigned int v)
+{
+   fputc(v & 0xFF, fp);
+   fputc((v >> 8) & 0xFF, fp);
+}
+
+static void
+wav32le(FILE *fp, unsigned int v)
+{
+   wav16le(fp, v & 0xFFFF);
+   wav16le(fp, v >> 16);
+}
+
+static int
+write_wav(const char *file)
+{
+   int blocksize = NO_TRACKS*2;
+   int datasize = FS*blocksize;
+   FILE *fp;
+   int i;
+
+   fp = fopen(file, "wb");
+   if (!fp) return -1;
+
+   fwrite("RIFF", 1, 4, fp);
+   wav32le(fp, 4 + 24 + 8 + datasize);
+   fwrite("WAVE", 1, 4, fp);
+   fwrite("fmt ", 1, 4, fp);
+   wav32le(fp, 16);
+   wav16le(fp, 1);
+   wav16le(fp, NO_TRACKS);
+   wav32le(fp, FS);
+   wav32le(fp, FS*blocksize);
+   wav16le(fp, blocksize);
+   wav16le(fp, 16);
+   fwrite("data", 1, 4, fp);
+   wav32le(fp, datasize);
+   for (i=0; i<datasize/2; ++i) wav16le(fp, i*37);
+   fclose(fp);
+
+   return 0;
+}
+
+/* Connect the stream driver to a file the way the sensor does. */
+static void*
+stream_open(const char *file)
+{
+   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
+   float refrate = 50.0f, period_rate = 50.0f, rate = FS;
+   unsigned int tracks = NO_TRACKS;
+   int fmt = AAX_PCM24S, brate = 0;
+   void *id;
+
+   id = stream->new_handle(AAX_MODE_READ);
+   id = stream->connect(NULL, id, NULL, file, AAX_MODE_READ);
+   if (id && !stream->setup(id, &refrate, &fmt, &tracks, &rate, &brate,
+                            false, period_rate))
+   {
+      stream->disconnect(id);
+      id = NULL;
+   }
+   return id;
+}
+
+/*
+ * Capture batched the way a buffer is read, or the way the mixer thread
+ * does which does not wait for a stream that is decoded ahead by the pool.
+ */
+static char capture_batched = true;
+
+static size_t
+stream_capture(void *id, void **tracks, size_t no_samples)
+{
+   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
+   int empty = 0, max_empty;
+   size_t rv = 0;
+   ssize_t res;
+
+   /* decoding after a seek may take a few calls before samples return */
+   max_empty = capture_batched ? 8 : 5000;
+   do
+   {
+      ssize_t offs = rv;
+      size_t frames = _MIN(no_samples - rv, PERIOD_FRAMES);
+
+      res = stream->capture(id, tracks, &offs, &frames, NULL, 0, 1.0f,
+                            capture_batched);
+      rv += frames;
+      if (frames) empty = 0;
+      else if (++empty == max_empty) break;
+      else if (!capture_batched) msecSleep(1);
+   }
+   while (res >= 0 && rv < no_samples);
+
+   return rv;
+}
+
+/*
+ * Decode the file as int32_t and straight into the float mixer format.
+ * Both must hold the same samples.
+ */
+static int
+test_mixer_format(const char *file)
+{
+   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
+   int32_t *idata[NO_TRACKS];
+   float *fdata[NO_TRACKS];
+   size_t i, inum, fnum;
+   int t, rv = -1;
+   void *id;
+
+   for (t=0; t<NO_TRACKS; ++t)
+   {
+      idata[t] = calloc(NO_SAMPLES+PACKET_SAMPLES, sizeof(int32_t));
+      fdata[t] = calloc(NO_SAMPLES+PACKET_SAMPLES, sizeof(float));
+   }
+
+   // extensions without a float decoder must refuse the mixer format
+   id = stream_open(WAVNAME);
+   if (!id)
+   {
+      printf("Unable to open %s\n", WAVNAME);
+      goto done;
+   }
+   if (stream->set_param(id, DRIVER_MIXER_FORMAT, true) ||
+       stream->param(id, DRIVER_MIXER_FORMAT))
+   {
+      printf("%s: mixer format accepted without a float decoder\n", WAVNAME);
+      goto done;
+   }
+   stream->disconnect(id);
+
+   id = stream_open(file);
+   if (!id)
+   {
+      printf("Unable to open %s\n", file);
+      goto done;
+   }
+   inum = stream_capture(id, (void**)idata, NO_SAMPLES+PACKET_SAMPLES);
+   stream->disconnect(id);
+
+   id = stream_open(file);
+   if (!id)
+   {
+      printf("Unable to open %s\n", file);
+      goto done;
+   }
+   if (stream->param(id, DRIVER_MIXER_FORMAT))
+   {
+      printf("The mixer format is set without a request\n");
+      goto done;
+   }
+   if (!stream->set_param(id, DRIVER_MIXER_FORMAT, true) ||
+       !stream->param(id, DRIVER_MIXER_FORMAT))
+   {
+      printf("The mixer format is not accepted for %s\n", file);
+      goto done;
+   }
+   fnum = stream_capture(id, (void**)fdata, NO_SAMPLES+PACKET_SAMPLES);
+
+   // clearing the mode returns to int32_t
+   if (stream->set_param(id, DRIVER_MIXER_FORMAT, false) ||
+       stream->param(id, DRIVER_MIXER_FORMAT))
+   {
+      printf("The mixer format could not be cleared\n");
+      goto done;
+   }
+
+   if (inum != NO_SAMPLES || fnum != inum)
+   {
+      printf("decoded %zu int32_t and %zu float samples instead of %i\n",
+              inum, fnum, NO_SAMPLES);
+      goto done;
+   }
+
+   rv = 0;
+   for (t=0; t<NO_TRACKS && !rv; ++t)
+   {
+      float peak = 0.0f;
+      for (i=0; i<inum; ++i)
+      {
+         if (fabsf(fdata[t][i] - (float)idata[t][i]) > 1.0f)
+         {
+            printf("track %i, sample %zu: float %f, int32_t %i\n", t, i,
+                    fdata[t][i], idata[t][i]);
+            rv = -1;
+            break;
+         }
+         if (fabsf(fdata[t][i]) > peak) peak = fabsf(fdata[t][i]);
+      }
+      if (!rv && peak < 1000.0f)
+      {
+         printf("track %i is silent\n", t);
+         rv = -1;
+      }
+   }
+
+done:
+   if (id) stream->disconnect(id);
+   for (t=0; t<NO_TRACKS; ++t)
+   {
+      free(idata[t]);
+      free(fdata[t]);
+   }
+   return rv;
+}
+
+/* Read a file in memory so it can be fed to the extension in pieces. */
+static uint8_t*
+read_file(const char *file, size_t *size)
+{
+   uint8_t *rv = NULL;
+   FILE *fp;
+
+   fp = fopen(file, "rb");
+   if (fp)
+   {
+      fseek(fp, 0, SEEK_END);
+      *size = ftell(fp);
+      fseek(fp, 0, SEEK_SET);
+
+      rv = malloc(*size);
+      if (rv && fread(rv, 1, *size, fp) != *size)
+      {
+         free(rv);
+         rv = NULL;
+      }
+      fclose(fp);
+   }
+   return rv;
+}
+
+static size_t
+page_size(const uint8_t *page)
+{
+   size_t i, rv = 27 + page[26];
+   for (i=0; i<page[26]; ++i) rv += page[27+i];
+   return rv;
+}
+
+static size_t
+page_offset(const uint8_t *data, size_t size, int page_no)
+{
+   size_t rv = 0;
+   while (page_no-- && rv+27 < size) rv += page_size(data+rv);
+   return rv;
+}
+
+/*
+ * Decode an Ogg stream from memory the way the stream driver does, but
+ * with audio reads of exactly chunk bytes so pages get split anywhere.
+ */
+static size_t
+ext_decode(const uint8_t *data, size_t size, size_t chunk, int32_t **tracks, size_t max)
+{
+   _ext_t *ext = _ext_create(_EXT_OGG);
+   size_t bufsize, pos = 0, avail = 0, rv = 0;
+   uint8_t *raw = malloc(size);
+   char fill = 0;
+   ssize_t req;
+   void *ptr;
+   int res;
+
+   if (!ext || !raw) goto done;
+   if (!ext->setup(ext, AAX_MODE_READ, &bufsize, FS, NO_TRACKS, AAX_PCM24S,
+                   1024, 0))
+   {
+      _ext_free(ext);
+      ext = NULL;
+      goto done;
+   }
+
+   // the headers are read in blocks of the requested size
+   do
+   {
+      req = (size - pos < bufsize) ? size - pos : bufsize;
+      ptr = ext->open(ext, (void*)(data+pos), &req, size);
+      pos += req;
+   }
+   while (ptr && req);
+   if (ptr) goto done;
+
+   do
+   {
+      if (!fill)
+      {
+         size_t num = max - rv;
+         res = ext->cvt_from_intl(ext, tracks, rv, &num);
+         rv += num;
+      }
+      else
+      {
+         ssize_t used = avail;
+         res = ext->fill(ext, raw, &used);
+         memmove(raw, raw+used, avail-used);
+         avail -= used;
+      }
+
+      if (res == __F_EOF) break;
+      if (res == __F_PROCESS) {
+         fill = 0;
+      }
+      else if (res == __F_NEED_MORE || rv < max)
+      {
+         req = (size - pos < chunk) ? size - pos : chunk;
+         if (!req && !avail && (fill || res == __F_NEED_MORE)) break;
+         memcpy(raw+avail, data+pos, req);
+         avail += req;
+         pos += req;
+         fill = 1;
+      }
+   }
+   while (rv < max);
+
+done:
+   if (ext)
+   {
+      ext->close(ext);
+      _ext_free(ext);
+   }
+   free(raw);
+
+   return rv;
+}
+
+/*
+ * The SIMD float to int32_t conversion rounds where the scalar code for
+ * the remaining samples truncates so allow a difference of one.
+ */
+static int
+compare(int32_t **ref, size_t ref_offs, int32_t **data, size_t offs, size_t num, const char *name)
+{
+   size_t i;
+   int t;
+
+   for (t=0; t<NO_TRACKS; ++t) {
+      for (i=0; i<num; ++i) {
+         if (abs(ref[t][ref_offs+i] - data[t][offs+i]) > 1)
+         {
+            printf("%s: track %i, sample %zu differs: %i instead of %i\n",
+                    name, t, offs+i, data[t][offs+i], ref[t][ref_offs+i]);
+            return -1;
+         }
+      }
+   }
+   return 0;
+}
+
+/*
+ * The checksums of the test pages are calculated bit by bit: check that
+ * against the CRC check value and a known page, then every page of streams
+ * with many different page sizes must be accepted by the slice-by-8 code.
+ */
+static int
+test_page_checksums(const uint8_t *data, size_t size, int32_t **ref)
+{
+   static const uint32_t max_body[] = { 255, 300, 1001, 2047 };
+   int32_t *out[NO_TRACKS];
+   size_t i, num, file_size;
+   uint32_t crc;
+   uint8_t *file;
+   int t, rv = -1;
+   FILE *fp;
+
+   for (t=0; t<NO_TRACKS; ++t) {
+      out[t] = calloc(NO_SAMPLES+PACKET_SAMPLES, sizeof(int32_t));
+   }
+
+   crc = ogg_crc(0, (const uint8_t*)"123456789", 9);
+   if (crc != 0x89A1897F)
+   {
+      printf("CRC check value: 0x%08X instead of 0x89A1897F\n", crc);
+      goto done;
+   }
+
+   crc = data[22] | data[23] << 8 | data[24] << 16 | (uint32_t)data[25] << 24;
+   if (crc != IDENT_PAGE_CRC)
+   {
+      printf("identification page CRC: 0x%08X instead of 0x%08X\n", crc,
+              IDENT_PAGE_CRC);
+      goto done;
+   }
+
+   for (i=0; i<sizeof(max_body)/sizeof(max_body[0]); ++i)
+   {
+      fp = fopen(FILENAME, "wb");
+      if (!fp) goto done;
+      write_vorbis(fp, 0x1234, 1, max_body[i], 0, NO_PACKETS, 0);
+      fclose(fp);
+
+      file = read_file(FILENAME, &file_size);
+      if (!file) goto done;
+
+      num = ext_decode(file, file_size, file_size, out, NO_SAMPLES);
+      free(file);
+      if (num != NO_SAMPLES)
+      {
+         printf("pages of at most %u bytes: %zu samples instead of %i\n",
+                 max_body[i], num, NO_SAMPLES);
+         goto done;
+      }
+      if (compare(ref, 0, out, 0, num, "page size")) goto done;
+   }
+   rv = 0;
+
+done:
+   for (t=0; t<NO_TRACKS; ++t) free(out[t]);
+   if (write_ogg(FILENAME, MAX_PAGE_BODY, 0) < 0) rv = -1;
+   return rv;
+}
+
+/* Pages which are split across two reads must decode the same. */
+static int
+test_split_pages(const uint8_t *data, size_t size, int32_t **ref)
+{
+   static const size_t chunk[] = { 1, 7, 1000, 4099 };
+   int32_t *out[NO_TRACKS];
+   int t, rv = 0;
+   size_t i, num;
+
+   for (t=0; t<NO_TRACKS; ++t) {
+      out[t] = calloc(NO_SAMPLES+PACKET_SAMPLES, sizeof(int32_t));
+   }
+
+   for (i=0; i<sizeof(chunk)/sizeof(chunk[0]) && !rv; ++i)
+   {
+      num = ext_decode(data, size, chunk[i], out, NO_SAMPLES);
+      if (num != NO_SAMPLES)
+      {
+         printf("reads of %zu bytes: %zu samples instead of %i\n", chunk[i],
+                 num, NO_SAMPLES);
+         rv = -1;
+      }
+      else rv = compare(ref, 0, out, 0, num, "split pages");
+   }
+
+   for (t=0; t<NO_TRACKS; ++t) free(out[t]);
+   return rv;
+}
+
+/*
+ * A page with a bad checksum must be skipped and decoding must continue
+ * with the next page: only the packets of that page are lost.
+ */
+static int
+test_corrupt_page(const uint8_t *data, size_t size, int32_t **ref)
+{
+   const int page_no = 2+4;
+   const size_t lost = PACKETS_PER_PAGE*PACKET_SAMPLES;
+   const size_t start = 4*PACKETS_PER_PAGE*PACKET_SAMPLES;
+   const size_t tail = 4*PACKETS_PER_PAGE*PACKET_SAMPLES;
+   int32_t *out[NO_TRACKS];
+   uint8_t *copy;
+   size_t offs, num;
+   int t, rv = -1;
+
+   for (t=0; t<NO_TRACKS; ++t) {
+      out[t] = calloc(NO_SAMPLES+PACKET_SAMPLES, sizeof(int32_t));
+   }
+
+   copy = malloc(size);
+   memcpy(copy, data, size);
+   offs = page_offset(copy, size, page_no);
+   copy[offs + page_size(copy+offs) - 10] ^= 0x20;
+
+   num = ext_decode(copy, size, 1000, out, NO_SAMPLES);
+   if (num != NO_SAMPLES - lost) {
+      printf("corrupt page: %zu samples instead of %zu\n", num,
+              NO_SAMPLES - lost);
+   }
+   else if (!compare(ref, 0, out, 0, start - PACKET_SAMPLES, "corrupt page") &&
+            !compare(ref, NO_SAMPLES-tail, out, num-tail, tail, "corrupt page"))
+   {
+      rv = 0;
+   }
+
+   free(copy);
+   for (t=0; t<NO_TRACKS; ++t) free(out[t]);
+   return rv;
+}
+
+/*
+ * Junk between pages, including a false capture pattern, must be skipped
+ * without losing any of the pages around it.
+ */
+static int
+test_lost_sync(const uint8_t *data, size_t size, int32_t **ref)
+{
+   static const int page_no[] = { 3, 9, 15 };
+   uint8_t junk[64] = "junkOgOggOggS";
+   int32_t *out[NO_TRACKS];
+   size_t i, pos, offs, num;
+   uint8_t *copy;
+   int t, rv = -1;
+
+   for (t=0; t<NO_TRACKS; ++t) {
+      out[t] = calloc(NO_SAMPLES+PACKET_SAMPLES, sizeof(int32_t));
+   }
+
+   /* the false page header claims a page of 17 segments of 17 bytes */
+   memset(junk+13, 0x11, sizeof(junk)-13);
+
+   copy = malloc(size + 3*sizeof(junk));
+   pos = offs = 0;
+   for (i=0; i<3; ++i)
+   {
+      size_t n = page_offset(data, size, page_no[i]) - offs;
+      memcpy(copy+pos, data+offs, n);
+      pos += n;
+      offs += n;
+      memcpy(copy+pos, junk, sizeof(junk));
+      pos += sizeof(junk);
+   }
+   memcpy(copy+pos, data+offs, size-offs);
+   pos += size-offs;
+
+   num = ext_decode(copy, pos, 1000, out, NO_SAMPLES);
+   if (num != NO_SAMPLES) {
+      printf("lost sync: %zu samples instead of %i\n", num, NO_SAMPLES);
+   } else if (!compare(ref, 0, out, 0, num, "lost sync")) {
+      rv = 0;
+   }
+
+   free(copy);
+   for (t=0; t<NO_TRACKS; ++t) free(out[t]);
+   return rv;
+}
+
+static int
+test_pages(const char *file)
+{
+   int32_t *ref[NO_TRACKS];
+   uint8_t *data;
+   size_t size, num;
+   int t, rv = -1;
+
+   for (t=0; t<NO_TRACKS; ++t) {
+      ref[t] = calloc(NO_SAMPLES+PACKET_SAMPLES, sizeof(int32_t));
+   }
+
+   data = read_file(file, &size);
+   if (!data)
+   {
+      printf("Unable to read %s\n", file);
+      goto done;
+   }
+
+   num = ext_decode(data, size, size, ref, NO_SAMPLES+PACKET_SAMPLES);
+   if (num != NO_SAMPLES) {
+      printf("%s: %zu samples instead of %i\n", file, num, NO_SAMPLES);
+   }
+   else if (!test_page_checksums(data, size, ref) &&
+            !test_split_pages(data, size, ref) &&
+            !test_corrupt_page(data, size, ref) &&
+            !test_lost_sync(data, size, ref))
+   {
+      rv = 0;
+   }
+
+done:
+   for (t=0; t<NO_TRACKS; ++t) free(ref[t]);
+   free(data);
+   return rv;
+}
+
+/*
+ * Seek to many positions, forward and backward, after the file was read
+ * once to build the seek index. Every seek must continue with exactly the
+ * samples a linear decode produces from that position on.
+ */
+static int
+test_seek(const char *file)
+{
+   static const size_t target[] = {
+      40000, 0, 1, 127, 128, 1000, 2047, 2048, 4095, 4096, 4097, 5000,
+      8191, 10000, 25000, 12345, 33333, NO_SAMPLES-1000, NO_SAMPLES-1, 3
+   };
+   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
+   int32_t *ref[NO_TRACKS], *out[NO_TRACKS];
+   size_t i, num;
+   int t, rv = -1;
+   void *id;
+
+   for (t=0; t<NO_TRACKS; ++t)
+   {
+      ref[t] = calloc(NO_SAMPLES+PACKET_SAMPLES, sizeof(int32_t));
+      out[t] = calloc(NO_SAMPLES+PACKET_SAMPLES, sizeof(int32_t));
+   }
+
+   id = stream_open(file);
+   if (!id)
+   {
+      printf("Unable to open %s\n", file);
+      goto done;
+   }
+
+   num = stream_capture(id, (void**)ref, NO_SAMPLES+PACKET_SAMPLES);
+   if (num != NO_SAMPLES)
+   {
+      printf("%s: %zu samples instead of %i\n", file, num, NO_SAMPLES);
+      goto done;
+   }
+
+   for (i=0; i<sizeof(target)/sizeof(target[0]); ++i)
+   {
+      char name[64];
+
+      snprintf(name, sizeof(name), "%s, seek to %zu", file, target[i]);
+      stream->set_position(id, target[i]);
+
+      // seek once more while the samples of the first seek are queued
+      num = _MIN(PERIOD_FRAMES, NO_SAMPLES - target[i]);
+      num = stream_capture(id, (void**)out, num);
+      if (compare(ref, target[i], out, 0, num, name)) {
+         goto done;
+      }
+      stream->set_position(id, target[i]);
+
+      num = stream_capture(id, (void**)out, NO_SAMPLES+PACKET_SAMPLES);
+      if (num != NO_SAMPLES - target[i])
+      {
+         printf("%s: %zu samples instead of %zu\n", name, num,
+                 NO_SAMPLES - target[i]);
+         goto done;
+      }
+      if (compare(ref, target[i], out, 0, num, name)) {
+         goto done;
+      }
+   }
+   rv = 0;
+
+done:
+   if (id) stream->disconnect(id);
+   for (t=0; t<NO_TRACKS; ++t)
+   {
+      free(ref[t]);
+      free(out[t]);
+   }
+   return rv;
+}
+
+/*
+ * The granule positions of the second stream of a chained file start at
+ * zero again: its samples must follow those of the first stream and the
+ * end trimming must use its own last granule position.
+ */
+static int
+test_chain(const char *chain, const char *first, const char *link)
+{
+   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
+   int32_t *ref[NO_TRACKS], *out[NO_TRACKS];
+   size_t num, rnum, lnum, max;
+   int t, rv = -1;
+   void *id;
+
+   max = NO_SAMPLES+LINK_SAMPLES+PACKET_SAMPLES;
+   for (t=0; t<NO_TRACKS; ++t)
+   {
+      ref[t] = calloc(max, sizeof(int32_t));
+      out[t] = calloc(max, sizeof(int32_t));
+   }
+
+   id = stream_open(first);
+   rnum = id ? stream_capture(id, (void**)ref, max) : 0;
+   if (id) stream->disconnect(id);
+
+   id = stream_open(link);
+   lnum = id ? stream_capture(id, (void**)out, max) : 0;
+   if (id) stream->disconnect(id);
+
+   if (rnum != NO_SAMPLES || lnum != LINK_SAMPLES)
+   {
+      printf("decoded %zu and %zu samples instead of %i and %i\n",
+              rnum, lnum, NO_SAMPLES, LINK_SAMPLES);
+      goto done;
+   }
+   for (t=0; t<NO_TRACKS; ++t) {
+      memcpy(ref[t]+rnum, out[t], lnum*sizeof(int32_t));
+   }
+
+   id = stream_open(chain);
+   if (!id)
+   {
+      printf("Unable to open %s\n", chain);
+      goto done;
+   }
+   num = stream_capture(id, (void**)out, max);
+   stream->disconnect(id);
+
+   if (num != rnum+lnum) {
+      printf("%s: %zu samples instead of %zu\n", chain, num, rnum+lnum);
+   } else if (!compare(ref, 0, out, 0, num, chain)) {
+      rv = 0;
+   }
+
+done:
+   for (t=0; t<NO_TRACKS; ++t)
+   {
+      free(ref[t]);
+      free(out[t]);
+   }
+   return rv;
+}
+
+/*
+ * The Opus pre-skip is dropped from the start and the samples after the
+ * granule position of the last page from the end of the output.
+ */
+static int
+test_opus(const char *file)
+{
+   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
+   int32_t *out[NO_TRACKS];
+   size_t num, max;
+   int t, rv = -1;
+   _fmt_t *fmt;
+   void *id;
+
+   fmt = _fmt_create(_FMT_OPUS, AAX_MODE_READ);
+   if (!fmt)
+   {
+      printf("Opus decoding is not available, skipped\n");
+      return 0;
+   }
+   _fmt_free(fmt);
+
+   max = OPUS_PACKETS*OPUS_FRAME;
+   for (t=0; t<NO_TRACKS; ++t) {
+      out[t] = calloc(max, sizeof(int32_t));
+   }
+
+   id = stream_open(file);
+   if (id)
+   {
+      num = stream_capture(id, (void**)out, max);
+      stream->disconnect(id);
+
+      if (num != OPUS_SAMPLES) {
+         printf("%s: %zu samples instead of %i\n", file, num, OPUS_SAMPLES);
+      } else {
+         rv = 0;
+      }
+   }
+   else {
+      printf("Unable to open %s\n", file);
+   }
+
+   for (t=0; t<NO_TRACKS; ++t) free(out[t]);
+   return rv;
+}
+
+int main()
+{
+   int rv = 0;
+
+   if (write_ogg(FILENAME, MAX_PAGE_BODY, 0) < 0 ||
+       write_ogg(SPLITNAME, 4096, 600) < 0 ||
+       write_chain(CHAINNAME, LINKNAME) < 0 || write_opus(OPUSNAME) < 0 ||
+       write_wav(WAVNAME) < 0)
+   {
+      printf("Unable to write the test files\n");
+      return -1;
+   }
+
+   if (test_mixer_format(FILENAME)) rv = -1;
+   if (test_pages(FILENAME)) rv = -1;
+   if (test_seek(FILENAME)) rv = -1;
+   if (test_seek(SPLITNAME)) rv = -1;
+   if (test_chain(CHAINNAME, FILENAME, LINKNAME)) rv = -1;
+   if (test_opus(OPUSNAME)) rv = -1;
+
+   // decoded ahead by the shared pool and captured by the mixer thread
+   setenv("AAX_STREAM_SHARED_IO", "true", 1);
+   capture_batched = false;
+   if (test_mixer_format(FILENAME)) rv = -1;
+   if (test_seek(FILENAME)) rv = -1;
+   if (test_seek(SPLITNAME)) rv = -1;
+   unsetenv("AAX_STREAM_SHARED_IO");
+
+   remove(FILENAME);
+   remove(SPLITNAME);
+   remove(CHAINNAME);
+   remove(LINKNAME);
+   remove(OPUSNAME);
+   remove(WAVNAME);
+
+   return rv;
+}
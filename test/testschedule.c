@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include <aax/aax.h>
+
+#include <software/rbuf_int.h>
+#include <software/renderer.h>
+#include <base/buffers.h>
+#include <dsp/filters.h>
+#include <dsp/effects.h>
+#include <objects.h>
+
+#define DEVNAME			"None"
+#define SAMPLE_FREQUENCY	48000
+#define NO_SAMPLES		1024
+#define NO_PERIODS		4
+#define SRC_SAMPLES		(NO_PERIODS*NO_SAMPLES)
+
+/*
+ * Render an emitter which is scheduled to start at sample time start and
+ * to stop at sample time stop (when >= 0) for NO_PERIODS periods.
+ * Returns the first track of all periods.
+ */
+static const float*
+render(aaxConfig config, int64_t start, int64_t stop)
+{
+   static float rv[NO_PERIODS*NO_SAMPLES];
+   static int32_t src[SRC_SAMPLES];
+   _aax2dProps fp2d;
+   _aaxRingBuffer *drb;
+   _aaxMixerInfo *info = NULL;
+   _aaxRendererData data;
+   _aaxRingBufferData *rbi;
+   _intBuffers *emitters = NULL;
+   aaxEmitter emitter;
+   aaxBuffer buffer;
+   unsigned int pos;
+   int i, p;
+
+   _aaxSetDefaultInfo(&info, NULL);
+   info->frequency = SAMPLE_FREQUENCY;
+   info->curr_sample = 0;
+
+   memset(&fp2d, 0, sizeof(_aax2dProps));
+   _aaxSetDefault2dProps(&fp2d);
+   _aaxSetDefaultFilter2d(&fp2d.filter[VOLUME_FILTER], VOLUME_FILTER, 0);
+   _aaxSetDefaultEffect2d(&fp2d.effect[PITCH_EFFECT], PITCH_EFFECT, 0);
+   _aaxSetDefault2dFiltersEffects(&fp2d);
+   fp2d.final.gain_max = 1.0f;
+   fp2d.final.k = 1.0f;
+
+   drb = _aaxRingBufferCreate(0.0f, AAX_MODE_WRITE_STEREO);
+   drb->set_format(drb, AAX_PCM24S, true);
+   drb->set_parami(drb, RB_NO_TRACKS, 2);
+   drb->set_paramf(drb, RB_FREQUENCY, SAMPLE_FREQUENCY);
+   drb->set_parami(drb, RB_NO_SAMPLES, NO_SAMPLES);
+   drb->init(drb, true);
+
+   for (i=0; i<SRC_SAMPLES; ++i) src[i] = 0x200000;
+   buffer = aaxBufferCreate(config, SRC_SAMPLES, 1, AAX_PCM24S);
+   aaxBufferSetSetup(buffer, AAX_FREQUENCY, SAMPLE_FREQUENCY);
+   aaxBufferSetData(buffer, src);
+
+   emitter = aaxEmitterCreate();
+   aaxEmitterAddBuffer(emitter, buffer);
+   aaxEmitterSetStateAt(emitter, AAX_PLAYING, start);
+   if (stop >= 0) {
+      aaxEmitterSetStateAt(emitter, AAX_STOPPED, stop);
+   }
+
+   _intBufCreate(&emitters, _AAX_EMITTER);
+   pos = _intBufAddData(emitters, _AAX_EMITTER, emitter);
+
+   memset(&data, 0, sizeof(data));
+   data.info = info;
+   data.drb = drb;
+   data.fp2d = &fp2d;
+   data.dt = (float)NO_SAMPLES/SAMPLE_FREQUENCY;
+
+   rbi = drb->handle;
+   for (p=0; p<NO_PERIODS; ++p)
+   {
+      _intBufferData *dptr = _intBufGet(emitters, _AAX_EMITTER, pos);
+
+      drb->set_state(drb, RB_CLEARED);
+      _aaxProcessEmitter(drb, &data, dptr, 1);
+      memcpy(rv+p*NO_SAMPLES, rbi->sample->track[0], NO_SAMPLES*sizeof(float));
+      info->curr_sample += NO_SAMPLES;
+   }
+
+   _intBufErase(&emitters, _AAX_EMITTER, NULL);
+   aaxEmitterSetState(emitter, AAX_PROCESSED);
+   aaxEmitterRemoveBuffer(emitter);
+   aaxEmitterDestroy(emitter);
+   aaxBufferDestroy(buffer);
+   _aaxRingBufferFree(drb);
+
+   return rv;
+}
+
+/*
+ * The rendered signal should start exactly at sample start and end
+ * exactly at sample stop, no matter where the period boundaries are.
+ * The click-suppression gain ramp starts at zero at the start sample.
+ */
+static int
+test_schedule(aaxConfig config, const char *name, int64_t start, int64_t stop)
+{
+   const float *d = render(config, start, stop);
+   int64_t i, end = (stop >= 0) ? stop : NO_PERIODS*NO_SAMPLES;
+   int rv = 0;
+
+   for (i=0; i<NO_PERIODS*NO_SAMPLES; ++i)
+   {
+      bool playing = (i > start && i < end);
+      if (playing != (d[i] != 0.0f))
+      {
+         printf("%s: sample %li is %f\n", name, (long)i, d[i]);
+         rv = -1;
+         break;
+      }
+   }
+
+   return rv;
+}
+
+int main()
+{
+   aaxConfig config;
+   int rv = -1;
+
+   config = aaxDriverOpenByName(DEVNAME, AAX_MODE_WRITE_STEREO);
+   if (!config)
+   {
+      printf("Unable to open the %s device\n", DEVNAME);
+      return rv;
+   }
+
+   rv = 0;
+
+   rv |= test_schedule(config, "start within a period", 300, -1);
+   rv |= test_schedule(config, "start at a period boundary", NO_SAMPLES, -1);
+   rv |= test_schedule(config, "start and stop within a period", 1324, 1900);
+   rv |= test_schedule(config, "stop within a later period", 300, 2500);
+   rv |= test_schedule(config, "stop at a period boundary", 300, 2*NO_SAMPLES);
+   rv |= test_schedule(config, "stop at the start", NO_SAMPLES, NO_SAMPLES);
+
+   aaxDriverClose(config);
+   aaxDriverDestroy(config);
+
+   if (rv == 0) printf("Schedule test passed\n");
+
+   return rv;
+}
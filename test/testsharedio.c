@@ -0,0 +1,445 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <aax/aax.h>
+
+#include <base/xthreads.h>
+#include <backends/driver.h>
+#include <stream/device.h>
+
+#define DEVNAME			"None"
+#define FS			44100
+#define NO_TRACKS		2
+#define NO_SAMPLES		200001
+#define NO_STREAMS		4
+#define DATA_SIZE		(NO_SAMPLES*NO_TRACKS*sizeof(int16_t))
+#define PERIOD_FRAMES		1024
+#define MAX_EMPTY		5000
+
+/*
+ * Streams read through the shared I/O pool, which has fewer threads than
+ * there are streams. Each stream waits only for its own read jobs and all
+ * of them must return the same data as when they are read by a dedicated
+ * I/O thread.
+ *
+ * The files have an inst chunk so they are read by the stream driver
+ * instead of being memory mapped.
+ */
+static void *reference[NO_STREAMS];
+static int32_t *decoded[NO_STREAMS][NO_TRACKS];
+
+static int16_t
+sample(int stream, int track, int pos) {
+   return (int16_t)(pos*(7+stream) + track*1000 + stream*333);
+}
+
+static void
+write16le(FILE *fp, unsigned int v)
+{
+   fputc(v & 0xFF, fp);
+   fputc((v >> 8) & 0xFF, fp);
+}
+
+static void
+write32le(FILE *fp, unsigned int v)
+{
+   write16le(fp, v & 0xFFFF);
+   write16le(fp, v >> 16);
+}
+
+static int
+write_wav(const char *file, int stream)
+{
+   int blocksize = NO_TRACKS*2;
+   int datasize = NO_SAMPLES*blocksize;
+   FILE *fp;
+   int i, t;
+
+   fp = fopen(file, "wb");
+   if (!fp) return -1;
+
+   fwrite("RIFF", 1, 4, fp);
+   write32le(fp, 4 + 24 + 16 + 8 + datasize);
+   fwrite("WAVE", 1, 4, fp);
+   fwrite("fmt ", 1, 4, fp);
+   write32le(fp, 16);
+   write16le(fp, 1);
+   write16le(fp, NO_TRACKS);
+   write32le(fp, FS);
+   write32le(fp, FS*blocksize);
+   write16le(fp, blocksize);
+   write16le(fp, 16);
+   fwrite("inst", 1, 4, fp);
+   write32le(fp, 7);
+   fputc(60, fp);			// unshifted note
+   fputc(0, fp);			// fine tune
+   fputc(0, fp);			// gain
+   fputc(0, fp);			// low note
+   fputc(127, fp);			// high note
+   fputc(1, fp);			// low velocity
+   fputc(127, fp);			// high velocity
+   fputc(0, fp);			// pad byte
+   fwrite("data", 1, 4, fp);
+   write32le(fp, datasize);
+
+   for (i=0; i<NO_SAMPLES; ++i) {
+      for (t=0; t<NO_TRACKS; ++t) {
+         write16le(fp, (uint16_t)sample(stream, t, i));
+      }
+   }
+   fclose(fp);
+
+   return 0;
+}
+
+/* Returns a copy of the buffer data read from the file of a stream */
+static void*
+read_stream(int stream)
+{
+   aaxConfig config;
+   aaxBuffer buffer;
+   char file[64];
+   void *rv = NULL;
+
+   snprintf(file, sizeof(file), "testsharedio%i.wav", stream);
+
+   config = aaxDriverOpenByName(DEVNAME, AAX_MODE_WRITE_STEREO);
+   if (!config)
+   {
+      printf("Unable to open the %s device\n", DEVNAME);
+      return rv;
+   }
+
+   buffer = aaxBufferReadFromStream(config, file);
+   if (!buffer) {
+      printf("stream %i: unable to read %s\n", stream, file);
+   }
+   else if (aaxBufferGetSetup(buffer, AAX_NO_SAMPLES) != NO_SAMPLES)
+   {
+      printf("stream %i: %" PRIi64 " samples instead of %i\n", stream,
+              aaxBufferGetSetup(buffer, AAX_NO_SAMPLES), NO_SAMPLES);
+   }
+   else
+   {
+      void **data = aaxBufferGetData(buffer);
+      if (data)
+      {
+         rv = malloc(DATA_SIZE);
+         if (rv) memcpy(rv, data[0], DATA_SIZE);
+         aaxFree(data);
+      }
+      else {
+         printf("stream %i: unable to get the buffer data\n", stream);
+      }
+   }
+   aaxBufferDestroy(buffer);
+
+   aaxDriverClose(config);
+   aaxDriverDestroy(config);
+
+   return rv;
+}
+
+static int
+read_shared(void *arg)
+{
+   int stream = (int)(intptr_t)arg;
+   void *data = read_stream(stream);
+   int rv = -1;
+
+   if (data)
+   {
+      if (memcmp(data, reference[stream], DATA_SIZE)) {
+         printf("stream %i: the data differs from the reference\n", stream);
+      } else {
+         rv = 0;
+      }
+      free(data);
+   }
+
+   return rv;
+}
+
+static int
+run_shared(const char *threads, const char *read_ahead)
+{
+   thrd_t thread[NO_STREAMS] = { 0 };
+   int i, res, rv = 0;
+
+   setenv("AAX_STREAM_SHARED_IO", "true", 1);
+   setenv("AAX_STREAM_IO_THREADS", threads, 1);
+   if (read_ahead) setenv("AAX_STREAM_READ_AHEAD_MS", read_ahead, 1);
+   else unsetenv("AAX_STREAM_READ_AHEAD_MS");
+
+   for (i=0; i<NO_STREAMS; ++i)
+   {
+      if (thrd_create(&thread[i], read_shared, (void*)(intptr_t)i) != thrd_success)
+      {
+         printf("Unable to start stream %i\n", i);
+         thread[i] = 0;
+         rv = -1;
+      }
+   }
+
+   for (i=0; i<NO_STREAMS; ++i)
+   {
+      if (thread[i])
+      {
+         thrd_join(thread[i], &res);
+         if (res) rv = -1;
+      }
+   }
+
+   if (rv) {
+      printf("%s I/O thread(s), read ahead: %s ms failed\n", threads,
+              read_ahead ? read_ahead : "unlimited");
+   }
+
+   return rv;
+}
+
+/* Connect the stream driver to a file the way the sensor does. */
+static void*
+stream_open(const char *file)
+{
+   const _aaxDriverBackend *stream = &_aaxStreamDriverBackend;
+   float refrate = 50.0f, period_rate = 50.0f, rate = FS;
+   unsigned int tracks = NO_TRACKS;
+   int fmt = AAX_PCM24S, brate = 0;
+   void *id;
+
+   id = stream->new_handle(AAX_MODE_READ);
+   id = stream->connect(NULL, id, NULL, file, AAX_MODE_READ);
+   if (id && !stream->setup(id, &refrate, &fmt, &tracks, &rate, &brate,
+                            false, period_rate))
+   {
+      stream->disconnect(id);
+      id = NULL;
+   }
+   return id;
+}
+
+/*
+ * Capture a stream period by period the way the mixer thread does, or
+ * batched the way a buffer is read. The mixer thread never waits for the
+ * pool, a capture which returns less than a period is retried until the
+ * pool caught up.
+ */
+static int
+capture_stream(int stream, char batched, int32_t **dst)
+{
+   const _aaxDriverBackend *be = &_aaxStreamDriverBackend;
+   int32_t *tracks[NO_TRACKS];
+   size_t pos = 0, end = NO_SAMPLES;
+   int t, empty = 0, rv = -1;
+   char file[64];
+   void *id;
+
+   snprintf(file, sizeof(file), "testsharedio%i.wav", stream);
+   id = stream_open(file);
+   if (!id)
+   {
+      printf("stream %i: unable to open %s\n", stream, file);
+      return rv;
+   }
+
+   while (pos < end && empty < MAX_EMPTY)
+   {
+      size_t frames = _MIN(PERIOD_FRAMES, end - pos);
+      ssize_t offs = 0, res;
+
+      for (t=0; t<NO_TRACKS; ++t) {
+         tracks[t] = dst[t] + pos;
+      }
+
+      res = be->capture(id, (void**)tracks, &offs, &frames, NULL, 0, 1.0f,
+                        batched);
+      pos += frames;
+      if (res < 0) break;
+
+      if (frames) empty = 0;
+      else
+      {
+         msecSleep(1);
+         empty++;
+      }
+   }
+   be->disconnect(id);
+
+   if (pos == end) rv = 0;
+   else {
+      printf("stream %i: %zu samples instead of %i\n", stream, pos, NO_SAMPLES);
+   }
+
+   return rv;
+}
+
+static int
+decode_shared(void *arg)
+{
+   int stream = (int)(intptr_t)arg;
+   int32_t *tracks[NO_TRACKS];
+   int t, rv = -1;
+
+   for (t=0; t<NO_TRACKS; ++t) {
+      tracks[t] = calloc(NO_SAMPLES, sizeof(int32_t));
+   }
+
+   if (tracks[0] && tracks[1] && !capture_stream(stream, false, tracks))
+   {
+      rv = 0;
+      for (t=0; t<NO_TRACKS; ++t)
+      {
+         if (memcmp(tracks[t], decoded[stream][t], NO_SAMPLES*sizeof(int32_t)))
+         {
+            printf("stream %i: decoded track %i differs\n", stream, t);
+            rv = -1;
+         }
+      }
+   }
+
+   for (t=0; t<NO_TRACKS; ++t) {
+      free(tracks[t]);
+   }
+
+   return rv;
+}
+
+/*
+ * The pool decodes the streams ahead in order of the time at which they
+ * would run out of decoded samples, with fewer threads than streams.
+ */
+static int
+run_decode(const char *threads, const char *read_ahead)
+{
+   thrd_t thread[NO_STREAMS] = { 0 };
+   int i, res, rv = 0;
+
+   setenv("AAX_STREAM_SHARED_IO", "true", 1);
+   setenv("AAX_STREAM_IO_THREADS", threads, 1);
+   if (read_ahead) setenv("AAX_STREAM_READ_AHEAD_MS", read_ahead, 1);
+   else unsetenv("AAX_STREAM_READ_AHEAD_MS");
+
+   for (i=0; i<NO_STREAMS; ++i)
+   {
+      if (thrd_create(&thread[i], decode_shared, (void*)(intptr_t)i) != thrd_success)
+      {
+         printf("Unable to start stream %i\n", i);
+         thread[i] = 0;
+         rv = -1;
+      }
+   }
+
+   for (i=0; i<NO_STREAMS; ++i)
+   {
+      if (thread[i])
+      {
+         thrd_join(thread[i], &res);
+         if (res) rv = -1;
+      }
+   }
+
+   if (rv) {
+      printf("decoding by %s thread(s), ahead: %s ms failed\n", threads,
+              read_ahead ? read_ahead : "default");
+   }
+
+   return rv;
+}
+
+int main()
+{
+   int i, rv = 0;
+
+   for (i=0; i<NO_STREAMS; ++i)
+   {
+      char file[64];
+
+      snprintf(file, sizeof(file), "testsharedio%i.wav", i);
+      if (write_wav(file, i) < 0)
+      {
+         printf("Unable to write %s\n", file);
+         return -1;
+      }
+   }
+
+   unsetenv("AAX_STREAM_SHARED_IO");
+   for (i=0; i<NO_STREAMS; ++i)
+   {
+      reference[i] = read_stream(i);
+      if (!reference[i]) rv = -1;
+
+      decoded[i][0] = calloc(NO_SAMPLES, sizeof(int32_t));
+      decoded[i][1] = calloc(NO_SAMPLES, sizeof(int32_t));
+      if (!decoded[i][0] || !decoded[i][1] ||
+          capture_stream(i, true, decoded[i]))
+      {
+         rv = -1;
+      }
+   }
+
+   // one thread which fills the I/O buffers completely
+   if (!rv) rv = run_shared("1", NULL);
+
+   // jobs which read no more than 20 ms ahead, in order of their deadline
+   if (!rv) rv = run_shared("2", "20");
+
+   // one thread which decodes all streams ahead
+   if (!rv) rv = run_decode("1", NULL);
+
+   // two threads which decode no more than 50 ms ahead
+   if (!rv) rv = run_decode("2", "50");
+
+   for (i=0; i<NO_STREAMS; ++i)
+   {
+      char file[64];
+
+      snprintf(file, sizeof(file), "testsharedio%i.wav", i);
+      remove(file);
+      free(reference[i]);
+      free(decoded[i][0]);
+      free(decoded[i][1]);
+   }
+
+   if (!rv) printf("testsharedio: ok\n");
+
+   return rv;
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include <aax/aax.h>
+
+#include <base/timer.h>
+#include <software/rbuf_int.h>
+
+#define FS			44100.0f
+#define NO_TRACKS		2
+#define NO_SAMPLES		100000
+#define NO_RESIDENT		4096
+#define LOOP_START		1000
+#define STREAM_LOOP_START	50000
+#define PERIOD			256
+
+static int32_t dst[NO_SAMPLES];
+
+static int32_t
+sample(int track, size_t pos) {
+   return (int32_t)((pos*7 + track*1000) & 0x7FFFFF);
+}
+
+static void*
+stream_open(void *data) {
+   return data;
+}
+
+static ssize_t
+stream_read(void *io, int32_t **tracks, size_t pos, size_t no_samples)
+{
+   size_t i;
+   int t;
+
+   for (t=0; t<NO_TRACKS; ++t) {
+      for (i=0; i<no_samples; ++i) {
+         tracks[t][i] = sample(t, pos+i);
+      }
+   }
+   return no_samples;
+}
+
+static void
+stream_close(void *io) {
+}
+
+static int
+compare(const char *name, int track, size_t pos, const int32_t *d, size_t no_samples)
+{
+   size_t i;
+   for (i=0; i<no_samples; ++i)
+   {
+      if (d[i] != sample(track, pos+i))
+      {
+         printf("%s: track %i, sample %zu is %i instead of %i\n", name, track,
+                 pos+i, d[i], sample(track, pos+i));
+         return -1;
+      }
+   }
+   return 0;
+}
+
+/* play a looping voice up to the loop end, wrap and play to the end again */
+static int
+play_loop(_aaxRingBuffer *rb, size_t loop_start)
+{
+   _aaxRingBuffer *erb = rb->reference(rb);
+   int rv = -1;
+
+   if (erb)
+   {
+      _aaxRingBufferData *erbi = erb->handle;
+      size_t pos;
+      int t;
+
+      rv = 0;
+      for (pos=0; pos<NO_SAMPLES-10; pos += PERIOD)
+      {
+         size_t len = _MIN(PERIOD, NO_SAMPLES-10 - pos);
+         for (t=0; t<NO_TRACKS; ++t)
+         {
+            _aaxRingBufferProcessStream(dst, erbi, t, pos, loop_start,
+                                        NO_SAMPLES, len, true);
+            rv |= compare("loop voice", t, pos, dst, len);
+         }
+         if (rv) break;
+         msecSleep(2);
+      }
+
+      for (t=0; t<NO_TRACKS; ++t)
+      {
+         _aaxRingBufferProcessStream(dst, erbi, t, NO_SAMPLES-10, loop_start,
+                                     NO_SAMPLES, 2*PERIOD, true);
+         rv |= compare("stream loop end", t, NO_SAMPLES-10, dst, 10);
+         rv |= compare("stream loop", t, loop_start, dst+10, 2*PERIOD-10);
+      }
+
+      for (pos=loop_start+2*PERIOD-10; !rv && pos<NO_SAMPLES; pos += PERIOD)
+      {
+         size_t len = _MIN(PERIOD, NO_SAMPLES - pos);
+         for (t=0; t<NO_TRACKS; ++t)
+         {
+            _aaxRingBufferProcessStream(dst, erbi, t, pos, loop_start,
+                                        NO_SAMPLES, len, true);
+            rv |= compare("looped voice", t, pos, dst, len);
+         }
+         msecSleep(2);
+      }
+
+      erb->destroy(erb);
+   }
+
+   return rv;
+}
+
+int main()
+{
+   _aaxRingBuffer *rb;
+   int rv = -1;
+
+   rb = _aaxRingBufferCreate(0.0f, AAX_MODE_WRITE_STEREO);
+   if (rb)
+   {
+      _aaxRingBufferData *rbi = rb->handle;
+      _aaxRingBufferStream *stream;
+      _aaxRingBuffer *erb;
+      int32_t **tracks;
+      int t;
+
+      rb->set_format(rb, AAX_PCM24S, false);
+      rb->set_parami(rb, RB_NO_TRACKS, NO_TRACKS);
+      rb->set_paramf(rb, RB_FREQUENCY, FS);
+      rb->set_parami(rb, RB_NO_SAMPLES, NO_SAMPLES);
+
+      stream = _aaxRingBufferStreamCreate(NO_TRACKS, NO_RESIDENT);
+      if (stream)
+      {
+         stream->open = stream_open;
+         stream->read = stream_read;
+         stream->close = stream_close;
+         stream->data = stream;
+         stream_read(NULL, stream->head, 0, NO_RESIDENT);
+         rbi->sample->stream = stream;
+      }
+
+      rv = 0;
+      if (!stream || !rb->get_state(rb, RB_IS_VALID))
+      {
+         printf("create: the disk streamed sample is not valid\n");
+         rv = -1;
+      }
+
+      // the complete sample is read while the tracks are accessed
+      tracks = rb->get_tracks_ptr(rb, RB_READ);
+      for (t=0; tracks && t<NO_TRACKS; ++t) {
+         rv |= compare("expand", t, 0, tracks[t], NO_SAMPLES);
+      }
+      rb->release_tracks_ptr(rb);
+      if (!tracks)
+      {
+         printf("expand: the sample could not be read\n");
+         rv = -1;
+      }
+      if (rbi->sample->track)
+      {
+         printf("release: the read tracks were not released\n");
+         rv = -1;
+      }
+
+      // every voice streams the part after the resident samples
+      erb = rb->reference(rb);
+      if (erb)
+      {
+         _aaxRingBufferData *erbi = erb->handle;
+         size_t pos;
+
+         for (pos=0; pos<NO_SAMPLES; pos += PERIOD)
+         {
+            size_t len = _MIN(PERIOD, NO_SAMPLES - pos);
+            for (t=0; t<NO_TRACKS; ++t)
+            {
+               _aaxRingBufferProcessStream(dst, erbi, t, pos, 0, NO_SAMPLES,
+                                           len, false);
+               rv |= compare("voice", t, pos, dst, len);
+            }
+            if (rv) break;
+            msecSleep(2);
+         }
+
+         // looping back to the resident samples continues without a gap
+         _aaxRingBufferProcessStream(dst, erbi, 0, NO_SAMPLES-10, LOOP_START,
+                                     NO_SAMPLES, 2*PERIOD, true);
+         rv |= compare("loop end", 0, NO_SAMPLES-10, dst, 10);
+         rv |= compare("loop", 0, LOOP_START, dst+10, 2*PERIOD-10);
+
+         erb->destroy(erb);
+      }
+
+      // looping back into the streamed samples continues without a gap
+      rb->set_parami(rb, RB_LOOPPOINT_END, NO_SAMPLES);
+      rb->set_parami(rb, RB_LOOPPOINT_START, STREAM_LOOP_START);
+      rv |= play_loop(rb, STREAM_LOOP_START);
+
+      // the streamed samples after a resident loop start are kept as well
+      rb->set_parami(rb, RB_LOOPPOINT_START, 0);
+      rv |= play_loop(rb, 0);
+
+      _aaxRingBufferFree(rb);
+   }
+
+   if (rv == 0) printf("Disk streamed sample test passed\n");
+
+   return rv;
+}
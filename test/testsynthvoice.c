@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <aax/aax.h>
+
+#include <software/rbuf_int.h>
+#include <software/cpu/arch2d_simd.h>
+#include <arch.h>
+
+#define FS			48000.0f
+#define NO_SAMPLES		1024
+#define DDE_SAMPLES		64
+#define MAX_ERROR		1e-3f
+
+static float dst[2][DDE_SAMPLES+2*NO_SAMPLES];
+static float scratch[DDE_SAMPLES+2*NO_SAMPLES];
+
+static int
+compare(const char *name, const float *a, const float *b, int no_samples)
+{
+   int i;
+   for (i=0; i<no_samples; ++i)
+   {
+      if (fabsf(a[i] - b[i])/AAX_PEAK_MAX > MAX_ERROR)
+      {
+         printf("%s: sample %i is %f instead of %f\n", name, i, b[i], a[i]);
+         return -1;
+      }
+   }
+   return 0;
+}
+
+static int
+test_voice(_aaxSynthVoice *voice)
+{
+   float phases_ref[MAX_SYNTH_OSCILLATORS];
+   float phases[MAX_SYNTH_OSCILLATORS];
+   unsigned int i;
+   int rv = 0;
+
+   // one period of 2*NO_SAMPLES samples
+   for (i=0; i<voice->no_oscillators; ++i) phases[i] = voice->osc[i].phase;
+   _bufferRenderSynthVoice(dst[0], scratch, voice, phases,
+                           0, 2*NO_SAMPLES, FS, 1.0f);
+   memcpy(phases_ref, phases, sizeof(phases));
+
+   // two periods of NO_SAMPLES samples should continue the phase
+   for (i=0; i<voice->no_oscillators; ++i) phases[i] = voice->osc[i].phase;
+   _bufferRenderSynthVoice(dst[1], scratch, voice, phases,
+                           0, NO_SAMPLES, FS, 1.0f);
+   _bufferRenderSynthVoice(dst[1]+NO_SAMPLES, scratch, voice, phases,
+                           0, NO_SAMPLES, FS, 1.0f);
+   rv |= compare("continuity", dst[0], dst[1], 2*NO_SAMPLES);
+
+   // the delay effects section rewinds the phase but does not advance it
+   for (i=0; i<voice->no_oscillators; ++i) phases[i] = voice->osc[i].phase;
+   _bufferRenderSynthVoice(dst[1], scratch, voice, phases,
+                           0, NO_SAMPLES, FS, 1.0f);
+   _bufferRenderSynthVoice(dst[1], scratch, voice, phases,
+                           DDE_SAMPLES, NO_SAMPLES, FS, 1.0f);
+   rv |= compare("delay effects", dst[0]+NO_SAMPLES-DDE_SAMPLES, dst[1],
+                  DDE_SAMPLES+NO_SAMPLES);
+   for (i=0; i<voice->no_oscillators; ++i)
+   {
+      if (fabsf(phases[i] - phases_ref[i]) > MAX_ERROR)
+      {
+         printf("phase: oscillator %i is at %f instead of %f\n", i,
+                 phases[i], phases_ref[i]);
+         rv = -1;
+      }
+   }
+
+   return rv;
+}
+
+int main()
+{
+   _aaxRingBuffer *rb;
+   int rv = -1;
+
+   // initializes the SIMD functions
+   _aaxGetSIMDSupportLevel();
+   rb = _aaxRingBufferCreate(0.0f, AAX_MODE_WRITE_STEREO);
+   if (rb)
+   {
+      _aaxSynthVoice voice;
+      int i;
+
+      memset(&voice, 0, sizeof(voice));
+      voice.frequency = 440.0f;
+      voice.no_oscillators = 3;
+      voice.osc[0].wtype = AAX_PURE_SAWTOOTH;
+      voice.osc[0].freq_fact = 1.0f;
+      voice.osc[0].gain = 0.8f;
+      voice.osc[0].pre_gain = 0.0f;
+      voice.osc[1].wtype = AAX_SQUARE;
+      voice.osc[1].freq_fact = 2.01f;
+      voice.osc[1].gain = 0.6f;
+      voice.osc[1].phase = 1.0f;
+      voice.osc[1].pre_gain = 1.0f;
+      voice.osc[2].wtype = AAX_PURE_PULSE;
+      voice.osc[2].freq_fact = 0.5f;
+      voice.osc[2].gain = 0.5f;
+      voice.osc[2].pre_gain = 1.0f;
+      voice.osc[2].modulate = true;
+      rv = test_voice(&voice);
+
+      // the SIMD additive generator should match the scalar version,
+      // including the samples which do not fill a complete vector
+      _aax_generate_additive_cpu(dst[0], NO_SAMPLES+3, 436.0f, 1.0f,
+                                 AAX_SAWTOOTH);
+      _aax_generate_additive_float(dst[1], NO_SAMPLES+3, 436.0f, 1.0f,
+                                   AAX_SAWTOOTH);
+      for (i=0; i<NO_SAMPLES+3; ++i)
+      {
+         if (fabsf(dst[0][i] - dst[1][i]) > MAX_ERROR)
+         {
+            printf("additive: sample %i is %f instead of %f\n", i,
+                    dst[1][i], dst[0][i]);
+            rv = -1;
+            break;
+         }
+      }
+
+      // nothing above the Nyquist frequency
+      voice.frequency = FS;
+      voice.no_oscillators = 1;
+      _bufferRenderSynthVoice(dst[0], scratch, &voice, &voice.osc[0].phase,
+                              0, NO_SAMPLES, FS, 1.0f);
+      for (i=0; i<NO_SAMPLES; ++i)
+      {
+         if (dst[0][i] != 0.0f)
+         {
+            printf("nyquist: sample %i is %f instead of 0.0\n", i, dst[0][i]);
+            rv = -1;
+            break;
+         }
+      }
+      _aaxRingBufferFree(rb);
+   }
+
+   if (rv == 0) printf("Synth voice test passed\n");
+
+   return rv;
+}
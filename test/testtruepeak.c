@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <aax/aax.h>
+
+#include <arch.h>
+#include "base/timer.h"
+#include <software/rbuf_int.h>
+
+#define SAMPLE_FREQUENCY	48000
+#define NO_SAMPLES		1024
+#define NO_PERIODS		16
+#define CEILING			(0.891251f*AAX_PEAK_MAX)
+
+#define BUDGET_FREQUENCY	192000
+#define BUDGET_SAMPLES		1024
+#define BUDGET_TRACKS		8
+#define BUDGET_PERIODS		100
+
+static int
+test_budget()
+{
+   static MIX_T track[BUDGET_TRACKS][TRUEPEAK_TAPS+BUDGET_SAMPLES];
+   _aaxRingBufferSample rbd;
+   MIX_T *tracks[BUDGET_TRACKS];
+   double elapsed, budget;
+   _aaxTimer *ts;
+   int rv = 0;
+   size_t i;
+   int p, t;
+
+   memset(&rbd, 0, sizeof(rbd));
+   rbd.frequency_hz = BUDGET_FREQUENCY;
+   rbd.lookahead_sec = 0.005f;
+
+   for (t=0; t<BUDGET_TRACKS; ++t) {
+      tracks[t] = track[t] + TRUEPEAK_TAPS;
+   }
+
+   ts = _aaxTimerCreate();
+   elapsed = 0.0;
+   for (p=0; p<BUDGET_PERIODS; ++p)
+   {
+      for (t=0; t<BUDGET_TRACKS; ++t)
+      {
+         memcpy(track[t], tracks[t]+BUDGET_SAMPLES-TRUEPEAK_TAPS,
+                TRUEPEAK_TAPS*sizeof(MIX_T));
+         for (i=0; i<BUDGET_SAMPLES; ++i)
+         {
+            double s = 2.0*M_PI*997.0*(p*BUDGET_SAMPLES+i)/BUDGET_FREQUENCY;
+            tracks[t][i] = 1.5*AAX_PEAK_MAX*sin(s + t);
+         }
+      }
+
+      _aaxTimerStart(ts);
+      _aaxRingBufferTruePeakLimiter(&rbd, tracks, BUDGET_TRACKS,
+                                    BUDGET_SAMPLES);
+      elapsed += _aaxTimerElapsed(ts);
+   }
+   _aaxTimerDestroy(ts);
+   _aaxRingBufferTruePeakLimiterDestroy(rbd.limiter);
+
+   elapsed /= BUDGET_PERIODS;
+   budget = (double)BUDGET_SAMPLES/BUDGET_FREQUENCY;
+   printf("%i tracks at %i Hz: %5.3f ms of the %5.3f ms period (%4.1f%%)\n",
+           BUDGET_TRACKS, BUDGET_FREQUENCY, 1e3*elapsed, 1e3*budget,
+           100.0*elapsed/budget);
+   if (elapsed > 0.5*budget)
+   {
+      printf("true-peak limiter exceeds the period budget\n");
+      rv = -1;
+   }
+
+   return rv;
+}
+
+int main()
+{
+   static MIX_T track[2][TRUEPEAK_TAPS+NO_SAMPLES];
+   static MIX_T peak[NO_SAMPLES];
+   _aaxRingBufferSample rbd;
+   MIX_T *tracks[2];
+   float max = 0.0f;
+   int rv = 0;
+   size_t i;
+   int p, t;
+
+   memset(&rbd, 0, sizeof(rbd));
+   rbd.frequency_hz = SAMPLE_FREQUENCY;
+   rbd.lookahead_sec = 0.002f;
+
+   tracks[0] = track[0] + TRUEPEAK_TAPS;
+   tracks[1] = track[1] + TRUEPEAK_TAPS;
+   for (p=0; p<NO_PERIODS; ++p)
+   {
+      // a quarter sample-rate sine wave at 45 degrees phase offset has its
+      // true-peak exactly in between the samples and 3dB above them.
+      for (t=0; t<2; ++t)
+      {
+         memcpy(track[t], tracks[t]+NO_SAMPLES-TRUEPEAK_TAPS,
+                TRUEPEAK_TAPS*sizeof(MIX_T));
+         for (i=0; i<NO_SAMPLES; ++i)
+         {
+            double s = 0.25*2.0*M_PI*(p*NO_SAMPLES+i) + 0.25*M_PI;
+            tracks[t][i] = (t+1)*0.6*AAX_PEAK_MAX*sin(s);
+         }
+      }
+
+      _aaxRingBufferTruePeakLimiter(&rbd, tracks, 2, NO_SAMPLES);
+
+      if (p > 1)
+      {
+         memset(peak, 0, sizeof(peak));
+         for (t=0; t<2; ++t) {
+            _batch_get_truepeak(peak, tracks[t], NO_SAMPLES);
+         }
+         for (i=0; i<NO_SAMPLES; ++i) {
+            if (peak[i] > max) max = peak[i];
+         }
+      }
+   }
+   _aaxRingBufferTruePeakLimiterDestroy(rbd.limiter);
+
+   printf("true-peak: %5.2f dBTP, ceiling: %5.2f dBTP\n",
+           20.0f*log10f(max/AAX_PEAK_MAX), 20.0f*log10f(CEILING/AAX_PEAK_MAX));
+   if (max > 1.01f*CEILING || max < 0.9f*CEILING)
+   {
+      printf("true-peak limiter failed\n");
+      rv = -1;
+   }
+
+   // 8 tracks at 192kHz with the longest lookahead must stay well within
+   // the time of one period.
+   if (!rv) {
+      rv = test_budget();
+   }
+
+   return rv;
+}
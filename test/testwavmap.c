@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2008-2018 by Erik Hofman.
+ * Copyright (C) 2009-2018 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ * 
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR 
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <aax/aax.h>
+
+#define DEVNAME			"None"
+#define FILENAME		"testwavmap.wav"
+#define FS			44100
+#define NO_SAMPLES		5001
+#define LOOP_COUNT		3
+
+static void
+write16le(FILE *fp, unsigned int v)
+{
+   fputc(v & 0xFF, fp);
+   fputc((v >> 8) & 0xFF, fp);
+}
+
+static void
+write32le(FILE *fp, unsigned int v)
+{
+   write16le(fp, v & 0xFFFF);
+   write16le(fp, v >> 16);
+}
+
+static float
+sample(int track, int pos) {
+   return 0.8f*sinf(0.01f*pos*(track+1));
+}
+
+static int
+write_wav(const char *file, int tag, int bits, int tracks, int smpl)
+{
+   int blocksize = tracks*bits/8;
+   int datasize = NO_SAMPLES*blocksize;
+   int smplsize = smpl ? 8 + 60 : 0;
+   FILE *fp;
+   int i, t;
+
+   fp = fopen(file, "wb");
+   if (!fp) return -1;
+
+   fwrite("RIFF", 1, 4, fp);
+   write32le(fp, 4 + 24 + 8 + datasize + (datasize & 1) + smplsize);
+   fwrite("WAVE", 1, 4, fp);
+   fwrite("fmt ", 1, 4, fp);
+   write32le(fp, 16);
+   write16le(fp, tag);
+   write16le(fp, tracks);
+   write32le(fp, FS);
+   write32le(fp, FS*blocksize);
+   write16le(fp, blocksize);
+   write16le(fp, bits);
+   fwrite("data", 1, 4, fp);
+   write32le(fp, datasize);
+
+   for (i=0; i<NO_SAMPLES; ++i)
+   {
+      for (t=0; t<tracks; ++t)
+      {
+         float f = sample(t, i);
+         if (tag == 3) {
+            fwrite(&f, sizeof(float), 1, fp);
+         }
+         else
+         {
+            int32_t s = (int32_t)(f*8388607.0f);
+            fputc(s & 0xFF, fp);
+            fputc((s >> 8) & 0xFF, fp);
+            fputc((s >> 16) & 0xFF, fp);
+         }
+      }
+   }
+   if (datasize & 1) fputc(0, fp);
+
+   if (smpl)	/* one loop, stored after the data chunk */
+   {
+      fwrite("smpl", 1, 4, fp);
+      write32le(fp, 60);
+      write32le(fp, 0);			// manufacturer
+      write32le(fp, 0);			// product
+      write32le(fp, 1000000000/FS);	// sample period
+      write32le(fp, 60);		// unity note
+      write32le(fp, 0);			// pitch fraction
+      write32le(fp, 0);			// SMPTE format
+      write32le(fp, 0);			// SMPTE offset
+      write32le(fp, 1);			// number of loops
+      write32le(fp, 0);			// sampler data
+      write32le(fp, 0);			// cue point id
+      write32le(fp, 0);			// type: forward
+      write32le(fp, 1000);		// start
+      write32le(fp, 4000);		// end
+      write32le(fp, 0);			// fraction
+      write32le(fp, LOOP_COUNT);	// play count
+   }
+   fclose(fp);
+
+   return 0;
+}
+
+static int
+test_wav(aaxConfig config, const char *name, int tag, int bits, int tracks, enum aaxFormat fmt, int smpl)
+{
+   aaxBuffer buffer;
+   int rv = -1;
+
+   if (write_wav(FILENAME, tag, bits, tracks, smpl) < 0)
+   {
+      printf("%s: unable to write %s\n", name, FILENAME);
+      return rv;
+   }
+
+   buffer = aaxBufferReadFromStream(config, FILENAME);
+   if (!buffer) {
+      printf("%s: unable to read %s\n", name, FILENAME);
+   }
+   else if (aaxBufferGetSetup(buffer, AAX_FORMAT) != fmt ||
+            aaxBufferGetSetup(buffer, AAX_TRACKS) != tracks ||
+            aaxBufferGetSetup(buffer, AAX_NO_SAMPLES) != NO_SAMPLES)
+   {
+      printf("%s: format: %" PRIx64 ", tracks: %" PRIi64 ", samples: %" PRIi64 "\n",
+              name,
+              aaxBufferGetSetup(buffer, AAX_FORMAT),
+              aaxBufferGetSetup(buffer, AAX_TRACKS),
+              aaxBufferGetSetup(buffer, AAX_NO_SAMPLES));
+   }
+   else if (smpl && aaxBufferGetSetup(buffer, AAX_LOOP_COUNT) != LOOP_COUNT)
+   {
+      printf("%s: loop count: %" PRIi64 " instead of %i\n", name,
+              aaxBufferGetSetup(buffer, AAX_LOOP_COUNT), LOOP_COUNT);
+   }
+   else
+   {
+      void **data = aaxBufferGetData(buffer);
+      if (data)
+      {
+         const uint8_t *d = data[0];
+         int i, t;
+
+         rv = 0;
+         for (i=0; i<NO_SAMPLES && !rv; ++i)
+         {
+            for (t=0; t<tracks && !rv; ++t)
+            {
+               float f;
+
+               if (tag == 3)
+               {
+                  memcpy(&f, d, sizeof(float));
+                  d += sizeof(float);
+               }
+               else
+               {
+                  int32_t s = (int32_t)((d[0] << 8) | (d[1] << 16) | (d[2] << 24)) >> 8;
+                  f = s/8388607.0f;
+                  d += 3;
+               }
+
+               if (fabsf(f - sample(t, i)) > 1e-6f)
+               {
+                  printf("%s: track %i, sample %i is %f instead of %f\n",
+                          name, t, i, f, sample(t, i));
+                  rv = -1;
+               }
+            }
+         }
+         aaxFree(data);
+      }
+      else {
+         printf("%s: unable to get the buffer data\n", name);
+      }
+   }
+   aaxBufferDestroy(buffer);
+   remove(FILENAME);
+
+   return rv;
+}
+
+int main()
+{
+   aaxConfig config;
+   int rv = -1;
+
+   config = aaxDriverOpenByName(DEVNAME, AAX_MODE_WRITE_STEREO);
+   if (config)
+   {
+      rv = test_wav(config, "float", 3, 32, 2, AAX_FLOAT_LE, 0);
+      if (!rv) rv = test_wav(config, "pcm24", 1, 24, 1, AAX_PCM24S_PACKED_LE, 0);
+      if (!rv) rv = test_wav(config, "smpl", 1, 24, 1, AAX_PCM24S_PACKED_LE, 1);
+
+      aaxDriverClose(config);
+      aaxDriverDestroy(config);
+   }
+   else {
+      printf("Unable to open the %s device\n", DEVNAME);
+   }
+
+   if (!rv) printf("testwavmap: ok\n");
+
+   return rv;
+}